@@ -0,0 +1,113 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/ThreadPool.h"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace carla {
+
+namespace detail {
+
+  /// Maximum number of chunks of a ParallelFor, one per hardware thread.
+  inline size_t GetParallelForMaxChunks() {
+    static const size_t max_chunks = std::max(1u, std::thread::hardware_concurrency());
+    return max_chunks;
+  }
+
+  /// Worker threads shared by all the ParallelFor calls, started on first
+  /// use. The calling thread runs a chunk too, so there is one worker less
+  /// than chunks. Never destroyed, joining threads from static destructors
+  /// may deadlock when unloading a shared library.
+  inline ThreadPool &GetParallelForPool() {
+    static ThreadPool &pool = []() -> ThreadPool & {
+      auto *instance = new ThreadPool;
+      instance->AsyncRun(GetParallelForMaxChunks() - 1u);
+      return *instance;
+    }();
+    return pool;
+  }
+
+  /// Whether this thread is running a chunk of a ParallelFor.
+  inline bool &IsInParallelFor() {
+    static thread_local bool value = false;
+    return value;
+  }
+
+} // namespace detail
+
+  /// Call @a functor(i) for every i in [0, @a size), splitting the range in
+  /// contiguous chunks of at least @a min_chunk_size that run in parallel,
+  /// one per hardware thread. Blocks until every call has returned.
+  ///
+  /// Each index is visited by a single thread and in increasing order within
+  /// its chunk. If any call throws, the exception of the first failing chunk
+  /// is rethrown once all the threads have finished.
+  ///
+  /// The chunks run on a pool of threads shared by all the calls. A
+  /// ParallelFor called from inside a chunk runs in the calling thread, so the
+  /// pool is never waiting on itself.
+  template <typename FunctorT>
+  void ParallelFor(size_t size, size_t min_chunk_size, FunctorT &&functor) {
+    const size_t max_chunks = detail::IsInParallelFor() ? 1u : detail::GetParallelForMaxChunks();
+    const size_t number_of_chunks =
+        std::min(max_chunks, size / std::max<size_t>(1u, min_chunk_size));
+    if (number_of_chunks <= 1u) {
+      for (size_t i = 0u; i < size; ++i) {
+        functor(i);
+      }
+      return;
+    }
+
+    const size_t chunk_size = (size + number_of_chunks - 1u) / number_of_chunks;
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    std::vector<std::exception_ptr> exceptions(number_of_chunks);
+#endif // LIBCARLA_NO_EXCEPTIONS
+    auto run_chunk = [&](size_t chunk) {
+      detail::IsInParallelFor() = true;
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+        const size_t end = std::min(size, (chunk + 1u) * chunk_size);
+        for (size_t i = chunk * chunk_size; i < end; ++i) {
+          functor(i);
+        }
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      } catch (...) {
+        exceptions[chunk] = std::current_exception();
+      }
+#endif // LIBCARLA_NO_EXCEPTIONS
+      detail::IsInParallelFor() = false;
+    };
+
+    auto &pool = detail::GetParallelForPool();
+    std::vector<std::future<void>> workers;
+    workers.reserve(number_of_chunks - 1u);
+    for (size_t chunk = 1u; chunk < number_of_chunks; ++chunk) {
+      workers.emplace_back(pool.Post([&run_chunk, chunk]() { run_chunk(chunk); }));
+    }
+    // The first chunk runs in this thread.
+    run_chunk(0u);
+    for (auto &worker : workers) {
+      worker.wait();
+    }
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    for (auto &exception : exceptions) {
+      if (exception != nullptr) {
+        std::rethrow_exception(exception);
+      }
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+
+} // namespace carla
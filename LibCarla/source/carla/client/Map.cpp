@@ -11,7 +11,11 @@
 #include "carla/road/Map.h"
 #include "carla/road/RoadTypes.h"
 
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <sstream>
+#include <utility>
 
 namespace carla {
 namespace client {
@@ -22,12 +26,45 @@ namespace client {
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
-    return std::move(*map);
+    return std::make_shared<const road::Map>(std::move(*map));
+  }
+
+  /// Return the road map of @a opendrive_contents, parsed only once while any
+  /// client map of the same OpenDRIVE is alive. Every world.get_map() call
+  /// creates a new client map, this way they share the parsed map and its
+  /// cached waypoints and topology.
+  ///
+  /// Maps are keyed by the whole OpenDRIVE, comparing it costs far less than
+  /// parsing it.
+  static std::shared_ptr<const road::Map> GetSharedMap(const std::string &opendrive_contents) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const road::Map>> maps;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto it = maps.find(opendrive_contents);
+      if (it != maps.end()) {
+        if (auto map = it->second.lock()) {
+          return map;
+        }
+      }
+    }
+    // Parse without holding the lock, other maps can be created meanwhile.
+    auto map = MakeMap(opendrive_contents);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &entry = maps[opendrive_contents];
+    if (auto existing = entry.lock()) {
+      return existing;
+    }
+    entry = map;
+    for (auto it = maps.begin(); it != maps.end();) {
+      it = it->second.expired() ? maps.erase(it) : std::next(it);
+    }
+    return map;
   }
 
   Map::Map(rpc::MapInfo description)
     : _description(std::move(description)),
-      _map(MakeMap(_description.open_drive_file)) {}
+      _map(GetSharedMap(_description.open_drive_file)) {}
 
   Map::Map(std::string name, std::string xodr_content)
     : Map(rpc::MapInfo{
@@ -43,9 +80,25 @@ namespace client {
       uint32_t lane_type) const {
     boost::optional<road::element::Waypoint> waypoint;
     if (project_to_road) {
-      waypoint = _map.GetClosestWaypointOnRoad(location, lane_type);
+      waypoint = _map->GetClosestWaypointOnRoad(location, lane_type);
     } else {
-      waypoint = _map.GetWaypoint(location, lane_type);
+      waypoint = _map->GetWaypoint(location, lane_type);
+    }
+    return waypoint.has_value() ?
+        SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+        nullptr;
+  }
+
+  SharedPtr<Waypoint> Map::GetWaypoint(
+      const geom::Location &location,
+      const Waypoint &hint,
+      bool project_to_road,
+      uint32_t lane_type) const {
+    boost::optional<road::element::Waypoint> waypoint;
+    if (project_to_road) {
+      waypoint = _map->GetClosestWaypointOnRoad(location, hint._waypoint, lane_type);
+    } else {
+      waypoint = _map->GetWaypoint(location, hint._waypoint, lane_type);
     }
     return waypoint.has_value() ?
         SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
@@ -67,9 +120,9 @@ namespace client {
     };
 
     TopologyList result;
-    auto topology = _map.GenerateTopology();
-    result.reserve(topology.size());
-    for (const auto &pair : topology) {
+    const auto topology = _map->GetCachedTopology();
+    result.reserve(topology->size());
+    for (const auto &pair : *topology) {
       result.emplace_back(
           get_or_make_waypoint(pair.first),
           get_or_make_waypoint(pair.second));
@@ -79,22 +132,37 @@ namespace client {
 
   std::vector<SharedPtr<Waypoint>> Map::GenerateWaypoints(double distance) const {
     std::vector<SharedPtr<Waypoint>> result;
-    const auto waypoints = _map.GenerateWaypoints(distance);
-    result.reserve(waypoints.size());
-    for (const auto &waypoint : waypoints) {
+    const auto waypoints = _map->GetCachedWaypoints(distance);
+    result.reserve(waypoints->size());
+    for (const auto &waypoint : *waypoints) {
       result.emplace_back(SharedPtr<Waypoint>(new Waypoint{shared_from_this(), waypoint}));
     }
     return result;
   }
 
+  road::WaypointArrays Map::ExportWaypoints(
+      const std::vector<road::element::Waypoint> &waypoints) const {
+    return _map->ExportWaypoints(waypoints);
+  }
+
+  road::WaypointArrays Map::ExportWaypoints(double distance) const {
+    return _map->ExportWaypoints(*_map->GetCachedWaypoints(distance));
+  }
+
   std::vector<road::element::LaneMarking> Map::CalculateCrossedLanes(
       const geom::Location &origin,
       const geom::Location &destination) const {
-    return _map.CalculateCrossedLanes(origin, destination);
+    return _map->CalculateCrossedLanes(origin, destination);
+  }
+
+  std::vector<std::vector<road::element::LaneMarking>> Map::CalculateCrossedLanes(
+      const std::vector<road::element::LaneCrossingCalculator::Segment> &segments,
+      std::vector<road::element::LaneCrossingCalculator::Hint> &hints) const {
+    return _map->CalculateCrossedLanes(segments, hints);
   }
 
   const geom::GeoLocation &Map::GetGeoReference() const {
-    return _map.GetGeoReference();
+    return _map->GetGeoReference();
   }
 
 } // namespace client
@@ -13,6 +13,7 @@
 #include "carla/rpc/MapInfo.h"
 #include "carla/road/Lane.h"
 
+#include <memory>
 #include <string>
 
 namespace carla {
@@ -37,7 +38,7 @@ namespace client {
     }
 
     const road::Map &GetMap() const {
-      return _map;
+      return *_map;
     }
 
     const std::string &GetOpenDrive() const {
@@ -53,23 +54,44 @@ namespace client {
         bool project_to_road = true,
         uint32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
 
+    /// Same as above, but searching first around @a hint, usually the
+    /// waypoint of the same object in the previous frame.
+    SharedPtr<Waypoint> GetWaypoint(
+        const geom::Location &location,
+        const Waypoint &hint,
+        bool project_to_road = true,
+        uint32_t lane_type = static_cast<uint32_t>(road::Lane::LaneType::Driving)) const;
+
     using TopologyList = std::vector<std::pair<SharedPtr<Waypoint>, SharedPtr<Waypoint>>>;
 
     TopologyList GetTopology() const;
 
     std::vector<SharedPtr<Waypoint>> GenerateWaypoints(double distance) const;
 
+    /// Compute the properties of @a waypoints as contiguous arrays, see
+    /// road::Map::ExportWaypoints.
+    road::WaypointArrays ExportWaypoints(
+        const std::vector<road::element::Waypoint> &waypoints) const;
+
+    /// Same as above for the waypoints of GenerateWaypoints(@a distance).
+    road::WaypointArrays ExportWaypoints(double distance) const;
+
     std::vector<road::element::LaneMarking> CalculateCrossedLanes(
         const geom::Location &origin,
         const geom::Location &destination) const;
 
+    std::vector<std::vector<road::element::LaneMarking>> CalculateCrossedLanes(
+        const std::vector<road::element::LaneCrossingCalculator::Segment> &segments,
+        std::vector<road::element::LaneCrossingCalculator::Hint> &hints) const;
+
     const geom::GeoLocation &GetGeoReference() const;
 
   private:
 
     const rpc::MapInfo _description;
 
-    const road::Map _map;
+    /// Shared with the other client maps of the same OpenDRIVE.
+    const std::shared_ptr<const road::Map> _map;
   };
 
 } // namespace client
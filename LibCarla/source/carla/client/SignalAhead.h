@@ -0,0 +1,37 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/road/RoadTypes.h"
+
+#include <string>
+
+namespace carla {
+namespace client {
+
+  class Waypoint;
+
+  /// A signal found ahead of a waypoint, see Waypoint::GetSignalsAhead.
+  struct SignalAhead {
+    road::SignId id = 0u;
+    std::string name;
+    std::string country;
+    std::string type;
+    std::string subtype;
+    double value = 0.0;
+    std::string unit;
+    std::string text;
+    bool is_dynamic = false;
+    /// Distance driven from the waypoint up to the signal [meters].
+    double distance = 0.0;
+    /// Waypoint on the lane the signal applies to, at the signal's position.
+    SharedPtr<Waypoint> waypoint;
+  };
+
+} // namespace client
+} // namespace carla
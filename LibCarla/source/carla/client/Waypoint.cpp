@@ -7,6 +7,7 @@
 #include "carla/client/Waypoint.h"
 
 #include "carla/client/Map.h"
+#include "carla/road/signal/Signal.h"
 
 namespace carla {
 namespace client {
@@ -46,6 +47,29 @@ namespace client {
     return result;
   }
 
+  std::vector<SignalAhead> Waypoint::GetSignalsAhead(double distance) const {
+    const auto signals = _parent->GetMap().GetSignalsAhead(_waypoint, distance);
+    std::vector<SignalAhead> result;
+    result.reserve(signals.size());
+    for (const auto &item : signals) {
+      const auto &signal = *item.signal;
+      SignalAhead ahead;
+      ahead.id = signal.GetSignalId();
+      ahead.name = signal.GetName();
+      ahead.country = signal.GetCountry();
+      ahead.type = signal.GetType();
+      ahead.subtype = signal.GetSubtype();
+      ahead.value = signal.GetValue();
+      ahead.unit = signal.GetUnit();
+      ahead.text = signal.GetText();
+      ahead.is_dynamic = signal.IsDynamic();
+      ahead.distance = item.distance;
+      ahead.waypoint = SharedPtr<Waypoint>(new Waypoint(_parent, item.waypoint));
+      result.emplace_back(std::move(ahead));
+    }
+    return result;
+  }
+
   SharedPtr<Waypoint> Waypoint::GetRight() const {
     auto right_lane_waypoint =
         _parent->GetMap().GetRight(_waypoint);
@@ -8,6 +8,7 @@
 
 #include "carla/Memory.h"
 #include "carla/NonCopyable.h"
+#include "carla/client/SignalAhead.h"
 #include "carla/geom/Transform.h"
 #include "carla/road/element/LaneMarking.h"
 #include "carla/road/element/RoadInfoMarkRecord.h"
@@ -67,6 +68,11 @@ namespace client {
 
     std::vector<SharedPtr<Waypoint>> GetNext(double distance) const;
 
+    /// Return the signals that apply to this lane or the lanes a vehicle
+    /// could drive to from here, up to @a distance meters ahead, sorted by
+    /// distance.
+    std::vector<SignalAhead> GetSignalsAhead(double distance) const;
+
     SharedPtr<Waypoint> GetRight() const;
 
     SharedPtr<Waypoint> GetLeft() const;
@@ -8,6 +8,7 @@
 
 #include "carla/Logging.h"
 #include "carla/client/detail/Client.h"
+#include "carla/client/detail/LaneInvasionBatch.h"
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/sensor/Deserializer.h"
 
@@ -76,6 +77,12 @@ namespace detail {
           navigation->Tick(*next);
         }
 
+        // Tick lane invasion sensors.
+        auto lane_invasion = self->_lane_invasion.load();
+        if (lane_invasion != nullptr) {
+          lane_invasion->Tick(WorldSnapshot{next});
+        }
+
         // Call user callbacks.
         self->_on_tick_callbacks.Call(next);
       }
@@ -106,6 +113,18 @@ namespace detail {
     return navigation;
   }
 
+  std::shared_ptr<LaneInvasionBatch> Episode::CreateLaneInvasionBatchIfMissing() {
+    std::shared_ptr<LaneInvasionBatch> lane_invasion;
+    do {
+      lane_invasion = _lane_invasion.load();
+      if (lane_invasion == nullptr) {
+        auto new_lane_invasion = std::make_shared<LaneInvasionBatch>(_client);
+        _lane_invasion.compare_exchange(&lane_invasion, new_lane_invasion);
+      }
+    } while (lane_invasion == nullptr);
+    return lane_invasion;
+  }
+
   std::vector<rpc::Actor> Episode::GetActorsById(const std::vector<ActorId> &actor_ids) {
     return GetActorsById_Impl(_client, _actors, actor_ids);
   }
@@ -118,6 +137,7 @@ namespace detail {
     _actors.Clear();
     _on_tick_callbacks.Clear();
     _navigation.reset();
+    _lane_invasion.reset();
   }
 
 } // namespace detail
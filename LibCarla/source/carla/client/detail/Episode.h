@@ -23,6 +23,7 @@ namespace client {
 namespace detail {
 
   class Client;
+  class LaneInvasionBatch;
   class WalkerNavigation;
 
   /// Holds the current episode, and the current episode state.
@@ -57,6 +58,14 @@ namespace detail {
       return nav;
     }
 
+    std::shared_ptr<LaneInvasionBatch> CreateLaneInvasionBatchIfMissing();
+
+    /// Return nullptr if no lane invasion sensor was registered in this
+    /// episode.
+    std::shared_ptr<LaneInvasionBatch> GetLaneInvasionBatch() const {
+      return _lane_invasion.load();
+    }
+
     void RegisterActor(rpc::Actor actor) {
       _actors.Insert(std::move(actor));
     }
@@ -91,6 +100,8 @@ namespace detail {
 
     AtomicSharedPtr<WalkerNavigation> _navigation;
 
+    AtomicSharedPtr<LaneInvasionBatch> _lane_invasion;
+
     CachedActorList _actors;
 
     CallbackList<WorldSnapshot> _on_tick_callbacks;
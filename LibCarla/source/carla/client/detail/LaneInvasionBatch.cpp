@@ -0,0 +1,183 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/client/detail/LaneInvasionBatch.h"
+
+#include "carla/Logging.h"
+#include "carla/client/Map.h"
+#include "carla/client/WorldSnapshot.h"
+#include "carla/client/detail/Client.h"
+#include "carla/geom/Math.h"
+#include "carla/sensor/data/LaneInvasionEvent.h"
+
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <limits>
+
+namespace carla {
+namespace client {
+namespace detail {
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  static geom::Location Rotate(float yaw, const geom::Location &location) {
+    yaw *= geom::Math::Pi<float>() / 180.0f;
+    const float c = std::cos(yaw);
+    const float s = std::sin(yaw);
+    return {
+        c * location.x - s * location.y,
+        s * location.x + c * location.y,
+        location.z};
+  }
+
+  static std::vector<geom::Location> MakeCorners(
+      const geom::BoundingBox &box,
+      const geom::Transform &transform) {
+    const auto location = transform.location + box.location;
+    const auto yaw = transform.rotation.yaw;
+    return {
+        location + Rotate(yaw, geom::Location( box.extent.x,  box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location(-box.extent.x,  box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location( box.extent.x, -box.extent.y, 0.0f)),
+        location + Rotate(yaw, geom::Location(-box.extent.x, -box.extent.y, 0.0f))};
+  }
+
+  // ===========================================================================
+  // -- LaneInvasionBatch ------------------------------------------------------
+  // ===========================================================================
+
+  LaneInvasionBatch::LaneInvasionBatch(Client &client)
+    : _map(MakeShared<Map>(client.GetMapInfo())) {}
+
+  size_t LaneInvasionBatch::Register(
+      const ActorId parent,
+      const geom::BoundingBox &parent_bounding_box,
+      CallbackFunctionType callback) {
+    // Shared by all batches, a sensor may try to unregister from the batch of
+    // a newer episode.
+    static std::atomic_size_t counter{0u};
+    const size_t id = ++counter;
+    DEBUG_ASSERT(id != 0u);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _sensors.emplace_back(Sensor{
+        id,
+        parent,
+        parent_bounding_box,
+        std::move(callback),
+        0u,
+        {},
+        std::vector<road::element::LaneCrossingCalculator::Hint>(4u)});
+    return id;
+  }
+
+  void LaneInvasionBatch::Unregister(const size_t id) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _sensors.begin(); it != _sensors.end(); ++it) {
+      if (it->id == id) {
+        _sensors.erase(it);
+        return;
+      }
+    }
+  }
+
+  void LaneInvasionBatch::Tick(const WorldSnapshot &snapshot) {
+    using Calculator = road::element::LaneCrossingCalculator;
+
+    struct Event {
+      CallbackFunctionType callback;
+      ActorId parent;
+      geom::Transform transform;
+      std::vector<road::element::LaneMarking> crossed_lanes;
+    };
+    std::vector<Event> events;
+
+    try {
+      std::lock_guard<std::mutex> lock(_mutex);
+
+      // Collect the four corner segments of every vehicle that moved.
+      std::vector<Calculator::Segment> segments;
+      std::vector<Calculator::Hint> hints;
+      std::vector<std::pair<Sensor *, geom::Transform>> moved;
+      constexpr float distance_threshold = 10.0f * std::numeric_limits<float>::epsilon();
+      for (auto &sensor : _sensors) {
+        // Make sure the parent is alive and the frame is up-to-date.
+        auto parent = snapshot.Find(sensor.parent);
+        if (!parent || (sensor.frame >= snapshot.GetFrame())) {
+          continue;
+        }
+        sensor.frame = snapshot.GetFrame();
+        auto corners = MakeCorners(sensor.parent_bounding_box, parent->transform);
+        // First frame there is nothing to compare with.
+        if (sensor.corners.empty()) {
+          sensor.corners = std::move(corners);
+          continue;
+        }
+        // Make sure the distance is long enough.
+        bool has_moved = true;
+        for (auto i = 0u; i < 4u; ++i) {
+          if ((corners[i] - sensor.corners[i]).Length() < distance_threshold) {
+            has_moved = false;
+          }
+        }
+        if (!has_moved) {
+          continue;
+        }
+        for (auto i = 0u; i < 4u; ++i) {
+          segments.emplace_back(sensor.corners[i], corners[i]);
+          hints.emplace_back(sensor.hints[i]);
+        }
+        sensor.corners = std::move(corners);
+        moved.emplace_back(&sensor, parent->transform);
+      }
+      if (segments.empty()) {
+        return;
+      }
+
+      // Compute the crossed lanes of all of them at once.
+      const auto crossed_lanes_by_corner = _map->CalculateCrossedLanes(segments, hints);
+      DEBUG_ASSERT(crossed_lanes_by_corner.size() == segments.size());
+      for (auto k = 0u; k < moved.size(); ++k) {
+        auto &sensor = *moved[k].first;
+        std::vector<road::element::LaneMarking> crossed_lanes;
+        for (auto i = 0u; i < 4u; ++i) {
+          const auto &lanes = crossed_lanes_by_corner[4u * k + i];
+          crossed_lanes.insert(crossed_lanes.end(), lanes.begin(), lanes.end());
+          sensor.hints[i] = std::move(hints[4u * k + i]);
+        }
+        if (!crossed_lanes.empty()) {
+          events.emplace_back(Event{
+              sensor.callback,
+              sensor.parent,
+              moved[k].second,
+              std::move(crossed_lanes)});
+        }
+      }
+    } catch (const std::exception &e) {
+      log_error("LaneInvasionSensor:", e.what());
+      return;
+    }
+
+    // Call the callbacks without the lock, they may stop their sensor.
+    for (auto &event : events) {
+      try {
+        event.callback(MakeShared<sensor::data::LaneInvasionEvent>(
+            snapshot.GetTimestamp().frame,
+            snapshot.GetTimestamp().elapsed_seconds,
+            event.transform,
+            event.parent,
+            std::move(event.crossed_lanes)));
+      } catch (const std::exception &e) {
+        log_error("LaneInvasionSensor:", e.what());
+      }
+    }
+  }
+
+} // namespace detail
+} // namespace client
+} // namespace carla
@@ -0,0 +1,76 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/road/element/LaneCrossingCalculator.h"
+#include "carla/rpc/ActorId.h"
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+namespace sensor { class SensorData; }
+namespace client {
+
+  class Map;
+  class WorldSnapshot;
+
+namespace detail {
+
+  class Client;
+
+  /// Lane invasion detection of all the lane invasion sensors of an episode.
+  /// Each tick the crossed lanes of every vehicle are calculated in a single
+  /// batch, sharing one copy of the map.
+  class LaneInvasionBatch : private NonCopyable {
+  public:
+
+    using CallbackFunctionType = std::function<void(SharedPtr<sensor::SensorData>)>;
+
+    explicit LaneInvasionBatch(Client &client);
+
+    /// Register a sensor attached to the vehicle @a parent, @a callback is
+    /// called with a LaneInvasionEvent each tick it crosses lane markings.
+    /// Return an id to unregister it, unique among all batches.
+    size_t Register(
+        ActorId parent,
+        const geom::BoundingBox &parent_bounding_box,
+        CallbackFunctionType callback);
+
+    void Unregister(size_t id);
+
+    void Tick(const WorldSnapshot &snapshot);
+
+  private:
+
+    struct Sensor {
+      size_t id;
+      ActorId parent;
+      geom::BoundingBox parent_bounding_box;
+      CallbackFunctionType callback;
+      size_t frame;
+      /// Bounding box corners in the last frame, empty before the first one.
+      std::vector<geom::Location> corners;
+      /// Lanes found at each corner in the last frame.
+      std::vector<road::element::LaneCrossingCalculator::Hint> hints;
+    };
+
+    SharedPtr<const Map> _map;
+
+    std::mutex _mutex;
+
+    std::vector<Sensor> _sensors;
+  };
+
+} // namespace detail
+} // namespace client
+} // namespace carla
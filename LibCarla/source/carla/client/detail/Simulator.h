@@ -19,6 +19,7 @@
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/Episode.h"
 #include "carla/client/detail/EpisodeProxy.h"
+#include "carla/client/detail/LaneInvasionBatch.h"
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/rpc/TrafficLightState.h"
@@ -150,6 +151,26 @@ namespace detail {
       _episode->RemoveOnTickEvent(id);
     }
 
+    /// Register a lane invasion sensor attached to @a vehicle, all of them are
+    /// ticked together in one batch.
+    size_t RegisterLaneInvasionSensor(
+        const Vehicle &vehicle,
+        LaneInvasionBatch::CallbackFunctionType callback) {
+      DEBUG_ASSERT(_episode != nullptr);
+      return _episode->CreateLaneInvasionBatchIfMissing()->Register(
+          vehicle.GetId(),
+          vehicle.GetBoundingBox(),
+          std::move(callback));
+    }
+
+    void UnregisterLaneInvasionSensor(size_t id) {
+      DEBUG_ASSERT(_episode != nullptr);
+      auto lane_invasion = _episode->GetLaneInvasionBatch();
+      if (lane_invasion != nullptr) {
+        lane_invasion->Unregister(id);
+      }
+    }
+
     uint64_t Tick();
 
     /// @}
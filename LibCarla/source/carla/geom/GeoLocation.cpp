@@ -63,6 +63,30 @@ namespace geom {
     MercatorToLatLon(mx, my, scale, lat_end, lon_end);
   }
 
+  /// Mercator projection around a geo-reference, with the terms that depend
+  /// only on the geo-reference precomputed for converting many points.
+  struct MercatorProjection {
+
+    explicit MercatorProjection(const GeoLocation &reference)
+      : altitude(reference.altitude),
+        radius(LatToScale(reference.latitude) * EARTH_RADIUS_EQUA),
+        meters_per_degree(Math::ToRadians(radius)) {
+      LatLonToMercator(reference.latitude, reference.longitude, radius / EARTH_RADIUS_EQUA, origin_x, origin_y);
+    }
+
+    double altitude;
+
+    /// Earth radius at the equator times the scale of the geo-reference.
+    double radius;
+
+    /// Meters per degree of longitude.
+    double meters_per_degree;
+
+    double origin_x;
+
+    double origin_y;
+  };
+
   GeoLocation GeoLocation::Transform(const Location &location) const {
     GeoLocation result{0.0, 0.0, altitude + location.z};
     LatLonAddMeters(
@@ -72,5 +96,56 @@ namespace geom {
     return result;
   }
 
+  void GeoLocation::Transform(
+      const Location *locations,
+      const size_t count,
+      GeoLocation *result) const {
+    const MercatorProjection projection(*this);
+    const double degrees_per_meter = 1.0 / projection.meters_per_degree;
+    const double inverse_radius = 1.0 / projection.radius;
+    // Same as MercatorToLatLon, without branches nor divisions so the
+    // arithmetic can be vectorized.
+    for (size_t i = 0u; i < count; ++i) {
+      const double mx = projection.origin_x + locations[i].x;
+      const double my = projection.origin_y - locations[i].y; // Increasing latitudes northward.
+      result[i].latitude = 2.0 * Math::ToDegrees(std::atan(std::exp(my * inverse_radius))) - 90.0;
+      result[i].longitude = mx * degrees_per_meter;
+      result[i].altitude = projection.altitude + locations[i].z;
+    }
+  }
+
+  std::vector<GeoLocation> GeoLocation::Transform(const std::vector<Location> &locations) const {
+    std::vector<GeoLocation> result(locations.size());
+    Transform(locations.data(), locations.size(), result.data());
+    return result;
+  }
+
+  Location GeoLocation::InverseTransform(const GeoLocation &geo_location) const {
+    Location result;
+    InverseTransform(&geo_location, 1u, &result);
+    return result;
+  }
+
+  void GeoLocation::InverseTransform(
+      const GeoLocation *geo_locations,
+      const size_t count,
+      Location *result) const {
+    const MercatorProjection projection(*this);
+    // Same as LatLonToMercator.
+    for (size_t i = 0u; i < count; ++i) {
+      const double mx = geo_locations[i].longitude * projection.meters_per_degree;
+      const double my = projection.radius * std::log(std::tan(Math::ToRadians(0.5 * (90.0 + geo_locations[i].latitude))));
+      result[i].x = static_cast<float>(mx - projection.origin_x);
+      result[i].y = static_cast<float>(projection.origin_y - my);
+      result[i].z = static_cast<float>(geo_locations[i].altitude - projection.altitude);
+    }
+  }
+
+  std::vector<Location> GeoLocation::InverseTransform(const std::vector<GeoLocation> &geo_locations) const {
+    std::vector<Location> result(geo_locations.size());
+    InverseTransform(geo_locations.data(), geo_locations.size(), result.data());
+    return result;
+  }
+
 } // namespace geom
 } // namespace carla
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 namespace carla {
 namespace geom {
 
@@ -43,6 +46,23 @@ namespace geom {
     /// geo-reference.
     GeoLocation Transform(const Location &location) const;
 
+    /// Transform the @a count locations at @a locations to GeoLocations using
+    /// this as geo-reference, writing them to @a result. Same as calling
+    /// Transform for each location, but the terms that depend only on the
+    /// geo-reference are computed once per call.
+    void Transform(const Location *locations, size_t count, GeoLocation *result) const;
+
+    std::vector<GeoLocation> Transform(const std::vector<Location> &locations) const;
+
+    /// Transform the given @a geo_location back to a Location using this as
+    /// geo-reference, the inverse of Transform.
+    Location InverseTransform(const GeoLocation &geo_location) const;
+
+    /// Batch version of InverseTransform, see Transform.
+    void InverseTransform(const GeoLocation *geo_locations, size_t count, Location *result) const;
+
+    std::vector<Location> InverseTransform(const std::vector<GeoLocation> &geo_locations) const;
+
     // =========================================================================
     // -- Comparison operators -------------------------------------------------
     // =========================================================================
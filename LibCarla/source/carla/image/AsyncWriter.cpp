@@ -0,0 +1,143 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/AsyncWriter.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/sensor/SensorData.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace carla {
+namespace image {
+
+  AsyncWriter::AsyncWriter(
+      WriteFunction write,
+      size_t worker_threads,
+      const size_t queue_size,
+      const DropPolicy drop_policy)
+    : _write(std::move(write)),
+      _queue_size(queue_size),
+      _drop_policy(drop_policy) {
+    if (_queue_size == 0u) {
+      throw_exception(std::invalid_argument("the queue size must be greater than zero"));
+    }
+    if (worker_threads == 0u) {
+      worker_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    _workers.CreateThreads(worker_threads, [this]() { Run(); });
+  }
+
+  AsyncWriter::~AsyncWriter() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _job_available.notify_all();
+    _space_available.notify_all();
+    _workers.JoinAll();
+  }
+
+  bool AsyncWriter::Submit(SharedPtr<sensor::SensorData> data, std::string path) {
+    DEBUG_ASSERT(data != nullptr);
+    // The discarded job is destroyed after releasing the lock.
+    Job discarded;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      if (_submitted == 0u) {
+        _first_submission = clock::now();
+      }
+      ++_submitted;
+      if (_queue.size() >= _queue_size) {
+        switch (_drop_policy) {
+          case DropPolicy::Block:
+            _space_available.wait(lock, [this]() {
+              return _stop || (_queue.size() < _queue_size);
+            });
+            if (_stop) {
+              ++_dropped;
+              return false;
+            }
+            break;
+          case DropPolicy::DropNewest:
+            ++_dropped;
+            return false;
+          case DropPolicy::DropOldest:
+            discarded = std::move(_queue.front());
+            _queue.pop_front();
+            ++_dropped;
+            break;
+        }
+      }
+      _queue.emplace_back(Job{std::move(data), std::move(path)});
+    }
+    _job_available.notify_one();
+    return true;
+  }
+
+  void AsyncWriter::Flush() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this]() { return _queue.empty() && (_in_progress == 0u); });
+  }
+
+  AsyncWriter::Stats AsyncWriter::GetStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::chrono::duration<double> elapsed = _last_write - _first_submission;
+    const size_t done = _written + _failed;
+    return {
+        _queue.size() + _in_progress,
+        _submitted,
+        _written,
+        _dropped,
+        _failed,
+        (done > 0u) && (elapsed.count() > 0.0) ? static_cast<double>(done) / elapsed.count() : 0.0};
+  }
+
+  void AsyncWriter::Run() {
+    for (;;) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _job_available.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+          return; // Stopped and every job written.
+        }
+        job = std::move(_queue.front());
+        _queue.pop_front();
+        ++_in_progress;
+      }
+      _space_available.notify_one();
+
+      bool success = false;
+      try {
+        _write(*job.data, job.path);
+        success = true;
+      } catch (const std::exception &e) {
+        log_error("failed to write", job.path, ':', e.what());
+      }
+      job.data.reset();
+
+      bool idle = false;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_in_progress;
+        ++(success ? _written : _failed);
+        _last_write = clock::now();
+        idle = _queue.empty() && (_in_progress == 0u);
+      }
+      if (idle) {
+        _idle.notify_all();
+      }
+    }
+  }
+
+} // namespace image
+} // namespace carla
@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace carla {
+namespace sensor { class SensorData; }
+namespace image {
+
+  /// Writes sensor data, like images and point clouds, to disk in a pool of
+  /// worker threads, so the thread submitting it, usually a sensor callback,
+  /// does not wait for the encoding. The data submitted waits in a bounded
+  /// queue, when the queue is full the DropPolicy decides whether submitting
+  /// blocks or which data is discarded.
+  class AsyncWriter : private NonCopyable {
+  public:
+
+    /// Writes the data to the given path, called concurrently from the worker
+    /// threads.
+    using WriteFunction = std::function<void(const sensor::SensorData &, std::string)>;
+
+    enum class DropPolicy : uint8_t {
+      /// Wait until there is space in the queue.
+      Block,
+      /// Discard the data being submitted.
+      DropNewest,
+      /// Discard the oldest data in the queue.
+      DropOldest
+    };
+
+    struct Stats {
+      /// Data waiting in the queue or being written.
+      size_t pending;
+      size_t submitted;
+      size_t written;
+      size_t dropped;
+      size_t failed;
+      /// Writes per second from the first submission to the last write.
+      double writes_per_second;
+    };
+
+    /// Launch @a worker_threads threads calling @a write, or one per hardware
+    /// thread if zero, with a queue of @a queue_size elements.
+    AsyncWriter(
+        WriteFunction write,
+        size_t worker_threads,
+        size_t queue_size,
+        DropPolicy drop_policy);
+
+    /// Write the data still in the queue and join the worker threads.
+    ~AsyncWriter();
+
+    /// Queue @a data to be written to @a path.
+    ///
+    /// @return false if @a data was discarded.
+    bool Submit(SharedPtr<sensor::SensorData> data, std::string path);
+
+    /// Block until all the data submitted has been written or discarded.
+    void Flush();
+
+    Stats GetStats() const;
+
+  private:
+
+    using clock = std::chrono::steady_clock;
+
+    struct Job {
+      SharedPtr<sensor::SensorData> data;
+      std::string path;
+    };
+
+    void Run();
+
+    const WriteFunction _write;
+
+    const size_t _queue_size;
+
+    const DropPolicy _drop_policy;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _job_available;
+
+    std::condition_variable _space_available;
+
+    std::condition_variable _idle;
+
+    std::deque<Job> _queue;
+
+    size_t _in_progress = 0u;
+
+    bool _stop = false;
+
+    size_t _submitted = 0u;
+
+    size_t _written = 0u;
+
+    size_t _dropped = 0u;
+
+    size_t _failed = 0u;
+
+    clock::time_point _first_submission;
+
+    clock::time_point _last_write;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace image
+} // namespace carla
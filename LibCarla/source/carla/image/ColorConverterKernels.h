@@ -0,0 +1,326 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/image/BoostGil.h"
+#include "carla/image/ColorConverter.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+#  include <immintrin.h>
+#endif
+
+namespace carla {
+namespace image {
+namespace detail {
+
+  /// The depth encoded in the red, green and blue channels of a BGRA pixel
+  /// read as a little-endian 32-bit integer, as read by ColorConverter::Depth.
+  static inline uint32_t DecodeDepth(uint32_t pixel) {
+    return ((pixel >> 16u) & 0xFFu) | (pixel & 0xFF00u) | ((pixel & 0xFFu) << 16u);
+  }
+
+  /// Opaque BGRA pixel with the same @a grey level in every color channel.
+  static inline uint32_t MakeGreyPixel(uint32_t grey) {
+    return 0xFF000000u | (grey << 16u) | (grey << 8u) | grey;
+  }
+
+  static inline boost::gil::bgra8_pixel_t EncodeDepth(uint32_t depth) {
+    boost::gil::bgra8_pixel_t pixel;
+    get_color(pixel, boost::gil::red_t()) = static_cast<uint8_t>(depth & 0xFFu);
+    get_color(pixel, boost::gil::green_t()) = static_cast<uint8_t>((depth >> 8u) & 0xFFu);
+    get_color(pixel, boost::gil::blue_t()) = static_cast<uint8_t>((depth >> 16u) & 0xFFu);
+    get_color(pixel, boost::gil::alpha_t()) = 255u;
+    return pixel;
+  }
+
+  /// Replace each pixel of [@a begin, @a end), read as a 32-bit integer, by
+  /// @a kernel(pixel).
+  template <typename FunctorT>
+  static inline void ForEachPixel(uint8_t *begin, uint8_t *end, FunctorT &&kernel) {
+    const auto size = static_cast<size_t>(end - begin) / sizeof(uint32_t);
+    for (size_t i = 0u; i < size; ++i) {
+      uint32_t pixel;
+      std::memcpy(&pixel, begin + sizeof(uint32_t) * i, sizeof(uint32_t));
+      pixel = kernel(pixel);
+      std::memcpy(begin + sizeof(uint32_t) * i, &pixel, sizeof(uint32_t));
+    }
+  }
+
+  /// Table mapping each of the 2^24 depths to the grey level given by a
+  /// converter, in buckets of 256 depths. Buckets where the grey level is
+  /// constant store it directly, the rest point to a table of 256 grey
+  /// levels.
+  ///
+  /// The grey level must be non-decreasing with the depth, so only the
+  /// first and last depth of each bucket need to be evaluated to find the
+  /// constant ones. The values are computed with the converter itself, so
+  /// the table gives exactly the same results.
+  class DepthLookupTable {
+  public:
+
+    template <typename FunctorT>
+    explicit DepthLookupTable(FunctorT &&grey_level) {
+      constexpr uint32_t bucket_size = 256u;
+      _buckets.resize(1u << 16u);
+      for (uint32_t bucket = 0u; bucket < _buckets.size(); ++bucket) {
+        const uint32_t first = bucket * bucket_size;
+        const uint8_t value = grey_level(first);
+        if (value == grey_level(first + bucket_size - 1u)) {
+          _buckets[bucket] = value;
+          continue;
+        }
+        _buckets[bucket] = static_cast<uint16_t>(bucket_size + _tables.size() / bucket_size);
+        for (uint32_t i = 0u; i < bucket_size; ++i) {
+          _tables.emplace_back(grey_level(first + i));
+        }
+      }
+      // Padding, so 32-bit gathers of the last elements stay in bounds.
+      _buckets.emplace_back(0u);
+      _tables.resize(_tables.size() + 3u, 0u);
+    }
+
+    uint8_t operator[](uint32_t depth) const {
+      const uint16_t bucket = _buckets[depth >> 8u];
+      return bucket < 256u ?
+          static_cast<uint8_t>(bucket) :
+          _tables[((bucket - 256u) << 8u) | (depth & 0xFFu)];
+    }
+
+    const uint16_t *GetBuckets() const {
+      return _buckets.data();
+    }
+
+    const uint8_t *GetTables() const {
+      return _tables.data();
+    }
+
+  private:
+
+    std::vector<uint16_t> _buckets;
+
+    std::vector<uint8_t> _tables;
+  };
+
+  static inline const DepthLookupTable &GetLogarithmicDepthTable() {
+    static const DepthLookupTable table{[](uint32_t depth) {
+      boost::gil::gray32f_pixel_t linear;
+      ColorConverter::Depth()(EncodeDepth(depth), linear);
+      boost::gil::bgra8_pixel_t dst;
+      ColorConverter::LogarithmicLinear()(linear, dst);
+      return get_color(dst, boost::gil::red_t());
+    }};
+    return table;
+  }
+
+  /// Output pixel of each tag, the red channel of the input pixel.
+  static inline const std::array<uint32_t, 256u> &GetCityScapesPaletteTable() {
+    static const auto table = [] {
+      std::array<uint32_t, 256u> result;
+      for (auto tag = 0u; tag < result.size(); ++tag) {
+        boost::gil::bgra8_pixel_t src{0u, 0u, 0u, 255u};
+        get_color(src, boost::gil::red_t()) = static_cast<uint8_t>(tag);
+        boost::gil::bgra8_pixel_t dst;
+        ColorConverter::CityScapesPalette()(src, dst);
+        static_assert(sizeof(dst) == sizeof(uint32_t), "Invalid pixel size.");
+        std::memcpy(&result[tag], &dst, sizeof(dst));
+      }
+      return result;
+    }();
+    return table;
+  }
+
+#ifdef LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+
+  /// Whether the CPU we are running on supports AVX2.
+  static inline bool HasAvx2() {
+    static const bool result = [] {
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return result;
+  }
+
+namespace avx2 {
+
+  // Each kernel converts blocks of 8 pixels and returns where it stopped, the
+  // remaining pixels are left to the scalar kernels.
+
+  constexpr size_t BlockSize = sizeof(__m256i);
+
+  __attribute__((target("avx2")))
+  static inline __m256i Load(const uint8_t *data) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+  }
+
+  __attribute__((target("avx2")))
+  static inline void Store(uint8_t *data, __m256i pixels) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(data), pixels);
+  }
+
+  /// DecodeDepth of 8 pixels, the red, green and blue bytes of each pixel
+  /// moved to its bytes 0, 1 and 2.
+  __attribute__((target("avx2")))
+  static inline __m256i DecodeDepth(__m256i pixels) {
+    const __m256i shuffle = _mm256_setr_epi8(
+        2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+        2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+    return _mm256_shuffle_epi8(pixels, shuffle);
+  }
+
+  /// MakeGreyPixel of 8 grey levels.
+  __attribute__((target("avx2")))
+  static inline __m256i MakeGreyPixel(__m256i grey) {
+    return _mm256_or_si256(
+        _mm256_mullo_epi32(grey, _mm256_set1_epi32(0x00010101)),
+        _mm256_set1_epi32(static_cast<int>(0xFF000000u)));
+  }
+
+  /// The same float operations as the scalar kernel, the division and then
+  /// channel_convert's truncated x * 255 + 0.5, so the results are
+  /// bit-identical.
+  __attribute__((target("avx2")))
+  static inline uint8_t *Depth(uint8_t *begin, uint8_t *end) {
+    const __m256 max_depth = _mm256_set1_ps(static_cast<float>(256 * 256 * 256 - 1));
+    const __m256 max_value = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    for (; static_cast<size_t>(end - begin) >= BlockSize; begin += BlockSize) {
+      const __m256 depth = _mm256_cvtepi32_ps(DecodeDepth(Load(begin)));
+      const __m256 normalized = _mm256_div_ps(depth, max_depth);
+      const __m256 grey = _mm256_add_ps(_mm256_mul_ps(normalized, max_value), half);
+      Store(begin, MakeGreyPixel(_mm256_cvttps_epi32(grey)));
+    }
+    return begin;
+  }
+
+  /// Two gathers per block, the bucket of each depth and, for the buckets
+  /// pointing to a table, the grey level in the table.
+  __attribute__((target("avx2")))
+  static inline uint8_t *LogarithmicDepth(uint8_t *begin, uint8_t *end) {
+    const auto &table = GetLogarithmicDepthTable();
+    const auto *buckets = reinterpret_cast<const int *>(table.GetBuckets());
+    const auto *tables = reinterpret_cast<const int *>(table.GetTables());
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+    const __m256i low_half = _mm256_set1_epi32(0xFFFF);
+    const __m256i max_grey = _mm256_set1_epi32(255);
+    const __m256i first_table = _mm256_set1_epi32(256);
+    for (; static_cast<size_t>(end - begin) >= BlockSize; begin += BlockSize) {
+      const __m256i depth = DecodeDepth(Load(begin));
+      const __m256i bucket = _mm256_and_si256(
+          _mm256_i32gather_epi32(buckets, _mm256_srli_epi32(depth, 8), 2),
+          low_half);
+      const __m256i in_table = _mm256_cmpgt_epi32(bucket, max_grey);
+      const __m256i index = _mm256_or_si256(
+          _mm256_slli_epi32(_mm256_sub_epi32(bucket, first_table), 8),
+          _mm256_and_si256(depth, low_byte));
+      // Lanes out of the mask keep the bucket, their grey level.
+      const __m256i grey = _mm256_and_si256(
+          _mm256_mask_i32gather_epi32(bucket, tables, index, in_table, 1),
+          low_byte);
+      Store(begin, MakeGreyPixel(grey));
+    }
+    return begin;
+  }
+
+  __attribute__((target("avx2")))
+  static inline uint8_t *CityScapesPalette(uint8_t *begin, uint8_t *end) {
+    const auto *table = reinterpret_cast<const int *>(GetCityScapesPaletteTable().data());
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+    for (; static_cast<size_t>(end - begin) >= BlockSize; begin += BlockSize) {
+      const __m256i tag = _mm256_and_si256(_mm256_srli_epi32(Load(begin), 16), low_byte);
+      Store(begin, _mm256_i32gather_epi32(table, tag, 4));
+    }
+    return begin;
+  }
+
+} // namespace avx2
+
+#endif // LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+
+} // namespace detail
+
+  /// Color conversions of 32-bit BGRA pixels in place, with the same
+  /// results as the per-pixel converters of ColorConverter but working
+  /// directly on the pixel memory. The converters that need a logarithm or a
+  /// palette are precomputed once in lookup tables.
+  ///
+  /// On x86 with GCC or Clang, the kernels use AVX2 if the CPU supports it,
+  /// checked at runtime. Otherwise, and for the pixels left after the last
+  /// block of 8, they fall back to the Scalar kernels.
+  class ColorConverterKernels {
+  public:
+
+    /// Kernels without intrinsics, the reference of the vectorized ones.
+    class Scalar {
+    public:
+
+      /// Same as ColorConverter::Depth, with the same floating point
+      /// operations in a branch-free loop the compiler can vectorize.
+      static void Depth(uint8_t *begin, uint8_t *end) {
+        constexpr float max_depth = static_cast<float>(256 * 256 * 256 - 1);
+        detail::ForEachPixel(begin, end, [](uint32_t pixel) {
+          const float normalized = static_cast<float>(detail::DecodeDepth(pixel)) / max_depth;
+          return detail::MakeGreyPixel(boost::gil::channel_convert<uint8_t>(boost::gil::float32_t(normalized)));
+        });
+      }
+
+      /// Same as ColorConverter::LogarithmicDepth.
+      static void LogarithmicDepth(uint8_t *begin, uint8_t *end) {
+        const auto &table = detail::GetLogarithmicDepthTable();
+        detail::ForEachPixel(begin, end, [&table](uint32_t pixel) {
+          return detail::MakeGreyPixel(table[detail::DecodeDepth(pixel)]);
+        });
+      }
+
+      /// Same as ColorConverter::CityScapesPalette.
+      static void CityScapesPalette(uint8_t *begin, uint8_t *end) {
+        const auto &table = detail::GetCityScapesPaletteTable();
+        detail::ForEachPixel(begin, end, [&table](uint32_t pixel) {
+          return table[(pixel >> 16u) & 0xFFu];
+        });
+      }
+    };
+
+    /// Same as ColorConverter::Depth.
+    static void Depth(uint8_t *begin, uint8_t *end) {
+#ifdef LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+      if (detail::HasAvx2()) {
+        begin = detail::avx2::Depth(begin, end);
+      }
+#endif // LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+      Scalar::Depth(begin, end);
+    }
+
+    /// Same as ColorConverter::LogarithmicDepth.
+    static void LogarithmicDepth(uint8_t *begin, uint8_t *end) {
+#ifdef LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+      if (detail::HasAvx2()) {
+        begin = detail::avx2::LogarithmicDepth(begin, end);
+      }
+#endif // LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+      Scalar::LogarithmicDepth(begin, end);
+    }
+
+    /// Same as ColorConverter::CityScapesPalette.
+    static void CityScapesPalette(uint8_t *begin, uint8_t *end) {
+#ifdef LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+      if (detail::HasAvx2()) {
+        begin = detail::avx2::CityScapesPalette(begin, end);
+      }
+#endif // LIBCARLA_IMAGE_WITH_AVX2_KERNELS
+      Scalar::CityScapesPalette(begin, end);
+    }
+  };
+
+} // namespace image
+} // namespace carla
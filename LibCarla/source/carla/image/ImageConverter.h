@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/image/ColorConverterKernels.h"
 #include "carla/image/ImageView.h"
 
 namespace carla {
@@ -28,6 +29,34 @@ namespace image {
           ImageView::MakeColorConvertedView<MutableImageView, DstPixelT>(image_view, converter),
           image_view);
     }
+
+    /// @{
+    /// Same as the generic ConvertInPlace, for the BGRA images of the
+    /// sensors, using the precomputed ColorConverterKernels.
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::Depth) {
+      ForEachRow(image_view, ColorConverterKernels::Depth);
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::LogarithmicDepth) {
+      ForEachRow(image_view, ColorConverterKernels::LogarithmicDepth);
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::CityScapesPalette) {
+      ForEachRow(image_view, ColorConverterKernels::CityScapesPalette);
+    }
+
+    /// @}
+
+  private:
+
+    template <typename FunctorT>
+    static void ForEachRow(boost::gil::bgra8_view_t &image_view, FunctorT &&kernel) {
+      for (std::ptrdiff_t y = 0; y < image_view.height(); ++y) {
+        auto *begin = reinterpret_cast<uint8_t *>(&*image_view.row_begin(y));
+        kernel(begin, begin + sizeof(boost::gil::bgra8_pixel_t) * static_cast<size_t>(image_view.width()));
+      }
+    }
   };
 
 } // namespace image
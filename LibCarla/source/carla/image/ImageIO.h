@@ -24,6 +24,15 @@ namespace image {
       IO::write_view(out_filename, image_view);
       return out_filename;
     }
+
+    /// Write @a image_view with the @a compression level of the format, from
+    /// 0 to 9 for PNG and the quality from 0 to 100 for JPEG, negative for the
+    /// default.
+    template <typename ViewT, typename IO = io::any>
+    static std::string WriteView(std::string out_filename, const ViewT &image_view, int compression, IO = IO()) {
+      IO::write_view(out_filename, image_view, compression);
+      return out_filename;
+    }
   };
 
 } // namespace image
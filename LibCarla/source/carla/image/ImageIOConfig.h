@@ -123,6 +123,17 @@ namespace detail {
       boost::gil::write_view(std::forward<Str>(out_filename), view, boost::gil::png_tag());
     }
 
+    /// Write with zlib @a compression level from 0 to 9, negative for the
+    /// default.
+    template <typename Str, typename ViewT>
+    static void write_view(Str &&out_filename, const ViewT &view, int compression) {
+      boost::gil::image_write_info<boost::gil::png_tag> info;
+      if (compression >= 0) {
+        info._compression_level = compression;
+      }
+      boost::gil::write_view(std::forward<Str>(out_filename), view, info);
+    }
+
 #endif // LIBCARLA_IMAGE_WITH_PNG_SUPPORT
   };
 
@@ -162,6 +173,30 @@ namespace detail {
           boost::gil::jpeg_tag());
     }
 
+    /// Write with @a quality from 0 to 100, negative for the default.
+    template <typename Str, typename ViewT>
+    static typename std::enable_if<is_write_supported<ViewT, boost::gil::jpeg_tag>::value>::type
+    write_view(Str &&out_filename, const ViewT &view, int quality) {
+      boost::gil::write_view(std::forward<Str>(out_filename), view, make_write_info(quality));
+    }
+
+    template <typename Str, typename ViewT>
+    static typename std::enable_if<!is_write_supported<ViewT, boost::gil::jpeg_tag>::value>::type
+    write_view(Str &&out_filename, const ViewT &view, int quality) {
+      boost::gil::write_view(
+          std::forward<Str>(out_filename),
+          boost::gil::color_converted_view<boost::gil::rgb8_pixel_t>(view),
+          make_write_info(quality));
+    }
+
+    static boost::gil::image_write_info<boost::gil::jpeg_tag> make_write_info(int quality) {
+      boost::gil::image_write_info<boost::gil::jpeg_tag> info;
+      if (quality >= 0) {
+        info._quality = quality;
+      }
+      return info;
+    }
+
 #endif // LIBCARLA_IMAGE_WITH_JPEG_SUPPORT
   };
 
@@ -200,6 +235,12 @@ namespace detail {
           boost::gil::tiff_tag());
     }
 
+    /// The compression is ignored, TIFF is written uncompressed.
+    template <typename Str, typename ViewT>
+    static void write_view(Str &&out_filename, const ViewT &view, int) {
+      write_view(std::forward<Str>(out_filename), view);
+    }
+
 #endif // LIBCARLA_IMAGE_WITH_TIFF_SUPPORT
   };
 
@@ -7,6 +7,7 @@
 #include "carla/opendrive/OpenDriveParser.h"
 
 #include "carla/Logging.h"
+#include "carla/ParallelFor.h"
 #include "carla/opendrive/parser/GeoReferenceParser.h"
 #include "carla/opendrive/parser/GeometryParser.h"
 #include "carla/opendrive/parser/JunctionParser.h"
@@ -16,13 +17,47 @@
 #include "carla/opendrive/parser/RoadParser.h"
 #include "carla/opendrive/parser/SignalParser.h"
 #include "carla/opendrive/parser/TrafficGroupParser.h"
+#include "carla/road/CompiledMap.h"
 #include "carla/road/MapBuilder.h"
 
 #include <pugixml/pugixml.hpp>
 
+#include <unordered_map>
+#include <vector>
+
 namespace carla {
 namespace opendrive {
 
+  /// Parse the geometries, lanes and profiles of the roads in parallel. All
+  /// the nodes of a road id are parsed by the same thread in document order,
+  /// so the result is the same as parsing them sequentially.
+  static void ParseRoadInfos(
+      const pugi::xml_document &xml,
+      road::MapBuilder &map_builder) {
+    std::vector<std::vector<pugi::xml_node>> roads;
+    std::unordered_map<road::RoadId, size_t> indices;
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      const road::RoadId id = node_road.attribute("id").as_uint();
+      const auto result = indices.emplace(id, roads.size());
+      if (result.second) {
+        roads.emplace_back();
+      }
+      roads[result.first->second].emplace_back(node_road);
+    }
+
+    ParallelFor(roads.size(), 16u, [&](size_t i) {
+      for (const auto &node_road : roads[i]) {
+        parser::GeometryParser::ParseRoad(node_road, map_builder);
+      }
+      for (const auto &node_road : roads[i]) {
+        parser::LaneParser::ParseRoad(node_road, map_builder);
+      }
+      for (const auto &node_road : roads[i]) {
+        parser::ProfilesParser::ParseRoad(node_road, map_builder);
+      }
+    });
+  }
+
   boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
     pugi::xml_document xml;
     pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());
@@ -37,9 +72,7 @@ namespace opendrive {
     parser::GeoReferenceParser::Parse(xml, map_builder);
     parser::RoadParser::Parse(xml, map_builder);
     parser::JunctionParser::Parse(xml, map_builder);
-    parser::GeometryParser::Parse(xml, map_builder);
-    parser::LaneParser::Parse(xml, map_builder);
-    parser::ProfilesParser::Parse(xml, map_builder);
+    ParseRoadInfos(xml, map_builder);
     parser::TrafficGroupParser::Parse(xml, map_builder);
     parser::SignalParser::Parse(xml, map_builder);
     // parser::ObjectParser::Parse(xml, map_builder);
@@ -47,5 +80,22 @@ namespace opendrive {
     return map_builder.Build();
   }
 
+  boost::optional<road::Map> OpenDriveParser::LoadCompiled(
+      const std::string &opendrive,
+      const std::string &compiled_map_path) {
+    const auto source_hash = road::CompiledMap::Hash(opendrive);
+    if (road::CompiledMap::IsUpToDate(compiled_map_path, opendrive)) {
+      auto map = road::CompiledMap::Load(compiled_map_path, source_hash);
+      if (map.has_value()) {
+        return map;
+      }
+    }
+    auto map = Load(opendrive);
+    if (map.has_value()) {
+      road::CompiledMap::Save(*map, source_hash, compiled_map_path);
+    }
+    return map;
+  }
+
 } // namespace opendrive
 } // namespace carla
@@ -19,6 +19,13 @@ namespace opendrive {
   public:
 
     static boost::optional<road::Map> Load(const std::string &opendrive);
+
+    /// Load the map from the compiled map at @a compiled_map_path if it was
+    /// compiled from @a opendrive. Otherwise parse @a opendrive and save it
+    /// compiled to @a compiled_map_path, so next loads are faster.
+    static boost::optional<road::Map> LoadCompiled(
+        const std::string &opendrive,
+        const std::string &compiled_map_path);
   };
 
 } // namespace opendrive
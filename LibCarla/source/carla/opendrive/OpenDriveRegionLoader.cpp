@@ -0,0 +1,396 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/opendrive/OpenDriveRegionLoader.h"
+
+#include "carla/Logging.h"
+#include "carla/opendrive/OpenDriveParser.h"
+
+#include <pugixml/pugixml.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace carla {
+namespace opendrive {
+
+  namespace {
+
+    /// Streams the elements at the top level of an OpenDRIVE document, the
+    /// children of the root element, without building the document tree.
+    /// Only the element being read is kept in memory.
+    class ElementScanner {
+    public:
+
+      explicit ElementScanner(std::istream &in) : _in(*in.rdbuf()) {}
+
+      /// Read the next top-level element, return false at the end of the
+      /// document.
+      bool Next(uint64_t &offset, std::string &text) {
+        text.clear();
+        int c;
+        while ((c = Get()) != EOF) {
+          const bool inside = _depth > 1u;
+          if (c != '<') {
+            if (inside) {
+              text += static_cast<char>(c);
+            }
+            continue;
+          }
+          const uint64_t start = _offset - 1u;
+          _markup.assign(1u, '<');
+          const Markup markup = ReadMarkup(_markup);
+          if (inside) {
+            text += _markup;
+            if (markup == Markup::StartTag) {
+              ++_depth;
+            } else if ((markup == Markup::EndTag) && (--_depth == 1u)) {
+              return true;
+            }
+            continue;
+          }
+          switch (markup) {
+            case Markup::StartTag:
+              if (_depth == 1u) {
+                offset = start;
+                text = _markup;
+              }
+              ++_depth;
+              break;
+            case Markup::EmptyTag:
+              if (_depth == 1u) {
+                offset = start;
+                text = _markup;
+                return true;
+              }
+              break;
+            case Markup::EndTag:
+              if (_depth == 0u) {
+                return false; // Malformed document.
+              }
+              --_depth;
+              break;
+            default:
+              break;
+          }
+        }
+        return false;
+      }
+
+    private:
+
+      enum class Markup {
+        StartTag,
+        EndTag,
+        EmptyTag,
+        Other
+      };
+
+      int Get() {
+        const int c = _in.sbumpc();
+        if (c != EOF) {
+          ++_offset;
+        }
+        return c;
+      }
+
+      /// Read until @a end is found, appending to @a text.
+      void ReadUntil(const char *end, std::string &text) {
+        const size_t length = std::strlen(end);
+        int c;
+        while ((c = Get()) != EOF) {
+          text += static_cast<char>(c);
+          if ((text.size() >= length) &&
+              (text.compare(text.size() - length, length, end) == 0)) {
+            return;
+          }
+        }
+      }
+
+      /// Read the rest of the markup starting with the '<' in @a text.
+      Markup ReadMarkup(std::string &text) {
+        int c = Get();
+        if (c == EOF) {
+          return Markup::Other;
+        }
+        text += static_cast<char>(c);
+        if (c == '?') {
+          ReadUntil("?>", text);
+          return Markup::Other;
+        }
+        if (c == '!') {
+          // Comment, CDATA section or declaration.
+          for (int i = 0; (i < 2) && ((c = Get()) != EOF); ++i) {
+            text += static_cast<char>(c);
+          }
+          if (text.compare(0u, 4u, "<!--") == 0) {
+            ReadUntil("-->", text);
+          } else if (text.compare(0u, 4u, "<![C") == 0) {
+            ReadUntil("]]>", text);
+          } else {
+            ReadUntil(">", text);
+          }
+          return Markup::Other;
+        }
+        const bool end_tag = (c == '/');
+        char quote = '\0';
+        char previous = static_cast<char>(c);
+        while ((c = Get()) != EOF) {
+          text += static_cast<char>(c);
+          if (quote != '\0') {
+            if (c == quote) {
+              quote = '\0';
+            }
+          } else if ((c == '"') || (c == '\'')) {
+            quote = static_cast<char>(c);
+          } else if (c == '>') {
+            break;
+          }
+          previous = static_cast<char>(c);
+        }
+        if (end_tag) {
+          return Markup::EndTag;
+        }
+        return (previous == '/') ? Markup::EmptyTag : Markup::StartTag;
+      }
+
+      std::streambuf &_in;
+
+      uint64_t _offset = 0u;
+
+      size_t _depth = 0u;
+
+      std::string _markup;
+    };
+
+    bool ReadFragment(std::istream &in, uint64_t offset, uint64_t size, std::string &out) {
+      const size_t begin = out.size();
+      out.resize(begin + size);
+      in.seekg(static_cast<std::streamoff>(offset));
+      in.read(&out[begin], static_cast<std::streamsize>(size));
+      return in.good();
+    }
+
+  } // namespace
+
+  std::shared_ptr<OpenDriveRegionLoader> OpenDriveRegionLoader::Open(
+      const std::string &path,
+      size_t max_regions) {
+    std::shared_ptr<OpenDriveRegionLoader> loader{
+        new OpenDriveRegionLoader(path, std::max<size_t>(1u, max_regions))};
+    if (!loader->BuildIndex()) {
+      return nullptr;
+    }
+    return loader;
+  }
+
+  OpenDriveRegionLoader::OpenDriveRegionLoader(std::string path, size_t max_regions)
+    : _path(std::move(path)),
+      _max_regions(max_regions) {}
+
+  bool OpenDriveRegionLoader::BuildIndex() {
+    std::ifstream in(_path, std::ios::binary);
+    if (!in.good()) {
+      log_error("unable to open", _path);
+      return false;
+    }
+
+    ElementScanner scanner(in);
+    uint64_t offset = 0u;
+    std::string text;
+    while (scanner.Next(offset, text)) {
+      if (text.compare(0u, 5u, "<road") == 0) {
+        pugi::xml_document xml;
+        if (!xml.load_buffer(text.data(), text.size())) {
+          log_error("unable to parse the road at offset", offset, "of", _path);
+          return false;
+        }
+        const pugi::xml_node node = xml.child("road");
+        if (!node) {
+          continue;
+        }
+        RoadEntry entry;
+        entry.id = node.attribute("id").as_uint();
+        entry.fragment = Fragment{offset, text.size()};
+        const road::JuncId junction_id = node.attribute("junction").as_int();
+        if (junction_id != -1) {
+          entry.junctions.emplace_back(junction_id);
+        }
+        for (pugi::xml_node link : node.child("link").children()) {
+          if (std::strcmp(link.attribute("elementType").value(), "junction") == 0) {
+            entry.junctions.emplace_back(link.attribute("elementId").as_int());
+          }
+        }
+        // Conservative bounds: a geometry of length l starting at (x, y) lies
+        // within l meters of its start.
+        entry.min_x = entry.min_y = std::numeric_limits<double>::max();
+        entry.max_x = entry.max_y = std::numeric_limits<double>::lowest();
+        for (pugi::xml_node geometry : node.child("planView").children("geometry")) {
+          const double x = geometry.attribute("x").as_double();
+          const double y = geometry.attribute("y").as_double();
+          const double length = geometry.attribute("length").as_double();
+          entry.min_x = std::min(entry.min_x, x - length);
+          entry.min_y = std::min(entry.min_y, y - length);
+          entry.max_x = std::max(entry.max_x, x + length);
+          entry.max_y = std::max(entry.max_y, y + length);
+        }
+        _road_indices.emplace(entry.id, _roads.size());
+        _roads.emplace_back(std::move(entry));
+      } else if (text.compare(0u, 9u, "<junction") == 0) {
+        pugi::xml_document xml;
+        if (!xml.load_buffer(text.data(), text.size())) {
+          log_error("unable to parse the junction at offset", offset, "of", _path);
+          return false;
+        }
+        const road::JuncId id = xml.child("junction").attribute("id").as_int();
+        _junctions.emplace(id, Fragment{offset, text.size()});
+      } else if (text.compare(0u, 7u, "<header") == 0) {
+        _header = text;
+      }
+    }
+    if (_roads.empty()) {
+      log_error("no roads found in", _path);
+      return false;
+    }
+    return true;
+  }
+
+  size_t OpenDriveRegionLoader::GetNumberOfCachedRegions() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _regions.size();
+  }
+
+  std::vector<road::RoadId> OpenDriveRegionLoader::GetRoadsInArea(
+      const geom::Location &min,
+      const geom::Location &max) const {
+    // Unreal's Y axis hack, the OpenDRIVE y axis is inverted.
+    const double min_y = -max.y;
+    const double max_y = -min.y;
+    std::vector<road::RoadId> result;
+    for (const auto &road : _roads) {
+      if ((road.max_x >= min.x) && (road.min_x <= max.x) &&
+          (road.max_y >= min_y) && (road.min_y <= max_y)) {
+        result.emplace_back(road.id);
+      }
+    }
+    return result;
+  }
+
+  std::shared_ptr<const road::Map> OpenDriveRegionLoader::GetRegion(
+      std::vector<road::RoadId> road_ids) {
+    road_ids.erase(std::remove_if(road_ids.begin(), road_ids.end(), [this](road::RoadId id) {
+      return _road_indices.find(id) == _road_indices.end();
+    }), road_ids.end());
+    std::sort(road_ids.begin(), road_ids.end());
+    road_ids.erase(std::unique(road_ids.begin(), road_ids.end()), road_ids.end());
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto cached = FindCachedRegion(road_ids);
+      if (cached != nullptr) {
+        return cached;
+      }
+    }
+    // Parsing takes long, build without holding the lock so other regions
+    // can be served meanwhile.
+    auto map = BuildRegion(road_ids);
+    if (map == nullptr) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    // Another thread may have built the same region meanwhile, keep theirs.
+    auto cached = FindCachedRegion(road_ids);
+    if (cached != nullptr) {
+      return cached;
+    }
+    _regions.push_front(Region{road_ids, map});
+    _region_index.emplace(std::move(road_ids), _regions.begin());
+    EvictUnusedRegions();
+    return map;
+  }
+
+  std::shared_ptr<const road::Map> OpenDriveRegionLoader::FindCachedRegion(
+      const std::vector<road::RoadId> &road_ids) {
+    auto search = _region_index.find(road_ids);
+    if (search == _region_index.end()) {
+      return nullptr;
+    }
+    // Move it to the front, it is now the most recently used.
+    _regions.splice(_regions.begin(), _regions, search->second);
+    auto map = search->second->map;
+    EvictUnusedRegions();
+    return map;
+  }
+
+  std::shared_ptr<const road::Map> OpenDriveRegionLoader::GetArea(
+      const geom::Location &min,
+      const geom::Location &max) {
+    return GetRegion(GetRoadsInArea(min, max));
+  }
+
+  std::shared_ptr<const road::Map> OpenDriveRegionLoader::BuildRegion(
+      const std::vector<road::RoadId> &road_ids) const {
+    std::ifstream in(_path, std::ios::binary);
+    if (!in.good()) {
+      log_error("unable to open", _path);
+      return nullptr;
+    }
+
+    // Roads in document order, so the region is parsed as the whole map.
+    std::vector<size_t> roads;
+    std::vector<road::JuncId> junctions;
+    roads.reserve(road_ids.size());
+    for (auto id : road_ids) {
+      const size_t index = _road_indices.at(id);
+      roads.emplace_back(index);
+      const auto &road_junctions = _roads[index].junctions;
+      junctions.insert(junctions.end(), road_junctions.begin(), road_junctions.end());
+    }
+    std::sort(roads.begin(), roads.end());
+    std::sort(junctions.begin(), junctions.end());
+    junctions.erase(std::unique(junctions.begin(), junctions.end()), junctions.end());
+
+    std::string opendrive = "<?xml version=\"1.0\" standalone=\"yes\"?>\n<OpenDRIVE>\n";
+    opendrive += _header;
+    bool good = true;
+    for (auto index : roads) {
+      const auto &fragment = _roads[index].fragment;
+      good = good && ReadFragment(in, fragment.offset, fragment.size, opendrive);
+    }
+    for (auto id : junctions) {
+      auto search = _junctions.find(id);
+      if (search != _junctions.end()) {
+        good = good && ReadFragment(in, search->second.offset, search->second.size, opendrive);
+      }
+    }
+    opendrive += "\n</OpenDRIVE>\n";
+    if (!good) {
+      log_error("unable to read", _path);
+      return nullptr;
+    }
+
+    auto map = OpenDriveParser::Load(opendrive);
+    if (!map.has_value()) {
+      return nullptr;
+    }
+    return std::make_shared<const road::Map>(std::move(*map));
+  }
+
+  void OpenDriveRegionLoader::EvictUnusedRegions() {
+    auto it = _regions.end();
+    while ((_regions.size() > _max_regions) && (it != _regions.begin())) {
+      --it;
+      if (it->map.use_count() == 1) {
+        _region_index.erase(it->road_ids);
+        it = _regions.erase(it);
+      }
+    }
+  }
+
+} // namespace opendrive
+} // namespace carla
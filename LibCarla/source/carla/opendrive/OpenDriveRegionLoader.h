@@ -0,0 +1,130 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/road/Map.h"
+#include "carla/road/RoadTypes.h"
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace opendrive {
+
+  /// Loads regions of an OpenDRIVE file too big to be loaded as a whole.
+  ///
+  /// Opening a file streams through it once to index the position in the
+  /// file and the bounding box of each road, without building its document
+  /// tree. Regions of the map are built on demand from a set of roads or an
+  /// area, parsing only those roads and the junctions they connect to; links
+  /// to roads outside the region are dropped.
+  ///
+  /// The most recently used regions are cached. When the cache is full, the
+  /// least recently used region that is not held anymore outside the loader
+  /// is evicted.
+  class OpenDriveRegionLoader : private NonCopyable {
+  public:
+
+    /// Open and index the OpenDRIVE file at @a path, caching at most
+    /// @a max_regions regions. Return nullptr if the file cannot be read.
+    static std::shared_ptr<OpenDriveRegionLoader> Open(
+        const std::string &path,
+        size_t max_regions = 8u);
+
+    size_t GetNumberOfRoads() const {
+      return _roads.size();
+    }
+
+    size_t GetNumberOfCachedRegions() const;
+
+    /// Return the ids of the roads whose reference line may lie within the
+    /// area between @a min and @a max. Only x and y are considered, in the
+    /// same coordinates as road::Map locations.
+    std::vector<road::RoadId> GetRoadsInArea(
+        const geom::Location &min,
+        const geom::Location &max) const;
+
+    /// Return the region of the map with the roads @a road_ids, ids not
+    /// present in the file are ignored. Return nullptr if the region cannot
+    /// be parsed.
+    std::shared_ptr<const road::Map> GetRegion(std::vector<road::RoadId> road_ids);
+
+    /// Return the region of the map with the roads in the area between
+    /// @a min and @a max, see GetRoadsInArea.
+    std::shared_ptr<const road::Map> GetArea(
+        const geom::Location &min,
+        const geom::Location &max);
+
+  private:
+
+    /// Position of an element in the file.
+    struct Fragment {
+      uint64_t offset;
+      uint64_t size;
+    };
+
+    struct RoadEntry {
+      road::RoadId id;
+      Fragment fragment;
+      /// Junctions the road belongs or connects to.
+      std::vector<road::JuncId> junctions;
+      /// Bounding box of the reference line.
+      double min_x;
+      double min_y;
+      double max_x;
+      double max_y;
+    };
+
+    struct Region {
+      std::vector<road::RoadId> road_ids;
+      std::shared_ptr<const road::Map> map;
+    };
+
+    OpenDriveRegionLoader(std::string path, size_t max_regions);
+
+    bool BuildIndex();
+
+    std::shared_ptr<const road::Map> BuildRegion(
+        const std::vector<road::RoadId> &road_ids) const;
+
+    /// Return the cached region with @a road_ids, marking it as the most
+    /// recently used, or nullptr if not cached. Requires holding _mutex.
+    std::shared_ptr<const road::Map> FindCachedRegion(
+        const std::vector<road::RoadId> &road_ids);
+
+    void EvictUnusedRegions();
+
+    const std::string _path;
+
+    const size_t _max_regions;
+
+    std::string _header;
+
+    /// Roads in document order.
+    std::vector<RoadEntry> _roads;
+
+    std::map<road::RoadId, size_t> _road_indices;
+
+    std::map<road::JuncId, Fragment> _junctions;
+
+    mutable std::mutex _mutex;
+
+    /// Cached regions, the most recently used first.
+    std::list<Region> _regions;
+
+    std::map<std::vector<road::RoadId>, std::list<Region>::iterator> _region_index;
+  };
+
+} // namespace opendrive
+} // namespace carla
@@ -46,63 +46,68 @@ namespace parser {
   void ProfilesParser::Parse(
       const pugi::xml_document &xml,
       carla::road::MapBuilder &map_builder) {
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      ParseRoad(node_road, map_builder);
+    }
+  }
+
+  void ProfilesParser::ParseRoad(
+      const pugi::xml_node &node_road,
+      carla::road::MapBuilder &map_builder) {
 
     std::vector<ElevationProfile> elevation_profile;
     std::vector<LateralProfile> lateral_profile;
 
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
-
-      // parse elevation profile
-      pugi::xml_node node_profile = node_road.child("elevationProfile");
-      if (node_profile) {
-        // all geometry
-        for (pugi::xml_node node_elevation : node_profile.children("elevation")) {
-          ElevationProfile elev;
-
-          // get road id
-          road::RoadId road_id = node_road.attribute("id").as_uint();
-          elev.road = map_builder.GetRoad(road_id);
-
-          // get common properties
-          elev.s = node_elevation.attribute("s").as_double();
-          elev.a = node_elevation.attribute("a").as_double();
-          elev.b = node_elevation.attribute("b").as_double();
-          elev.c = node_elevation.attribute("c").as_double();
-          elev.d = node_elevation.attribute("d").as_double();
-
-          // add it
-          elevation_profile.emplace_back(elev);
-        }
+    // parse elevation profile
+    pugi::xml_node node_profile = node_road.child("elevationProfile");
+    if (node_profile) {
+      // all geometry
+      for (pugi::xml_node node_elevation : node_profile.children("elevation")) {
+        ElevationProfile elev;
+
+        // get road id
+        road::RoadId road_id = node_road.attribute("id").as_uint();
+        elev.road = map_builder.GetRoad(road_id);
+
+        // get common properties
+        elev.s = node_elevation.attribute("s").as_double();
+        elev.a = node_elevation.attribute("a").as_double();
+        elev.b = node_elevation.attribute("b").as_double();
+        elev.c = node_elevation.attribute("c").as_double();
+        elev.d = node_elevation.attribute("d").as_double();
+
+        // add it
+        elevation_profile.emplace_back(elev);
       }
+    }
 
-      // parse lateral profile
-      node_profile = node_road.child("lateralProfile");
-      if (node_profile) {
-        for (pugi::xml_node node : node_profile.children()) {
-          LateralProfile lateral;
-
-          // get road id
-          road::RoadId road_id = node_road.attribute("id").as_uint();
-          lateral.road = map_builder.GetRoad(road_id);
-
-          // get common properties
-          lateral.s = node.attribute("s").as_double();
-          lateral.a = node.attribute("a").as_double();
-          lateral.b = node.attribute("b").as_double();
-          lateral.c = node.attribute("c").as_double();
-          lateral.d = node.attribute("d").as_double();
-
-          // handle different types
-          lateral.type = node.name();
-          if (lateral.type == "crossfall") {
-            lateral.cross.side = node.attribute("side").value();
-          } else if (lateral.type == "shape") {
-            lateral.shape.t = node.attribute("t").as_double();
-          }
-
-          // add it
-          lateral_profile.emplace_back(lateral);
+    // parse lateral profile
+    node_profile = node_road.child("lateralProfile");
+    if (node_profile) {
+      for (pugi::xml_node node : node_profile.children()) {
+        LateralProfile lateral;
+
+        // get road id
+        road::RoadId road_id = node_road.attribute("id").as_uint();
+        lateral.road = map_builder.GetRoad(road_id);
+
+        // get common properties
+        lateral.s = node.attribute("s").as_double();
+        lateral.a = node.attribute("a").as_double();
+        lateral.b = node.attribute("b").as_double();
+        lateral.c = node.attribute("c").as_double();
+        lateral.d = node.attribute("d").as_double();
+
+        // handle different types
+        lateral.type = node.name();
+        if (lateral.type == "crossfall") {
+          lateral.cross.side = node.attribute("side").value();
+        } else if (lateral.type == "shape") {
+          lateral.shape.t = node.attribute("t").as_double();
         }
+
+        // add it
+        lateral_profile.emplace_back(lateral);
       }
     }
 
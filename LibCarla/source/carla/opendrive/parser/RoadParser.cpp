@@ -7,6 +7,7 @@
 #include "carla/opendrive/parser/RoadParser.h"
 
 #include "carla/Logging.h"
+#include "carla/ParallelFor.h"
 #include "carla/StringUtil.h"
 #include "carla/road/MapBuilder.h"
 #include "carla/road/RoadTypes.h"
@@ -21,6 +22,9 @@ namespace parser {
   using LaneId = road::LaneId;
   using JuncId = road::JuncId;
 
+  /// Minimum number of roads parsed per thread.
+  static constexpr size_t MinChunkSize = 64u;
+
   struct Polynomial {
     double s;
     double a, b, c, d;
@@ -110,144 +114,152 @@ namespace parser {
     }
   }
 
-  void RoadParser::Parse(
-      const pugi::xml_document &xml,
-      carla::road::MapBuilder &map_builder) {
+  static Road ParseRoad(const pugi::xml_node &node_road) {
+    Road road { 0, "", 0.0, -1, 0, 0, {}, {}, {} };
 
-    std::vector<Road> roads;
+    // attributes
+    road.id = node_road.attribute("id").as_uint();
+    road.name = node_road.attribute("name").value();
+    road.length = node_road.attribute("length").as_double();
+    road.junction_id = node_road.attribute("junction").as_int();
 
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
-      Road road { 0, "", 0.0, -1, 0, 0, {}, {}, {} };
-
-      // attributes
-      road.id = node_road.attribute("id").as_uint();
-      road.name = node_road.attribute("name").value();
-      road.length = node_road.attribute("length").as_double();
-      road.junction_id = node_road.attribute("junction").as_int();
-
-      // link
-      pugi::xml_node link = node_road.child("link");
-      if (link) {
-        if (link.child("predecessor")) {
-          road.predecessor = link.child("predecessor").attribute("elementId").as_uint();
-        }
-        if (link.child("successor")) {
-          road.successor = link.child("successor").attribute("elementId").as_uint();
-        }
+    // link
+    pugi::xml_node link = node_road.child("link");
+    if (link) {
+      if (link.child("predecessor")) {
+        road.predecessor = link.child("predecessor").attribute("elementId").as_uint();
+      }
+      if (link.child("successor")) {
+        road.successor = link.child("successor").attribute("elementId").as_uint();
       }
+    }
 
-      // types
-      for (pugi::xml_node node_type : node_road.children("type")) {
-        RoadTypeSpeed type { 0.0, "", 0.0, "" };
+    // types
+    for (pugi::xml_node node_type : node_road.children("type")) {
+      RoadTypeSpeed type { 0.0, "", 0.0, "" };
 
-        type.s = node_type.attribute("s").as_double();
-        type.type = node_type.attribute("type").value();
+      type.s = node_type.attribute("s").as_double();
+      type.type = node_type.attribute("type").value();
 
-        // speed type
-        pugi::xml_node speed = node_type.child("speed");
-        if (speed) {
-          type.max = speed.attribute("max").as_double();
-          type.unit = speed.attribute("unit").value();
+      // speed type
+      pugi::xml_node speed = node_type.child("speed");
+      if (speed) {
+        type.max = speed.attribute("max").as_double();
+        type.unit = speed.attribute("unit").value();
+      }
+
+      // add it
+      road.speed.emplace_back(type);
+    }
+
+    // section offsets
+    for (pugi::xml_node node_offset : node_road.child("lanes").children("laneOffset")) {
+      LaneOffset offset { 0.0, 0.0, 0.0, 0.0, 0.0 };
+      offset.s = node_offset.attribute("s").as_double();
+      offset.a = node_offset.attribute("a").as_double();
+      offset.b = node_offset.attribute("b").as_double();
+      offset.c = node_offset.attribute("c").as_double();
+      offset.d = node_offset.attribute("d").as_double();
+      road.section_offsets.emplace_back(offset);
+    }
+
+    // lane sections
+    for (pugi::xml_node node_section : node_road.child("lanes").children("laneSection")) {
+      LaneSection section { 0.0, {} };
+
+      section.s = node_section.attribute("s").as_double();
+
+      // left lanes
+      for (pugi::xml_node node_lane : node_section.child("left").children("lane")) {
+        Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
+
+        lane.id = node_lane.attribute("id").as_int();
+        lane.type = StringToLaneType(node_lane.attribute("type").value());
+        lane.level = node_lane.attribute("level").as_bool();
+
+        // link
+        pugi::xml_node link2 = node_lane.child("link");
+        if (link2) {
+          if (link2.child("predecessor")) {
+            lane.predecessor = link2.child("predecessor").attribute("id").as_int();
+          }
+          if (link2.child("successor")) {
+            lane.successor = link2.child("successor").attribute("id").as_int();
+          }
         }
 
         // add it
-        road.speed.emplace_back(type);
+        section.lanes.emplace_back(lane);
       }
 
-      // section offsets
-      for (pugi::xml_node node_offset : node_road.child("lanes").children("laneOffset")) {
-        LaneOffset offset { 0.0, 0.0, 0.0, 0.0, 0.0 };
-        offset.s = node_offset.attribute("s").as_double();
-        offset.a = node_offset.attribute("a").as_double();
-        offset.b = node_offset.attribute("b").as_double();
-        offset.c = node_offset.attribute("c").as_double();
-        offset.d = node_offset.attribute("d").as_double();
-        road.section_offsets.emplace_back(offset);
-      }
+      // center lane
+      for (pugi::xml_node node_lane : node_section.child("center").children("lane")) {
+        Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
 
-      // lane sections
-      for (pugi::xml_node node_section : node_road.child("lanes").children("laneSection")) {
-        LaneSection section { 0.0, {} };
-
-        section.s = node_section.attribute("s").as_double();
-
-        // left lanes
-        for (pugi::xml_node node_lane : node_section.child("left").children("lane")) {
-          Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
-
-          lane.id = node_lane.attribute("id").as_int();
-          lane.type = StringToLaneType(node_lane.attribute("type").value());
-          lane.level = node_lane.attribute("level").as_bool();
-
-          // link
-          pugi::xml_node link2 = node_lane.child("link");
-          if (link2) {
-            if (link2.child("predecessor")) {
-              lane.predecessor = link2.child("predecessor").attribute("id").as_int();
-            }
-            if (link2.child("successor")) {
-              lane.successor = link2.child("successor").attribute("id").as_int();
-            }
-          }
+        lane.id = node_lane.attribute("id").as_int();
+        lane.type = StringToLaneType(node_lane.attribute("type").value());
+        lane.level = node_lane.attribute("level").as_bool();
 
-          // add it
-          section.lanes.emplace_back(lane);
+        // link (probably it never exists)
+        pugi::xml_node link2 = node_lane.child("link");
+        if (link2) {
+          if (link2.child("predecessor")) {
+            lane.predecessor = link2.child("predecessor").attribute("id").as_int();
+          }
+          if (link2.child("successor")) {
+            lane.successor = link2.child("successor").attribute("id").as_int();
+          }
         }
 
-        // center lane
-        for (pugi::xml_node node_lane : node_section.child("center").children("lane")) {
-          Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
-
-          lane.id = node_lane.attribute("id").as_int();
-          lane.type = StringToLaneType(node_lane.attribute("type").value());
-          lane.level = node_lane.attribute("level").as_bool();
-
-          // link (probably it never exists)
-          pugi::xml_node link2 = node_lane.child("link");
-          if (link2) {
-            if (link2.child("predecessor")) {
-              lane.predecessor = link2.child("predecessor").attribute("id").as_int();
-            }
-            if (link2.child("successor")) {
-              lane.successor = link2.child("successor").attribute("id").as_int();
-            }
-          }
+        // add it
+        section.lanes.emplace_back(lane);
+      }
 
-          // add it
-          section.lanes.emplace_back(lane);
-        }
+      // right lane
+      for (pugi::xml_node node_lane : node_section.child("right").children("lane")) {
+        Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
 
-        // right lane
-        for (pugi::xml_node node_lane : node_section.child("right").children("lane")) {
-          Lane lane { 0, road::Lane::LaneType::None, false, 0, 0 };
-
-          lane.id = node_lane.attribute("id").as_int();
-          lane.type = StringToLaneType(node_lane.attribute("type").value());
-          lane.level = node_lane.attribute("level").as_bool();
-
-          // link
-          pugi::xml_node link2 = node_lane.child("link");
-          if (link2) {
-            if (link2.child("predecessor")) {
-              lane.predecessor = link2.child("predecessor").attribute("id").as_int();
-            }
-            if (link2.child("successor")) {
-              lane.successor = link2.child("successor").attribute("id").as_int();
-            }
-          }
+        lane.id = node_lane.attribute("id").as_int();
+        lane.type = StringToLaneType(node_lane.attribute("type").value());
+        lane.level = node_lane.attribute("level").as_bool();
 
-          // add it
-          section.lanes.emplace_back(lane);
+        // link
+        pugi::xml_node link2 = node_lane.child("link");
+        if (link2) {
+          if (link2.child("predecessor")) {
+            lane.predecessor = link2.child("predecessor").attribute("id").as_int();
+          }
+          if (link2.child("successor")) {
+            lane.successor = link2.child("successor").attribute("id").as_int();
+          }
         }
 
-        // add section
-        road.sections.emplace_back(section);
+        // add it
+        section.lanes.emplace_back(lane);
       }
 
-      // add road
-      roads.emplace_back(road);
+      // add section
+      road.sections.emplace_back(section);
     }
 
+    return road;
+  }
+
+  void RoadParser::Parse(
+      const pugi::xml_document &xml,
+      carla::road::MapBuilder &map_builder) {
+
+    std::vector<pugi::xml_node> nodes;
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      nodes.emplace_back(node_road);
+    }
+
+    // the nodes are only read, parse them in parallel keeping their order
+    std::vector<Road> roads(nodes.size());
+    ParallelFor(nodes.size(), MinChunkSize, [&](size_t i) {
+      roads[i] = ParseRoad(nodes[i]);
+    });
+
     // test print
     /*
        printf("Roads: %d\n", roads.size());
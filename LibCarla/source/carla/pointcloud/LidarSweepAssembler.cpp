@@ -0,0 +1,137 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/pointcloud/LidarSweepAssembler.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/geom/Math.h"
+#include "carla/sensor/data/LidarMeasurement.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace carla {
+namespace pointcloud {
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  /// Rotation around the z axis plus a translation.
+  struct YawTransform {
+    float cos;
+    float sin;
+    geom::Vector3D translation;
+
+    geom::Location operator()(const geom::Location &point) const {
+      return {
+          cos * point.x - sin * point.y + translation.x,
+          sin * point.x + cos * point.y + translation.y,
+          point.z + translation.z};
+    }
+  };
+
+  /// The lidar writes each point relative to the sensor location and rotated
+  /// by 90 - yaw degrees, i.e., point = Rot(90 - yaw) * (location - hit).
+  /// Returns the transform taking the points written with @a transform to
+  /// the points that would be written with @a reference.
+  static YawTransform MakeCompensation(
+      const geom::Transform &transform,
+      const geom::Transform &reference) {
+    const float yaw = geom::Math::ToRadians(transform.rotation.yaw - reference.rotation.yaw);
+    const float reference_yaw = geom::Math::ToRadians(90.0f - reference.rotation.yaw);
+    const geom::Vector3D offset = reference.location - transform.location;
+    const float c = std::cos(reference_yaw);
+    const float s = std::sin(reference_yaw);
+    return {
+        std::cos(yaw),
+        std::sin(yaw),
+        {c * offset.x - s * offset.y, s * offset.x + c * offset.y, offset.z}};
+  }
+
+  // ===========================================================================
+  // -- LidarSweepAssembler ----------------------------------------------------
+  // ===========================================================================
+
+  LidarSweepAssembler::LidarSweepAssembler(
+      const size_t max_points_per_sweep,
+      const size_t ring_size) {
+    if (ring_size == 0u) {
+      throw_exception(std::invalid_argument("the ring size must be greater than zero"));
+    }
+    _ring.resize(ring_size);
+    for (auto &slot : _ring) {
+      slot.points.resize(max_points_per_sweep);
+    }
+  }
+
+  const LidarSweepAssembler::Sweep *LidarSweepAssembler::Add(
+      const sensor::data::LidarMeasurement &measurement) {
+    const float angle = measurement.GetHorizontalAngle();
+    // Equal angles mean the lidar turned a full rotation in one tick.
+    const bool wraps = _has_previous_angle && (angle <= _previous_angle);
+    _has_previous_angle = true;
+    _previous_angle = angle;
+
+    if (!_started) {
+      _started = wraps;
+      return nullptr;
+    }
+
+    auto &slot = _ring[_current];
+    const size_t capacity = slot.points.size();
+    const size_t count = std::min(measurement.size(), capacity - slot.size);
+    std::memcpy(slot.points.data() + slot.size, measurement.data(), sizeof(geom::Location) * count);
+    _parts.push_back({slot.size, count, measurement.GetSensorTransform()});
+    slot.size += count;
+    _dropped_points += measurement.size() - count;
+
+    return wraps ? &CompleteSweep(measurement) : nullptr;
+  }
+
+  void LidarSweepAssembler::Reset() {
+    _ring[_current].size = 0u;
+    _parts.clear();
+    _dropped_points = 0u;
+    _started = false;
+    _has_previous_angle = false;
+  }
+
+  const LidarSweepAssembler::Sweep &LidarSweepAssembler::CompleteSweep(
+      const sensor::data::LidarMeasurement &last) {
+    auto &slot = _ring[_current];
+    const auto &reference = last.GetSensorTransform();
+    for (auto &part : _parts) {
+      if (part.transform == reference) {
+        continue;
+      }
+      const auto compensation = MakeCompensation(part.transform, reference);
+      auto *points = slot.points.data() + part.begin;
+      std::transform(points, points + part.size, points, compensation);
+    }
+
+    auto &sweep = slot.sweep;
+    sweep.frame = last.GetFrame();
+    sweep.timestamp = last.GetTimestamp();
+    sweep.transform = reference;
+    sweep.measurement_count = _parts.size();
+    sweep.dropped_points = _dropped_points;
+    sweep._points = slot.points.data();
+    sweep._size = slot.size;
+
+    // Start the next sweep in the next slot, clear keeps the capacity.
+    _parts.clear();
+    _dropped_points = 0u;
+    _current = (_current + 1u) % _ring.size();
+    _ring[_current].size = 0u;
+    return sweep;
+  }
+
+} // namespace pointcloud
+} // namespace carla
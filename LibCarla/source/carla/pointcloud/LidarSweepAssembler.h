@@ -0,0 +1,119 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  class LidarMeasurement;
+
+} // namespace data
+} // namespace sensor
+
+namespace pointcloud {
+
+  /// Assembles the partial measurements that a rotating lidar sends each tick
+  /// into full 360 degree sweeps. The points of each measurement are
+  /// motion-compensated into the frame of the sensor at the last measurement
+  /// of the sweep, using the sensor transform of each measurement.
+  ///
+  /// A sweep is completed by the measurement whose horizontal angle wraps
+  /// around; the measurements before the first wrap are discarded since they
+  /// do not make a full sweep.
+  ///
+  /// The sweeps are assembled in a ring of @a ring_size preallocated slots of
+  /// @a max_points_per_sweep points, so no memory is allocated per sweep. A
+  /// sweep is overwritten when its slot is filled again, after
+  /// @a ring_size - 1 more sweeps. Not thread-safe.
+  class LidarSweepAssembler : private NonCopyable {
+  public:
+
+    struct Sweep {
+      /// Frame of the last measurement of the sweep.
+      size_t frame;
+      /// Timestamp of the last measurement of the sweep.
+      double timestamp;
+      /// Sensor transform at the last measurement, the frame of the points.
+      geom::Transform transform;
+      /// Number of measurements in the sweep.
+      size_t measurement_count;
+      /// Points discarded because the sweep was full.
+      size_t dropped_points;
+
+      const geom::Location *begin() const {
+        return _points;
+      }
+
+      const geom::Location *end() const {
+        return _points + _size;
+      }
+
+      size_t size() const {
+        return _size;
+      }
+
+    private:
+
+      friend LidarSweepAssembler;
+
+      const geom::Location *_points;
+
+      size_t _size;
+    };
+
+    LidarSweepAssembler(size_t max_points_per_sweep, size_t ring_size);
+
+    /// Add the next measurement of the lidar.
+    ///
+    /// @return the sweep completed by @a measurement, or nullptr.
+    const Sweep *Add(const sensor::data::LidarMeasurement &measurement);
+
+    /// Discard the sweep being assembled and wait for the next wrap around.
+    void Reset();
+
+  private:
+
+    /// Points of a measurement in the slot being filled.
+    struct Part {
+      size_t begin;
+      size_t size;
+      geom::Transform transform;
+    };
+
+    struct Slot {
+      std::vector<geom::Location> points;
+      size_t size = 0u;
+      Sweep sweep;
+    };
+
+    const Sweep &CompleteSweep(const sensor::data::LidarMeasurement &last);
+
+    std::vector<Slot> _ring;
+
+    size_t _current = 0u;
+
+    std::vector<Part> _parts;
+
+    size_t _dropped_points = 0u;
+
+    bool _started = false;
+
+    bool _has_previous_angle = false;
+
+    float _previous_angle = 0.0f;
+  };
+
+} // namespace pointcloud
+} // namespace carla
@@ -0,0 +1,307 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/pointcloud/PointCloudFilter.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace carla {
+namespace pointcloud {
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  /// Minimum number of points processed by each thread.
+  static constexpr size_t MinChunkSize = 16384u;
+
+  /// Number of chunks, and threads, used to process @a size points.
+  static size_t GetNumberOfChunks(const size_t size) {
+    const size_t max_chunks = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<size_t>(1u, std::min(max_chunks, size / MinChunkSize));
+  }
+
+  /// Call @a functor(chunk, begin, end) for each chunk [begin, end) of the
+  /// @a number_of_chunks in which [0, @a size) is split, in parallel.
+  template <typename FunctorT>
+  static void ForEachChunk(const size_t size, const size_t number_of_chunks, FunctorT &&functor) {
+    const size_t chunk_size = (size + number_of_chunks - 1u) / number_of_chunks;
+    ParallelFor(number_of_chunks, 1u, [&](size_t chunk) {
+      functor(chunk, std::min(size, chunk * chunk_size), std::min(size, (chunk + 1u) * chunk_size));
+    });
+  }
+
+  /// Write, in order, the points for which @a predicate(point, index) is true
+  /// to @a out.
+  template <typename PredicateT>
+  static size_t CopyIf(
+      const geom::Location *points,
+      const size_t size,
+      geom::Location *out,
+      PredicateT &&predicate) {
+    const size_t number_of_chunks = GetNumberOfChunks(size);
+    // Each chunk writes at its own offset of the output, then they are moved
+    // together.
+    std::vector<std::pair<size_t, size_t>> kept(number_of_chunks);
+    ForEachChunk(size, number_of_chunks, [&](size_t chunk, size_t begin, size_t end) {
+      size_t count = 0u;
+      for (auto i = begin; i < end; ++i) {
+        if (predicate(points[i], i)) {
+          out[begin + count] = points[i];
+          ++count;
+        }
+      }
+      kept[chunk] = {begin, count};
+    });
+    size_t count = 0u;
+    for (auto &chunk : kept) {
+      std::memmove(out + count, out + chunk.first, sizeof(geom::Location) * chunk.second);
+      count += chunk.second;
+    }
+    return count;
+  }
+
+  /// Integer coordinates of a cell in a grid of cells.
+  struct CellKey {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+
+    bool operator==(const CellKey &rhs) const {
+      return (x == rhs.x) && (y == rhs.y) && (z == rhs.z);
+    }
+
+    bool operator!=(const CellKey &rhs) const {
+      return !(*this == rhs);
+    }
+
+    bool operator<(const CellKey &rhs) const {
+      return std::tie(x, y, z) < std::tie(rhs.x, rhs.y, rhs.z);
+    }
+  };
+
+  /// Compute in @a cell the cell of @a value, return false if the value is
+  /// not finite or its cell does not fit in 32 bits.
+  static bool MakeCellCoordinate(const float value, const float inverse_cell_size, int32_t &cell) {
+    constexpr float limit = 2147483648.0f; // 2^31, exact in a float.
+    const float coordinate = std::floor(value * inverse_cell_size);
+    if (!((coordinate >= -limit) && (coordinate < limit))) {
+      return false;
+    }
+    cell = static_cast<int32_t>(coordinate);
+    return true;
+  }
+
+  /// Compute in @a key the cell of @a point, return false if it is out of
+  /// range.
+  static bool MakeCellKey(
+      const geom::Location &point,
+      const float inverse_cell_size,
+      const bool with_z,
+      CellKey &key) {
+    key.z = 0;
+    return
+        MakeCellCoordinate(point.x, inverse_cell_size, key.x) &&
+        MakeCellCoordinate(point.y, inverse_cell_size, key.y) &&
+        (!with_z || MakeCellCoordinate(point.z, inverse_cell_size, key.z));
+  }
+
+  static size_t GetBucket(const CellKey &key, const size_t number_of_buckets) {
+    auto mix = [](int32_t coordinate, uint64_t prime) {
+      return static_cast<uint64_t>(static_cast<uint32_t>(coordinate)) * prime;
+    };
+    const uint64_t hash =
+        mix(key.x, 0x9E3779B97F4A7C15ull) ^
+        mix(key.y, 0xC2B2AE3D27D4EB4Full) ^
+        mix(key.z, 0x165667B19E3779F9ull);
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> 32u) % number_of_buckets;
+  }
+
+  struct CellEntry {
+    CellKey key;
+    uint32_t index;
+  };
+
+  /// Group the points by cell and call @a functor(bucket, begin, end) for the
+  /// entries [begin, end) of each cell, sorted by index. The cells are
+  /// distributed in @a number_of_buckets buckets processed in parallel, each
+  /// bucket visits its cells sequentially. Points out of the range of the
+  /// grid are not visited.
+  template <typename FunctorT>
+  static void ForEachCell(
+      const geom::Location *points,
+      const size_t size,
+      const size_t number_of_buckets,
+      const float cell_size,
+      const bool with_z,
+      FunctorT &&functor) {
+    DEBUG_ASSERT(size <= std::numeric_limits<uint32_t>::max());
+    const float inverse_cell_size = 1.0f / cell_size;
+    const size_t number_of_chunks = number_of_buckets;
+
+    // entries[chunk][bucket], so each thread scatters to its own vectors.
+    std::vector<std::vector<std::vector<CellEntry>>> entries(
+        number_of_chunks,
+        std::vector<std::vector<CellEntry>>(number_of_buckets));
+    ForEachChunk(size, number_of_chunks, [&](size_t chunk, size_t begin, size_t end) {
+      auto &buckets = entries[chunk];
+      for (auto &bucket : buckets) {
+        bucket.reserve((end - begin) / number_of_buckets + 1u);
+      }
+      for (auto i = begin; i < end; ++i) {
+        CellKey key;
+        if (MakeCellKey(points[i], inverse_cell_size, with_z, key)) {
+          buckets[GetBucket(key, number_of_buckets)].push_back({key, static_cast<uint32_t>(i)});
+        }
+      }
+    });
+
+    ParallelFor(number_of_buckets, 1u, [&](size_t bucket) {
+      std::vector<CellEntry> cells;
+      size_t total = 0u;
+      for (auto &chunk : entries) {
+        total += chunk[bucket].size();
+      }
+      cells.reserve(total);
+      for (auto &chunk : entries) {
+        cells.insert(cells.end(), chunk[bucket].begin(), chunk[bucket].end());
+        std::vector<CellEntry>().swap(chunk[bucket]);
+      }
+      std::sort(cells.begin(), cells.end(), [](const CellEntry &lhs, const CellEntry &rhs) {
+        return (lhs.key < rhs.key) || ((lhs.key == rhs.key) && (lhs.index < rhs.index));
+      });
+      for (auto it = cells.cbegin(); it != cells.cend();) {
+        auto cell_end = std::find_if(it, cells.cend(), [&](const CellEntry &entry) {
+          return entry.key != it->key;
+        });
+        functor(bucket, it, cell_end);
+        it = cell_end;
+      }
+    });
+  }
+
+  static void ValidateCellSize(const float cell_size) {
+    if (!(cell_size > 0.0f)) {
+      throw_exception(std::invalid_argument("the cell size must be greater than zero"));
+    }
+  }
+
+  // ===========================================================================
+  // -- PointCloudFilter -------------------------------------------------------
+  // ===========================================================================
+
+  size_t PointCloudFilter::VoxelDownsample(
+      const geom::Location *begin,
+      const geom::Location *end,
+      const float voxel_size,
+      geom::Location *out) {
+    DEBUG_ASSERT(begin <= end);
+    ValidateCellSize(voxel_size);
+    const auto size = static_cast<size_t>(end - begin);
+    const size_t number_of_buckets = GetNumberOfChunks(size);
+    std::vector<std::vector<geom::Location>> centroids(number_of_buckets);
+    using iterator = std::vector<CellEntry>::const_iterator;
+    ForEachCell(begin, size, number_of_buckets, voxel_size, true, [&](size_t bucket, iterator it, iterator cell_end) {
+      const auto count = static_cast<float>(std::distance(it, cell_end));
+      geom::Vector3D sum;
+      for (; it != cell_end; ++it) {
+        sum += begin[it->index];
+      }
+      centroids[bucket].emplace_back(sum / count);
+    });
+    size_t count = 0u;
+    for (auto &result : centroids) {
+      std::memcpy(out + count, result.data(), sizeof(geom::Location) * result.size());
+      count += result.size();
+    }
+    return count;
+  }
+
+  size_t PointCloudFilter::Crop(
+      const geom::Location *begin,
+      const geom::Location *end,
+      const geom::BoundingBox &box,
+      geom::Location *out) {
+    DEBUG_ASSERT(begin <= end);
+    const geom::Vector3D center = box.location;
+    const auto min = center - box.extent;
+    const auto max = center + box.extent;
+    return CopyIf(begin, static_cast<size_t>(end - begin), out, [&](const geom::Location &point, size_t) {
+      return
+          (point.x >= min.x) && (point.x <= max.x) &&
+          (point.y >= min.y) && (point.y <= max.y) &&
+          (point.z >= min.z) && (point.z <= max.z);
+    });
+  }
+
+  size_t PointCloudFilter::Crop(
+      const geom::Location *begin,
+      const geom::Location *end,
+      const geom::BoundingBox &box,
+      const geom::Transform &transform,
+      geom::Location *out) {
+    DEBUG_ASSERT(begin <= end);
+    // Axes of the local space, rotated once; a point is projected on each of
+    // them to move it to the local space.
+    const geom::Transform rotation{geom::Location{}, transform.rotation};
+    geom::Vector3D axes[3u] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+    for (auto &axis : axes) {
+      rotation.TransformPoint(axis);
+    }
+    return CopyIf(begin, static_cast<size_t>(end - begin), out, [&](const geom::Location &point, size_t) {
+      const auto relative = point - transform.location;
+      auto inside = [&](const geom::Vector3D &axis, float center, float extent) {
+        const auto local = relative.x * axis.x + relative.y * axis.y + relative.z * axis.z;
+        return std::abs(local - center) <= extent;
+      };
+      return
+          inside(axes[0u], box.location.x, box.extent.x) &&
+          inside(axes[1u], box.location.y, box.extent.y) &&
+          inside(axes[2u], box.location.z, box.extent.z);
+    });
+  }
+
+  size_t PointCloudFilter::RemoveGround(
+      const geom::Location *begin,
+      const geom::Location *end,
+      const float cell_size,
+      const float band_height,
+      geom::Location *out) {
+    DEBUG_ASSERT(begin <= end);
+    ValidateCellSize(cell_size);
+    const auto size = static_cast<size_t>(end - begin);
+    // Each point belongs to a single cell, so each flag is written once.
+    std::vector<uint8_t> keep(size, 0u);
+    using iterator = std::vector<CellEntry>::const_iterator;
+    ForEachCell(begin, size, GetNumberOfChunks(size), cell_size, false, [&](size_t, iterator it, iterator cell_end) {
+      float lowest = std::numeric_limits<float>::max();
+      for (auto entry = it; entry != cell_end; ++entry) {
+        lowest = std::min(lowest, begin[entry->index].z);
+      }
+      for (; it != cell_end; ++it) {
+        keep[it->index] = (begin[it->index].z - lowest) >= band_height;
+      }
+    });
+    return CopyIf(begin, size, out, [&](const geom::Location &, size_t index) {
+      return keep[index] != 0u;
+    });
+  }
+
+} // namespace pointcloud
+} // namespace carla
@@ -0,0 +1,68 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/BoundingBox.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Transform.h"
+
+#include <cstddef>
+
+namespace carla {
+namespace pointcloud {
+
+  /// Filters over the contiguous points [begin, end), like the points of a
+  /// LidarMeasurement. The points kept are written to @a out, that must have
+  /// room for end - begin points and must not overlap the input, and the
+  /// number of points written is returned.
+  ///
+  /// Large point clouds are processed in parallel, one thread per hardware
+  /// thread.
+  ///
+  /// The grid based filters drop the points with non-finite coordinates, or
+  /// whose cell index does not fit in 32 bits per axis.
+  class PointCloudFilter {
+  public:
+
+    /// Replace the points inside each cube of side @a voxel_size by their
+    /// centroid. The voxels are written in no particular order, but the
+    /// result is the same for the same input.
+    static size_t VoxelDownsample(
+        const geom::Location *begin,
+        const geom::Location *end,
+        float voxel_size,
+        geom::Location *out);
+
+    /// Keep, in order, the points inside @a box, aligned with the axes.
+    static size_t Crop(
+        const geom::Location *begin,
+        const geom::Location *end,
+        const geom::BoundingBox &box,
+        geom::Location *out);
+
+    /// Keep, in order, the points inside @a box placed in the local space of
+    /// @a transform, e.g., the bounding box of an actor and its transform.
+    static size_t Crop(
+        const geom::Location *begin,
+        const geom::Location *end,
+        const geom::BoundingBox &box,
+        const geom::Transform &transform,
+        geom::Location *out);
+
+    /// Remove the ground, the points less than @a band_height above the
+    /// lowest point of their cell in a horizontal grid of side @a cell_size.
+    /// Keeps the order of the points.
+    static size_t RemoveGround(
+        const geom::Location *begin,
+        const geom::Location *end,
+        float cell_size,
+        float band_height,
+        geom::Location *out);
+  };
+
+} // namespace pointcloud
+} // namespace carla
@@ -6,11 +6,140 @@
 
 #include "carla/pointcloud/PointCloudIO.h"
 
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+
+#include <boost/predef/other/endian.h>
+
+#include <cstring>
 #include <iomanip>
+#include <numeric>
+#include <stdexcept>
 
 namespace carla {
 namespace pointcloud {
 
+  static_assert(BOOST_ENDIAN_LITTLE_BYTE, "Binary point clouds are written in the byte order of the platform.");
+  static_assert(sizeof(geom::Location) == 3u * sizeof(float), "Invalid location size.");
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  static std::string MakePlyHeader(
+      const char *format,
+      const size_t number_of_points,
+      const bool with_channel) {
+    std::string header =
+        "ply\n"
+        "format " + std::string(format) + " 1.0\n"
+        "element vertex " + std::to_string(number_of_points) + "\n"
+        "property float32 x\n"
+        "property float32 y\n"
+        "property float32 z\n";
+    if (with_channel) {
+      header += "property uint16 channel\n";
+    }
+    header += "end_header\n";
+    return header;
+  }
+
+  /// Call @a functor(point, channel) for each point, in order.
+  template <typename FunctorT>
+  static void ForEachPoint(
+      const geom::Location *begin,
+      const geom::Location *end,
+      const std::vector<uint32_t> &point_count_by_channel,
+      FunctorT &&functor) {
+    for (auto channel = 0u; channel < point_count_by_channel.size(); ++channel) {
+      const auto *channel_end = begin + point_count_by_channel[channel];
+      for (; begin != channel_end; ++begin) {
+        functor(*begin, static_cast<uint16_t>(channel));
+      }
+    }
+    DEBUG_ASSERT(begin == end);
+    (void) end;
+  }
+
+  /// Copy @a value to @a dst and advance it.
+  template <typename T>
+  static void WriteBytes(char *&dst, const T value) {
+    std::memcpy(dst, &value, sizeof(T));
+    dst += sizeof(T);
+  }
+
+  static void WriteAsciiPly(
+      std::ostream &out,
+      const geom::Location *begin,
+      const geom::Location *end,
+      const std::vector<uint32_t> &point_count_by_channel) {
+    const auto number_of_points = static_cast<size_t>(end - begin);
+    out << MakePlyHeader("ascii", number_of_points, !point_count_by_channel.empty());
+    out << std::fixed << std::setprecision(4u);
+    if (point_count_by_channel.empty()) {
+      for (; begin != end; ++begin) {
+        out << begin->x << ' ' << begin->y << ' ' << begin->z << '\n';
+      }
+    } else {
+      ForEachPoint(begin, end, point_count_by_channel, [&](const geom::Location &point, uint16_t channel) {
+        out << point.x << ' ' << point.y << ' ' << point.z << ' ' << channel << '\n';
+      });
+    }
+  }
+
+  static std::vector<char> MakeBinaryPly(
+      const geom::Location *begin,
+      const geom::Location *end,
+      const std::vector<uint32_t> &point_count_by_channel) {
+    const auto number_of_points = static_cast<size_t>(end - begin);
+    const bool with_channel = !point_count_by_channel.empty();
+    const auto header = MakePlyHeader("binary_little_endian", number_of_points, with_channel);
+    const size_t vertex_size = sizeof(geom::Location) + (with_channel ? sizeof(uint16_t) : 0u);
+    std::vector<char> buffer(header.size() + vertex_size * number_of_points);
+    std::memcpy(buffer.data(), header.data(), header.size());
+    char *dst = buffer.data() + header.size();
+    if (!with_channel) {
+      std::memcpy(dst, begin, sizeof(geom::Location) * number_of_points);
+    } else {
+      ForEachPoint(begin, end, point_count_by_channel, [&](const geom::Location &point, uint16_t channel) {
+        WriteBytes(dst, point.x);
+        WriteBytes(dst, point.y);
+        WriteBytes(dst, point.z);
+        WriteBytes(dst, channel);
+      });
+    }
+    return buffer;
+  }
+
+  static std::vector<char> MakeBin(
+      const geom::Location *begin,
+      const geom::Location *end,
+      const std::vector<uint32_t> &point_count_by_channel) {
+    const auto number_of_points = static_cast<size_t>(end - begin);
+    std::vector<char> buffer(4u * sizeof(float) * number_of_points);
+    char *dst = buffer.data();
+    auto write = [&](const geom::Location &point, float w) {
+      WriteBytes(dst, point.x);
+      WriteBytes(dst, point.y);
+      WriteBytes(dst, point.z);
+      WriteBytes(dst, w);
+    };
+    if (point_count_by_channel.empty()) {
+      for (; begin != end; ++begin) {
+        write(*begin, 0.0f);
+      }
+    } else {
+      ForEachPoint(begin, end, point_count_by_channel, [&](const geom::Location &point, uint16_t channel) {
+        write(point, static_cast<float>(channel));
+      });
+    }
+    return buffer;
+  }
+
+  // ===========================================================================
+  // -- PointCloudIO -----------------------------------------------------------
+  // ===========================================================================
+
   void PointCloudIO::WriteHeader(std::ostream &out, size_t number_of_points) {
     out << "ply\n"
            "format ascii 1.0\n"
@@ -25,5 +154,53 @@ namespace pointcloud {
     out << std::fixed << std::setprecision(4u);
   }
 
+  void PointCloudIO::Dump(
+      std::ostream &out,
+      const Format format,
+      const geom::Location *begin,
+      const geom::Location *end,
+      const std::vector<uint32_t> &point_count_by_channel) {
+    DEBUG_ASSERT(begin <= end);
+    if (!point_count_by_channel.empty()) {
+      const auto total = std::accumulate(
+          point_count_by_channel.begin(),
+          point_count_by_channel.end(),
+          size_t(0u));
+      if (total != static_cast<size_t>(end - begin)) {
+        throw_exception(std::invalid_argument(
+            "the point count of the channels does not match the number of points"));
+      }
+    }
+    switch (format) {
+      case Format::AsciiPly:
+        WriteAsciiPly(out, begin, end, point_count_by_channel);
+        break;
+      case Format::BinaryPly: {
+        const auto data = MakeBinaryPly(begin, end, point_count_by_channel);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        break;
+      }
+      case Format::Bin: {
+        const auto data = MakeBin(begin, end, point_count_by_channel);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        break;
+      }
+      default:
+        throw_exception(std::invalid_argument("invalid point cloud format"));
+    }
+  }
+
+  std::string PointCloudIO::SaveToDisk(
+      std::string path,
+      const Format format,
+      const geom::Location *begin,
+      const geom::Location *end,
+      const std::vector<uint32_t> &point_count_by_channel) {
+    FileSystem::ValidateFilePath(path, format == Format::Bin ? ".bin" : ".ply");
+    std::ofstream out(path, std::ios::binary);
+    Dump(out, format, begin, end, point_count_by_channel);
+    return path;
+  }
+
 } // namespace pointcloud
 } // namespace carla
@@ -7,9 +7,12 @@
 #pragma once
 
 #include "carla/FileSystem.h"
+#include "carla/geom/Location.h"
 
+#include <cstdint>
 #include <fstream>
 #include <iterator>
+#include <vector>
 
 namespace carla {
 namespace pointcloud {
@@ -17,6 +20,17 @@ namespace pointcloud {
   class PointCloudIO {
   public:
 
+    enum class Format : uint8_t {
+      /// ASCII PLY, ".ply".
+      AsciiPly,
+      /// Binary little-endian PLY, ".ply".
+      BinaryPly,
+      /// Raw little-endian float32 x, y, z and w of each point, ".bin", as in
+      /// the KITTI dataset. w is the channel of the point if written,
+      /// otherwise zero.
+      Bin
+    };
+
     template <typename PointIt>
     static void Dump(std::ostream &out, PointIt begin, PointIt end) {
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
@@ -34,6 +48,28 @@ namespace pointcloud {
       return path;
     }
 
+    /// Write the contiguous points [@a begin, @a end) to @a out in
+    /// @a format. The binary formats are written with a single write.
+    ///
+    /// If @a point_count_by_channel is not empty, the i-th element is the
+    /// number of consecutive points generated by the channel i, and the
+    /// channel of each point is written as well.
+    static void Dump(
+        std::ostream &out,
+        Format format,
+        const geom::Location *begin,
+        const geom::Location *end,
+        const std::vector<uint32_t> &point_count_by_channel = {});
+
+    /// Save the contiguous points [@a begin, @a end) to @a path in
+    /// @a format, see Dump.
+    static std::string SaveToDisk(
+        std::string path,
+        Format format,
+        const geom::Location *begin,
+        const geom::Location *end,
+        const std::vector<uint32_t> &point_count_by_channel = {});
+
   private:
 
     static void WriteHeader(std::ostream &out, size_t number_of_points);
@@ -0,0 +1,942 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/CompiledMap.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+#include "carla/road/MapBuilder.h"
+#include "carla/road/element/RoadInfoElevation.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneAccess.h"
+#include "carla/road/element/RoadInfoLaneBorder.h"
+#include "carla/road/element/RoadInfoLaneHeight.h"
+#include "carla/road/element/RoadInfoLaneMaterial.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneRule.h"
+#include "carla/road/element/RoadInfoLaneVisibility.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+#include "carla/road/element/RoadInfoMarkTypeLine.h"
+#include "carla/road/element/RoadInfoSpeed.h"
+#include "carla/road/element/RoadInfoVisitor.h"
+
+#include <boost/filesystem/operations.hpp>
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+#  include <boost/interprocess/file_mapping.hpp>
+#  include <boost/interprocess/mapped_region.hpp>
+#endif // LIBCARLA_NO_EXCEPTIONS
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+
+namespace carla {
+namespace road {
+
+  using namespace carla::road::element;
+
+  /// Identifies the binary format, increase the version each time the format
+  /// changes.
+  static constexpr uint32_t FILE_MAGIC = 0x50414d43u; // "CMAP"
+  static constexpr uint32_t FILE_VERSION = 2u;
+
+  /// Magic, version and source hash.
+  static constexpr size_t HEADER_SIZE = 2u * sizeof(uint32_t) + sizeof(uint64_t);
+
+  enum class RecordType : uint8_t {
+    Elevation,
+    Geometry,
+    LaneAccess,
+    LaneBorder,
+    LaneHeight,
+    LaneMaterial,
+    LaneOffset,
+    LaneRule,
+    LaneVisibility,
+    LaneWidth,
+    MarkRecord,
+    Speed
+  };
+
+  static_assert(
+      std::is_trivially_copyable<geom::CubicPolynomial>::value,
+      "Polynomials are stored as raw bytes");
+
+  // ===========================================================================
+  // -- Writer -----------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    /// Binary output buffer, strings are stored once in a table and referenced
+    /// by index.
+    class Writer {
+    public:
+
+      template <typename T>
+      void Write(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+        const auto *begin = reinterpret_cast<const unsigned char *>(&value);
+        _body.insert(_body.end(), begin, begin + sizeof(T));
+      }
+
+      void WriteString(const std::string &str) {
+        auto result = _string_ids.emplace(str, static_cast<uint32_t>(_strings.size()));
+        if (result.second) {
+          _strings.emplace_back(&result.first->first);
+        }
+        Write(result.first->second);
+      }
+
+      void WriteCount(size_t count) {
+        Write(static_cast<uint32_t>(count));
+      }
+
+      /// Return the complete file: header, string table and body.
+      std::vector<unsigned char> Finish(uint64_t source_hash) {
+        Writer header;
+        header.Write(FILE_MAGIC);
+        header.Write(FILE_VERSION);
+        header.Write(source_hash);
+        header.WriteCount(_strings.size());
+        for (const auto *str : _strings) {
+          header.WriteCount(str->size());
+          header._body.insert(header._body.end(), str->begin(), str->end());
+        }
+        auto result = std::move(header._body);
+        result.insert(result.end(), _body.begin(), _body.end());
+        return result;
+      }
+
+    private:
+
+      std::vector<unsigned char> _body;
+
+      std::unordered_map<std::string, uint32_t> _string_ids;
+
+      std::vector<const std::string *> _strings;
+    };
+
+    class RoadInfoWriter final : public RoadInfoVisitor {
+    public:
+
+      explicit RoadInfoWriter(Writer &out) : _out(out) {}
+
+      void Visit(RoadInfoElevation &info) final {
+        WriteHeader(RecordType::Elevation, info);
+        _out.Write(info.GetPolynomial());
+      }
+
+      void Visit(RoadInfoGeometry &info) final {
+        WriteHeader(RecordType::Geometry, info);
+        const auto &geometry = info.GetGeometry();
+        _out.Write(static_cast<uint8_t>(geometry.GetType()));
+        _out.Write(geometry.GetStartOffset());
+        _out.Write(geometry.GetLength());
+        _out.Write(geometry.GetHeading());
+        _out.Write(geometry.GetStartPosition());
+        switch (geometry.GetType()) {
+          case GeometryType::LINE:
+            break;
+          case GeometryType::ARC:
+            _out.Write(static_cast<const GeometryArc &>(geometry).GetCurvature());
+            break;
+          case GeometryType::SPIRAL: {
+            const auto &spiral = static_cast<const GeometrySpiral &>(geometry);
+            _out.Write(spiral.GetCurveStart());
+            _out.Write(spiral.GetCurveEnd());
+            break;
+          }
+          case GeometryType::POLY3: {
+            const auto &poly3 = static_cast<const GeometryPoly3 &>(geometry);
+            _out.Write(poly3.GetA());
+            _out.Write(poly3.GetB());
+            _out.Write(poly3.GetC());
+            _out.Write(poly3.GetD());
+            break;
+          }
+          case GeometryType::PARAMPOLY3: {
+            const auto &poly3 = static_cast<const GeometryParamPoly3 &>(geometry);
+            _out.Write(poly3.GetAU());
+            _out.Write(poly3.GetBU());
+            _out.Write(poly3.GetCU());
+            _out.Write(poly3.GetDU());
+            _out.Write(poly3.GetAV());
+            _out.Write(poly3.GetBV());
+            _out.Write(poly3.GetCV());
+            _out.Write(poly3.GetDV());
+            _out.Write(static_cast<uint8_t>(poly3.IsArcLength()));
+            break;
+          }
+          default:
+            throw_exception(std::runtime_error("compiled map: geometry type not supported"));
+        }
+      }
+
+      void Visit(RoadInfoLaneAccess &info) final {
+        WriteHeader(RecordType::LaneAccess, info);
+        _out.WriteString(info.GetRestriction());
+      }
+
+      void Visit(RoadInfoLaneBorder &info) final {
+        WriteHeader(RecordType::LaneBorder, info);
+        _out.Write(info.GetPolynomial());
+      }
+
+      void Visit(RoadInfoLaneHeight &info) final {
+        WriteHeader(RecordType::LaneHeight, info);
+        _out.Write(info.GetInner());
+        _out.Write(info.GetOuter());
+      }
+
+      void Visit(RoadInfoLaneMaterial &info) final {
+        WriteHeader(RecordType::LaneMaterial, info);
+        _out.WriteString(info.GetSurface());
+        _out.Write(info.GetFriction());
+        _out.Write(info.GetRoughness());
+      }
+
+      void Visit(RoadInfoLaneOffset &info) final {
+        WriteHeader(RecordType::LaneOffset, info);
+        _out.Write(info.GetPolynomial());
+      }
+
+      void Visit(RoadInfoLaneRule &info) final {
+        WriteHeader(RecordType::LaneRule, info);
+        _out.WriteString(info.GetValue());
+      }
+
+      void Visit(RoadInfoLaneVisibility &info) final {
+        WriteHeader(RecordType::LaneVisibility, info);
+        _out.Write(info.GetForward());
+        _out.Write(info.GetBack());
+        _out.Write(info.GetLeft());
+        _out.Write(info.GetRight());
+      }
+
+      void Visit(RoadInfoLaneWidth &info) final {
+        WriteHeader(RecordType::LaneWidth, info);
+        _out.Write(info.GetPolynomial());
+      }
+
+      void Visit(RoadInfoMarkRecord &info) final {
+        WriteHeader(RecordType::MarkRecord, info);
+        _out.Write(info.GetRoadMarkId());
+        _out.WriteString(info.GetType());
+        _out.WriteString(info.GetWeight());
+        _out.WriteString(info.GetColor());
+        _out.WriteString(info.GetMaterial());
+        _out.Write(info.GetWidth());
+        _out.Write(info.GetLaneChange());
+        _out.Write(info.GetHeight());
+        _out.WriteString(info.GetTypeName());
+        _out.Write(info.GetTypeWidth());
+        _out.WriteCount(info.GetLines().size());
+        for (const auto &line : info.GetLines()) {
+          _out.Write(line->GetDistance());
+          _out.Write(line->GetLength());
+          _out.Write(line->GetSpace());
+          _out.Write(line->GetTOffset());
+          _out.WriteString(line->GetRule());
+          _out.Write(line->GetWidth());
+        }
+      }
+
+      void Visit(RoadInfoSpeed &info) final {
+        WriteHeader(RecordType::Speed, info);
+        _out.Write(info.GetSpeed());
+      }
+
+    private:
+
+      void WriteHeader(RecordType type, const RoadInfo &info) {
+        _out.Write(type);
+        _out.Write(info.GetDistance());
+      }
+
+      Writer &_out;
+    };
+
+  } // namespace
+
+  static void WriteInfos(Writer &out, const InformationSet &infos) {
+    RoadInfoWriter writer(out);
+    out.WriteCount(infos.GetAll().size());
+    for (const auto &info : infos.GetAll()) {
+      info->AcceptVisitor(writer);
+    }
+  }
+
+  /// Return the keys of @a map sorted, so the output does not depend on the
+  /// iteration order of unordered maps.
+  template <typename MapT>
+  static auto GetSortedKeys(const MapT &map) {
+    std::vector<typename MapT::key_type> result;
+    result.reserve(map.size());
+    for (const auto &pair : map) {
+      result.emplace_back(pair.first);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+  uint64_t CompiledMap::Hash(const std::string &opendrive) {
+    // 64-bit FNV-1a.
+    uint64_t hash = 14695981039346656037ull;
+    for (const auto c : opendrive) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  std::vector<unsigned char> CompiledMap::Serialize(const Map &map, const uint64_t source_hash) {
+    const auto &data = map._data;
+    Writer out;
+
+    auto write_validities = [&out](const std::vector<general::Validity> &validities) {
+      out.WriteCount(validities.size());
+      for (const auto &validity : validities) {
+        out.Write(validity._from_lane);
+        out.Write(validity._to_lane);
+      }
+    };
+
+    const auto &geo_reference = data.GetGeoReference();
+    out.Write(geo_reference.latitude);
+    out.Write(geo_reference.longitude);
+    out.Write(geo_reference.altitude);
+
+    out.WriteCount(data._junctions.size());
+    for (const auto junction_id : GetSortedKeys(data._junctions)) {
+      const auto &junction = data._junctions.at(junction_id);
+      out.Write(junction._id);
+      out.WriteString(junction._name);
+      out.WriteCount(junction._connections.size());
+      for (const auto connection_id : GetSortedKeys(junction._connections)) {
+        const auto &connection = junction._connections.at(connection_id);
+        out.Write(connection.id);
+        out.Write(connection.incoming_road);
+        out.Write(connection.connecting_road);
+        out.WriteCount(connection.lane_links.size());
+        for (const auto &link : connection.lane_links) {
+          out.Write(link.from);
+          out.Write(link.to);
+        }
+      }
+    }
+
+    out.WriteCount(data._roads.size());
+    for (const auto road_id : GetSortedKeys(data._roads)) {
+      const auto &road = data._roads.at(road_id);
+      out.Write(road._id);
+      out.WriteString(road._name);
+      out.Write(road._length);
+      out.Write(road._junction_id);
+      out.Write(road._predecessor);
+      out.Write(road._successor);
+
+      const auto sections = road.GetLaneSections();
+      out.WriteCount(static_cast<size_t>(std::distance(sections.begin(), sections.end())));
+      for (const auto &section : sections) {
+        out.Write(section.GetId());
+        out.Write(section.GetDistance());
+        out.WriteCount(section.GetLanes().size());
+        for (const auto &pair : section.GetLanes()) {
+          const auto &lane = pair.second;
+          out.Write(lane._id);
+          out.Write(static_cast<uint32_t>(lane._type));
+          out.Write(static_cast<uint8_t>(lane._level));
+          out.Write(lane._predecessor);
+          out.Write(lane._successor);
+          WriteInfos(out, lane._info);
+        }
+      }
+      WriteInfos(out, road._info);
+
+      out.WriteCount(road._signals.size());
+      for (const auto signal_id : GetSortedKeys(road._signals)) {
+        const auto &signal = road._signals.at(signal_id);
+        out.Write(signal._signal_id);
+        out.Write(signal._s);
+        out.Write(signal._t);
+        out.WriteString(signal._name);
+        out.WriteString(signal._dynamic);
+        out.WriteString(signal._orientation);
+        out.Write(signal._zOffset);
+        out.WriteString(signal._country);
+        out.WriteString(signal._type);
+        out.WriteString(signal._subtype);
+        out.Write(signal._value);
+        out.WriteString(signal._unit);
+        out.Write(signal._height);
+        out.Write(signal._width);
+        out.WriteString(signal._text);
+        out.Write(signal._hOffset);
+        out.Write(signal._pitch);
+        out.Write(signal._roll);
+        write_validities(signal._validities);
+        out.WriteCount(signal._dependencies.size());
+        for (const auto &dependency : signal._dependencies) {
+          out.Write(dependency._dependency_id);
+          out.WriteString(dependency._type);
+        }
+      }
+
+      out.WriteCount(road._sign_ref.size());
+      for (const auto reference_id : GetSortedKeys(road._sign_ref)) {
+        const auto &reference = road._sign_ref.at(reference_id);
+        out.Write(reference._signal_id);
+        out.Write(reference._s);
+        out.Write(reference._t);
+        out.WriteString(reference._orientation);
+        write_validities(reference._validities);
+      }
+    }
+
+    // Waypoints and topology already generated for this map, so loading the
+    // compiled map does not need to generate them again.
+    auto write_waypoint = [&out](const Waypoint &waypoint) {
+      out.Write(waypoint.road_id);
+      out.Write(waypoint.section_id);
+      out.Write(waypoint.lane_id);
+      out.Write(waypoint.s);
+    };
+    Map::Cache::WaypointLists waypoints;
+    std::shared_ptr<const Map::TopologyList> topology;
+    {
+      std::lock_guard<std::mutex> lock(map._cache->mutex);
+      waypoints = map._cache->waypoints;
+      topology = map._cache->topology;
+    }
+    out.WriteCount(waypoints.size());
+    for (const auto &pair : waypoints) {
+      out.Write(pair.first);
+      out.WriteCount(pair.second->size());
+      for (const auto &waypoint : *pair.second) {
+        write_waypoint(waypoint);
+      }
+    }
+    out.Write(static_cast<uint8_t>(topology != nullptr));
+    if (topology != nullptr) {
+      out.WriteCount(topology->size());
+      for (const auto &pair : *topology) {
+        write_waypoint(pair.first);
+        write_waypoint(pair.second);
+      }
+    }
+
+    return out.Finish(source_hash);
+  }
+
+  // ===========================================================================
+  // -- Reader -----------------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    /// Bounds-checked binary input, once a read fails every following read
+    /// fails too.
+    class Reader {
+    public:
+
+      Reader(const unsigned char *data, size_t size)
+        : _begin(data),
+          _end(data + size) {}
+
+      bool good() const {
+        return _good;
+      }
+
+      /// Mark the data as corrupted, e.g. on an unknown tag.
+      void Fail() {
+        _good = false;
+      }
+
+      template <typename T>
+      T Read() {
+        static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+        T value{};
+        if (Require(sizeof(T))) {
+          std::memcpy(&value, _begin, sizeof(T));
+          _begin += sizeof(T);
+        }
+        return value;
+      }
+
+      /// Read an element count, each element takes at least one byte so
+      /// counts greater than the remaining bytes are invalid.
+      uint32_t ReadCount() {
+        const auto count = Read<uint32_t>();
+        if (count > static_cast<size_t>(_end - _begin)) {
+          _good = false;
+          return 0u;
+        }
+        return count;
+      }
+
+      std::string ReadRawString() {
+        const auto size = ReadCount();
+        if (!Require(size)) {
+          return {};
+        }
+        std::string result(reinterpret_cast<const char *>(_begin), size);
+        _begin += size;
+        return result;
+      }
+
+      bool ReadStringTable() {
+        const auto count = ReadCount();
+        _strings.reserve(count);
+        for (auto i = 0u; (i < count) && _good; ++i) {
+          _strings.emplace_back(ReadRawString());
+        }
+        return _good;
+      }
+
+      const std::string &ReadString() {
+        static const std::string empty;
+        const auto index = Read<uint32_t>();
+        if (index >= _strings.size()) {
+          _good = false;
+          return empty;
+        }
+        return _strings[index];
+      }
+
+    private:
+
+      bool Require(size_t size) {
+        _good = _good && (size <= static_cast<size_t>(_end - _begin));
+        return _good;
+      }
+
+      const unsigned char *_begin;
+
+      const unsigned char *_end;
+
+      bool _good = true;
+
+      std::vector<std::string> _strings;
+    };
+
+  } // namespace
+
+  /// Read a list of infos, an unknown record or geometry type fails @a in
+  /// since the rest of the data can not be aligned anymore.
+  static bool ReadInfos(
+      Reader &in,
+      std::vector<std::unique_ptr<RoadInfo>> &result) {
+    const auto count = in.ReadCount();
+    result.reserve(count);
+    for (auto i = 0u; (i < count) && in.good(); ++i) {
+      const auto type = in.Read<RecordType>();
+      const auto s = in.Read<double>();
+      switch (type) {
+        case RecordType::Elevation:
+          result.emplace_back(std::make_unique<RoadInfoElevation>(s, in.Read<geom::CubicPolynomial>()));
+          break;
+        case RecordType::Geometry: {
+          const auto geometry_type = static_cast<GeometryType>(in.Read<uint8_t>());
+          const auto start_offset = in.Read<double>();
+          const auto length = in.Read<double>();
+          const auto heading = in.Read<double>();
+          const auto location = in.Read<geom::Location>();
+          std::unique_ptr<Geometry> geometry;
+          if (geometry_type == GeometryType::LINE) {
+            geometry = std::make_unique<GeometryLine>(start_offset, length, heading, location);
+          } else if (geometry_type == GeometryType::ARC) {
+            const auto curvature = in.Read<double>();
+            geometry = std::make_unique<GeometryArc>(start_offset, length, heading, location, curvature);
+          } else if (geometry_type == GeometryType::SPIRAL) {
+            // The lookup tables are not stored, they are rebuilt here.
+            const auto curve_start = in.Read<double>();
+            const auto curve_end = in.Read<double>();
+            geometry = std::make_unique<GeometrySpiral>(
+                start_offset, length, heading, location, curve_start, curve_end);
+          } else if (geometry_type == GeometryType::POLY3) {
+            const auto a = in.Read<double>();
+            const auto b = in.Read<double>();
+            const auto c = in.Read<double>();
+            const auto d = in.Read<double>();
+            geometry = std::make_unique<GeometryPoly3>(
+                start_offset, length, heading, location, a, b, c, d);
+          } else if (geometry_type == GeometryType::PARAMPOLY3) {
+            std::array<double, 8u> k;
+            for (auto &value : k) {
+              value = in.Read<double>();
+            }
+            const bool arc_length = in.Read<uint8_t>() != 0u;
+            geometry = std::make_unique<GeometryParamPoly3>(
+                start_offset, length, heading, location,
+                k[0u], k[1u], k[2u], k[3u], k[4u], k[5u], k[6u], k[7u], arc_length);
+          } else {
+            in.Fail();
+            return false;
+          }
+          result.emplace_back(std::make_unique<RoadInfoGeometry>(s, std::move(geometry)));
+          break;
+        }
+        case RecordType::LaneAccess:
+          result.emplace_back(std::make_unique<RoadInfoLaneAccess>(s, in.ReadString()));
+          break;
+        case RecordType::LaneBorder:
+          result.emplace_back(std::make_unique<RoadInfoLaneBorder>(s, in.Read<geom::CubicPolynomial>()));
+          break;
+        case RecordType::LaneHeight: {
+          const auto inner = in.Read<double>();
+          const auto outer = in.Read<double>();
+          result.emplace_back(std::make_unique<RoadInfoLaneHeight>(s, inner, outer));
+          break;
+        }
+        case RecordType::LaneMaterial: {
+          const auto &surface = in.ReadString();
+          const auto friction = in.Read<double>();
+          const auto roughness = in.Read<double>();
+          result.emplace_back(std::make_unique<RoadInfoLaneMaterial>(s, surface, friction, roughness));
+          break;
+        }
+        case RecordType::LaneOffset:
+          result.emplace_back(std::make_unique<RoadInfoLaneOffset>(s, in.Read<geom::CubicPolynomial>()));
+          break;
+        case RecordType::LaneRule:
+          result.emplace_back(std::make_unique<RoadInfoLaneRule>(s, in.ReadString()));
+          break;
+        case RecordType::LaneVisibility: {
+          const auto forward = in.Read<double>();
+          const auto back = in.Read<double>();
+          const auto left = in.Read<double>();
+          const auto right = in.Read<double>();
+          result.emplace_back(std::make_unique<RoadInfoLaneVisibility>(s, forward, back, left, right));
+          break;
+        }
+        case RecordType::LaneWidth:
+          result.emplace_back(std::make_unique<RoadInfoLaneWidth>(s, in.Read<geom::CubicPolynomial>()));
+          break;
+        case RecordType::MarkRecord: {
+          const auto road_mark_id = in.Read<int>();
+          const auto &type_str = in.ReadString();
+          const auto &weight = in.ReadString();
+          const auto &color = in.ReadString();
+          const auto &material = in.ReadString();
+          const auto width = in.Read<double>();
+          const auto lane_change = in.Read<RoadInfoMarkRecord::LaneChange>();
+          const auto height = in.Read<double>();
+          const auto &type_name = in.ReadString();
+          const auto type_width = in.Read<double>();
+          auto record = std::make_unique<RoadInfoMarkRecord>(
+              s, road_mark_id, type_str, weight, color, material, width,
+              lane_change, height, type_name, type_width);
+          const auto number_of_lines = in.ReadCount();
+          for (auto j = 0u; (j < number_of_lines) && in.good(); ++j) {
+            const auto line_s = in.Read<double>();
+            const auto line_length = in.Read<double>();
+            const auto space = in.Read<double>();
+            const auto t_offset = in.Read<double>();
+            const auto &rule = in.ReadString();
+            const auto line_width = in.Read<double>();
+            record->GetLines().emplace_back(std::make_unique<RoadInfoMarkTypeLine>(
+                line_s, road_mark_id, line_length, space, t_offset, rule, line_width));
+          }
+          result.emplace_back(std::move(record));
+          break;
+        }
+        case RecordType::Speed:
+          result.emplace_back(std::make_unique<RoadInfoSpeed>(s, in.Read<double>()));
+          break;
+        default:
+          in.Fail();
+          return false;
+      }
+    }
+    return in.good();
+  }
+
+  template <typename FuncT>
+  static void ReadValidities(Reader &in, FuncT &&add_validity) {
+    const auto count = in.ReadCount();
+    for (auto i = 0u; (i < count) && in.good(); ++i) {
+      const auto from_lane = in.Read<LaneId>();
+      const auto to_lane = in.Read<LaneId>();
+      add_validity(from_lane, to_lane);
+    }
+  }
+
+  static Waypoint ReadWaypoint(Reader &in) {
+    Waypoint waypoint;
+    waypoint.road_id = in.Read<RoadId>();
+    waypoint.section_id = in.Read<SectionId>();
+    waypoint.lane_id = in.Read<LaneId>();
+    waypoint.s = in.Read<double>();
+    return waypoint;
+  }
+
+  static bool ReadHeader(Reader &in, uint64_t &source_hash) {
+    const auto magic = in.Read<uint32_t>();
+    const auto version = in.Read<uint32_t>();
+    source_hash = in.Read<uint64_t>();
+    return in.good() && (magic == FILE_MAGIC) && (version == FILE_VERSION);
+  }
+
+  boost::optional<uint64_t> CompiledMap::GetSourceHash(const unsigned char *data, const size_t size) {
+    Reader in(data, size);
+    uint64_t source_hash;
+    if (!ReadHeader(in, source_hash)) {
+      return boost::none;
+    }
+    return source_hash;
+  }
+
+  boost::optional<Map> CompiledMap::Deserialize(
+      const unsigned char *data,
+      const size_t size,
+      const boost::optional<uint64_t> expected_source_hash) {
+    Reader in(data, size);
+    uint64_t source_hash;
+    if (!ReadHeader(in, source_hash)) {
+      log_error("compiled map: invalid header or unsupported version");
+      return boost::none;
+    }
+    if (expected_source_hash.has_value() && (*expected_source_hash != source_hash)) {
+      log_error("compiled map: compiled from a different OpenDRIVE");
+      return boost::none;
+    }
+    if (!in.ReadStringTable()) {
+      log_error("compiled map: corrupted data");
+      return boost::none;
+    }
+
+    MapBuilder builder;
+
+    const auto latitude = in.Read<double>();
+    const auto longitude = in.Read<double>();
+    const auto altitude = in.Read<double>();
+    builder.SetGeoReference(geom::GeoLocation{latitude, longitude, altitude});
+
+    const auto number_of_junctions = in.ReadCount();
+    for (auto i = 0u; (i < number_of_junctions) && in.good(); ++i) {
+      const auto junction_id = in.Read<JuncId>();
+      builder.AddJunction(junction_id, in.ReadString());
+      const auto number_of_connections = in.ReadCount();
+      for (auto j = 0u; (j < number_of_connections) && in.good(); ++j) {
+        const auto connection_id = in.Read<ConId>();
+        const auto incoming_road = in.Read<RoadId>();
+        const auto connecting_road = in.Read<RoadId>();
+        builder.AddConnection(junction_id, connection_id, incoming_road, connecting_road);
+        const auto number_of_links = in.ReadCount();
+        for (auto k = 0u; (k < number_of_links) && in.good(); ++k) {
+          const auto from = in.Read<LaneId>();
+          const auto to = in.Read<LaneId>();
+          builder.AddLaneLink(junction_id, connection_id, from, to);
+        }
+      }
+    }
+
+    std::vector<std::unique_ptr<RoadInfo>> infos;
+    const auto number_of_roads = in.ReadCount();
+    for (auto i = 0u; (i < number_of_roads) && in.good(); ++i) {
+      const auto road_id = in.Read<RoadId>();
+      const auto &name = in.ReadString();
+      const auto length = in.Read<double>();
+      const auto junction_id = in.Read<JuncId>();
+      const auto predecessor = in.Read<RoadId>();
+      const auto successor = in.Read<RoadId>();
+      auto *road = builder.AddRoad(road_id, name, length, junction_id, predecessor, successor);
+
+      const auto number_of_sections = in.ReadCount();
+      for (auto j = 0u; (j < number_of_sections) && in.good(); ++j) {
+        const auto section_id = in.Read<SectionId>();
+        const auto s = in.Read<double>();
+        auto *section = builder.AddRoadSection(road, section_id, s);
+        const auto number_of_lanes = in.ReadCount();
+        for (auto k = 0u; (k < number_of_lanes) && in.good(); ++k) {
+          const auto lane_id = in.Read<LaneId>();
+          const auto lane_type = in.Read<uint32_t>();
+          const auto level = in.Read<uint8_t>() != 0u;
+          const auto lane_predecessor = in.Read<LaneId>();
+          const auto lane_successor = in.Read<LaneId>();
+          auto *lane = builder.AddRoadSectionLane(
+              section, lane_id, lane_type, level, lane_predecessor, lane_successor);
+          infos.clear();
+          if (!ReadInfos(in, infos)) {
+            break;
+          }
+          for (auto &info : infos) {
+            builder.AddLaneInfo(lane, std::move(info));
+          }
+        }
+      }
+
+      infos.clear();
+      if (!ReadInfos(in, infos)) {
+        break;
+      }
+      for (auto &info : infos) {
+        builder.AddRoadInfo(road, std::move(info));
+      }
+
+      const auto number_of_signals = in.ReadCount();
+      for (auto j = 0u; (j < number_of_signals) && in.good(); ++j) {
+        const auto signal_id = in.Read<SignId>();
+        const auto s = in.Read<double>();
+        const auto t = in.Read<double>();
+        const auto &signal_name = in.ReadString();
+        const auto &dynamic = in.ReadString();
+        const auto &orientation = in.ReadString();
+        const auto z_offset = in.Read<double>();
+        const auto &country = in.ReadString();
+        const auto &type = in.ReadString();
+        const auto &subtype = in.ReadString();
+        const auto value = in.Read<double>();
+        const auto &unit = in.ReadString();
+        const auto height = in.Read<double>();
+        const auto width = in.Read<double>();
+        const auto &text = in.ReadString();
+        const auto h_offset = in.Read<double>();
+        const auto pitch = in.Read<double>();
+        const auto roll = in.Read<double>();
+        builder.AddSignal(
+            road_id, signal_id, s, t, signal_name, dynamic, orientation,
+            z_offset, country, type, subtype, value, unit, height, width, text,
+            h_offset, pitch, roll);
+        ReadValidities(in, [&](LaneId from_lane, LaneId to_lane) {
+          builder.AddValidityToSignal(road_id, signal_id, from_lane, to_lane);
+        });
+        const auto number_of_dependencies = in.ReadCount();
+        for (auto k = 0u; (k < number_of_dependencies) && in.good(); ++k) {
+          const auto dependency_id = in.Read<uint32_t>();
+          builder.AddDependencyToSignal(road_id, signal_id, dependency_id, in.ReadString());
+        }
+      }
+
+      const auto number_of_references = in.ReadCount();
+      for (auto j = 0u; (j < number_of_references) && in.good(); ++j) {
+        const auto reference_id = in.Read<SignRefId>();
+        const auto s = in.Read<double>();
+        const auto t = in.Read<double>();
+        builder.AddSignalReference(road_id, reference_id, s, t, in.ReadString());
+        ReadValidities(in, [&](LaneId from_lane, LaneId to_lane) {
+          builder.AddValidityToSignalReference(road_id, reference_id, from_lane, to_lane);
+        });
+      }
+    }
+
+    Map::Cache::WaypointLists waypoints;
+    const auto number_of_waypoint_lists = in.ReadCount();
+    for (auto i = 0u; (i < number_of_waypoint_lists) && in.good(); ++i) {
+      const auto distance = in.Read<double>();
+      Map::WaypointList list(in.ReadCount());
+      for (auto &waypoint : list) {
+        waypoint = ReadWaypoint(in);
+      }
+      if (waypoints.size() < Map::MaxCachedWaypointLists) {
+        waypoints.emplace_back(distance, std::make_shared<const Map::WaypointList>(std::move(list)));
+      }
+    }
+    std::shared_ptr<const Map::TopologyList> topology;
+    if (in.Read<uint8_t>() != 0u) {
+      Map::TopologyList list(in.ReadCount());
+      for (auto &pair : list) {
+        pair.first = ReadWaypoint(in);
+        pair.second = ReadWaypoint(in);
+      }
+      topology = std::make_shared<const Map::TopologyList>(std::move(list));
+    }
+
+    if (!in.good()) {
+      log_error("compiled map: corrupted data");
+      return boost::none;
+    }
+    auto map = builder.Build();
+    if (map.has_value()) {
+      map->_cache->waypoints = std::move(waypoints);
+      map->_cache->topology = std::move(topology);
+    }
+    return map;
+  }
+
+  // ===========================================================================
+  // -- Files ------------------------------------------------------------------
+  // ===========================================================================
+
+  bool CompiledMap::Save(const Map &map, const uint64_t source_hash, const std::string &path) {
+    namespace fs = boost::filesystem;
+    const auto buffer = Serialize(map, source_hash);
+    boost::system::error_code ec;
+    const auto temp_path = fs::unique_path(path + ".%%%%-%%%%-%%%%.tmp", ec);
+    if (!ec) {
+      std::ofstream out(temp_path.string(), std::ios::binary);
+      out.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+      out.close();
+      if (out.good()) {
+        fs::rename(temp_path, path, ec);
+      } else {
+        ec = boost::system::errc::make_error_code(boost::system::errc::io_error);
+      }
+      if (ec) {
+        fs::remove(temp_path, ec);
+      }
+    }
+    if (ec) {
+      log_error("compiled map: unable to write", path);
+      return false;
+    }
+    return true;
+  }
+
+  boost::optional<Map> CompiledMap::Load(
+      const std::string &path,
+      const boost::optional<uint64_t> source_hash) {
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    namespace ipc = boost::interprocess;
+    try {
+      const ipc::file_mapping file(path.c_str(), ipc::read_only);
+      ipc::mapped_region region(file, ipc::read_only);
+      region.advise(ipc::mapped_region::advice_sequential);
+      return Deserialize(
+          static_cast<const unsigned char *>(region.get_address()),
+          region.get_size(),
+          source_hash);
+    } catch (const std::exception &e) {
+      log_error("compiled map: unable to map", path, ':', e.what());
+      return boost::none;
+    }
+#else
+    // Memory mapping is only available with exceptions, read the file instead.
+    std::ifstream in(path, std::ios::binary);
+    if (!in.good()) {
+      log_error("compiled map: unable to open", path);
+      return boost::none;
+    }
+    const std::vector<unsigned char> buffer{
+        std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>()};
+    return Deserialize(buffer.data(), buffer.size(), source_hash);
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+
+  bool CompiledMap::IsUpToDate(const std::string &path, const std::string &opendrive) {
+    unsigned char header[HEADER_SIZE];
+    std::ifstream in(path, std::ios::binary);
+    in.read(reinterpret_cast<char *>(header), HEADER_SIZE);
+    if (!in.good()) {
+      return false;
+    }
+    const auto source_hash = GetSourceHash(header, HEADER_SIZE);
+    return source_hash.has_value() && (*source_hash == Hash(opendrive));
+  }
+
+} // namespace road
+} // namespace carla
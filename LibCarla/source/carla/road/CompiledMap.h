@@ -0,0 +1,70 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/Map.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Binary format of a road::Map, much faster to load than the OpenDRIVE it
+  /// was compiled from.
+  ///
+  /// A compiled map contains the roads, lane sections, lanes, road info
+  /// records, junctions and signals of the map; the links between lanes are
+  /// recomputed from the ids when loading. The waypoints and topology cached
+  /// by the map when it was serialized are stored too, see
+  /// Map::GetCachedWaypoints. Files are memory-mapped, so every
+  /// process loading the same compiled map reads it from the same pages of
+  /// the operating system's file cache.
+  ///
+  /// Each compiled map stores the version of the format and the hash of the
+  /// OpenDRIVE it was compiled from, see IsUpToDate.
+  class CompiledMap {
+  public:
+
+    /// Hash identifying the OpenDRIVE source of a compiled map.
+    static uint64_t Hash(const std::string &opendrive);
+
+    /// Serialize @a map, compiled from an OpenDRIVE with hash @a source_hash.
+    static std::vector<unsigned char> Serialize(const Map &map, uint64_t source_hash);
+
+    /// Deserialize a map from the buffer @a data of @a size bytes. Return an
+    /// empty optional if the data is not a valid compiled map, or if
+    /// @a source_hash is given and does not match the stored one.
+    static boost::optional<Map> Deserialize(
+        const unsigned char *data,
+        size_t size,
+        boost::optional<uint64_t> source_hash = boost::none);
+
+    /// Return the hash of the OpenDRIVE source stored in the compiled map
+    /// @a data, if it is valid and has the current format version.
+    static boost::optional<uint64_t> GetSourceHash(const unsigned char *data, size_t size);
+
+    /// Save @a map to the file at @a path. The file is written to a temporary
+    /// location first and then moved, so other processes never read a file
+    /// partially written. Return false if the file cannot be written.
+    static bool Save(const Map &map, uint64_t source_hash, const std::string &path);
+
+    /// Load the compiled map file at @a path, see Deserialize.
+    static boost::optional<Map> Load(
+        const std::string &path,
+        boost::optional<uint64_t> source_hash = boost::none);
+
+    /// Return whether the file at @a path is a compiled map of the current
+    /// format version compiled from @a opendrive.
+    static bool IsUpToDate(const std::string &path, const std::string &opendrive);
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,898 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/ContractionHierarchy.h"
+
+#include "carla/Debug.h"
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+
+namespace carla {
+namespace road {
+
+  using element::Waypoint;
+  using NodeId = ContractionHierarchy::NodeId;
+  using Arc = ContractionHierarchy::Arc;
+  using AdjacencyList = ContractionHierarchy::AdjacencyList;
+  using Seed = ContractionHierarchy::Seed;
+
+  static constexpr NodeId INVALID_NODE = RoutingGraph::InvalidNode;
+
+  /// Identifies the binary format of the hierarchy, increase the version each
+  /// time the format changes.
+  static constexpr uint32_t FILE_MAGIC = 0x48435243u; // "CRCH"
+  static constexpr uint32_t FILE_VERSION = 1u;
+
+  /// Maximum number of nodes settled by each witness search during the
+  /// contraction. Witness searches that give up add a shortcut that may not
+  /// be necessary, which is always safe.
+  static constexpr size_t MAX_WITNESS_SETTLED_NODES = 500u;
+
+  // ===========================================================================
+  // -- Search space -----------------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    /// Distances and parents of a Dijkstra search, can be reused between
+    /// searches since only the touched nodes are reset.
+    class SearchSpace {
+    public:
+
+      struct Label {
+        double distance = ContractionHierarchy::Infinity;
+        NodeId parent = INVALID_NODE;
+        NodeId middle = INVALID_NODE;
+      };
+
+      explicit SearchSpace(size_t number_of_nodes) : _labels(number_of_nodes) {}
+
+      void Clear() {
+        for (auto node : _touched) {
+          _labels[node] = Label{};
+        }
+        _touched.clear();
+        _queue = Queue{};
+      }
+
+      const Label &operator[](NodeId node) const {
+        return _labels[node];
+      }
+
+      bool Relax(NodeId node, double distance, NodeId parent, NodeId middle) {
+        auto &label = _labels[node];
+        if (distance < label.distance) {
+          if (label.distance == ContractionHierarchy::Infinity) {
+            _touched.emplace_back(node);
+          }
+          label = Label{distance, parent, middle};
+          _queue.emplace(distance, node);
+          return true;
+        }
+        return false;
+      }
+
+      /// Return the distance of the next node to settle, infinity if the queue
+      /// is empty. Discards outdated entries of the queue.
+      double GetMinDistance() {
+        while (!_queue.empty() && _queue.top().first > _labels[_queue.top().second].distance) {
+          _queue.pop();
+        }
+        return _queue.empty() ? ContractionHierarchy::Infinity : _queue.top().first;
+      }
+
+      /// Pop the next node to settle, GetMinDistance must be called first.
+      NodeId Pop() {
+        DEBUG_ASSERT(!_queue.empty());
+        const auto node = _queue.top().second;
+        _queue.pop();
+        return node;
+      }
+
+    private:
+
+      using QueueEntry = std::pair<double, NodeId>;
+
+      using Queue = std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>>;
+
+      std::vector<Label> _labels;
+
+      std::vector<NodeId> _touched;
+
+      Queue _queue;
+    };
+
+  } // namespace
+
+  /// Run a complete search on the upward graph @a graph, calling @a callback
+  /// for each settled node.
+  template <typename FuncT>
+  static void UpwardSearch(
+      const AdjacencyList &graph,
+      const std::vector<Seed> &seeds,
+      SearchSpace &space,
+      FuncT &&callback) {
+    space.Clear();
+    for (const auto &seed : seeds) {
+      space.Relax(seed.node, seed.distance, INVALID_NODE, INVALID_NODE);
+    }
+    while (space.GetMinDistance() < ContractionHierarchy::Infinity) {
+      const auto node = space.Pop();
+      const auto distance = space[node].distance;
+      callback(node, distance);
+      for (auto arc = graph.begin(node); arc != graph.end(node); ++arc) {
+        space.Relax(arc->node, distance + arc->weight, node, arc->middle);
+      }
+    }
+  }
+
+  // ===========================================================================
+  // -- Contraction ------------------------------------------------------------
+  // ===========================================================================
+
+  static AdjacencyList MakeAdjacencyList(
+      size_t number_of_nodes,
+      std::vector<std::pair<NodeId, Arc>> &&arcs) {
+    std::stable_sort(arcs.begin(), arcs.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+    AdjacencyList result;
+    result.offsets.assign(number_of_nodes + 1u, 0u);
+    result.arcs.reserve(arcs.size());
+    for (const auto &pair : arcs) {
+      ++result.offsets[pair.first + 1u];
+      result.arcs.emplace_back(pair.second);
+    }
+    for (auto i = 1u; i < result.offsets.size(); ++i) {
+      result.offsets[i] += result.offsets[i - 1u];
+    }
+    return result;
+  }
+
+  namespace {
+
+    /// Graph being contracted, it only keeps the edges between nodes that are
+    /// not contracted yet.
+    class Contractor {
+    public:
+
+      explicit Contractor(const RoutingGraph &graph)
+        : _out(graph.GetNumberOfNodes()),
+          _in(graph.GetNumberOfNodes()),
+          _contracted(graph.GetNumberOfNodes(), false),
+          _deleted_neighbors(graph.GetNumberOfNodes(), 0),
+          _witness(graph.GetNumberOfNodes()) {
+        for (const auto &edge : graph.GetEdges()) {
+          if (edge.source != edge.target) {
+            AddArc(edge.source, edge.target, edge.weight, INVALID_NODE);
+          }
+        }
+      }
+
+      /// Contract all the nodes, fills @a upward and @a downward with the edges
+      /// of the hierarchy. Return the number of shortcuts added.
+      size_t Run(
+          std::vector<std::pair<NodeId, Arc>> &upward,
+          std::vector<std::pair<NodeId, Arc>> &downward) {
+        using Entry = std::pair<int, NodeId>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        for (auto node = 0u; node < _out.size(); ++node) {
+          queue.emplace(GetPriority(node), node);
+        }
+        size_t shortcuts = 0u;
+        while (!queue.empty()) {
+          const auto node = queue.top().second;
+          queue.pop();
+          // Lazy update: re-evaluate the priority, and postpone the node if it
+          // is no longer the best candidate.
+          const auto priority = GetPriority(node);
+          if (!queue.empty() && priority > queue.top().first) {
+            queue.emplace(priority, node);
+            continue;
+          }
+          shortcuts += Contract(node, upward, downward);
+        }
+        return shortcuts;
+      }
+
+    private:
+
+      struct Shortcut {
+        NodeId source;
+        NodeId target;
+        double weight;
+      };
+
+      void AddArc(NodeId source, NodeId target, double weight, NodeId middle) {
+        auto &out = _out[source];
+        auto it = std::find_if(out.begin(), out.end(), [=](const Arc &arc) {
+          return arc.node == target;
+        });
+        if (it != out.end()) {
+          if (weight < it->weight) {
+            *it = Arc{target, middle, weight};
+            auto &in = _in[target];
+            auto jt = std::find_if(in.begin(), in.end(), [=](const Arc &arc) {
+              return arc.node == source;
+            });
+            DEBUG_ASSERT(jt != in.end());
+            *jt = Arc{source, middle, weight};
+          }
+        } else {
+          out.emplace_back(Arc{target, middle, weight});
+          _in[target].emplace_back(Arc{source, middle, weight});
+        }
+      }
+
+      static void RemoveArc(std::vector<Arc> &arcs, NodeId node) {
+        arcs.erase(
+            std::remove_if(arcs.begin(), arcs.end(), [=](const Arc &arc) { return arc.node == node; }),
+            arcs.end());
+      }
+
+      /// Return the shortcuts needed to contract @a node.
+      std::vector<Shortcut> FindShortcuts(NodeId node) {
+        std::vector<Shortcut> result;
+        const auto &in = _in[node];
+        const auto &out = _out[node];
+        if (in.empty() || out.empty()) {
+          return result;
+        }
+        double max_out = 0.0;
+        for (const auto &arc : out) {
+          max_out = std::max(max_out, arc.weight);
+        }
+        for (const auto &in_arc : in) {
+          const auto source = in_arc.node;
+          RunWitnessSearch(source, node, in_arc.weight + max_out);
+          for (const auto &out_arc : out) {
+            const auto target = out_arc.node;
+            if (target == source) {
+              continue;
+            }
+            const double via = in_arc.weight + out_arc.weight;
+            if (_witness[target].distance > via) {
+              result.emplace_back(Shortcut{source, target, via});
+            }
+          }
+        }
+        return result;
+      }
+
+      /// Dijkstra search from @a source avoiding @a excluded, up to distance
+      /// @a max_distance.
+      void RunWitnessSearch(NodeId source, NodeId excluded, double max_distance) {
+        _witness.Clear();
+        _witness.Relax(source, 0.0, INVALID_NODE, INVALID_NODE);
+        for (size_t settled = 0u; settled < MAX_WITNESS_SETTLED_NODES; ++settled) {
+          const double distance = _witness.GetMinDistance();
+          if (distance > max_distance) {
+            break;
+          }
+          const auto node = _witness.Pop();
+          for (const auto &arc : _out[node]) {
+            if (arc.node != excluded) {
+              _witness.Relax(arc.node, distance + arc.weight, node, INVALID_NODE);
+            }
+          }
+        }
+      }
+
+      /// Edge difference heuristic plus number of contracted neighbors, so the
+      /// contraction is spread uniformly over the graph.
+      int GetPriority(NodeId node) {
+        const auto shortcuts = static_cast<int>(FindShortcuts(node).size());
+        const auto degree = static_cast<int>(_in[node].size() + _out[node].size());
+        return shortcuts - degree + _deleted_neighbors[node];
+      }
+
+      size_t Contract(
+          NodeId node,
+          std::vector<std::pair<NodeId, Arc>> &upward,
+          std::vector<std::pair<NodeId, Arc>> &downward) {
+        const auto shortcuts = FindShortcuts(node);
+        // The remaining neighbors are all ranked higher than this node.
+        for (const auto &arc : _out[node]) {
+          upward.emplace_back(node, arc);
+          RemoveArc(_in[arc.node], node);
+          ++_deleted_neighbors[arc.node];
+        }
+        for (const auto &arc : _in[node]) {
+          downward.emplace_back(node, arc);
+          RemoveArc(_out[arc.node], node);
+          ++_deleted_neighbors[arc.node];
+        }
+        _out[node].clear();
+        _in[node].clear();
+        _contracted[node] = true;
+        for (const auto &shortcut : shortcuts) {
+          AddArc(shortcut.source, shortcut.target, shortcut.weight, node);
+        }
+        return shortcuts.size();
+      }
+
+      std::vector<std::vector<Arc>> _out;
+
+      std::vector<std::vector<Arc>> _in;
+
+      std::vector<bool> _contracted;
+
+      std::vector<int> _deleted_neighbors;
+
+      SearchSpace _witness;
+    };
+
+  } // namespace
+
+  // ===========================================================================
+  // -- ContractionHierarchy ---------------------------------------------------
+  // ===========================================================================
+
+  constexpr double ContractionHierarchy::Infinity;
+
+  ContractionHierarchy::ContractionHierarchy(const RoutingGraph &graph)
+    : _nodes(graph.GetNodes()) {
+    const auto number_of_nodes = _nodes.size();
+
+    std::vector<std::pair<NodeId, Arc>> successors;
+    successors.reserve(graph.GetEdges().size());
+    for (const auto &edge : graph.GetEdges()) {
+      successors.emplace_back(edge.source, Arc{edge.target, INVALID_NODE, edge.weight});
+    }
+    _successors = MakeAdjacencyList(number_of_nodes, std::move(successors));
+
+    std::vector<std::pair<NodeId, Arc>> upward;
+    std::vector<std::pair<NodeId, Arc>> downward;
+    _number_of_shortcuts = Contractor(graph).Run(upward, downward);
+    _upward = MakeAdjacencyList(number_of_nodes, std::move(upward));
+    _downward = MakeAdjacencyList(number_of_nodes, std::move(downward));
+
+    UpdateNodeIds();
+  }
+
+  void ContractionHierarchy::UpdateNodeIds() {
+    _node_ids.clear();
+    _node_ids.reserve(_nodes.size());
+    for (auto id = 0u; id < _nodes.size(); ++id) {
+      const auto &node = _nodes[id];
+      _node_ids.emplace(Waypoint{node.road_id, node.section_id, node.lane_id, 0.0}, id);
+    }
+  }
+
+  bool ContractionHierarchy::IsBuiltFrom(const RoutingGraph &graph) const {
+    if (graph.GetNumberOfNodes() != _nodes.size()) {
+      return false;
+    }
+    constexpr double epsilon = 1e-6;
+    for (const auto &node : graph.GetNodes()) {
+      const auto id = GetNodeId(Waypoint{node.road_id, node.section_id, node.lane_id, 0.0});
+      if (!id.has_value() ||
+          std::abs(_nodes[*id].s - node.s) > epsilon ||
+          std::abs(_nodes[*id].length - node.length) > epsilon) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  boost::optional<NodeId> ContractionHierarchy::GetNodeId(const Waypoint &waypoint) const {
+    const auto it = _node_ids.find(Waypoint{waypoint.road_id, waypoint.section_id, waypoint.lane_id, 0.0});
+    if (it == _node_ids.end()) {
+      return boost::optional<NodeId>{};
+    }
+    return it->second;
+  }
+
+  Waypoint ContractionHierarchy::GetWaypoint(const NodeId id) const {
+    const auto &node = _nodes.at(id);
+    const double s = (node.lane_id <= 0) ? node.s : node.s + node.length;
+    return Waypoint{node.road_id, node.section_id, node.lane_id, s};
+  }
+
+  std::vector<Seed> ContractionHierarchy::MakeOriginSeeds(const Waypoint &waypoint) const {
+    std::vector<Seed> result;
+    const auto id = GetNodeId(waypoint);
+    if (id.has_value()) {
+      // Every route leaving the lane goes through one of its successors.
+      const auto &node = _nodes[*id];
+      const double remaining = node.length - RoutingGraph::GetProgress(node, waypoint.s);
+      for (auto arc = _successors.begin(*id); arc != _successors.end(*id); ++arc) {
+        result.emplace_back(Seed{arc->node, remaining});
+      }
+    }
+    return result;
+  }
+
+  boost::optional<Seed> ContractionHierarchy::MakeDestinationSeed(const Waypoint &waypoint) const {
+    const auto id = GetNodeId(waypoint);
+    if (!id.has_value()) {
+      return boost::optional<Seed>{};
+    }
+    return Seed{*id, RoutingGraph::GetProgress(_nodes[*id], waypoint.s)};
+  }
+
+  /// Return the distance from @a origin to @a destination without leaving the
+  /// lane, infinity if @a destination is not ahead of @a origin.
+  static double GetDistanceOnSameLane(
+      const RoutingGraph::Node &node,
+      const Waypoint &origin,
+      const Waypoint &destination) {
+    const double delta =
+        RoutingGraph::GetProgress(node, destination.s) -
+        RoutingGraph::GetProgress(node, origin.s);
+    return delta >= 0.0 ? delta : ContractionHierarchy::Infinity;
+  }
+
+  double ContractionHierarchy::Query(
+      const std::vector<Seed> &origins,
+      const std::vector<Seed> &destinations,
+      std::vector<NodeId> *route) const {
+    SearchSpace forward(_nodes.size());
+    SearchSpace backward(_nodes.size());
+    for (const auto &seed : origins) {
+      forward.Relax(seed.node, seed.distance, INVALID_NODE, INVALID_NODE);
+    }
+    for (const auto &seed : destinations) {
+      backward.Relax(seed.node, seed.distance, INVALID_NODE, INVALID_NODE);
+    }
+
+    double best = Infinity;
+    NodeId meeting_node = INVALID_NODE;
+
+    auto step = [&](SearchSpace &space, const SearchSpace &other, const AdjacencyList &graph) {
+      const auto node = space.Pop();
+      const double distance = space[node].distance;
+      const double total = distance + other[node].distance;
+      if (total < best) {
+        best = total;
+        meeting_node = node;
+      }
+      for (auto arc = graph.begin(node); arc != graph.end(node); ++arc) {
+        space.Relax(arc->node, distance + arc->weight, node, arc->middle);
+      }
+    };
+
+    for (;;) {
+      const double forward_min = forward.GetMinDistance();
+      const double backward_min = backward.GetMinDistance();
+      if (std::min(forward_min, backward_min) >= best) {
+        break;
+      }
+      if (forward_min <= backward_min) {
+        step(forward, backward, _upward);
+      } else {
+        step(backward, forward, _downward);
+      }
+    }
+
+    if ((route != nullptr) && (meeting_node != INVALID_NODE)) {
+      // Walk back to the origin seed.
+      std::vector<NodeId> forward_path;
+      for (auto node = meeting_node; forward[node].parent != INVALID_NODE; node = forward[node].parent) {
+        forward_path.emplace_back(node);
+      }
+      auto node = forward_path.empty() ? meeting_node : forward[forward_path.back()].parent;
+      route->emplace_back(node);
+      for (auto it = forward_path.rbegin(); it != forward_path.rend(); ++it) {
+        Unpack(forward[*it].parent, *it, forward[*it].middle, *route);
+      }
+      // Walk forward to the destination seed.
+      for (node = meeting_node; backward[node].parent != INVALID_NODE; node = backward[node].parent) {
+        Unpack(node, backward[node].parent, backward[node].middle, *route);
+      }
+    }
+    return best;
+  }
+
+  void ContractionHierarchy::Unpack(
+      const NodeId source,
+      const NodeId target,
+      const NodeId middle,
+      std::vector<NodeId> &route) const {
+    if (middle == INVALID_NODE) {
+      route.emplace_back(target);
+      return;
+    }
+    // The middle node is ranked lower than both ends, so the first half is
+    // stored as a downward edge and the second half as an upward edge.
+    auto first = std::find_if(_downward.begin(middle), _downward.end(middle), [=](const Arc &arc) {
+      return arc.node == source;
+    });
+    auto second = std::find_if(_upward.begin(middle), _upward.end(middle), [=](const Arc &arc) {
+      return arc.node == target;
+    });
+    // Both halves exist, checked when the hierarchy is read.
+    DEBUG_ASSERT(first != _downward.end(middle));
+    DEBUG_ASSERT(second != _upward.end(middle));
+    Unpack(source, middle, first->middle, route);
+    Unpack(middle, target, second->middle, route);
+  }
+
+  double ContractionHierarchy::GetDistance(const NodeId origin, const NodeId destination) const {
+    DEBUG_ASSERT(origin < _nodes.size());
+    DEBUG_ASSERT(destination < _nodes.size());
+    return Query({Seed{origin, 0.0}}, {Seed{destination, 0.0}}, nullptr);
+  }
+
+  double ContractionHierarchy::GetDistance(const Waypoint &origin, const Waypoint &destination) const {
+    const auto destination_seed = MakeDestinationSeed(destination);
+    if (!destination_seed.has_value()) {
+      return Infinity;
+    }
+    const auto origin_id = GetNodeId(origin);
+    double result = Query(MakeOriginSeeds(origin), {*destination_seed}, nullptr);
+    if (origin_id.has_value() && (*origin_id == destination_seed->node)) {
+      result = std::min(result, GetDistanceOnSameLane(_nodes[*origin_id], origin, destination));
+    }
+    return result;
+  }
+
+  std::vector<NodeId> ContractionHierarchy::GetRoute(const NodeId origin, const NodeId destination) const {
+    DEBUG_ASSERT(origin < _nodes.size());
+    DEBUG_ASSERT(destination < _nodes.size());
+    std::vector<NodeId> result;
+    Query({Seed{origin, 0.0}}, {Seed{destination, 0.0}}, &result);
+    return result;
+  }
+
+  std::vector<Waypoint> ContractionHierarchy::GetRoute(
+      const Waypoint &origin,
+      const Waypoint &destination) const {
+    std::vector<Waypoint> result;
+    const auto origin_id = GetNodeId(origin);
+    const auto destination_seed = MakeDestinationSeed(destination);
+    if (!origin_id.has_value() || !destination_seed.has_value()) {
+      return result;
+    }
+    std::vector<NodeId> route;
+    const double distance = Query(MakeOriginSeeds(origin), {*destination_seed}, &route);
+    if ((*origin_id == destination_seed->node) &&
+        (GetDistanceOnSameLane(_nodes[*origin_id], origin, destination) <= distance)) {
+      return {origin, destination};
+    }
+    if (distance == Infinity) {
+      return result;
+    }
+    result.reserve(route.size() + 1u);
+    result.emplace_back(origin);
+    for (auto i = 0u; i + 1u < route.size(); ++i) {
+      result.emplace_back(GetWaypoint(route[i]));
+    }
+    result.emplace_back(destination);
+    return result;
+  }
+
+  std::vector<double> ContractionHierarchy::ComputeDistanceMatrix(
+      const std::vector<std::vector<Seed>> &origins,
+      const std::vector<std::vector<Seed>> &destinations) const {
+    const auto columns = destinations.size();
+    std::vector<double> result(origins.size() * columns, Infinity);
+
+    // Backward search from each destination, store the settled nodes in
+    // buckets.
+    struct BucketEntry {
+      NodeId node;
+      uint32_t column;
+      double distance;
+    };
+    std::vector<BucketEntry> entries;
+    SearchSpace space(_nodes.size());
+    for (auto column = 0u; column < columns; ++column) {
+      UpwardSearch(_downward, destinations[column], space, [&](NodeId node, double distance) {
+        entries.emplace_back(BucketEntry{node, column, distance});
+      });
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.node < rhs.node;
+    });
+    std::vector<uint32_t> buckets(_nodes.size() + 1u, 0u);
+    for (const auto &entry : entries) {
+      ++buckets[entry.node + 1u];
+    }
+    for (auto i = 1u; i < buckets.size(); ++i) {
+      buckets[i] += buckets[i - 1u];
+    }
+
+    // Forward search from each origin, scanning the buckets of every settled
+    // node.
+    for (auto row = 0u; row < origins.size(); ++row) {
+      double *distances = result.data() + row * columns;
+      UpwardSearch(_upward, origins[row], space, [&](NodeId node, double distance) {
+        for (auto i = buckets[node]; i < buckets[node + 1u]; ++i) {
+          const auto &entry = entries[i];
+          distances[entry.column] = std::min(distances[entry.column], distance + entry.distance);
+        }
+      });
+    }
+    return result;
+  }
+
+  std::vector<double> ContractionHierarchy::GetDistanceMatrix(
+      const std::vector<NodeId> &origins,
+      const std::vector<NodeId> &destinations) const {
+    auto make_seeds = [](const std::vector<NodeId> &nodes) {
+      std::vector<std::vector<Seed>> result;
+      result.reserve(nodes.size());
+      for (auto node : nodes) {
+        result.emplace_back(std::vector<Seed>{Seed{node, 0.0}});
+      }
+      return result;
+    };
+    return ComputeDistanceMatrix(make_seeds(origins), make_seeds(destinations));
+  }
+
+  std::vector<double> ContractionHierarchy::GetDistanceMatrix(
+      const std::vector<Waypoint> &origins,
+      const std::vector<Waypoint> &destinations) const {
+    std::vector<std::vector<Seed>> origin_seeds;
+    origin_seeds.reserve(origins.size());
+    for (const auto &waypoint : origins) {
+      origin_seeds.emplace_back(MakeOriginSeeds(waypoint));
+    }
+    std::vector<std::vector<Seed>> destination_seeds;
+    destination_seeds.reserve(destinations.size());
+    for (const auto &waypoint : destinations) {
+      const auto seed = MakeDestinationSeed(waypoint);
+      destination_seeds.emplace_back();
+      if (seed.has_value()) {
+        destination_seeds.back().emplace_back(*seed);
+      }
+    }
+    auto result = ComputeDistanceMatrix(origin_seeds, destination_seeds);
+
+    // Destinations ahead on the same lane are reached without going through
+    // any other node.
+    const auto columns = destinations.size();
+    for (auto row = 0u; row < origins.size(); ++row) {
+      const auto origin_id = GetNodeId(origins[row]);
+      if (!origin_id.has_value()) {
+        continue;
+      }
+      for (auto column = 0u; column < columns; ++column) {
+        const auto &seeds = destination_seeds[column];
+        if (!seeds.empty() && (seeds.front().node == *origin_id)) {
+          auto &distance = result[row * columns + column];
+          distance = std::min(
+              distance,
+              GetDistanceOnSameLane(_nodes[*origin_id], origins[row], destinations[column]));
+        }
+      }
+    }
+    return result;
+  }
+
+  // ===========================================================================
+  // -- Serialization ----------------------------------------------------------
+  // ===========================================================================
+
+  template <typename T>
+  static void WriteValue(std::ostream &out, const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  static bool ReadValue(std::istream &in, T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+    in.read(reinterpret_cast<char *>(&value), sizeof(T));
+    return in.good();
+  }
+
+  /// Number of bytes left to read in @a in, the maximum if it cannot be told.
+  static uint64_t GetRemainingSize(std::istream &in) {
+    const auto position = in.tellg();
+    if (position < 0) {
+      return std::numeric_limits<uint64_t>::max();
+    }
+    in.seekg(0, std::ios::end);
+    const auto end = in.tellg();
+    in.seekg(position);
+    return end < position ? 0u : static_cast<uint64_t>(end - position);
+  }
+
+  /// Read a number of records of @a record_size bytes, rejecting counts that
+  /// do not fit in the rest of the stream before anything is allocated.
+  static bool ReadCount(std::istream &in, const size_t record_size, uint64_t &count) {
+    return ReadValue(in, count) && (count <= GetRemainingSize(in) / record_size);
+  }
+
+  static void WriteAdjacencyList(std::ostream &out, const AdjacencyList &list) {
+    WriteValue(out, static_cast<uint64_t>(list.arcs.size()));
+    for (auto offset : list.offsets) {
+      WriteValue(out, offset);
+    }
+    for (const auto &arc : list.arcs) {
+      WriteValue(out, arc.node);
+      WriteValue(out, arc.middle);
+      WriteValue(out, arc.weight);
+    }
+  }
+
+  static bool ReadAdjacencyList(std::istream &in, const size_t number_of_nodes, AdjacencyList &list) {
+    constexpr auto arc_size = 2u * sizeof(NodeId) + sizeof(double);
+    uint64_t number_of_arcs = 0u;
+    if (!ReadCount(in, arc_size, number_of_arcs) ||
+        ((number_of_nodes + 1u) * sizeof(uint32_t) > GetRemainingSize(in))) {
+      return false;
+    }
+    list.offsets.resize(number_of_nodes + 1u);
+    for (auto &offset : list.offsets) {
+      if (!ReadValue(in, offset) || (offset > number_of_arcs)) {
+        return false;
+      }
+    }
+    if (!std::is_sorted(list.offsets.begin(), list.offsets.end()) ||
+        (list.offsets.front() != 0u) ||
+        (list.offsets.back() != number_of_arcs)) {
+      return false;
+    }
+    list.arcs.resize(number_of_arcs);
+    for (auto &arc : list.arcs) {
+      if (!ReadValue(in, arc.node) || !ReadValue(in, arc.middle) || !ReadValue(in, arc.weight)) {
+        return false;
+      }
+      if ((arc.node >= number_of_nodes) ||
+          ((arc.middle != INVALID_NODE) && (arc.middle >= number_of_nodes))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool HasArc(const AdjacencyList &list, const NodeId node, const NodeId target) {
+    return std::any_of(list.begin(node), list.end(node), [=](const Arc &arc) {
+      return arc.node == target;
+    });
+  }
+
+  /// Check that every shortcut can be unpacked: both halves are stored at its
+  /// middle node, and arcs only go from lower to higher ranked nodes, i.e.
+  /// there are no cycles, so unpacking always ends.
+  static bool IsValidHierarchy(
+      const size_t number_of_nodes,
+      const AdjacencyList &upward,
+      const AdjacencyList &downward) {
+    // Topological sort of the arcs of both lists.
+    std::vector<size_t> in_degree(number_of_nodes, 0u);
+    for (const auto &arc : upward.arcs) {
+      ++in_degree[arc.node];
+    }
+    for (const auto &arc : downward.arcs) {
+      ++in_degree[arc.node];
+    }
+    std::vector<NodeId> pending;
+    for (auto node = 0u; node < number_of_nodes; ++node) {
+      if (in_degree[node] == 0u) {
+        pending.emplace_back(node);
+      }
+    }
+    size_t sorted = 0u;
+    while (!pending.empty()) {
+      const auto node = pending.back();
+      pending.pop_back();
+      ++sorted;
+      for (const auto *list : {&upward, &downward}) {
+        for (auto arc = list->begin(node); arc != list->end(node); ++arc) {
+          if (--in_degree[arc->node] == 0u) {
+            pending.emplace_back(arc->node);
+          }
+        }
+      }
+    }
+    if (sorted != number_of_nodes) {
+      return false;
+    }
+    // Upward arcs go from node to arc.node, downward arcs from arc.node to
+    // node; the first half of a shortcut is a downward arc of its middle node
+    // and the second half an upward arc.
+    for (auto node = 0u; node < number_of_nodes; ++node) {
+      for (auto arc = upward.begin(node); arc != upward.end(node); ++arc) {
+        if ((arc->middle != INVALID_NODE) &&
+            (!HasArc(downward, arc->middle, node) || !HasArc(upward, arc->middle, arc->node))) {
+          return false;
+        }
+      }
+      for (auto arc = downward.begin(node); arc != downward.end(node); ++arc) {
+        if ((arc->middle != INVALID_NODE) &&
+            (!HasArc(downward, arc->middle, arc->node) || !HasArc(upward, arc->middle, node))) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void ContractionHierarchy::Write(std::ostream &out) const {
+    WriteValue(out, FILE_MAGIC);
+    WriteValue(out, FILE_VERSION);
+    WriteValue(out, static_cast<uint64_t>(_nodes.size()));
+    for (const auto &node : _nodes) {
+      WriteValue(out, node.road_id);
+      WriteValue(out, node.section_id);
+      WriteValue(out, node.lane_id);
+      WriteValue(out, node.s);
+      WriteValue(out, node.length);
+    }
+    WriteAdjacencyList(out, _successors);
+    WriteAdjacencyList(out, _upward);
+    WriteAdjacencyList(out, _downward);
+    WriteValue(out, static_cast<uint64_t>(_number_of_shortcuts));
+  }
+
+  boost::optional<ContractionHierarchy> ContractionHierarchy::Read(std::istream &in) {
+    uint32_t magic = 0u;
+    uint32_t version = 0u;
+    if (!ReadValue(in, magic) || !ReadValue(in, version) ||
+        (magic != FILE_MAGIC) || (version != FILE_VERSION)) {
+      log_error("contraction hierarchy: invalid header or unsupported version");
+      return boost::optional<ContractionHierarchy>{};
+    }
+    ContractionHierarchy result;
+    using Node = RoutingGraph::Node;
+    constexpr auto node_size =
+        sizeof(Node::road_id) +
+        sizeof(Node::section_id) +
+        sizeof(Node::lane_id) +
+        sizeof(Node::s) +
+        sizeof(Node::length);
+    uint64_t number_of_nodes = 0u;
+    bool success = ReadCount(in, node_size, number_of_nodes);
+    if (success) {
+      result._nodes.resize(number_of_nodes);
+      for (auto &node : result._nodes) {
+        success = success &&
+            ReadValue(in, node.road_id) &&
+            ReadValue(in, node.section_id) &&
+            ReadValue(in, node.lane_id) &&
+            ReadValue(in, node.s) &&
+            ReadValue(in, node.length);
+      }
+    }
+    uint64_t number_of_shortcuts = 0u;
+    success = success &&
+        ReadAdjacencyList(in, number_of_nodes, result._successors) &&
+        ReadAdjacencyList(in, number_of_nodes, result._upward) &&
+        ReadAdjacencyList(in, number_of_nodes, result._downward) &&
+        ReadValue(in, number_of_shortcuts) &&
+        IsValidHierarchy(number_of_nodes, result._upward, result._downward);
+    if (!success) {
+      log_error("contraction hierarchy: corrupted data");
+      return boost::optional<ContractionHierarchy>{};
+    }
+    result._number_of_shortcuts = number_of_shortcuts;
+    result.UpdateNodeIds();
+    return result;
+  }
+
+  void ContractionHierarchy::Save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary);
+    Write(out);
+    if (!out.good()) {
+      throw_exception(std::runtime_error("failed to write contraction hierarchy to " + path));
+    }
+  }
+
+  boost::optional<ContractionHierarchy> ContractionHierarchy::Load(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.good()) {
+      log_error("contraction hierarchy: unable to open", path);
+      return boost::optional<ContractionHierarchy>{};
+    }
+    return Read(in);
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,183 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/RoutingGraph.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Contraction hierarchy of a RoutingGraph, for answering many shortest
+  /// route queries on the same map.
+  ///
+  /// Building it contracts the nodes one by one adding shortcut edges, this
+  /// is expensive but it only needs to be done once per map; the result can
+  /// be saved to disk alongside the map and loaded afterwards. Queries then
+  /// only explore the small "upward" search space of origin and destination,
+  /// and distance matrices are computed with a single search per row and per
+  /// column.
+  ///
+  /// Distances are driving distances in meters following the lane topology
+  /// (lane changes are not considered), unreachable destinations have
+  /// infinite distance.
+  class ContractionHierarchy {
+  public:
+
+    using NodeId = RoutingGraph::NodeId;
+
+    static constexpr double Infinity = std::numeric_limits<double>::infinity();
+
+    explicit ContractionHierarchy(const RoutingGraph &graph);
+
+    size_t GetNumberOfNodes() const {
+      return _nodes.size();
+    }
+
+    size_t GetNumberOfShortcuts() const {
+      return _number_of_shortcuts;
+    }
+
+    /// Return whether this hierarchy was built from a graph with the same
+    /// lanes as @a graph, i.e. whether it is up to date with the map.
+    bool IsBuiltFrom(const RoutingGraph &graph) const;
+
+    /// Return the node of the lane @a waypoint belongs to, if the lane is
+    /// part of the topology.
+    boost::optional<NodeId> GetNodeId(const element::Waypoint &waypoint) const;
+
+    /// Return the waypoint at the entrance of the lane @a node.
+    element::Waypoint GetWaypoint(NodeId node) const;
+
+    /// Shortest driving distance from the entrance of lane @a origin to the
+    /// entrance of lane @a destination.
+    double GetDistance(NodeId origin, NodeId destination) const;
+
+    /// Shortest driving distance from @a origin to @a destination.
+    double GetDistance(
+        const element::Waypoint &origin,
+        const element::Waypoint &destination) const;
+
+    /// Return the sequence of lanes to drive through from @a origin to
+    /// @a destination, both included. Empty if @a destination is not
+    /// reachable.
+    std::vector<NodeId> GetRoute(NodeId origin, NodeId destination) const;
+
+    /// Return a waypoint at the entrance of each lane to drive through from
+    /// @a origin to @a destination, starting with @a origin and ending with
+    /// @a destination. Empty if @a destination is not reachable.
+    std::vector<element::Waypoint> GetRoute(
+        const element::Waypoint &origin,
+        const element::Waypoint &destination) const;
+
+    /// Return the row-major matrix of distances from each of @a origins to
+    /// each of @a destinations.
+    std::vector<double> GetDistanceMatrix(
+        const std::vector<NodeId> &origins,
+        const std::vector<NodeId> &destinations) const;
+
+    /// @copydoc GetDistanceMatrix(const std::vector<NodeId> &, const std::vector<NodeId> &)
+    ///
+    /// Waypoints that are not on the topology have infinite distance to
+    /// every other waypoint.
+    std::vector<double> GetDistanceMatrix(
+        const std::vector<element::Waypoint> &origins,
+        const std::vector<element::Waypoint> &destinations) const;
+
+    /// Write the hierarchy in binary format to @a out.
+    void Write(std::ostream &out) const;
+
+    /// Read a hierarchy previously written with Write. Return an empty
+    /// optional if the data is not a valid hierarchy.
+    static boost::optional<ContractionHierarchy> Read(std::istream &in);
+
+    /// Save the hierarchy to the file at @a path.
+    ///
+    /// @throw std::runtime_error if the file cannot be written.
+    void Save(const std::string &path) const;
+
+    /// Load a hierarchy saved with Save. Return an empty optional if the file
+    /// cannot be read or is not a valid hierarchy.
+    static boost::optional<ContractionHierarchy> Load(const std::string &path);
+
+    /// An edge of the hierarchy, if @a middle is a valid node the edge is a
+    /// shortcut for the edges (@a source, @a middle) and (@a middle,
+    /// @a target).
+    struct Arc {
+      NodeId node;
+      NodeId middle;
+      double weight;
+    };
+
+    /// Adjacency lists stored in compressed sparse row format.
+    struct AdjacencyList {
+      std::vector<uint32_t> offsets;
+      std::vector<Arc> arcs;
+
+      const Arc *begin(NodeId node) const {
+        return arcs.data() + offsets[node];
+      }
+
+      const Arc *end(NodeId node) const {
+        return arcs.data() + offsets[node + 1u];
+      }
+    };
+
+    /// A search seed: a node reached at an initial distance.
+    struct Seed {
+      NodeId node;
+      double distance;
+    };
+
+  private:
+
+    ContractionHierarchy() = default;
+
+    void UpdateNodeIds();
+
+    std::vector<Seed> MakeOriginSeeds(const element::Waypoint &waypoint) const;
+
+    boost::optional<Seed> MakeDestinationSeed(const element::Waypoint &waypoint) const;
+
+    double Query(
+        const std::vector<Seed> &origins,
+        const std::vector<Seed> &destinations,
+        std::vector<NodeId> *route) const;
+
+    void Unpack(NodeId source, NodeId target, NodeId middle, std::vector<NodeId> &route) const;
+
+    std::vector<double> ComputeDistanceMatrix(
+        const std::vector<std::vector<Seed>> &origins,
+        const std::vector<std::vector<Seed>> &destinations) const;
+
+    std::vector<RoutingGraph::Node> _nodes;
+
+    /// Successors of each node in the original graph.
+    AdjacencyList _successors;
+
+    /// Edges going to a higher ranked node, indexed by source.
+    AdjacencyList _upward;
+
+    /// Edges coming from a higher ranked node, indexed by target.
+    AdjacencyList _downward;
+
+    size_t _number_of_shortcuts = 0u;
+
+    std::unordered_map<element::Waypoint, NodeId> _node_ids;
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/InformationSet.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace road {
+
+  /// Adds each visited info to the subset of its type.
+  class InformationSet::Indexer final : public element::RoadInfoVisitor {
+  public:
+
+    explicit Indexer(InformationSet &self) : _self(self) {}
+
+    void Visit(element::RoadInfoElevation &info) final { Add(info); }
+    void Visit(element::RoadInfoGeometry &info) final { Add(info); }
+    void Visit(element::RoadInfoLane &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneAccess &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneBorder &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneHeight &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneMaterial &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneOffset &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneRule &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneVisibility &info) final { Add(info); }
+    void Visit(element::RoadInfoLaneWidth &info) final { Add(info); }
+    void Visit(element::RoadInfoMarkRecord &info) final { Add(info); }
+    void Visit(element::RoadInfoMarkTypeLine &info) final { Add(info); }
+    void Visit(element::RoadInfoSpeed &info) final { Add(info); }
+
+    /// The distance of the last visited info.
+    double distance = 0.0;
+
+  private:
+
+    template <typename T>
+    void Add(const T &info) {
+      auto &subset = std::get<Subset<T>>(_self._subsets);
+      subset.distances.emplace_back(distance);
+      subset.infos.emplace_back(&info);
+    }
+
+    InformationSet &_self;
+  };
+
+  InformationSet::InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
+    : _road_set(std::move(vec)) {
+    // The infos are already sorted by distance, so are the subsets.
+    Indexer indexer(*this);
+    for (const auto &info : _road_set.GetAll()) {
+      DEBUG_ASSERT(info != nullptr);
+      indexer.distance = info->GetDistance();
+      info->AcceptVisitor(indexer);
+    }
+  }
+
+} // road
+} // carla
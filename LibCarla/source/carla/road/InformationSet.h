@@ -9,44 +9,84 @@
 #include "carla/NonCopyable.h"
 #include "carla/road/RoadElementSet.h"
 #include "carla/road/element/RoadInfo.h"
-#include "carla/road/element/RoadInfoIterator.h"
+#include "carla/road/element/RoadInfoVisitor.h"
 
-#include <vector>
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 namespace carla {
 namespace road {
 
+  /// Set of road infos of a road or a lane. Besides the list of all the
+  /// infos, the infos of each type are indexed in flat arrays sorted by
+  /// distance, so looking up an info of a given type is a binary search with
+  /// no virtual dispatch.
   class InformationSet : private MovableNonCopyable {
   public:
 
     InformationSet() = default;
 
-    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
-      : _road_set(std::move(vec)) {}
+    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec);
 
     /// Return all infos given a type from the start of the road
     template <typename T>
-    std::vector<const T *> GetInfos() const {
-      std::vector<const T *> vec;
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll());
-      for (; !it.IsAtEnd(); ++it) {
-        vec.emplace_back(&*it);
-      }
-      return vec;
+    const std::vector<const T *> &GetInfos() const {
+      return Get<T>().infos;
     }
 
     /// Returns single info given a type and a distance (s) from
     /// the start of the road
     template <typename T>
     const T *GetInfo(const double s) const {
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s));
-      return it.IsAtEnd() ? nullptr : &*it;
+      const auto &subset = Get<T>();
+      const auto it = std::upper_bound(subset.distances.begin(), subset.distances.end(), s);
+      if (it == subset.distances.begin()) {
+        return nullptr;
+      }
+      return subset.infos[static_cast<size_t>(std::distance(subset.distances.begin(), it)) - 1u];
+    }
+
+    /// Return all infos sorted by distance.
+    const std::vector<std::unique_ptr<element::RoadInfo>> &GetAll() const {
+      return _road_set.GetAll();
     }
 
   private:
 
+    class Indexer;
+
+    /// Infos of type T sorted by distance, and their distances.
+    template <typename T>
+    struct Subset {
+      std::vector<double> distances;
+      std::vector<const T *> infos;
+    };
+
+    template <typename T>
+    const Subset<T> &Get() const {
+      return std::get<Subset<T>>(_subsets);
+    }
+
     RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set;
+
+    std::tuple<
+        Subset<element::RoadInfoElevation>,
+        Subset<element::RoadInfoGeometry>,
+        Subset<element::RoadInfoLane>,
+        Subset<element::RoadInfoLaneAccess>,
+        Subset<element::RoadInfoLaneBorder>,
+        Subset<element::RoadInfoLaneHeight>,
+        Subset<element::RoadInfoLaneMaterial>,
+        Subset<element::RoadInfoLaneOffset>,
+        Subset<element::RoadInfoLaneRule>,
+        Subset<element::RoadInfoLaneVisibility>,
+        Subset<element::RoadInfoLaneWidth>,
+        Subset<element::RoadInfoMarkRecord>,
+        Subset<element::RoadInfoMarkTypeLine>,
+        Subset<element::RoadInfoSpeed>> _subsets;
   };
 
 } // road
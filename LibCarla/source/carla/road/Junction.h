@@ -16,6 +16,7 @@
 namespace carla {
 namespace road {
 
+  class CompiledMap;
   class MapBuilder;
 
   class Junction : private MovableNonCopyable {
@@ -68,6 +69,8 @@ namespace road {
 
     friend MapBuilder;
 
+    friend CompiledMap;
+
     JuncId _id;
 
     std::string _name;
@@ -16,6 +16,7 @@
 namespace carla {
 namespace road {
 
+  class CompiledMap;
   class LaneSection;
   class MapBuilder;
   class Road;
@@ -103,6 +104,8 @@ namespace road {
 
     friend MapBuilder;
 
+    friend CompiledMap;
+
     LaneSection *_lane_section = nullptr;
 
     LaneId _id = 0;
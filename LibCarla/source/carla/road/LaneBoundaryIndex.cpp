@@ -0,0 +1,408 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/LaneBoundaryIndex.h"
+
+#include "carla/ParallelFor.h"
+#include "carla/geom/Math.h"
+#include "carla/road/MapData.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace carla {
+namespace road {
+
+  using element::Waypoint;
+
+  constexpr double LaneBoundaryIndex::MaxStep;
+  constexpr double LaneBoundaryIndex::MaxError;
+  constexpr double LaneBoundaryIndex::Tolerance;
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  static double GetLaneWidth(const Lane &lane, double s) {
+    const auto info = lane.GetInfo<element::RoadInfoLaneWidth>(s);
+    return info != nullptr ? info->GetPolynomial().Evaluate(s) : 0.0;
+  }
+
+  /// Point at @a lateral_offset meters to the right of @a point, in map
+  /// coordinates.
+  static geom::Vector2D GetBoundaryPoint(const element::DirectedPoint &point, double lateral_offset) {
+    const double x = point.location.x + lateral_offset * std::sin(point.tangent);
+    const double y = point.location.y - lateral_offset * std::cos(point.tangent);
+    // Unreal's Y axis hack.
+    return {static_cast<float>(x), static_cast<float>(-y)};
+  }
+
+  /// Whether (@a x, @a y) is inside the quad, or within @a tolerance meters of
+  /// its edges. The quad is assumed convex, in any orientation.
+  static bool IsInside(
+      const std::array<geom::Vector2D, 4u> &corners,
+      const double x,
+      const double y,
+      const double tolerance) {
+    bool has_positive = false;
+    bool has_negative = false;
+    for (size_t i = 0u, j = 3u; i < 4u; j = i++) {
+      const double ex = corners[i].x - corners[j].x;
+      const double ey = corners[i].y - corners[j].y;
+      const double cross = ex * (y - corners[j].y) - ey * (x - corners[j].x);
+      const double margin = tolerance * std::hypot(ex, ey);
+      has_positive = has_positive || (cross > margin);
+      has_negative = has_negative || (cross < -margin);
+    }
+    return !(has_positive && has_negative);
+  }
+
+  /// Distance from (@a x, @a y) to the center of the lane in @a quad, and
+  /// the waypoint of its projection on the center.
+  template <typename QuadT>
+  static std::pair<double, Waypoint> ProjectOnLaneCenter(
+      const QuadT &quad,
+      const double x,
+      const double y) {
+    const auto &c = quad.corners;
+    const double x0 = 0.5 * (c[0u].x + c[1u].x);
+    const double y0 = 0.5 * (c[0u].y + c[1u].y);
+    const double dx = 0.5 * (c[2u].x + c[3u].x) - x0;
+    const double dy = 0.5 * (c[2u].y + c[3u].y) - y0;
+    const double squared_length = dx * dx + dy * dy;
+    const double u = squared_length > 0.0 ?
+        geom::Math::Clamp(((x - x0) * dx + (y - y0) * dy) / squared_length, 0.0, 1.0) :
+        0.0;
+    return std::make_pair(
+        std::hypot(x0 + u * dx - x, y0 + u * dy - y),
+        Waypoint{
+            quad.road_id,
+            quad.section_id,
+            quad.lane_id,
+            quad.s0 + u * (quad.s1 - quad.s0)});
+  }
+
+  /// Inner and outer boundary of each lane of a lane section at some s.
+  using Boundaries = std::vector<std::pair<geom::Vector2D, geom::Vector2D>>;
+
+  /// Compute the boundaries at @a s of @a lanes, the right lanes from the
+  /// center outwards followed by the left lanes.
+  static void ComputeBoundaries(
+      const Road &road,
+      const std::vector<const Lane *> &lanes,
+      const double s,
+      Boundaries &boundaries) {
+    const auto point = road.GetDirectedPointIn(s);
+    double right_offset = 0.0;
+    double left_offset = 0.0;
+    boundaries.resize(lanes.size());
+    for (size_t i = 0u; i < lanes.size(); ++i) {
+      const double width = GetLaneWidth(*lanes[i], s);
+      if (lanes[i]->GetId() < 0) {
+        boundaries[i].first = GetBoundaryPoint(point, right_offset);
+        right_offset += width;
+        boundaries[i].second = GetBoundaryPoint(point, right_offset);
+      } else {
+        boundaries[i].first = GetBoundaryPoint(point, -left_offset);
+        left_offset += width;
+        boundaries[i].second = GetBoundaryPoint(point, -left_offset);
+      }
+    }
+  }
+
+  /// Maximum distance between the boundaries at @a middle and the midpoints
+  /// of the boundaries at @a begin and @a end.
+  static double ComputeMaxDeviation(
+      const Boundaries &begin,
+      const Boundaries &middle,
+      const Boundaries &end) {
+    auto deviation = [](auto a, auto b, auto m) {
+      return std::hypot(0.5 * (a.x + b.x) - m.x, 0.5 * (a.y + b.y) - m.y);
+    };
+    double result = 0.0;
+    for (size_t i = 0u; i < middle.size(); ++i) {
+      result = std::max(result, deviation(begin[i].first, end[i].first, middle[i].first));
+      result = std::max(result, deviation(begin[i].second, end[i].second, middle[i].second));
+    }
+    return result;
+  }
+
+  // ===========================================================================
+  // -- LaneBoundaryIndex ------------------------------------------------------
+  // ===========================================================================
+
+  void LaneBoundaryIndex::AddQuads(const Road &road, std::vector<Quad> &quads) {
+    /// Shortest step, in case the boundaries are not smooth.
+    constexpr double MinStep = 0.05;
+
+    for (const auto &section : road.GetLaneSections()) {
+      const auto &lanes = section.GetLanes();
+      const double s_begin = section.GetDistance();
+      const double s_end = road.UpperBound(s_begin);
+      if (lanes.empty() || (s_end <= s_begin)) {
+        continue;
+      }
+
+      // Right lanes from the center outwards, then left lanes.
+      std::vector<const Lane *> ordered_lanes;
+      for (auto it = std::make_reverse_iterator(lanes.lower_bound(0)); it != lanes.rend(); ++it) {
+        ordered_lanes.emplace_back(&it->second);
+      }
+      for (auto it = lanes.lower_bound(1); it != lanes.end(); ++it) {
+        ordered_lanes.emplace_back(&it->second);
+      }
+
+      // Quads of each lane, so the quads of a lane are contiguous.
+      std::vector<std::vector<Quad>> lane_quads(ordered_lanes.size());
+      Boundaries current;
+      Boundaries next;
+      Boundaries middle;
+      double s = s_begin;
+      double step = MaxStep;
+      ComputeBoundaries(road, ordered_lanes, s, current);
+      while (s < s_end) {
+        // Halve the step until the boundaries are straight enough.
+        double next_s = std::min(s + step, s_end);
+        ComputeBoundaries(road, ordered_lanes, next_s, next);
+        while ((next_s - s) > MinStep) {
+          ComputeBoundaries(road, ordered_lanes, 0.5 * (s + next_s), middle);
+          if (ComputeMaxDeviation(current, middle, next) <= MaxError) {
+            break;
+          }
+          next_s = 0.5 * (s + next_s);
+          std::swap(next, middle);
+        }
+        for (size_t i = 0u; i < ordered_lanes.size(); ++i) {
+          const auto &lane = *ordered_lanes[i];
+          if (lane.GetId() != 0) {
+            lane_quads[i].emplace_back(Quad{
+                {current[i].first, current[i].second, next[i].second, next[i].first},
+                s,
+                next_s,
+                road.GetId(),
+                section.GetId(),
+                lane.GetId(),
+                static_cast<uint32_t>(lane.GetType())});
+          }
+        }
+        step = std::min(2.0 * (next_s - s), MaxStep);
+        s = next_s;
+        std::swap(current, next);
+      }
+      for (const auto &item : lane_quads) {
+        quads.insert(quads.end(), item.begin(), item.end());
+      }
+    }
+  }
+
+  LaneBoundaryIndex::LaneBoundaryIndex(const MapData &data) {
+    // Sorted by id, so the index does not depend on the order of the roads.
+    std::vector<const Road *> roads;
+    roads.reserve(data.GetRoads().size());
+    for (const auto &pair : data.GetRoads()) {
+      roads.emplace_back(&pair.second);
+    }
+    std::sort(roads.begin(), roads.end(), [](const Road *lhs, const Road *rhs) {
+      return lhs->GetId() < rhs->GetId();
+    });
+
+    std::vector<std::vector<Quad>> road_quads(roads.size());
+    ParallelFor(roads.size(), 64u, [&](size_t i) {
+      AddQuads(*roads[i], road_quads[i]);
+    });
+    size_t number_of_quads = 0u;
+    for (const auto &quads : road_quads) {
+      number_of_quads += quads.size();
+    }
+    _quads.reserve(number_of_quads);
+    for (const auto &quads : road_quads) {
+      _quads.insert(_quads.end(), quads.begin(), quads.end());
+    }
+    BuildLaneIndex();
+    BuildGrid();
+  }
+
+  void LaneBoundaryIndex::BuildLaneIndex() {
+    for (size_t i = 0u; i < _quads.size();) {
+      const auto &quad = _quads[i];
+      size_t end = i + 1u;
+      while ((end < _quads.size()) &&
+             (_quads[end].road_id == quad.road_id) &&
+             (_quads[end].section_id == quad.section_id) &&
+             (_quads[end].lane_id == quad.lane_id)) {
+        ++end;
+      }
+      _lanes[quad.road_id].emplace_back(LaneQuads{
+          quad.section_id,
+          quad.lane_id,
+          static_cast<uint32_t>(i),
+          static_cast<uint32_t>(end)});
+      i = end;
+    }
+  }
+
+  void LaneBoundaryIndex::BuildGrid() {
+    if (_quads.empty()) {
+      return;
+    }
+    double max_x = std::numeric_limits<double>::lowest();
+    double max_y = std::numeric_limits<double>::lowest();
+    _min_x = _min_y = std::numeric_limits<double>::max();
+    for (const auto &quad : _quads) {
+      for (const auto &corner : quad.corners) {
+        _min_x = std::min<double>(_min_x, corner.x);
+        _min_y = std::min<double>(_min_y, corner.y);
+        max_x = std::max<double>(max_x, corner.x);
+        max_y = std::max<double>(max_y, corner.y);
+      }
+    }
+    // About as many cells as quads, but not smaller than a lane.
+    const double area = std::max(1.0, (max_x - _min_x) * (max_y - _min_y));
+    _cell_size = std::max(4.0, std::sqrt(area / static_cast<double>(_quads.size())));
+    _columns = static_cast<size_t>((max_x - _min_x) / _cell_size) + 1u;
+    _rows = static_cast<size_t>((max_y - _min_y) / _cell_size) + 1u;
+
+    // Counting sort of the quads by cell, each quad is added to every cell
+    // its bounding box overlaps, widened by the tolerance.
+    auto for_each_cell = [this](const Quad &quad, auto &&callback) {
+      const auto &c = quad.corners;
+      const auto x_range = std::minmax({c[0u].x, c[1u].x, c[2u].x, c[3u].x});
+      const auto y_range = std::minmax({c[0u].y, c[1u].y, c[2u].y, c[3u].y});
+      const size_t first = GetCell(x_range.first - Tolerance, y_range.first - Tolerance);
+      const size_t last = GetCell(x_range.second + Tolerance, y_range.second + Tolerance);
+      for (size_t row = first / _columns; row <= last / _columns; ++row) {
+        for (size_t column = first % _columns; column <= last % _columns; ++column) {
+          callback(row * _columns + column);
+        }
+      }
+    };
+    _cell_offsets.assign(_columns * _rows + 1u, 0u);
+    for (const auto &quad : _quads) {
+      for_each_cell(quad, [this](size_t cell) { ++_cell_offsets[cell + 1u]; });
+    }
+    for (size_t i = 1u; i < _cell_offsets.size(); ++i) {
+      _cell_offsets[i] += _cell_offsets[i - 1u];
+    }
+    _cell_quads.resize(_cell_offsets.back());
+    auto position = _cell_offsets;
+    for (size_t i = 0u; i < _quads.size(); ++i) {
+      for_each_cell(_quads[i], [&](size_t cell) {
+        _cell_quads[position[cell]++] = static_cast<uint32_t>(i);
+      });
+    }
+  }
+
+  size_t LaneBoundaryIndex::GetCell(const double x, const double y) const {
+    auto clamp = [this](double value, size_t size) {
+      const double cell = std::floor(value / _cell_size);
+      return static_cast<size_t>(geom::Math::Clamp(cell, 0.0, static_cast<double>(size - 1u)));
+    };
+    return clamp(y - _min_y, _rows) * _columns + clamp(x - _min_x, _columns);
+  }
+
+  std::vector<Waypoint> LaneBoundaryIndex::GetLanesAt(
+      const geom::Location &location,
+      const uint32_t lane_type) const {
+    const double x = location.x;
+    const double y = location.y;
+    if (_quads.empty()) {
+      return {};
+    }
+    // Locations outside the grid fall in its border cells, no quad there
+    // contains them.
+    const size_t cell = GetCell(x, y);
+
+    // Distance to the center of the lane and waypoint of each lane found.
+    std::vector<std::pair<double, Waypoint>> found;
+    for (auto i = _cell_offsets[cell]; i < _cell_offsets[cell + 1u]; ++i) {
+      const auto &quad = _quads[_cell_quads[i]];
+      if (((quad.lane_type & lane_type) == 0u) || !IsInside(quad.corners, x, y, Tolerance)) {
+        continue;
+      }
+      double distance;
+      Waypoint waypoint;
+      std::tie(distance, waypoint) = ProjectOnLaneCenter(quad, x, y);
+
+      // A location on the edge between two quads of a lane is in both.
+      auto same_lane = std::find_if(found.begin(), found.end(), [&](const auto &item) {
+        return (item.second.road_id == waypoint.road_id) &&
+               (item.second.section_id == waypoint.section_id) &&
+               (item.second.lane_id == waypoint.lane_id);
+      });
+      if (same_lane == found.end()) {
+        found.emplace_back(distance, waypoint);
+      } else if (distance < same_lane->first) {
+        *same_lane = std::make_pair(distance, waypoint);
+      }
+    }
+
+    std::sort(found.begin(), found.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.first < rhs.first;
+    });
+    std::vector<Waypoint> result;
+    result.reserve(found.size());
+    for (const auto &item : found) {
+      result.emplace_back(item.second);
+    }
+    return result;
+  }
+
+  boost::optional<Waypoint> LaneBoundaryIndex::GetLaneAt(
+      const geom::Location &location,
+      const uint32_t lane_type) const {
+    auto lanes = GetLanesAt(location, lane_type);
+    if (lanes.empty()) {
+      return boost::optional<Waypoint>{};
+    }
+    return lanes.front();
+  }
+
+  boost::optional<Waypoint> LaneBoundaryIndex::GetLaneAt(
+      const geom::Location &location,
+      const uint32_t lane_type,
+      const std::vector<Waypoint> &lanes,
+      const double distance) const {
+    const double x = location.x;
+    const double y = location.y;
+    boost::optional<Waypoint> result;
+    double nearest = std::numeric_limits<double>::max();
+    for (const auto &lane : lanes) {
+      const auto road = _lanes.find(lane.road_id);
+      if (road == _lanes.end()) {
+        continue;
+      }
+      const auto range = std::find_if(road->second.begin(), road->second.end(), [&](const auto &item) {
+        return (item.section_id == lane.section_id) && (item.lane_id == lane.lane_id);
+      });
+      if ((range == road->second.end()) || ((_quads[range->begin].lane_type & lane_type) == 0u)) {
+        continue;
+      }
+      const auto begin = _quads.begin() + range->begin;
+      const auto end = _quads.begin() + range->end;
+      auto quad = std::lower_bound(begin, end, lane.s - distance, [](const Quad &item, double s) {
+        return item.s1 < s;
+      });
+      for (; (quad != end) && (quad->s0 <= lane.s + distance); ++quad) {
+        // Locations near the boundaries may be in other lanes too, these are
+        // left to the search in the whole grid.
+        if (IsInside(quad->corners, x, y, -Tolerance)) {
+          const auto projection = ProjectOnLaneCenter(*quad, x, y);
+          if (projection.first < nearest) {
+            nearest = projection.first;
+            result = projection.second;
+          }
+        }
+      }
+    }
+    return result;
+  }
+
+} // namespace road
+} // namespace carla
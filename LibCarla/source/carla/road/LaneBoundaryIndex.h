@@ -0,0 +1,136 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Vector2D.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class MapData;
+  class Road;
+
+  /// Boundary polygons of the lanes of a map, to find the lanes containing a
+  /// location.
+  ///
+  /// The boundaries of each lane are sampled along its lane section from the
+  /// road's reference line, lane offset and lane widths, and the lane is
+  /// split in quads between consecutive samples. Samples are placed closer
+  /// where the boundaries bend, so the edges of the quads stay within
+  /// MaxError of the exact boundaries. The quads are indexed in a uniform
+  /// grid, so a query only tests the few quads in the cell of the location.
+  ///
+  /// Locations are in the same coordinates as road::Map locations, only x and
+  /// y are considered.
+  class LaneBoundaryIndex {
+  public:
+
+    /// Maximum distance between the samples of a lane [meters].
+    static constexpr double MaxStep = 8.0;
+
+    /// Maximum distance between the edges of the quads and the exact
+    /// boundaries of the lanes [meters].
+    static constexpr double MaxError = 5e-3;
+
+    /// Locations this close to the boundaries of a lane are considered in
+    /// the lane [meters].
+    static constexpr double Tolerance = 1e-3;
+
+    LaneBoundaryIndex() = default;
+
+    explicit LaneBoundaryIndex(const MapData &data);
+
+    size_t GetNumberOfQuads() const {
+      return _quads.size();
+    }
+
+    /// Return a waypoint on each lane of @a lane_type that contains
+    /// @a location, with the distance along the road of the location. Sorted
+    /// by distance from @a location to the center of the lane, nearest first.
+    std::vector<element::Waypoint> GetLanesAt(
+        const geom::Location &location,
+        uint32_t lane_type) const;
+
+    /// Return the first of GetLanesAt, if any.
+    boost::optional<element::Waypoint> GetLaneAt(
+        const geom::Location &location,
+        uint32_t lane_type) const;
+
+    /// Like GetLaneAt, but only searching the lanes of @a lanes, within
+    /// @a distance meters along each lane from the s of its waypoint.
+    /// Locations closer than Tolerance to the boundaries are not found.
+    boost::optional<element::Waypoint> GetLaneAt(
+        const geom::Location &location,
+        uint32_t lane_type,
+        const std::vector<element::Waypoint> &lanes,
+        double distance) const;
+
+  private:
+
+    /// Part of a lane between two samples.
+    struct Quad {
+      /// Inner and outer boundary at s0, then outer and inner at s1.
+      std::array<geom::Vector2D, 4u> corners;
+      double s0;
+      double s1;
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      uint32_t lane_type;
+    };
+
+    /// Quads of a lane in a lane section, sorted by s.
+    struct LaneQuads {
+      SectionId section_id;
+      LaneId lane_id;
+      uint32_t begin;
+      uint32_t end;
+    };
+
+    static void AddQuads(const Road &road, std::vector<Quad> &quads);
+
+    void BuildLaneIndex();
+
+    void BuildGrid();
+
+    /// Cell of the grid at @a x, @a y, clamped to the grid.
+    size_t GetCell(double x, double y) const;
+
+    std::vector<Quad> _quads;
+
+    std::unordered_map<RoadId, std::vector<LaneQuads>> _lanes;
+
+    double _min_x = 0.0;
+
+    double _min_y = 0.0;
+
+    double _cell_size = 1.0;
+
+    size_t _columns = 0u;
+
+    size_t _rows = 0u;
+
+    /// The quads in cell i are _cell_quads[j] for j in
+    /// [_cell_offsets[i], _cell_offsets[i + 1]).
+    std::vector<uint32_t> _cell_offsets;
+
+    std::vector<uint32_t> _cell_quads;
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,116 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/LaneGraph.h"
+
+#include "carla/road/MapData.h"
+
+#include <cstdlib>
+
+namespace carla {
+namespace road {
+
+  constexpr LaneGraph::LaneIndex LaneGraph::InvalidIndex;
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  /// Fill @a offsets and @a list with the lanes linked to each lane, given by
+  /// @a get_links, in compressed sparse row form.
+  template <typename FuncT>
+  static void BuildLinks(
+      const std::vector<LaneGraph::Node> &nodes,
+      const std::unordered_map<const Lane *, LaneGraph::LaneIndex> &indices,
+      FuncT &&get_links,
+      std::vector<uint32_t> &offsets,
+      std::vector<LaneGraph::LaneIndex> &list) {
+    offsets.clear();
+    offsets.reserve(nodes.size() + 1u);
+    offsets.emplace_back(0u);
+    list.clear();
+    for (const auto &node : nodes) {
+      for (const auto *lane : get_links(*node.lane)) {
+        const auto it = indices.find(lane);
+        if (it != indices.end()) {
+          list.emplace_back(it->second);
+        }
+      }
+      offsets.emplace_back(static_cast<uint32_t>(list.size()));
+    }
+  }
+
+  // ===========================================================================
+  // -- LaneGraph --------------------------------------------------------------
+  // ===========================================================================
+
+  LaneGraph::LaneGraph(const MapData &data) {
+    std::unordered_map<const Lane *, LaneIndex> indices;
+    for (const auto &pair : data.GetRoads()) {
+      const auto &road = pair.second;
+      for (const auto &section : road.GetLaneSections()) {
+        const auto &lanes = section.GetLanes();
+        if (lanes.empty()) {
+          continue;
+        }
+        const double s = section.GetDistance();
+        const double length = road.UpperBound(s) - s;
+        const Section entry{
+            static_cast<uint32_t>(_slots.size()),
+            lanes.begin()->first,
+            lanes.rbegin()->first};
+        _sections.emplace(MakeKey(road.GetId(), section.GetId()), entry);
+        _slots.resize(_slots.size() + static_cast<size_t>(entry.max_lane_id - entry.min_lane_id) + 1u, InvalidIndex);
+        for (const auto &lane : lanes) {
+          const auto index = static_cast<LaneIndex>(_nodes.size());
+          _nodes.emplace_back(Node{&lane.second, road.GetId(), section.GetId(), lane.first, s, length});
+          _slots[entry.first_slot + static_cast<uint32_t>(lane.first - entry.min_lane_id)] = index;
+          indices.emplace(&lane.second, index);
+        }
+      }
+    }
+
+    BuildLinks(_nodes, indices, [](const Lane &lane) -> const std::vector<Lane *> & {
+      return lane.GetNextLanes();
+    }, _successor_offsets, _successors);
+    BuildLinks(_nodes, indices, [](const Lane &lane) -> const std::vector<Lane *> & {
+      return lane.GetPreviousLanes();
+    }, _predecessor_offsets, _predecessors);
+
+    _right.resize(_nodes.size(), InvalidIndex);
+    _left.resize(_nodes.size(), InvalidIndex);
+    for (auto i = 0u; i < _nodes.size(); ++i) {
+      const auto &node = _nodes[i];
+      if (node.lane_id == 0) {
+        continue;
+      }
+      // Right moves away from the center, left towards and across it.
+      const LaneId right = node.lane_id > 0 ? node.lane_id + 1 : node.lane_id - 1;
+      const LaneId left =
+          std::abs(node.lane_id) == 1 ? -node.lane_id :
+          node.lane_id > 0 ? node.lane_id - 1 : node.lane_id + 1;
+      _right[i] = GetIndex(node.road_id, node.section_id, right);
+      _left[i] = GetIndex(node.road_id, node.section_id, left);
+    }
+  }
+
+  LaneGraph::LaneIndex LaneGraph::GetIndex(
+      const RoadId road_id,
+      const SectionId section_id,
+      const LaneId lane_id) const {
+    const auto it = _sections.find(MakeKey(road_id, section_id));
+    if (it == _sections.end()) {
+      return InvalidIndex;
+    }
+    const auto &section = it->second;
+    if ((lane_id < section.min_lane_id) || (lane_id > section.max_lane_id)) {
+      return InvalidIndex;
+    }
+    return _slots[section.first_slot + static_cast<uint32_t>(lane_id - section.min_lane_id)];
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,147 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/ListView.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Lane;
+  class MapData;
+
+  /// Dense index of every lane of a map, including the center lanes, and the
+  /// links between them.
+  ///
+  /// Each lane gets an index in [0, GetNumberOfLanes()), so going from a
+  /// lane index to its road, section and lane ids is an array access, and
+  /// going back a single hash lookup. Successors and predecessors are stored
+  /// in compressed sparse row arrays, left and right lanes in flat arrays.
+  ///
+  /// Lanes are indexed in the order of the roads of the map data, then by
+  /// section and lane id, so iterating the indices visits the lanes in the
+  /// same order as iterating the roads.
+  class LaneGraph {
+  public:
+
+    using LaneIndex = uint32_t;
+
+    static constexpr LaneIndex InvalidIndex = static_cast<LaneIndex>(-1);
+
+    using IndexList = ListView<const LaneIndex *>;
+
+    struct Node {
+      const Lane *lane;
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      /// Distance from road's start to the start of the lane section.
+      double s;
+      /// Length of the lane section.
+      double length;
+    };
+
+    LaneGraph() = default;
+
+    explicit LaneGraph(const MapData &data);
+
+    size_t GetNumberOfLanes() const {
+      return _nodes.size();
+    }
+
+    /// Return the index of the lane @a lane_id of section @a section_id of
+    /// road @a road_id, or InvalidIndex if there is no such lane.
+    LaneIndex GetIndex(RoadId road_id, SectionId section_id, LaneId lane_id) const;
+
+    LaneIndex GetIndex(const element::Waypoint &waypoint) const {
+      return GetIndex(waypoint.road_id, waypoint.section_id, waypoint.lane_id);
+    }
+
+    const Node &GetNode(LaneIndex index) const {
+      DEBUG_ASSERT(index < _nodes.size());
+      return _nodes[index];
+    }
+
+    const Lane &GetLane(LaneIndex index) const {
+      return *GetNode(index).lane;
+    }
+
+    /// Lanes following @a index in its driving direction.
+    IndexList GetSuccessors(LaneIndex index) const {
+      return GetRange(_successor_offsets, _successors, index);
+    }
+
+    /// Lanes preceding @a index in its driving direction.
+    IndexList GetPredecessors(LaneIndex index) const {
+      return GetRange(_predecessor_offsets, _predecessors, index);
+    }
+
+    /// Lane at the right of @a index in its driving direction, or
+    /// InvalidIndex. Same as Map::GetRight.
+    LaneIndex GetRight(LaneIndex index) const {
+      DEBUG_ASSERT(index < _right.size());
+      return _right[index];
+    }
+
+    /// Lane at the left of @a index in its driving direction, or
+    /// InvalidIndex. Same as Map::GetLeft.
+    LaneIndex GetLeft(LaneIndex index) const {
+      DEBUG_ASSERT(index < _left.size());
+      return _left[index];
+    }
+
+  private:
+
+    /// Lanes of a section, lane l has index _slots[first_slot + l - min_lane_id].
+    struct Section {
+      uint32_t first_slot;
+      LaneId min_lane_id;
+      LaneId max_lane_id;
+    };
+
+    static uint64_t MakeKey(RoadId road_id, SectionId section_id) {
+      return (static_cast<uint64_t>(road_id) << 32u) | section_id;
+    }
+
+    static IndexList GetRange(
+        const std::vector<uint32_t> &offsets,
+        const std::vector<LaneIndex> &list,
+        LaneIndex index) {
+      DEBUG_ASSERT(index + 1u < offsets.size());
+      return MakeListView(list.data() + offsets[index], list.data() + offsets[index + 1u]);
+    }
+
+    std::vector<Node> _nodes;
+
+    std::unordered_map<uint64_t, Section> _sections;
+
+    std::vector<LaneIndex> _slots;
+
+    /// The successors of lane i are _successors[j] for j in
+    /// [_successor_offsets[i], _successor_offsets[i + 1]).
+    std::vector<uint32_t> _successor_offsets;
+
+    std::vector<LaneIndex> _successors;
+
+    std::vector<uint32_t> _predecessor_offsets;
+
+    std::vector<LaneIndex> _predecessors;
+
+    std::vector<LaneIndex> _right;
+
+    std::vector<LaneIndex> _left;
+  };
+
+} // namespace road
+} // namespace carla
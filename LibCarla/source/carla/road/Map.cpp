@@ -7,6 +7,7 @@
 #include "carla/road/Map.h"
 
 #include "carla/Exception.h"
+#include "carla/ParallelFor.h"
 #include "carla/road/element/LaneCrossingCalculator.h"
 #include "carla/road/element/RoadInfoGeometry.h"
 #include "carla/road/element/RoadInfoLaneWidth.h"
@@ -14,6 +15,8 @@
 #include "carla/road/element/RoadInfoLaneOffset.h"
 #include "carla/geom/Math.h"
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 namespace carla {
@@ -29,74 +32,36 @@ namespace road {
   // -- Static local methods ---------------------------------------------------
   // ===========================================================================
 
-  template <typename T>
-  static std::vector<T> ConcatVectors(std::vector<T> dst, std::vector<T> src) {
-    if (src.size() > dst.size()) {
-      return ConcatVectors(src, dst);
-    }
-    dst.insert(
-        dst.end(),
-        std::make_move_iterator(src.begin()),
-        std::make_move_iterator(src.end()));
-    return dst;
-  }
-
-  static double GetDistanceAtStartOfLane(const Lane &lane) {
-    if (lane.GetId() <= 0) {
-      return lane.GetDistance() + 10.0 * EPSILON;
+  static double GetDistanceAtStartOfLane(const LaneGraph::Node &node) {
+    if (node.lane_id <= 0) {
+      return node.s + 10.0 * EPSILON;
     } else {
-      return lane.GetDistance() + lane.GetLength() - 10.0 * EPSILON;
+      return node.s + node.length - 10.0 * EPSILON;
     }
   }
 
-  static double GetDistanceAtEndOfLane(const Lane &lane) {
-    if (lane.GetId() > 0) {
-      return lane.GetDistance() + 10.0 * EPSILON;
+  static double GetDistanceAtEndOfLane(const LaneGraph::Node &node) {
+    if (node.lane_id > 0) {
+      return node.s + 10.0 * EPSILON;
     } else {
-      return lane.GetDistance() + lane.GetLength() - 10.0 * EPSILON;
+      return node.s + node.length - 10.0 * EPSILON;
     }
   }
 
-  /// Return a waypoint for each drivable lane on @a lane_section.
-  template <typename FuncT>
-  static void ForEachDrivableLaneImpl(
-      RoadId road_id,
-      const LaneSection &lane_section,
-      double distance,
-      FuncT &&func) {
-    for (const auto &pair : lane_section.GetLanes()) {
-      const auto &lane = pair.second;
-      if ((static_cast<uint32_t>(lane.GetType()) & static_cast<uint32_t>(Lane::LaneType::Driving)) > 0) {
-        std::forward<FuncT>(func)(Waypoint{
-            road_id,
-            lane_section.GetId(),
-            lane.GetId(),
-            distance < 0.0 ? GetDistanceAtStartOfLane(lane) : distance});
-      }
-    }
-  }
-
-  /// Return a waypoint for each drivable lane on each lane section of @a road.
-  template <typename FuncT>
-  static void ForEachDrivableLane(const Road &road, FuncT &&func) {
-    for (const auto &lane_section : road.GetLaneSections()) {
-      ForEachDrivableLaneImpl(
-          road.GetId(),
-          lane_section,
-          -1.0,
-          std::forward<FuncT>(func));
-    }
+  static bool IsDriving(const Lane &lane) {
+    return (static_cast<uint32_t>(lane.GetType()) & static_cast<uint32_t>(Lane::LaneType::Driving)) > 0;
   }
 
   /// Return a waypoint for each drivable lane at @a distance on @a road.
   template <typename FuncT>
   static void ForEachDrivableLaneAt(const Road &road, double distance, FuncT &&func) {
     for (const auto &lane_section : road.GetLaneSectionsAt(distance)) {
-      ForEachDrivableLaneImpl(
-          road.GetId(),
-          lane_section,
-          distance,
-          std::forward<FuncT>(func));
+      for (const auto &pair : lane_section.GetLanes()) {
+        const auto &lane = pair.second;
+        if (IsDriving(lane)) {
+          std::forward<FuncT>(func)(Waypoint{road.GetId(), lane_section.GetId(), lane.GetId(), distance});
+        }
+      }
     }
   }
 
@@ -129,11 +94,16 @@ namespace road {
     return std::make_pair(dist, tangent);
   }
 
-  /// Assumes road_id and section_id are valid.
-  static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
-    const auto &section = data.GetRoad(waypoint.road_id).GetLaneSectionById(waypoint.section_id);
-    return section.ContainsLane(waypoint.lane_id);
-  }
+  // ===========================================================================
+  // -- Map: Constructor -------------------------------------------------------
+  // ===========================================================================
+
+  Map::Map(MapData m)
+    : _data(std::move(m)),
+      _lane_graph(_data),
+      _signal_index(_data, _lane_graph),
+      _lane_boundaries(_data),
+      _cache(std::make_shared<Cache>()) {}
 
   // ===========================================================================
   // -- Map: Geometry ----------------------------------------------------------
@@ -221,41 +191,94 @@ namespace road {
   boost::optional<Waypoint> Map::GetWaypoint(
       const geom::Location &pos,
       uint32_t lane_type) const {
-    boost::optional<Waypoint> w = GetClosestWaypointOnRoad(pos, lane_type);
-
-    if (!w.has_value()) {
-      return w;
+    auto waypoint = _lane_boundaries.GetLaneAt(pos, lane_type);
+    if (waypoint.has_value()) {
+      // Make sure 0.0 < waipoint.s < Road's length
+      const auto &road = _data.GetRoad(waypoint->road_id);
+      constexpr double margin = 5.0 * EPSILON;
+      waypoint->s = geom::Math::Clamp(waypoint->s, margin, road.GetLength() - margin);
     }
+    return waypoint;
+  }
 
-    const auto dist = geom::Math::Distance2D(ComputeTransform(*w).location, pos);
-    const auto lane_width_info = GetLane(*w).GetInfo<RoadInfoLaneWidth>(w->s);
-    const auto half_lane_width =
-        lane_width_info->GetPolynomial().Evaluate(w->s) * 0.5;
+  boost::optional<Waypoint> Map::GetClosestWaypointOnRoad(
+      const geom::Location &pos,
+      const Waypoint hint,
+      uint32_t lane_type) const {
+    auto waypoint = GetWaypointNear(pos, hint, lane_type);
+    return waypoint.has_value() ? waypoint : GetClosestWaypointOnRoad(pos, lane_type);
+  }
 
-    if (dist < half_lane_width) {
-      return w;
+  boost::optional<Waypoint> Map::GetWaypoint(
+      const geom::Location &pos,
+      const Waypoint hint,
+      uint32_t lane_type) const {
+    auto waypoint = GetWaypointNear(pos, hint, lane_type);
+    return waypoint.has_value() ? waypoint : GetWaypoint(pos, lane_type);
+  }
+
+  boost::optional<Waypoint> Map::GetWaypointNear(
+      const geom::Location &pos,
+      const Waypoint hint,
+      uint32_t lane_type) const {
+    // Distance along the lanes searched from the hint, objects are expected
+    // to move much less between two queries.
+    constexpr double search_distance = 10.0;
+
+    // The hint may be stale or come from another map, then the caller falls
+    // back to the search in the whole map.
+    const auto hint_index = _lane_graph.GetIndex(hint);
+    if ((hint_index == LaneGraph::InvalidIndex) || (hint.lane_id == 0) || !std::isfinite(hint.s)) {
+      return boost::none;
     }
 
-    return boost::optional<Waypoint>{};
+    // Search the lane of the hint, then its neighbours, then the lanes
+    // connected to it.
+    std::vector<Waypoint> lanes = { hint };
+    auto waypoint = _lane_boundaries.GetLaneAt(pos, lane_type, lanes, search_distance);
+    if (!waypoint.has_value()) {
+      lanes.clear();
+      const auto &section = *_lane_graph.GetLane(hint_index).GetLaneSection();
+      for (const auto &pair : section.GetLanes()) {
+        if ((pair.first != 0) && (pair.first != hint.lane_id)) {
+          lanes.emplace_back(Waypoint{hint.road_id, hint.section_id, pair.first, hint.s});
+        }
+      }
+      waypoint = _lane_boundaries.GetLaneAt(pos, lane_type, lanes, search_distance);
+    }
+    if (!waypoint.has_value()) {
+      lanes.clear();
+      for (const auto index : _lane_graph.GetSuccessors(hint_index)) {
+        lanes.emplace_back(GetLaneStart(index));
+      }
+      for (const auto index : _lane_graph.GetPredecessors(hint_index)) {
+        lanes.emplace_back(GetLaneEnd(index));
+      }
+      waypoint = _lane_boundaries.GetLaneAt(pos, lane_type, lanes, search_distance);
+    }
+    if (waypoint.has_value()) {
+      // Make sure 0.0 < waipoint.s < Road's length
+      const auto &road = _data.GetRoad(waypoint->road_id);
+      constexpr double margin = 5.0 * EPSILON;
+      waypoint->s = geom::Math::Clamp(waypoint->s, margin, road.GetLength() - margin);
+    }
+    return waypoint;
   }
 
   geom::Transform Map::ComputeTransform(Waypoint waypoint) const {
     // lane_id can't be 0
     RELEASE_ASSERT(waypoint.lane_id != 0);
 
-    const auto &road = _data.GetRoad(waypoint.road_id);
+    const auto &lane = GetLane(waypoint);
+    RELEASE_ASSERT(lane.GetRoad() != nullptr);
+    const auto &road = *lane.GetRoad();
 
     // must s be smaller (or eq) than road lenght and bigger (or eq) than 0?
     RELEASE_ASSERT(waypoint.s <= road.GetLength());
     RELEASE_ASSERT(waypoint.s >= 0.0);
 
-    const auto &lane_section = road.GetLaneSectionById(waypoint.section_id);
-    const std::map<LaneId, Lane> &lanes = lane_section.GetLanes();
-
-    // check that lane_id exists on the current s
-    RELEASE_ASSERT(!lanes.empty());
-    RELEASE_ASSERT(waypoint.lane_id >= lanes.begin()->first);
-    RELEASE_ASSERT(waypoint.lane_id <= lanes.rbegin()->first);
+    RELEASE_ASSERT(lane.GetLaneSection() != nullptr);
+    const std::map<LaneId, Lane> &lanes = lane.GetLaneSection()->GetLanes();
 
     float lane_width = 0.0f;
     float lane_tangent = 0.0f;
@@ -363,42 +386,32 @@ namespace road {
     return LaneCrossingCalculator::Calculate(*this, origin, destination);
   }
 
+  std::vector<std::vector<LaneMarking>> Map::CalculateCrossedLanes(
+      const std::vector<LaneCrossingCalculator::Segment> &segments,
+      std::vector<LaneCrossingCalculator::Hint> &hints) const {
+    return LaneCrossingCalculator::CalculateBatch(*this, segments, hints);
+  }
+
   // ===========================================================================
   // -- Map: Waypoint generation -----------------------------------------------
   // ===========================================================================
 
   std::vector<Waypoint> Map::GetSuccessors(const Waypoint waypoint) const {
-    const auto &next_lanes = GetLane(waypoint).GetNextLanes();
+    const auto next_lanes = _lane_graph.GetSuccessors(GetLaneIndex(waypoint));
     std::vector<Waypoint> result;
     result.reserve(next_lanes.size());
-    for (auto *next_lane : next_lanes) {
-      RELEASE_ASSERT(next_lane != nullptr);
-      const auto lane_id = next_lane->GetId();
-      RELEASE_ASSERT(lane_id != 0);
-      const auto *section = next_lane->GetLaneSection();
-      RELEASE_ASSERT(section != nullptr);
-      const auto *road = next_lane->GetRoad();
-      RELEASE_ASSERT(road != nullptr);
-      const auto distance = GetDistanceAtStartOfLane(*next_lane);
-      result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance});
+    for (const auto index : next_lanes) {
+      result.emplace_back(GetLaneStart(index));
     }
     return result;
   }
 
   std::vector<Waypoint> Map::GetPredecessors(const Waypoint waypoint) const {
-    const auto &prev_lanes = GetLane(waypoint).GetPreviousLanes();
+    const auto prev_lanes = _lane_graph.GetPredecessors(GetLaneIndex(waypoint));
     std::vector<Waypoint> result;
     result.reserve(prev_lanes.size());
-    for (auto *next_lane : prev_lanes) {
-      RELEASE_ASSERT(next_lane != nullptr);
-      const auto lane_id = next_lane->GetId();
-      RELEASE_ASSERT(lane_id != 0);
-      const auto *section = next_lane->GetLaneSection();
-      RELEASE_ASSERT(section != nullptr);
-      const auto *road = next_lane->GetRoad();
-      RELEASE_ASSERT(road != nullptr);
-      const auto distance = GetDistanceAtEndOfLane(*next_lane);
-      result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance});
+    for (const auto index : prev_lanes) {
+      result.emplace_back(GetLaneEnd(index));
     }
     return result;
   }
@@ -407,55 +420,29 @@ namespace road {
       const Waypoint waypoint,
       const double distance) const {
     RELEASE_ASSERT(distance > 0.0);
-    const auto &lane = GetLane(waypoint);
-    const bool forward = (waypoint.lane_id <= 0);
-    const double signed_distance = forward ? distance : -distance;
-    const double relative_s = waypoint.s - lane.GetDistance() + EPSILON;
-    const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s;
-    DEBUG_ASSERT(remaining_lane_length >= 0.0);
-
-    // If after subtracting the distance we are still in the same lane, return
-    // same waypoint with the extra distance.
-    if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint;
-      result.s += signed_distance;
-      result.s += forward ? -EPSILON : EPSILON;
-      RELEASE_ASSERT(result.s > 0.0);
-      return { result };
-    }
-
-    // If we run out of remaining_lane_length we have to go to the successors.
     std::vector<Waypoint> result;
-    for (const auto &successor : GetSuccessors(waypoint)) {
-      DEBUG_ASSERT(
-          successor.road_id != waypoint.road_id ||
-          successor.section_id != waypoint.section_id ||
-          successor.lane_id != waypoint.lane_id);
-      result = ConcatVectors(result, GetNext(successor, distance - remaining_lane_length));
-    }
+    GetNext(GetLaneIndex(waypoint), waypoint, distance, result);
     return result;
   }
 
   boost::optional<Waypoint> Map::GetRight(Waypoint waypoint) const {
     RELEASE_ASSERT(waypoint.lane_id != 0);
-    if (waypoint.lane_id > 0) {
-      ++waypoint.lane_id;
-    } else {
-      --waypoint.lane_id;
+    const auto right = _lane_graph.GetRight(GetLaneIndex(waypoint));
+    if (right == LaneGraph::InvalidIndex) {
+      return boost::optional<Waypoint>{};
     }
-    return IsLanePresent(_data, waypoint) ? waypoint : boost::optional<Waypoint>{};
+    waypoint.lane_id = _lane_graph.GetNode(right).lane_id;
+    return waypoint;
   }
 
   boost::optional<Waypoint> Map::GetLeft(Waypoint waypoint) const {
     RELEASE_ASSERT(waypoint.lane_id != 0);
-    if (std::abs(waypoint.lane_id) == 1) {
-      waypoint.lane_id *= -1;
-    } else if (waypoint.lane_id > 0) {
-      --waypoint.lane_id;
-    } else {
-      ++waypoint.lane_id;
+    const auto left = _lane_graph.GetLeft(GetLaneIndex(waypoint));
+    if (left == LaneGraph::InvalidIndex) {
+      return boost::optional<Waypoint>{};
     }
-    return IsLanePresent(_data, waypoint) ? waypoint : boost::optional<Waypoint>{};
+    waypoint.lane_id = _lane_graph.GetNode(left).lane_id;
+    return waypoint;
   }
 
   std::vector<Waypoint> Map::GenerateWaypoints(const double distance) const {
@@ -500,24 +487,163 @@ namespace road {
   }
 
   std::vector<std::pair<Waypoint, Waypoint>> Map::GenerateTopology() const {
+    // The lane graph visits the lanes in the same order as the roads.
     std::vector<std::pair<Waypoint, Waypoint>> result;
-    for (const auto &pair : _data.GetRoads()) {
-      const auto &road = pair.second;
-      ForEachDrivableLane(road, [&](auto &&waypoint) {
-        for (auto &&successor : GetSuccessors(waypoint)) {
-          result.push_back({waypoint, successor});
-        }
-      });
+    for (auto index = 0u; index < _lane_graph.GetNumberOfLanes(); ++index) {
+      if (!IsDriving(_lane_graph.GetLane(index))) {
+        continue;
+      }
+      const auto waypoint = GetLaneStart(index);
+      for (const auto successor : _lane_graph.GetSuccessors(index)) {
+        result.push_back({waypoint, GetLaneStart(successor)});
+      }
+    }
+    return result;
+  }
+
+  std::shared_ptr<const Map::WaypointList> Map::GetCachedWaypoints(
+      const double distance) const {
+    RELEASE_ASSERT(distance > 0.0);
+    std::lock_guard<std::mutex> lock(_cache->mutex);
+    auto &lists = _cache->waypoints;
+    auto it = std::find_if(lists.begin(), lists.end(), [=](const auto &pair) {
+      return pair.first == distance;
+    });
+    if (it != lists.end()) {
+      // Move it to the front, it is now the most recently used.
+      std::rotate(lists.begin(), it, it + 1);
+    } else {
+      lists.emplace(
+          lists.begin(),
+          distance,
+          std::make_shared<const WaypointList>(GenerateWaypoints(distance)));
+      if (lists.size() > MaxCachedWaypointLists) {
+        lists.pop_back();
+      }
+    }
+    return lists.front().second;
+  }
+
+  std::shared_ptr<const Map::TopologyList> Map::GetCachedTopology() const {
+    std::lock_guard<std::mutex> lock(_cache->mutex);
+    if (_cache->topology == nullptr) {
+      _cache->topology = std::make_shared<const TopologyList>(GenerateTopology());
     }
+    return _cache->topology;
+  }
+
+  WaypointArrays Map::ExportWaypoints(const std::vector<Waypoint> &waypoints) const {
+    WaypointArrays result;
+    result.resize(waypoints.size());
+    auto set_marking = [](
+        const RoadInfoMarkRecord *record,
+        uint8_t &type,
+        uint8_t &color,
+        uint8_t &lane_change,
+        double &width) {
+      if (record == nullptr) {
+        type = static_cast<uint8_t>(LaneMarking::Type::None);
+        return;
+      }
+      const LaneMarking marking(*record);
+      type = static_cast<uint8_t>(marking.type);
+      color = static_cast<uint8_t>(marking.color);
+      lane_change = static_cast<uint8_t>(marking.lane_change);
+      width = marking.width;
+    };
+    ParallelFor(waypoints.size(), 256u, [&](size_t i) {
+      const auto &waypoint = waypoints[i];
+      result.road_ids[i] = waypoint.road_id;
+      result.section_ids[i] = waypoint.section_id;
+      result.lane_ids[i] = waypoint.lane_id;
+      result.s[i] = waypoint.s;
+      result.transforms[i] = ComputeTransform(waypoint);
+      result.lane_widths[i] = GetLaneWidth(waypoint);
+      result.lane_types[i] = static_cast<uint32_t>(GetLaneType(waypoint));
+      result.junction_ids[i] = GetJunctionId(waypoint.road_id);
+      const auto marks = GetMarkRecord(waypoint);
+      set_marking(
+          marks.first,
+          result.right_marking_types[i],
+          result.right_marking_colors[i],
+          result.right_marking_lane_changes[i],
+          result.right_marking_widths[i]);
+      set_marking(
+          marks.second,
+          result.left_marking_types[i],
+          result.left_marking_colors[i],
+          result.left_marking_lane_changes[i],
+          result.left_marking_widths[i]);
+    });
     return result;
   }
 
+  // ===========================================================================
+  // -- Map: Signals -----------------------------------------------------------
+  // ===========================================================================
+
+  std::vector<SignalAhead> Map::GetSignalsAhead(
+      const Waypoint waypoint,
+      const double distance) const {
+    return _signal_index.GetSignalsAhead(_lane_graph, GetLaneIndex(waypoint), waypoint, distance);
+  }
+
   // ===========================================================================
   // -- Map: Private functions -------------------------------------------------
   // ===========================================================================
 
   const Lane &Map::GetLane(Waypoint waypoint) const {
-    return _data.GetRoad(waypoint.road_id).GetLaneById(waypoint.section_id, waypoint.lane_id);
+    return _lane_graph.GetLane(GetLaneIndex(waypoint));
+  }
+
+  LaneGraph::LaneIndex Map::GetLaneIndex(const Waypoint waypoint) const {
+    const auto index = _lane_graph.GetIndex(waypoint);
+    if (index == LaneGraph::InvalidIndex) {
+      throw_exception(std::out_of_range("lane not found in the map"));
+    }
+    return index;
+  }
+
+  Waypoint Map::GetLaneStart(const LaneGraph::LaneIndex index) const {
+    const auto &node = _lane_graph.GetNode(index);
+    RELEASE_ASSERT(node.lane_id != 0);
+    return Waypoint{node.road_id, node.section_id, node.lane_id, GetDistanceAtStartOfLane(node)};
+  }
+
+  Waypoint Map::GetLaneEnd(const LaneGraph::LaneIndex index) const {
+    const auto &node = _lane_graph.GetNode(index);
+    RELEASE_ASSERT(node.lane_id != 0);
+    return Waypoint{node.road_id, node.section_id, node.lane_id, GetDistanceAtEndOfLane(node)};
+  }
+
+  void Map::GetNext(
+      const LaneGraph::LaneIndex index,
+      const Waypoint waypoint,
+      const double distance,
+      std::vector<Waypoint> &result) const {
+    const auto &node = _lane_graph.GetNode(index);
+    const bool forward = (waypoint.lane_id <= 0);
+    const double signed_distance = forward ? distance : -distance;
+    const double relative_s = waypoint.s - node.s + EPSILON;
+    const double remaining_lane_length = forward ? node.length - relative_s : relative_s;
+    DEBUG_ASSERT(remaining_lane_length >= 0.0);
+
+    // If after subtracting the distance we are still in the same lane, return
+    // same waypoint with the extra distance.
+    if (distance <= remaining_lane_length) {
+      Waypoint next = waypoint;
+      next.s += signed_distance;
+      next.s += forward ? -EPSILON : EPSILON;
+      RELEASE_ASSERT(next.s > 0.0);
+      result.emplace_back(next);
+      return;
+    }
+
+    // If we run out of remaining_lane_length we have to go to the successors.
+    for (const auto successor : _lane_graph.GetSuccessors(index)) {
+      DEBUG_ASSERT(successor != index);
+      GetNext(successor, GetLaneStart(successor), distance - remaining_lane_length, result);
+    }
   }
 
 } // namespace road
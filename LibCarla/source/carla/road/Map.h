@@ -8,19 +8,29 @@
 
 #include "carla/NonCopyable.h"
 #include "carla/geom/Transform.h"
+#include "carla/road/LaneBoundaryIndex.h"
+#include "carla/road/LaneGraph.h"
 #include "carla/road/MapData.h"
 #include "carla/road/RoadTypes.h"
+#include "carla/road/SignalIndex.h"
+#include "carla/road/WaypointArrays.h"
+#include "carla/road/element/LaneCrossingCalculator.h"
 #include "carla/road/element/LaneMarking.h"
 #include "carla/road/element/RoadInfoMarkRecord.h"
 #include "carla/road/element/Waypoint.h"
 
 #include <boost/optional.hpp>
 
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 namespace carla {
 namespace road {
 
+  class CompiledMap;
+
   class Map : private MovableNonCopyable {
   public:
 
@@ -30,7 +40,7 @@ namespace road {
     /// -- Constructor ---------------------------------------------------------
     /// ========================================================================
 
-    Map(MapData m) : _data(std::move(m)) {}
+    Map(MapData m);
 
     /// ========================================================================
     /// -- Georeference --------------------------------------------------------
@@ -48,8 +58,28 @@ namespace road {
         const geom::Location &location,
         uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
 
+    /// Return a waypoint on the lane of @a lane_type that contains
+    /// @a location, if any. If several lanes overlap at @a location, the one
+    /// with the nearest center is chosen.
+    boost::optional<element::Waypoint> GetWaypoint(
+        const geom::Location &location,
+        uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
+
+    /// Same as GetClosestWaypointOnRoad, but if @a location is in the lane
+    /// of @a hint, one of its neighbours, successors or predecessors, that
+    /// lane is returned without searching the whole map. @a hint is usually
+    /// the waypoint found for the same object in the previous frame.
+    boost::optional<element::Waypoint> GetClosestWaypointOnRoad(
+        const geom::Location &location,
+        Waypoint hint,
+        uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
+
+    /// Same as GetWaypoint, but searching first the lane of @a hint, its
+    /// neighbours, successors and predecessors. Where lanes overlap, the
+    /// lanes near @a hint are preferred.
     boost::optional<element::Waypoint> GetWaypoint(
         const geom::Location &location,
+        Waypoint hint,
         uint32_t lane_type = static_cast<uint32_t>(Lane::LaneType::Driving)) const;
 
     geom::Transform ComputeTransform(Waypoint waypoint) const;
@@ -75,6 +105,12 @@ namespace road {
         const geom::Location &origin,
         const geom::Location &destination) const;
 
+    /// Calculate the lane markings crossed by each of @a segments, see
+    /// LaneCrossingCalculator::CalculateBatch.
+    std::vector<std::vector<element::LaneMarking>> CalculateCrossedLanes(
+        const std::vector<element::LaneCrossingCalculator::Segment> &segments,
+        std::vector<element::LaneCrossingCalculator::Hint> &hints) const;
+
     /// ========================================================================
     /// -- Waypoint generation -------------------------------------------------
     /// ========================================================================
@@ -105,15 +141,97 @@ namespace road {
     /// map. The waypoints are placed at the entrance of each lane.
     std::vector<std::pair<Waypoint, Waypoint>> GenerateTopology() const;
 
+    using WaypointList = std::vector<Waypoint>;
+
+    using TopologyList = std::vector<std::pair<Waypoint, Waypoint>>;
+
+    /// Maximum number of distances whose waypoints are cached.
+    static constexpr size_t MaxCachedWaypointLists = 4u;
+
+    /// Same as GenerateWaypoints, but the result is generated only once per
+    /// @a approx_distance and shared by every caller. Only the
+    /// MaxCachedWaypointLists distances most recently asked for are kept.
+    std::shared_ptr<const WaypointList> GetCachedWaypoints(double approx_distance) const;
+
+    /// Same as GenerateTopology, but the result is generated only once and
+    /// shared by every caller.
+    std::shared_ptr<const TopologyList> GetCachedTopology() const;
+
+    /// Compute the transform, lane width, lane type, junction id and lane
+    /// markings of each of @a waypoints, in parallel.
+    WaypointArrays ExportWaypoints(const std::vector<Waypoint> &waypoints) const;
+
+    /// Dense index of the lanes of the map and the links between them.
+    const LaneGraph &GetLaneGraph() const {
+      return _lane_graph;
+    }
+
+    /// ========================================================================
+    /// -- Signals -------------------------------------------------------------
+    /// ========================================================================
+
+    /// Return the signals that apply to the lane of @a waypoint or the lanes
+    /// a vehicle could drive to from it, up to @a distance meters ahead,
+    /// sorted by distance.
+    std::vector<SignalAhead> GetSignalsAhead(Waypoint waypoint, double distance) const;
+
 #ifdef LIBCARLA_WITH_GTEST
     MapData &GetMap() {
       return _data;
     }
+
+    const MapData &GetMap() const {
+      return _data;
+    }
 #endif // LIBCARLA_WITH_GTEST
 
 private:
 
+    friend CompiledMap;
+
+    /// Return the lane containing @a location among the lane of @a hint and
+    /// the lanes around it, if any.
+    boost::optional<Waypoint> GetWaypointNear(
+        const geom::Location &location,
+        Waypoint hint,
+        uint32_t lane_type) const;
+
+    /// Results of GetCachedWaypoints and GetCachedTopology. Shared so the map
+    /// stays movable.
+    struct Cache {
+      std::mutex mutex;
+      /// The most recently used first, at most MaxCachedWaypointLists.
+      using WaypointLists = std::vector<std::pair<double, std::shared_ptr<const WaypointList>>>;
+      WaypointLists waypoints;
+      std::shared_ptr<const TopologyList> topology;
+    };
+
+    /// Index of the lane of @a waypoint, throws if there is no such lane.
+    LaneGraph::LaneIndex GetLaneIndex(Waypoint waypoint) const;
+
+    /// Waypoint at the entrance of the lane @a index.
+    Waypoint GetLaneStart(LaneGraph::LaneIndex index) const;
+
+    /// Waypoint at the exit of the lane @a index.
+    Waypoint GetLaneEnd(LaneGraph::LaneIndex index) const;
+
+    /// Append to @a result the waypoints @a distance ahead of @a waypoint,
+    /// in the lane @a index.
+    void GetNext(
+        LaneGraph::LaneIndex index,
+        Waypoint waypoint,
+        double distance,
+        std::vector<Waypoint> &result) const;
+
     MapData _data;
+
+    LaneGraph _lane_graph;
+
+    SignalIndex _signal_index;
+
+    LaneBoundaryIndex _lane_boundaries;
+
+    std::shared_ptr<Cache> _cache;
   };
 
 } // namespace road
@@ -4,10 +4,13 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/Exception.h"
+#include "carla/ParallelFor.h"
 #include "carla/StringUtil.h"
 #include "carla/road/MapBuilder.h"
 #include "carla/road/element/RoadInfoElevation.h"
 #include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoIterator.h"
 #include "carla/road/element/RoadInfoLaneAccess.h"
 #include "carla/road/element/RoadInfoLaneBorder.h"
 #include "carla/road/element/RoadInfoLaneHeight.h"
@@ -28,6 +31,7 @@
 
 #include <iterator>
 #include <memory>
+#include <stdexcept>
 
 using namespace carla::road::element;
 
@@ -38,15 +42,28 @@ namespace road {
 
     CreatePointersBetweenRoadSegments();
 
-    for (auto &&info : _temp_road_info_container) {
+    // each information set is sorted independently, build them in parallel
+    std::vector<std::pair<Road *const, std::vector<std::unique_ptr<RoadInfo>>> *> road_infos;
+    road_infos.reserve(_temp_road_info_container.size());
+    for (auto &info : _temp_road_info_container) {
+      road_infos.emplace_back(&info);
+    }
+    ParallelFor(road_infos.size(), MinChunkSize, [&](size_t i) {
+      auto &info = *road_infos[i];
       DEBUG_ASSERT(info.first != nullptr);
       info.first->_info = InformationSet(std::move(info.second));
-    }
+    });
 
-    for (auto &&info : _temp_lane_info_container) {
+    std::vector<std::pair<Lane *const, std::vector<std::unique_ptr<RoadInfo>>> *> lane_infos;
+    lane_infos.reserve(_temp_lane_info_container.size());
+    for (auto &info : _temp_lane_info_container) {
+      lane_infos.emplace_back(&info);
+    }
+    ParallelFor(lane_infos.size(), MinChunkSize, [&](size_t i) {
+      auto &info = *lane_infos[i];
       DEBUG_ASSERT(info.first != nullptr);
       info.first->_info = InformationSet(std::move(info.second));
-    }
+    });
 
     // remove temporal already used information
     _temp_road_info_container.clear();
@@ -68,7 +85,7 @@ namespace road {
       const double d) {
     DEBUG_ASSERT(road != nullptr);
     auto elevation = std::make_unique<RoadInfoElevation>(s, a, b, c, d);
-    _temp_road_info_container[road].emplace_back(std::move(elevation));
+    GetRoadInfos(road).emplace_back(std::move(elevation));
   }
 
   // called from lane parser
@@ -77,7 +94,7 @@ namespace road {
       const double s,
       const std::string restriction) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneAccess>(s, restriction));
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoLaneAccess>(s, restriction));
   }
 
   void MapBuilder::CreateLaneBorder(
@@ -88,7 +105,7 @@ namespace road {
       const double c,
       const double d) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneBorder>(s, a, b, c, d));
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoLaneBorder>(s, a, b, c, d));
   }
 
   void MapBuilder::CreateLaneHeight(
@@ -97,7 +114,7 @@ namespace road {
       const double inner,
       const double outer) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneHeight>(s, inner, outer));
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoLaneHeight>(s, inner, outer));
   }
 
   void MapBuilder::CreateLaneMaterial(
@@ -107,7 +124,7 @@ namespace road {
       const double friction,
       const double roughness) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneMaterial>(s, surface, friction,
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoLaneMaterial>(s, surface, friction,
         roughness));
   }
 
@@ -116,7 +133,7 @@ namespace road {
       const double s,
       const std::string value) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneRule>(s, value));
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoLaneRule>(s, value));
   }
 
   void MapBuilder::CreateLaneVisibility(
@@ -127,7 +144,7 @@ namespace road {
       const double left,
       const double right) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneVisibility>(s, forward, back,
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoLaneVisibility>(s, forward, back,
         left, right));
   }
 
@@ -139,7 +156,7 @@ namespace road {
       const double c,
       const double d) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoLaneWidth>(s, a, b, c, d));
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoLaneWidth>(s, a, b, c, d));
   }
 
   void MapBuilder::CreateRoadMark(
@@ -169,7 +186,7 @@ namespace road {
     } else {
       lc = RoadInfoMarkRecord::LaneChange::None;
     }
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoMarkRecord>(s, road_mark_id, type,
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoMarkRecord>(s, road_mark_id, type,
         weight, color,
         material, width, lc, height, type_name, type_width));
   }
@@ -184,7 +201,7 @@ namespace road {
       const std::string rule,
       const double width) {
     DEBUG_ASSERT(lane != nullptr);
-    auto it = MakeRoadInfoIterator<RoadInfoMarkRecord>(_temp_lane_info_container[lane]);
+    auto it = MakeRoadInfoIterator<RoadInfoMarkRecord>(GetLaneInfos(lane));
     for (; !it.IsAtEnd(); ++it) {
       if (it->GetRoadMarkId() == road_mark_id) {
         it->GetLines().emplace_back(std::make_unique<RoadInfoMarkTypeLine>(s, road_mark_id, length, space,
@@ -201,7 +218,7 @@ namespace road {
       const double max,
       const std::string /*unit*/) {
     DEBUG_ASSERT(lane != nullptr);
-    _temp_lane_info_container[lane].emplace_back(std::make_unique<RoadInfoSpeed>(s, max));
+    GetLaneInfos(lane).emplace_back(std::make_unique<RoadInfoSpeed>(s, max));
   }
 
   void MapBuilder::AddSignal(
@@ -263,6 +280,9 @@ namespace road {
     road->_successor = successor;
     road->_predecessor = predecessor;
 
+    // reserve its infos now, so they can be filled concurrently
+    _temp_road_info_container[road];
+
     return road;
   }
 
@@ -296,6 +316,9 @@ namespace road {
     lane->_successor = successor;
     lane->_predecessor = predecessor;
 
+    // reserve its infos now, so they can be filled concurrently
+    _temp_lane_info_container[lane];
+
     return lane;
   }
 
@@ -314,7 +337,7 @@ namespace road {
         hdg,
         location);
 
-    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+    GetRoadInfos(road).emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
         std::move(line_geometry))));
   }
 
@@ -325,7 +348,7 @@ namespace road {
       const double max,
       const std::string /*unit*/) {
     DEBUG_ASSERT(road != nullptr);
-    _temp_road_info_container[road].emplace_back(std::make_unique<RoadInfoSpeed>(s, max));
+    GetRoadInfos(road).emplace_back(std::make_unique<RoadInfoSpeed>(s, max));
   }
 
   void MapBuilder::CreateSectionOffset(
@@ -336,7 +359,7 @@ namespace road {
       const double c,
       const double d) {
     DEBUG_ASSERT(road != nullptr);
-    _temp_road_info_container[road].emplace_back(std::make_unique<RoadInfoLaneOffset>(s, a, b, c, d));
+    GetRoadInfos(road).emplace_back(std::make_unique<RoadInfoLaneOffset>(s, a, b, c, d));
   }
 
   void MapBuilder::AddRoadGeometryArc(
@@ -356,53 +379,96 @@ namespace road {
         location,
         curvature);
 
-    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+    GetRoadInfos(road).emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
         std::move(arc_geometry))));
   }
 
   void MapBuilder::AddRoadGeometrySpiral(
-      carla::road::Road * /*road*/,
-      const double /*s*/,
-      const double /*x*/,
-      const double /*y*/,
-      const double /*hdg*/,
-      const double /*length*/,
-      const double /*curvStart*/,
-      const double /*curvEnd*/) {
-    throw_exception(std::runtime_error("geometry spiral not supported"));
+      carla::road::Road *road,
+      const double s,
+      const double x,
+      const double y,
+      const double hdg,
+      const double length,
+      const double curvStart,
+      const double curvEnd) {
+    DEBUG_ASSERT(road != nullptr);
+    const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    auto spiral_geometry = std::make_unique<GeometrySpiral>(
+        s,
+        length,
+        hdg,
+        location,
+        curvStart,
+        curvEnd);
+
+    GetRoadInfos(road).emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+        std::move(spiral_geometry))));
   }
 
   void MapBuilder::AddRoadGeometryPoly3(
-      carla::road::Road * /*road*/,
-      const double /*s*/,
-      const double /*x*/,
-      const double /*y*/,
-      const double /*hdg*/,
-      const double /*length*/,
-      const double /*a*/,
-      const double /*b*/,
-      const double /*c*/,
-      const double /*d*/) {
-    throw_exception(std::runtime_error("geometry poly3 not supported"));
+      carla::road::Road *road,
+      const double s,
+      const double x,
+      const double y,
+      const double hdg,
+      const double length,
+      const double a,
+      const double b,
+      const double c,
+      const double d) {
+    DEBUG_ASSERT(road != nullptr);
+    const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    auto poly3_geometry = std::make_unique<GeometryPoly3>(
+        s,
+        length,
+        hdg,
+        location,
+        a,
+        b,
+        c,
+        d);
+
+    GetRoadInfos(road).emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+        std::move(poly3_geometry))));
   }
 
   void MapBuilder::AddRoadGeometryParamPoly3(
-      carla::road::Road * /*road*/,
-      const double /*s*/,
-      const double /*x*/,
-      const double /*y*/,
-      const double /*hdg*/,
-      const double /*length*/,
-      const double /*aU*/,
-      const double /*bU*/,
-      const double /*cU*/,
-      const double /*dU*/,
-      const double /*aV*/,
-      const double /*bV*/,
-      const double /*cV*/,
-      const double /*dV*/,
-      const std::string /*p_range*/) {
-    throw_exception(std::runtime_error("geometry poly3 not supported"));
+      carla::road::Road *road,
+      const double s,
+      const double x,
+      const double y,
+      const double hdg,
+      const double length,
+      const double aU,
+      const double bU,
+      const double cU,
+      const double dU,
+      const double aV,
+      const double bV,
+      const double cV,
+      const double dV,
+      const std::string p_range) {
+    DEBUG_ASSERT(road != nullptr);
+    const geom::Location location(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    // The parameter range is "arcLength" unless stated otherwise.
+    auto param_poly3_geometry = std::make_unique<GeometryParamPoly3>(
+        s,
+        length,
+        hdg,
+        location,
+        aU,
+        bU,
+        cU,
+        dU,
+        aV,
+        bV,
+        cV,
+        dV,
+        p_range != "normalized");
+
+    GetRoadInfos(road).emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+        std::move(param_poly3_geometry))));
   }
 
   void MapBuilder::AddJunction(const int32_t id, const std::string name) {
@@ -473,6 +539,22 @@ namespace road {
         dependency_type));
   }
 
+  void MapBuilder::AddRoadInfo(
+      Road *road,
+      std::unique_ptr<RoadInfo> &&info) {
+    DEBUG_ASSERT(road != nullptr);
+    DEBUG_ASSERT(info != nullptr);
+    GetRoadInfos(road).emplace_back(std::move(info));
+  }
+
+  void MapBuilder::AddLaneInfo(
+      Lane *lane,
+      std::unique_ptr<RoadInfo> &&info) {
+    DEBUG_ASSERT(lane != nullptr);
+    DEBUG_ASSERT(info != nullptr);
+    GetLaneInfos(lane).emplace_back(std::move(info));
+  }
+
   Lane *MapBuilder::GetLane(
       const RoadId road_id,
       const LaneId lane_id,
@@ -485,6 +567,26 @@ namespace road {
     return &_map_data.GetRoad(road_id);
   }
 
+  std::vector<std::unique_ptr<RoadInfo>> &MapBuilder::GetRoadInfos(Road *road) {
+    // the key is created by AddRoad, inserting it here would not be
+    // thread-safe
+    auto search = _temp_road_info_container.find(road);
+    if (search == _temp_road_info_container.end()) {
+      throw_exception(std::runtime_error("road info added to a road not created with AddRoad"));
+    }
+    return search->second;
+  }
+
+  std::vector<std::unique_ptr<RoadInfo>> &MapBuilder::GetLaneInfos(Lane *lane) {
+    // the key is created by AddRoadSectionLane, inserting it here would not be
+    // thread-safe
+    auto search = _temp_lane_info_container.find(lane);
+    if (search == _temp_lane_info_container.end()) {
+      throw_exception(std::runtime_error("lane info added to a lane not created with AddRoadSectionLane"));
+    }
+    return search->second;
+  }
+
   // return the pointer to a lane object
   Lane *MapBuilder::GetEdgeLanePointer(RoadId road_id, bool from_start, LaneId lane_id) {
 
@@ -557,7 +659,10 @@ namespace road {
       // change to another road / junction
       if (next != 0 || (lane_id == 0 && next == 0)) {
         // single road
-        result.push_back(GetEdgeLanePointer(next_road, (next <= 0), next));
+        Lane *next_lane = GetEdgeLanePointer(next_road, (next <= 0), next);
+        if (next_lane != nullptr) {
+          result.push_back(next_lane);
+        }
       }
     } else {
       // several roads (junction)
@@ -567,7 +672,11 @@ namespace road {
       auto next_road_as_junction = static_cast<JuncId>(next_road);
       auto options = GetJunctionLanes(next_road_as_junction, road_id, lane_id);
       for (auto opt : options) {
-        result.push_back(GetEdgeLanePointer(opt.first, (opt.second <= 0), opt.second));
+        // the connecting road may not be loaded, e.g. in a region of the map
+        Lane *next_lane = GetEdgeLanePointer(opt.first, (opt.second <= 0), opt.second);
+        if (next_lane != nullptr) {
+          result.push_back(next_lane);
+        }
       }
     }
 
@@ -612,38 +721,55 @@ namespace road {
 
   // assign pointers to the next lanes
   void MapBuilder::CreatePointersBetweenRoadSegments(void) {
-    // process each lane to define its nexts
+    std::vector<Road *> roads;
+    std::vector<std::pair<Road *, LaneSection *>> lane_sections;
+    std::vector<Lane *> lanes;
+    roads.reserve(_map_data._roads.size());
     for (auto &road : _map_data._roads) {
+      roads.emplace_back(&road.second);
       for (auto &section : road.second._lane_sections) {
         for (auto &lane : section.second._lanes) {
-
-          // assign the next lane pointers
-          lane.second._next_lanes = GetLaneNext(road.first, section.second._id, lane.first);
-
-          // add to each lane found, this as its predecessor
-          for (auto next_lane : lane.second._next_lanes) {
-            // add as previous
-            DEBUG_ASSERT(next_lane != nullptr);
-            next_lane->_prev_lanes.push_back(&lane.second);
-          }
-
+          lane_sections.emplace_back(&road.second, &section.second);
+          lanes.emplace_back(&lane.second);
         }
       }
     }
 
-    // process each lane to define its nexts
-    for (auto &road : _map_data._roads) {
-      for (auto &section : road.second._lane_sections) {
+    // process each lane to define its nexts, this only reads the map so the
+    // lanes are processed in parallel
+    ParallelFor(lanes.size(), MinChunkSize, [&](size_t i) {
+      Lane &lane = *lanes[i];
+      lane._next_lanes = GetLaneNext(
+          lane_sections[i].first->_id,
+          lane_sections[i].second->_id,
+          lane._id);
+    });
+
+    // add to each lane found, this as its predecessor; done sequentially to
+    // keep the order of the predecessors
+    for (auto *lane : lanes) {
+      for (auto next_lane : lane->_next_lanes) {
+        // add as previous
+        DEBUG_ASSERT(next_lane != nullptr);
+        next_lane->_prev_lanes.push_back(lane);
+      }
+    }
+
+    // process each road to define its nexts and prevs, each road only
+    // modifies itself
+    ParallelFor(roads.size(), MinChunkSize, [&](size_t i) {
+      Road &road = *roads[i];
+      for (auto &section : road._lane_sections) {
         for (auto &lane : section.second._lanes) {
 
           // add next roads
           for (auto next_lane : lane.second._next_lanes) {
             DEBUG_ASSERT(next_lane != nullptr);
             // avoid same road
-            if (next_lane->GetRoad() != &road.second) {
-              if (std::find(road.second._nexts.begin(), road.second._nexts.end(),
-                  next_lane->GetRoad()) == road.second._nexts.end()) {
-                road.second._nexts.push_back(next_lane->GetRoad());
+            if (next_lane->GetRoad() != &road) {
+              if (std::find(road._nexts.begin(), road._nexts.end(),
+                  next_lane->GetRoad()) == road._nexts.end()) {
+                road._nexts.push_back(next_lane->GetRoad());
               }
             }
           }
@@ -652,17 +778,17 @@ namespace road {
           for (auto prev_lane : lane.second._prev_lanes) {
             DEBUG_ASSERT(prev_lane != nullptr);
             // avoid same road
-            if (prev_lane->GetRoad() != &road.second) {
-              if (std::find(road.second._prevs.begin(), road.second._prevs.end(),
-                  prev_lane->GetRoad()) == road.second._prevs.end()) {
-                road.second._prevs.push_back(prev_lane->GetRoad());
+            if (prev_lane->GetRoad() != &road) {
+              if (std::find(road._prevs.begin(), road._prevs.end(),
+                  prev_lane->GetRoad()) == road._prevs.end()) {
+                road._prevs.push_back(prev_lane->GetRoad());
               }
             }
           }
 
         }
       }
-    }
+    });
   }
 
 } // namespace road
@@ -15,6 +15,12 @@
 namespace carla {
 namespace road {
 
+  /// Builds a Map from the data parsed from an OpenDRIVE.
+  ///
+  /// Roads, sections and lanes must be added from a single thread. Once
+  /// added, the methods adding infos to roads and lanes may be called from
+  /// several threads as long as each road, and its lanes, is only filled by
+  /// one of them.
   class MapBuilder {
   public:
 
@@ -315,6 +321,15 @@ namespace road {
         const uint32_t dependency_id,
         const std::string dependency_type);
 
+    // called from compiled map loader
+    void AddRoadInfo(
+        Road *road,
+        std::unique_ptr<element::RoadInfo> &&info);
+
+    void AddLaneInfo(
+        Lane *lane,
+        std::unique_ptr<element::RoadInfo> &&info);
+
     Road *GetRoad(
         const RoadId road_id);
 
@@ -329,8 +344,15 @@ namespace road {
 
   private:
 
+    /// Minimum number of elements processed per thread when building.
+    static constexpr size_t MinChunkSize = 256u;
+
     MapData _map_data;
 
+    std::vector<std::unique_ptr<element::RoadInfo>> &GetRoadInfos(Road *road);
+
+    std::vector<std::unique_ptr<element::RoadInfo>> &GetLaneInfos(Lane *lane);
+
     /// Create the pointers between RoadSegments based on the ids.
     void CreatePointersBetweenRoadSegments();
 
@@ -22,6 +22,7 @@
 namespace carla {
 namespace road {
 
+  class CompiledMap;
   class Lane;
 
   class MapData : private MovableNonCopyable {
@@ -71,6 +72,8 @@ namespace road {
 
     friend class MapBuilder;
 
+    friend CompiledMap;
+
     MapData() = default;
 
     geom::GeoLocation _geo_reference;
@@ -202,8 +202,8 @@ namespace road {
   const std::pair<double, double> Road::GetNearestPoint(const geom::Location &loc) const {
     std::pair<double, double> last = { 0.0, std::numeric_limits<double>::max() };
 
-    auto geom_info_list = _info.GetInfos<element::RoadInfoGeometry>();
-    decltype(geom_info_list)::iterator nearest_geom = geom_info_list.end();
+    const auto &geom_info_list = _info.GetInfos<element::RoadInfoGeometry>();
+    auto nearest_geom = geom_info_list.end();
 
     for (auto g = geom_info_list.begin(); g != geom_info_list.end(); ++g) {
       DEBUG_ASSERT(*g != nullptr);
@@ -29,6 +29,7 @@ namespace road {
   class MapData;
   class Elevation;
   class MapBuilder;
+  class CompiledMap;
 
   class Road : private MovableNonCopyable {
   public:
@@ -83,6 +84,14 @@ namespace road {
 
     std::unordered_map<SignId, signal::SignalReference> *getSignalReferences();
 
+    const std::unordered_map<SignId, signal::Signal> &GetSignals() const {
+      return _signals;
+    }
+
+    const std::unordered_map<SignRefId, signal::SignalReference> &GetSignalReferences() const {
+      return _sign_ref;
+    }
+
     /// Returns a directed point on the center of the road (lane 0),
     /// with the corresponding laneOffset and elevation records applied,
     /// on distance "s".
@@ -171,6 +180,8 @@ namespace road {
 
     friend MapBuilder;
 
+    friend CompiledMap;
+
     MapData *_map_data { nullptr };
 
     RoadId _id { 0 };
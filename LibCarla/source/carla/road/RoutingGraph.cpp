@@ -0,0 +1,73 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/RoutingGraph.h"
+
+#include "carla/geom/Math.h"
+#include "carla/road/Map.h"
+
+#include <algorithm>
+
+namespace carla {
+namespace road {
+
+  using element::Waypoint;
+
+  /// Waypoint identifying a lane, used as key of the node lookup table.
+  static Waypoint MakeLaneKey(const Waypoint &waypoint) {
+    return Waypoint{waypoint.road_id, waypoint.section_id, waypoint.lane_id, 0.0};
+  }
+
+  constexpr RoutingGraph::NodeId RoutingGraph::InvalidNode;
+
+  RoutingGraph::RoutingGraph(const Map &map) {
+    auto get_or_add_node = [&](const Waypoint &waypoint) {
+      const auto key = MakeLaneKey(waypoint);
+      auto it = _node_ids.find(key);
+      if (it == _node_ids.end()) {
+        const auto &lane = map.GetLane(waypoint);
+        const auto id = static_cast<NodeId>(_nodes.size());
+        _nodes.emplace_back(Node{
+            waypoint.road_id,
+            waypoint.section_id,
+            waypoint.lane_id,
+            lane.GetDistance(),
+            lane.GetLength()});
+        it = _node_ids.emplace(key, id).first;
+      }
+      return it->second;
+    };
+
+    const auto topology = map.GenerateTopology();
+    _edges.reserve(topology.size());
+    for (const auto &pair : topology) {
+      const auto source = get_or_add_node(pair.first);
+      const auto target = get_or_add_node(pair.second);
+      _edges.emplace_back(Edge{source, target, _nodes[source].length});
+    }
+
+    std::stable_sort(_edges.begin(), _edges.end(), [](const Edge &lhs, const Edge &rhs) {
+      return lhs.source < rhs.source;
+    });
+  }
+
+  boost::optional<RoutingGraph::NodeId> RoutingGraph::GetNodeId(const Waypoint &waypoint) const {
+    const auto it = _node_ids.find(MakeLaneKey(waypoint));
+    if (it == _node_ids.end()) {
+      return boost::optional<NodeId>{};
+    }
+    return it->second;
+  }
+
+  double RoutingGraph::GetProgress(const Node &node, const double s) {
+    const double progress = (node.lane_id <= 0) ?
+        s - node.s :
+        node.s + node.length - s;
+    return geom::Math::Clamp(progress, 0.0, node.length);
+  }
+
+} // namespace road
+} // namespace carla
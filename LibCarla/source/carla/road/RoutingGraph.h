@@ -0,0 +1,86 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class Map;
+
+  /// Weighted directed graph of the lane topology of a Map.
+  ///
+  /// There is a node for each lane appearing in Map::GenerateTopology, and an
+  /// edge from each lane to each of its successors. Since every node stands
+  /// for the entrance of its lane, the weight of an edge is the length of the
+  /// lane being driven through.
+  class RoutingGraph {
+  public:
+
+    using NodeId = uint32_t;
+
+    static constexpr NodeId InvalidNode = static_cast<NodeId>(-1);
+
+    struct Node {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      /// Distance from road's start to the start of the lane section.
+      double s;
+      /// Length of the lane.
+      double length;
+    };
+
+    struct Edge {
+      NodeId source;
+      NodeId target;
+      double weight;
+    };
+
+    explicit RoutingGraph(const Map &map);
+
+    size_t GetNumberOfNodes() const {
+      return _nodes.size();
+    }
+
+    const std::vector<Node> &GetNodes() const {
+      return _nodes;
+    }
+
+    /// Edges sorted by source node.
+    const std::vector<Edge> &GetEdges() const {
+      return _edges;
+    }
+
+    /// Return the node of the lane @a waypoint belongs to, if the lane is
+    /// part of the topology.
+    boost::optional<NodeId> GetNodeId(const element::Waypoint &waypoint) const;
+
+    /// Return the distance driven from the entrance of the lane @a node up to
+    /// road distance @a s, taking into account the driving direction of the
+    /// lane.
+    static double GetProgress(const Node &node, double s);
+
+  private:
+
+    std::vector<Node> _nodes;
+
+    std::vector<Edge> _edges;
+
+    std::unordered_map<element::Waypoint, NodeId> _node_ids;
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,211 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/SignalIndex.h"
+
+#include "carla/geom/Math.h"
+#include "carla/road/MapData.h"
+#include "carla/road/signal/Signal.h"
+#include "carla/road/signal/SignalReference.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace carla {
+namespace road {
+
+  using element::Waypoint;
+
+  // ===========================================================================
+  // -- Static local methods ---------------------------------------------------
+  // ===========================================================================
+
+  /// Whether a signal with @a orientation and @a validities applies to the
+  /// lane @a lane_id.
+  static bool AppliesToLane(
+      const LaneId lane_id,
+      const std::string &orientation,
+      const std::vector<general::Validity> &validities) {
+    if (lane_id == 0) {
+      return false;
+    }
+    if (((orientation == "+") && (lane_id > 0)) ||
+        ((orientation == "-") && (lane_id < 0))) {
+      return false;
+    }
+    if (validities.empty()) {
+      return true;
+    }
+    return std::any_of(validities.begin(), validities.end(), [lane_id](const auto &validity) {
+      const auto from = std::min(validity.GetFromLane(), validity.GetToLane());
+      const auto to = std::max(validity.GetFromLane(), validity.GetToLane());
+      return (from <= lane_id) && (lane_id <= to);
+    });
+  }
+
+  /// Waypoint at the entrance of the lane @a node.
+  static Waypoint GetLaneStart(const LaneGraph::Node &node) {
+    return Waypoint{
+        node.road_id,
+        node.section_id,
+        node.lane_id,
+        node.lane_id <= 0 ? node.s : node.s + node.length};
+  }
+
+  // ===========================================================================
+  // -- SignalIndex ------------------------------------------------------------
+  // ===========================================================================
+
+  SignalIndex::SignalIndex(const MapData &data, const LaneGraph &graph) {
+    // Signals by id, to resolve the references to signals of other roads.
+    std::unordered_map<SignId, const signal::Signal *> signals;
+    for (const auto &pair : data.GetRoads()) {
+      for (const auto &signal : pair.second.GetSignals()) {
+        signals.emplace(signal.first, &signal.second);
+      }
+    }
+
+    std::vector<std::pair<LaneGraph::LaneIndex, Entry>> entries;
+    auto add = [&](
+        const Road &road,
+        double s,
+        const std::string &orientation,
+        const std::vector<general::Validity> &validities,
+        const signal::Signal *signal) {
+      s = geom::Math::Clamp(s, 0.0, road.GetLength());
+      for (const auto &section : road.GetLaneSectionsAt(s)) {
+        for (const auto &lane : section.GetLanes()) {
+          if (!AppliesToLane(lane.first, orientation, validities)) {
+            continue;
+          }
+          const auto index = graph.GetIndex(road.GetId(), section.GetId(), lane.first);
+          if (index != LaneGraph::InvalidIndex) {
+            entries.emplace_back(index, Entry{s, signal});
+          }
+        }
+      }
+    };
+    for (const auto &pair : data.GetRoads()) {
+      const auto &road = pair.second;
+      for (const auto &signal : road.GetSignals()) {
+        const auto &value = signal.second;
+        add(road, value.GetS(), value.GetOrientation(), value.GetValidities(), &value);
+      }
+      for (const auto &reference : road.GetSignalReferences()) {
+        const auto &value = reference.second;
+        const auto it = signals.find(value.GetSignalId());
+        if (it != signals.end()) {
+          add(road, value.GetS(), value.GetOrientation(), value.GetValidities(), it->second);
+        }
+      }
+    }
+
+    // Group the entries by lane, sorted by s.
+    std::sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+      return (lhs.first < rhs.first) || ((lhs.first == rhs.first) && (lhs.second.s < rhs.second.s));
+    });
+    _offsets.assign(graph.GetNumberOfLanes() + 1u, 0u);
+    _entries.reserve(entries.size());
+    for (const auto &entry : entries) {
+      ++_offsets[entry.first + 1u];
+      _entries.emplace_back(entry.second);
+    }
+    for (auto i = 1u; i < _offsets.size(); ++i) {
+      _offsets[i] += _offsets[i - 1u];
+    }
+  }
+
+  std::vector<SignalAhead> SignalIndex::GetSignalsAhead(
+      const LaneGraph &graph,
+      const LaneGraph::LaneIndex index,
+      const Waypoint &waypoint,
+      const double distance) const {
+    SignalsFound found;
+    if (_entries.empty()) {
+      return found.result;
+    }
+
+    // Dijkstra over the lanes ahead, each entered at its start. The lane of
+    // the waypoint is entered at the waypoint instead, it is entered again
+    // at its start only if a loop leads back to it.
+    using QueueEntry = std::pair<double, LaneGraph::LaneIndex>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    std::unordered_map<LaneGraph::LaneIndex, double> offsets;
+    auto push_successors = [&](LaneGraph::LaneIndex lane, double offset) {
+      if (offset >= distance) {
+        return;
+      }
+      for (const auto successor : graph.GetSuccessors(lane)) {
+        auto result = offsets.emplace(successor, offset);
+        if (result.second || (offset < result.first->second)) {
+          result.first->second = offset;
+          queue.emplace(offset, successor);
+        }
+      }
+    };
+    push_successors(index, AddSignalsAhead(graph, index, waypoint, 0.0, distance, found));
+    while (!queue.empty()) {
+      const auto entry = queue.top();
+      queue.pop();
+      const auto offset = entry.first;
+      const auto lane = entry.second;
+      if (offset > offsets[lane]) {
+        continue; // Already reached at a smaller offset.
+      }
+      const auto start = GetLaneStart(graph.GetNode(lane));
+      const auto length = AddSignalsAhead(graph, lane, start, offset, distance - offset, found);
+      push_successors(lane, offset + length);
+    }
+
+    std::stable_sort(found.result.begin(), found.result.end(), [](const auto &lhs, const auto &rhs) {
+      return lhs.distance < rhs.distance;
+    });
+    return found.result;
+  }
+
+  double SignalIndex::AddSignalsAhead(
+      const LaneGraph &graph,
+      const LaneGraph::LaneIndex index,
+      const Waypoint &waypoint,
+      const double offset,
+      const double distance,
+      SignalsFound &found) const {
+    const auto &node = graph.GetNode(index);
+    const bool forward = (waypoint.lane_id <= 0);
+    const double remaining = std::max(
+        0.0,
+        forward ? node.s + node.length - waypoint.s : waypoint.s - node.s);
+    const double reach = std::min(distance, remaining);
+
+    // Entries between waypoint.s and reach meters ahead.
+    const double min_s = forward ? waypoint.s : waypoint.s - reach;
+    const double max_s = forward ? waypoint.s + reach : waypoint.s;
+    const auto begin = _entries.begin() + _offsets[index];
+    const auto end = _entries.begin() + _offsets[index + 1u];
+    auto it = std::lower_bound(begin, end, min_s, [](const Entry &entry, double s) {
+      return entry.s < s;
+    });
+    for (; (it != end) && (it->s <= max_s); ++it) {
+      const SignalAhead item{
+          it->signal,
+          offset + std::abs(it->s - waypoint.s),
+          Waypoint{node.road_id, node.section_id, node.lane_id, it->s}};
+      auto position = found.positions.emplace(it->signal, found.result.size());
+      if (position.second) {
+        found.result.emplace_back(item);
+      } else if (item.distance < found.result[position.first->second].distance) {
+        found.result[position.first->second] = item;
+      }
+    }
+    return remaining;
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,98 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/LaneGraph.h"
+#include "carla/road/RoadTypes.h"
+#include "carla/road/element/Waypoint.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  class MapData;
+
+namespace signal { class Signal; }
+
+  /// A signal found along the lanes ahead of a waypoint.
+  struct SignalAhead {
+    const signal::Signal *signal;
+    /// Distance driven from the waypoint up to the signal [meters].
+    double distance;
+    /// Position of the signal on the lane it applies to.
+    element::Waypoint waypoint;
+  };
+
+  /// Signals and signal references of a map indexed by the lanes they apply
+  /// to, sorted by s.
+  ///
+  /// A signal applies to the lanes of the lane section at its s in the
+  /// driving direction given by its orientation, "+" for the right lanes,
+  /// "-" for the left lanes and both otherwise, restricted to its validity
+  /// ranges if it has any. Signal references add the referenced signal to
+  /// the lanes of the road where the reference is.
+  class SignalIndex {
+  public:
+
+    SignalIndex() = default;
+
+    SignalIndex(const MapData &data, const LaneGraph &graph);
+
+    size_t GetNumberOfEntries() const {
+      return _entries.size();
+    }
+
+    /// Return the signals applying to the lane of @a waypoint and the lanes
+    /// following it, up to @a distance meters ahead of @a waypoint in the
+    /// driving direction. Each signal appears once, at its nearest position,
+    /// sorted by distance.
+    ///
+    /// The lanes ahead are explored in order of distance, each one once, so
+    /// the cost grows with the number of lanes within @a distance.
+    std::vector<SignalAhead> GetSignalsAhead(
+        const LaneGraph &graph,
+        LaneGraph::LaneIndex index,
+        const element::Waypoint &waypoint,
+        double distance) const;
+
+  private:
+
+    struct Entry {
+      double s;
+      const signal::Signal *signal;
+    };
+
+    /// Signals found so far, and the position in the result of each.
+    struct SignalsFound {
+      std::vector<SignalAhead> result;
+      std::unordered_map<const signal::Signal *, size_t> positions;
+    };
+
+    /// Add to @a found the signals of the lane @a index between @a waypoint
+    /// and @a distance meters ahead, @a offset meters away from the start of
+    /// the search, keeping the nearest position of each. Return the distance
+    /// from @a waypoint to the end of the lane.
+    double AddSignalsAhead(
+        const LaneGraph &graph,
+        LaneGraph::LaneIndex index,
+        const element::Waypoint &waypoint,
+        double offset,
+        double distance,
+        SignalsFound &found) const;
+
+    /// The entries of lane i are _entries[j] for j in
+    /// [_offsets[i], _offsets[i + 1]).
+    std::vector<uint32_t> _offsets;
+
+    std::vector<Entry> _entries;
+  };
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,85 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Transform.h"
+#include "carla/road/RoadTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// Properties of a list of waypoints stored as contiguous arrays, one per
+  /// property; element i of each array belongs to the i-th waypoint.
+  ///
+  /// The lane markings are stored as the values of element::LaneMarking's
+  /// enums, waypoints without a marking have type LaneMarking::Type::None
+  /// and width 0.
+  struct WaypointArrays {
+
+    size_t size() const {
+      return road_ids.size();
+    }
+
+    void resize(size_t size) {
+      road_ids.resize(size);
+      section_ids.resize(size);
+      lane_ids.resize(size);
+      s.resize(size);
+      transforms.resize(size);
+      lane_widths.resize(size);
+      lane_types.resize(size);
+      junction_ids.resize(size);
+      right_marking_types.resize(size);
+      right_marking_colors.resize(size);
+      right_marking_lane_changes.resize(size);
+      right_marking_widths.resize(size);
+      left_marking_types.resize(size);
+      left_marking_colors.resize(size);
+      left_marking_lane_changes.resize(size);
+      left_marking_widths.resize(size);
+    }
+
+    std::vector<RoadId> road_ids;
+
+    std::vector<SectionId> section_ids;
+
+    std::vector<LaneId> lane_ids;
+
+    std::vector<double> s;
+
+    /// Six floats each: location x, y, z and rotation pitch, yaw, roll.
+    std::vector<geom::Transform> transforms;
+
+    std::vector<double> lane_widths;
+
+    std::vector<uint32_t> lane_types;
+
+    /// -1 if the waypoint is not in a junction.
+    std::vector<JuncId> junction_ids;
+
+    std::vector<uint8_t> right_marking_types;
+
+    std::vector<uint8_t> right_marking_colors;
+
+    std::vector<uint8_t> right_marking_lane_changes;
+
+    std::vector<double> right_marking_widths;
+
+    std::vector<uint8_t> left_marking_types;
+
+    std::vector<uint8_t> left_marking_colors;
+
+    std::vector<uint8_t> left_marking_lane_changes;
+
+    std::vector<double> left_marking_widths;
+  };
+
+} // namespace road
+} // namespace carla
@@ -7,14 +7,16 @@
 #include "carla/road/element/Geometry.h"
 
 #include "carla/Debug.h"
-#include "carla/Exception.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 
 #include <cephes/fresnel.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
-#include <stdexcept>
+#include <iterator>
+#include <limits>
 
 namespace carla {
 namespace road {
@@ -52,32 +54,439 @@ namespace element {
     return p;
   }
 
-  DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
-    // not working yet with negative values
+  // ===========================================================================
+  // -- GeometryLookupTable ----------------------------------------------------
+  // ===========================================================================
+
+  namespace {
+
+    using Sample = GeometryLookupTable::Sample;
+
+    /// Maximum number of intervals of a lookup table.
+    constexpr size_t MaxIntervals = 1u << 16;
+
+    /// Return @a sample with its heading within pi of @a reference.
+    Sample Unwrap(Sample sample, double reference) {
+      constexpr double pi = geom::Math::Pi<double>();
+      while (sample.heading - reference > pi) {
+        sample.heading -= 2.0 * pi;
+      }
+      while (reference - sample.heading > pi) {
+        sample.heading += 2.0 * pi;
+      }
+      return sample;
+    }
+
+  } // namespace
+
+  constexpr double GeometryLookupTable::MaxError;
+
+  GeometryLookupTable::GeometryLookupTable(
+      const double length,
+      const std::function<Sample(double)> &evaluate)
+    : _length(std::max(length, 0.0)) {
+    // Start with intervals of about 4 meters, halve them until accurate.
+    size_t intervals = std::max<size_t>(1u, static_cast<size_t>(std::ceil(_length / 4.0)));
+    _step = _length / static_cast<double>(intervals);
+    _samples.reserve(intervals + 1u);
+    _samples.emplace_back(evaluate(0.0));
+    for (size_t i = 1u; i <= intervals; ++i) {
+      const double dist = std::min(static_cast<double>(i) * _step, _length);
+      _samples.emplace_back(Unwrap(evaluate(dist), _samples.back().heading));
+    }
+
+    auto is_accurate = [&]() {
+      for (size_t i = 0u; i < intervals; ++i) {
+        for (double quarter : {0.25, 0.5, 0.75}) {
+          const double dist = (static_cast<double>(i) + quarter) * _step;
+          const auto exact = evaluate(dist);
+          const auto interpolated = Evaluate(dist);
+          if (std::hypot(exact.x - interpolated.x, exact.y - interpolated.y) > MaxError) {
+            return false;
+          }
+        }
+      }
+      return true;
+    };
+
+    _is_accurate = (_length <= 0.0) || is_accurate();
+    while (!_is_accurate && (intervals < MaxIntervals)) {
+      // Halve the intervals, the current samples are kept.
+      std::vector<Sample> samples;
+      samples.reserve(2u * intervals + 1u);
+      _step /= 2.0;
+      for (size_t i = 0u; i < intervals; ++i) {
+        samples.emplace_back(_samples[i]);
+        samples.emplace_back(Unwrap(evaluate(static_cast<double>(2u * i + 1u) * _step), _samples[i].heading));
+      }
+      samples.emplace_back(_samples.back());
+      _samples = std::move(samples);
+      intervals *= 2u;
+      _is_accurate = is_accurate();
+    }
+  }
+
+  Sample GeometryLookupTable::Evaluate(double dist) const {
+    DEBUG_ASSERT(!_samples.empty());
+    if (_samples.size() < 2u) {
+      return _samples.front();
+    }
     dist = geom::Math::Clamp(dist, 0.0, _length);
+    const double position = dist / _step;
+    const size_t i = std::min(static_cast<size_t>(position), _samples.size() - 2u);
+    const double t = position - static_cast<double>(i);
+    const auto &p0 = _samples[i];
+    const auto &p1 = _samples[i + 1u];
+
+    // Cubic Hermite basis.
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    const double h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+    const double h10 = (t3 - 2.0 * t2 + t) * _step;
+    const double h01 = -2.0 * t3 + 3.0 * t2;
+    const double h11 = (t3 - t2) * _step;
+
+    Sample result;
+    result.x = h00 * p0.x + h10 * std::cos(p0.heading) + h01 * p1.x + h11 * std::cos(p1.heading);
+    result.y = h00 * p0.y + h10 * std::sin(p0.heading) + h01 * p1.y + h11 * std::sin(p1.heading);
+    result.heading = h00 * p0.heading + h10 * p0.curvature + h01 * p1.heading + h11 * p1.curvature;
+    result.curvature = p0.curvature + t * (p1.curvature - p0.curvature);
+    return result;
+  }
+
+  std::pair<float, float> GeometryLookupTable::DistanceTo(const geom::Location &p) const {
+    return DistanceToImpl(p, [this](double dist) { return Evaluate(dist); });
+  }
+
+  std::pair<float, float> GeometryLookupTable::DistanceTo(
+      const geom::Location &p,
+      const std::function<Sample(double)> &evaluate) const {
+    return DistanceToImpl(p, evaluate);
+  }
+
+  template <typename EvaluateT>
+  std::pair<float, float> GeometryLookupTable::DistanceToImpl(
+      const geom::Location &p,
+      const EvaluateT &evaluate) const {
+    DEBUG_ASSERT(!_samples.empty());
+    const double px = p.x;
+    const double py = p.y;
+
+    // Closest point of the polyline joining the samples.
+    double best_dist = 0.0;
+    double best_distance_squared = std::numeric_limits<double>::max();
+    for (size_t i = 0u; i + 1u < _samples.size(); ++i) {
+      const auto &p0 = _samples[i];
+      const auto &p1 = _samples[i + 1u];
+      const double dx = p1.x - p0.x;
+      const double dy = p1.y - p0.y;
+      const double chord_squared = dx * dx + dy * dy;
+      double u = 0.0;
+      if (chord_squared > 0.0) {
+        u = geom::Math::Clamp(((px - p0.x) * dx + (py - p0.y) * dy) / chord_squared, 0.0, 1.0);
+      }
+      const double ex = p0.x + u * dx - px;
+      const double ey = p0.y + u * dy - py;
+      const double distance_squared = ex * ex + ey * ey;
+      if (distance_squared < best_distance_squared) {
+        best_distance_squared = distance_squared;
+        best_dist = (static_cast<double>(i) + u) * _step;
+      }
+    }
+
+    // Refine with Newton iterations on the curve.
+    for (int iteration = 0; iteration < 4; ++iteration) {
+      const auto sample = evaluate(best_dist);
+      const double ex = px - sample.x;
+      const double ey = py - sample.y;
+      const double cos_h = std::cos(sample.heading);
+      const double sin_h = std::sin(sample.heading);
+      const double along = ex * cos_h + ey * sin_h;
+      const double derivative = 1.0 - sample.curvature * (ey * cos_h - ex * sin_h);
+      best_dist = geom::Math::Clamp(
+          best_dist + along / std::max(derivative, 0.1),
+          0.0,
+          _length);
+    }
+    const auto sample = evaluate(best_dist);
+    return std::make_pair(
+        static_cast<float>(best_dist),
+        static_cast<float>(std::hypot(px - sample.x, py - sample.y)));
+  }
+
+  // ===========================================================================
+  // -- GeometryTabulated ------------------------------------------------------
+  // ===========================================================================
+
+  void GeometryTabulated::BuildLookupTable(const std::function<Sample(double)> &evaluate_local) {
+    _table = GeometryLookupTable(_length, [&](double dist) {
+      return ToGlobal(evaluate_local(dist));
+    });
+  }
+
+  Sample GeometryTabulated::ToGlobal(const Sample &local) const {
+    const double cos_h = std::cos(_heading);
+    const double sin_h = std::sin(_heading);
+    Sample result;
+    result.x = _start_position.x + local.x * cos_h - local.y * sin_h;
+    result.y = _start_position.y + local.x * sin_h + local.y * cos_h;
+    result.heading = _heading + local.heading;
+    result.curvature = local.curvature;
+    return result;
+  }
+
+  Sample GeometryTabulated::EvaluateGlobal(double dist) const {
+    return ToGlobal(EvaluateLocal(geom::Math::Clamp(dist, 0.0, _length)));
+  }
+
+  DirectedPoint GeometryTabulated::PosFromDist(double dist) const {
+    const auto sample = _table.IsAccurate() ? _table.Evaluate(dist) : EvaluateGlobal(dist);
+    return DirectedPoint(
+        static_cast<float>(sample.x),
+        static_cast<float>(sample.y),
+        0.0f,
+        sample.heading);
+  }
+
+  std::pair<float, float> GeometryTabulated::DistanceTo(const geom::Location &p) const {
+    if (_table.IsAccurate()) {
+      return _table.DistanceTo(p);
+    }
+    return _table.DistanceTo(p, [this](double dist) { return EvaluateGlobal(dist); });
+  }
+
+  DirectedPoint GeometryTabulated::PosFromDistExact(double dist) const {
+    const auto sample = EvaluateGlobal(dist);
+    return DirectedPoint(
+        static_cast<float>(sample.x),
+        static_cast<float>(sample.y),
+        0.0f,
+        sample.heading);
+  }
+
+  // ===========================================================================
+  // -- GeometrySpiral ---------------------------------------------------------
+  // ===========================================================================
+
+  GeometrySpiral::GeometrySpiral(
+      double start_offset,
+      double length,
+      double heading,
+      const geom::Location &start_pos,
+      double curv_s,
+      double curv_e)
+    : GeometryTabulated(GeometryType::SPIRAL, start_offset, length, heading, start_pos),
+      _curve_start(curv_s),
+      _curve_end(curv_e) {
     DEBUG_ASSERT(_length > 0.0);
-    DEBUG_ASSERT(std::fabs(_curve_end) > 1e-15);
-    const double radius = 1.0 / _curve_end;
-    const double extra_norm = 1.0 / std::sqrt(geom::Math::Pi<double>() / 2.0);
-    const double norm = 1.0 / std::sqrt(2.0 * radius * _length);
-    const double length = dist * norm;
-    double S, C;
-    fresnl(length * extra_norm, &S, &C);
-    S /= (norm * extra_norm);
-    C /= (norm * extra_norm);
-    DirectedPoint p(_start_position, _heading);
-    const double cos_a = std::cos(p.tangent);
-    const double sin_a = std::sin(p.tangent);
-    p.location.x += static_cast<float>(C * cos_a - S * sin_a);
-    p.location.y += static_cast<float>(S * cos_a + C * sin_a);
-    p.tangent += length * length;
+    BuildLookupTable([this](double dist) { return EvaluateLocal(dist); });
+  }
 
-    return p;
+  Sample GeometrySpiral::EvaluateLocal(double dist) const {
+    // The curvature changes linearly, k(s) = k0 + c * s.
+    const double k0 = _curve_start;
+    const double c = (_curve_end - _curve_start) / _length;
+    Sample result;
+    result.heading = k0 * dist + 0.5 * c * dist * dist;
+    result.curvature = k0 + c * dist;
+
+    if (std::abs(c) * _length * _length < 1e-10) {
+      // Constant curvature.
+      if (std::abs(k0) < 1e-12) {
+        result.x = dist;
+        result.y = 0.0;
+      } else {
+        result.x = std::sin(k0 * dist) / k0;
+        result.y = (1.0 - std::cos(k0 * dist)) / k0;
+      }
+      return result;
+    }
+
+    // With u = s + k0 / c the heading is c/2 * u^2 - k0^2 / (2 * c), and the
+    // integrals of cos and sin of c/2 * u^2 are Fresnel integrals of
+    // u * sqrt(|c| / pi).
+    const double scale = std::sqrt(geom::Math::Pi<double>() / std::abs(c));
+    const double sign = (c > 0.0) ? 1.0 : -1.0;
+    const double u0 = k0 / c;
+    double S0, C0, S1, C1;
+    fresnl(u0 / scale, &S0, &C0);
+    fresnl((u0 + dist) / scale, &S1, &C1);
+    const double integral_cos = scale * (C1 - C0);
+    const double integral_sin = sign * scale * (S1 - S0);
+    const double heading0 = 0.5 * c * u0 * u0;
+    const double cos_h0 = std::cos(heading0);
+    const double sin_h0 = std::sin(heading0);
+    result.x = cos_h0 * integral_cos + sin_h0 * integral_sin;
+    result.y = cos_h0 * integral_sin - sin_h0 * integral_cos;
+    return result;
+  }
+
+  // ===========================================================================
+  // -- GeometryPoly3 and GeometryParamPoly3 -----------------------------------
+  // ===========================================================================
+
+  /// Parametric cubic curve (u(p), v(p)), p in [0, range], evaluated by arc
+  /// length. The arc length is integrated with Gauss-Legendre quadrature.
+  class ParametricCubic {
+  public:
+
+    ParametricCubic(const std::array<double, 4u> &u, const std::array<double, 4u> &v, double range)
+      : _u(u),
+        _v(v),
+        _range(range) {
+      _lengths[0u] = 0.0;
+      for (size_t i = 0u; i < Panels; ++i) {
+        _lengths[i + 1u] = _lengths[i] + ArcLength(PanelStart(i), PanelStart(i + 1u));
+      }
+    }
+
+    /// Sample at arc length @a dist from the start, clamped to the curve.
+    Sample Evaluate(double dist) const {
+      dist = geom::Math::Clamp(dist, 0.0, _lengths.back());
+      const auto it = std::upper_bound(_lengths.begin(), _lengths.end(), dist);
+      const size_t i = std::min<size_t>(
+          static_cast<size_t>(std::max<std::ptrdiff_t>(std::distance(_lengths.begin(), it) - 1, 0)),
+          Panels - 1u);
+      const double p0 = PanelStart(i);
+      const double p_end = PanelStart(i + 1u);
+      const double target = dist - _lengths[i];
+      double p = p0;
+      for (int iteration = 0; iteration < 16; ++iteration) {
+        const double error = ArcLength(p0, p) - target;
+        const double speed = Speed(p);
+        if ((std::abs(error) < 1e-12) || (speed < 1e-12)) {
+          break;
+        }
+        p = geom::Math::Clamp(p - error / speed, p0, p_end);
+      }
+      return SampleAt(p);
+    }
+
+  private:
+
+    static constexpr size_t Panels = 32u;
+
+    double PanelStart(size_t i) const {
+      return _range * static_cast<double>(i) / static_cast<double>(Panels);
+    }
+
+    static double Value(const std::array<double, 4u> &k, double p) {
+      return k[0u] + p * (k[1u] + p * (k[2u] + p * k[3u]));
+    }
+
+    static double Derivative(const std::array<double, 4u> &k, double p) {
+      return k[1u] + p * (2.0 * k[2u] + p * 3.0 * k[3u]);
+    }
+
+    static double SecondDerivative(const std::array<double, 4u> &k, double p) {
+      return 2.0 * k[2u] + 6.0 * k[3u] * p;
+    }
+
+    double Speed(double p) const {
+      return std::hypot(Derivative(_u, p), Derivative(_v, p));
+    }
+
+    /// Five-point Gauss-Legendre quadrature of the speed in [a, b].
+    double ArcLength(double a, double b) const {
+      constexpr double x1 = 0.5384693101056831;
+      constexpr double x2 = 0.9061798459386640;
+      constexpr double w0 = 0.5688888888888889;
+      constexpr double w1 = 0.4786286704993665;
+      constexpr double w2 = 0.2369268850561891;
+      const double half = 0.5 * (b - a);
+      const double mid = 0.5 * (a + b);
+      return half * (
+          w0 * Speed(mid) +
+          w1 * (Speed(mid - half * x1) + Speed(mid + half * x1)) +
+          w2 * (Speed(mid - half * x2) + Speed(mid + half * x2)));
+    }
+
+    Sample SampleAt(double p) const {
+      const double du = Derivative(_u, p);
+      const double dv = Derivative(_v, p);
+      const double speed = std::hypot(du, dv);
+      Sample result;
+      result.x = Value(_u, p);
+      result.y = Value(_v, p);
+      result.heading = std::atan2(dv, du);
+      result.curvature = (speed > 1e-12) ?
+          (du * SecondDerivative(_v, p) - dv * SecondDerivative(_u, p)) / (speed * speed * speed) :
+          0.0;
+      return result;
+    }
+
+    std::array<double, 4u> _u;
+
+    std::array<double, 4u> _v;
+
+    double _range;
+
+    std::array<double, Panels + 1u> _lengths;
+  };
+
+  constexpr size_t ParametricCubic::Panels;
+
+  GeometryPoly3::GeometryPoly3(
+      double start_offset,
+      double length,
+      double heading,
+      const geom::Location &start_pos,
+      double a,
+      double b,
+      double c,
+      double d)
+    : GeometryTabulated(GeometryType::POLY3, start_offset, length, heading, start_pos),
+      _a(a),
+      _b(b),
+      _c(c),
+      _d(d) {
+    DEBUG_ASSERT(_length > 0.0);
+    // The arc length is at least u, so u is in [0, length].
+    _curve = std::make_shared<ParametricCubic>(
+        std::array<double, 4u>{0.0, 1.0, 0.0, 0.0},
+        std::array<double, 4u>{_a, _b, _c, _d},
+        _length);
+    BuildLookupTable([this](double dist) { return EvaluateLocal(dist); });
+  }
+
+  Sample GeometryPoly3::EvaluateLocal(double dist) const {
+    return _curve->Evaluate(dist);
+  }
+
+  GeometryParamPoly3::GeometryParamPoly3(
+      double start_offset,
+      double length,
+      double heading,
+      const geom::Location &start_pos,
+      double aU,
+      double bU,
+      double cU,
+      double dU,
+      double aV,
+      double bV,
+      double cV,
+      double dV,
+      bool arc_length)
+    : GeometryTabulated(GeometryType::PARAMPOLY3, start_offset, length, heading, start_pos),
+      _aU(aU),
+      _bU(bU),
+      _cU(cU),
+      _dU(dU),
+      _aV(aV),
+      _bV(bV),
+      _cV(cV),
+      _dV(dV),
+      _arc_length(arc_length) {
+    DEBUG_ASSERT(_length > 0.0);
+    _curve = std::make_shared<ParametricCubic>(
+        std::array<double, 4u>{_aU, _bU, _cU, _dU},
+        std::array<double, 4u>{_aV, _bV, _cV, _dV},
+        _arc_length ? _length : 1.0);
+    BuildLookupTable([this](double dist) { return EvaluateLocal(dist); });
   }
 
-  /// @todo
-  std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &) const {
-    throw_exception(std::runtime_error("not implemented"));
+  Sample GeometryParamPoly3::EvaluateLocal(double dist) const {
+    return _curve->Evaluate(dist);
   }
 
 } // namespace element
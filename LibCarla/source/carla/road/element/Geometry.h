@@ -9,6 +9,11 @@
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
 namespace carla {
 namespace road {
 namespace element {
@@ -16,7 +21,9 @@ namespace element {
   enum class GeometryType : unsigned int {
     LINE,
     ARC,
-    SPIRAL
+    SPIRAL,
+    POLY3,
+    PARAMPOLY3
   };
 
   struct DirectedPoint {
@@ -58,7 +65,7 @@ namespace element {
       return _heading;
     }
 
-    const geom::Location &GetStartPosition() {
+    const geom::Location &GetStartPosition() const {
       return _start_position;
     }
 
@@ -158,7 +165,111 @@ namespace element {
     double _curvature;
   };
 
-  class GeometrySpiral final : public Geometry {
+  /// Arc-length lookup table of a curve. The curve is sampled at regular
+  /// intervals of arc length and interpolated with cubic Hermite splines; the
+  /// interval is halved until the interpolated positions at the quarters of
+  /// every interval are within MaxError of the exact ones, or a maximum
+  /// number of intervals is reached.
+  class GeometryLookupTable {
+  public:
+
+    /// Maximum distance between interpolated and exact positions [meters].
+    static constexpr double MaxError = 1e-4;
+
+    /// Position, heading and curvature of a curve at an arc length.
+    struct Sample {
+      double x;
+      double y;
+      double heading;
+      double curvature;
+    };
+
+    GeometryLookupTable() = default;
+
+    /// Build the table of a curve of @a length, @a evaluate returns the
+    /// exact sample at an arc length.
+    GeometryLookupTable(double length, const std::function<Sample(double)> &evaluate);
+
+    size_t GetNumberOfSamples() const {
+      return _samples.size();
+    }
+
+    /// Whether the interpolation is within MaxError. False if the maximum
+    /// number of intervals was reached first.
+    bool IsAccurate() const {
+      return _is_accurate;
+    }
+
+    /// Interpolated sample at arc length @a dist, clamped to the curve.
+    Sample Evaluate(double dist) const;
+
+    /// Same as Geometry::DistanceTo.
+    std::pair<float, float> DistanceTo(const geom::Location &p) const;
+
+    /// Same as above, but the closest point found in the table is refined on
+    /// @a evaluate, the exact samples of the curve.
+    std::pair<float, float> DistanceTo(
+        const geom::Location &p,
+        const std::function<Sample(double)> &evaluate) const;
+
+  private:
+
+    template <typename EvaluateT>
+    std::pair<float, float> DistanceToImpl(const geom::Location &p, const EvaluateT &evaluate) const;
+
+    bool _is_accurate = true;
+
+    double _length = 0.0;
+
+    double _step = 0.0;
+
+    std::vector<Sample> _samples;
+  };
+
+  /// Base of the geometries without a cheap closed form, evaluated with a
+  /// GeometryLookupTable built on construction, or exactly if the table is
+  /// not accurate.
+  class GeometryTabulated : public Geometry {
+  public:
+
+    DirectedPoint PosFromDist(double dist) const final;
+
+    std::pair<float, float> DistanceTo(const geom::Location &p) const final;
+
+    /// Exact, but much slower, evaluation of PosFromDist.
+    DirectedPoint PosFromDistExact(double dist) const;
+
+    const GeometryLookupTable &GetLookupTable() const {
+      return _table;
+    }
+
+  protected:
+
+    using Geometry::Geometry;
+
+    /// Build the lookup table from @a evaluate_local, an exact evaluation of
+    /// EvaluateLocal. Must be called by the constructor of the derived
+    /// classes.
+    void BuildLookupTable(const std::function<GeometryLookupTable::Sample(double)> &evaluate_local);
+
+    /// Exact sample at arc length @a dist, in the local frame of the
+    /// geometry (starting at the origin with heading zero).
+    virtual GeometryLookupTable::Sample EvaluateLocal(double dist) const = 0;
+
+  private:
+
+    GeometryLookupTable::Sample ToGlobal(const GeometryLookupTable::Sample &local) const;
+
+    GeometryLookupTable::Sample EvaluateGlobal(double dist) const;
+
+    GeometryLookupTable _table;
+  };
+
+  /// Parametric cubic curve evaluated by arc length, shared by GeometryPoly3
+  /// and GeometryParamPoly3.
+  class ParametricCubic;
+
+  class GeometrySpiral final : public GeometryTabulated {
   public:
 
     GeometrySpiral(
@@ -167,29 +278,140 @@ namespace element {
         double heading,
         const geom::Location &start_pos,
         double curv_s,
-        double curv_e)
-      : Geometry(GeometryType::SPIRAL, start_offset, length, heading, start_pos),
-        _curve_start(curv_s),
-        _curve_end(curv_e) {}
+        double curv_e);
 
-    double GetCurveStart() {
+    double GetCurveStart() const {
       return _curve_start;
     }
 
-    double GetCurveEnd() {
+    double GetCurveEnd() const {
       return _curve_end;
     }
 
-    DirectedPoint PosFromDist(double dist) const override;
-
-    std::pair<float, float> DistanceTo(const geom::Location &) const override;
-
   private:
 
+    GeometryLookupTable::Sample EvaluateLocal(double dist) const override;
+
     double _curve_start;
     double _curve_end;
   };
 
+  /// Cubic polynomial v(u) = a + b*u + c*u^2 + d*u^3 in the local frame.
+  class GeometryPoly3 final : public GeometryTabulated {
+  public:
+
+    GeometryPoly3(
+        double start_offset,
+        double length,
+        double heading,
+        const geom::Location &start_pos,
+        double a,
+        double b,
+        double c,
+        double d);
+
+    double GetA() const {
+      return _a;
+    }
+
+    double GetB() const {
+      return _b;
+    }
+
+    double GetC() const {
+      return _c;
+    }
+
+    double GetD() const {
+      return _d;
+    }
+
+  private:
+
+    GeometryLookupTable::Sample EvaluateLocal(double dist) const override;
+
+    double _a;
+    double _b;
+    double _c;
+    double _d;
+
+    std::shared_ptr<const ParametricCubic> _curve;
+  };
+
+  /// Parametric cubic curve (u(p), v(p)) in the local frame, with p in
+  /// [0, 1] if the range is normalized or in [0, length] otherwise.
+  class GeometryParamPoly3 final : public GeometryTabulated {
+  public:
+
+    GeometryParamPoly3(
+        double start_offset,
+        double length,
+        double heading,
+        const geom::Location &start_pos,
+        double aU,
+        double bU,
+        double cU,
+        double dU,
+        double aV,
+        double bV,
+        double cV,
+        double dV,
+        bool arc_length);
+
+    double GetAU() const {
+      return _aU;
+    }
+
+    double GetBU() const {
+      return _bU;
+    }
+
+    double GetCU() const {
+      return _cU;
+    }
+
+    double GetDU() const {
+      return _dU;
+    }
+
+    double GetAV() const {
+      return _aV;
+    }
+
+    double GetBV() const {
+      return _bV;
+    }
+
+    double GetCV() const {
+      return _cV;
+    }
+
+    double GetDV() const {
+      return _dV;
+    }
+
+    /// Whether p ranges in [0, length] ("arcLength") instead of [0, 1].
+    bool IsArcLength() const {
+      return _arc_length;
+    }
+
+  private:
+
+    GeometryLookupTable::Sample EvaluateLocal(double dist) const override;
+
+    double _aU;
+    double _bU;
+    double _cU;
+    double _dU;
+    double _aV;
+    double _bV;
+    double _cV;
+    double _dV;
+    bool _arc_length;
+
+    std::shared_ptr<const ParametricCubic> _curve;
+  };
+
 } // namespace element
 } // namespace road
 } // namespace carla
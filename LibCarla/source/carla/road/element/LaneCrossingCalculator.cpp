@@ -9,6 +9,10 @@
 
 #include "carla/geom/Location.h"
 #include "carla/road/Map.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace carla {
 namespace road {
@@ -25,85 +29,289 @@ namespace element {
       static_cast<uint32_t>(Lane::LaneType::Biking) |
       static_cast<uint32_t>(Lane::LaneType::Parking);
 
-  /// Calculate the lane markings that need to be crossed from @a lane_id_origin
-  /// to @a lane_id_destination.
-  static std::vector<LaneMarking> CrossingAtSameSection(
+  /// Maximum number of lane links walked from each end to find a lane
+  /// section both ends can be related to.
+  static constexpr unsigned MAX_LINKS = 3u;
+
+  // ===========================================================================
+  // -- Lateral positions ------------------------------------------------------
+  // ===========================================================================
+
+  // Across a lane section, the border between lanes is numbered p, increasing
+  // to the right of the road: the center lane is at 0, the outer border of the
+  // right lane -k at k, and the outer border of the left lane k at -k. Thus
+  // border p is the outer border of lane -p, and its lane marking is the one
+  // of lane -p. A lane occupies the interval between two consecutive borders,
+  // an off-road location next to a lane the interval beyond it.
+
+  /// Interval of borders [first, second] occupied by a lane or an off-road
+  /// location.
+  using LateralInterval = std::pair<int, int>;
+
+  static LateralInterval GetLateralInterval(const LaneId lane_id) {
+    return lane_id < 0 ?
+        LateralInterval{-lane_id - 1, -lane_id} :
+        LateralInterval{-lane_id, -lane_id + 1};
+  }
+
+  /// Whether @a location is to the right of the center of @a waypoint's lane,
+  /// with respect to the road's reference line.
+  static bool IsAtRightOfLane(
       const Map &map,
-      const Waypoint *w0,
-      const Waypoint *w1,
-      const bool w0_is_offroad,
-      const bool dest_is_at_right) {
-    auto w0_marks = map.GetMarkRecord(*w0);
-    auto w1_marks = map.GetMarkRecord(*w1);
-
-    if (dest_is_at_right) {
-      if (w0_is_offroad) {
-        return { LaneMarking(*w1_marks.second) };
-      } else {
-        return { LaneMarking(*w0_marks.first) };
+      const Waypoint &waypoint,
+      const geom::Location &location) {
+    const auto &road = *map.GetLane(waypoint).GetRoad();
+    const auto point = road.GetDirectedPointIn(waypoint.s);
+    const auto center = map.ComputeTransform(waypoint).location;
+    // Unreal's Y axis hack.
+    const double dx = location.x - center.x;
+    const double dy = -(location.y - center.y);
+    return (dx * std::sin(point.tangent) - dy * std::cos(point.tangent)) > 0.0;
+  }
+
+  /// Interval of the lane of @a waypoint, or if @a is_offroad the interval
+  /// next to it on the side of @a location.
+  static LateralInterval GetLateralInterval(
+      const Map &map,
+      const Waypoint &waypoint,
+      const bool is_offroad,
+      const geom::Location &location) {
+    auto interval = GetLateralInterval(waypoint.lane_id);
+    if (is_offroad) {
+      const int side = IsAtRightOfLane(map, waypoint, location) ? 1 : -1;
+      interval.first += side;
+      interval.second += side;
+    }
+    return interval;
+  }
+
+  /// Append the lane markings of the borders crossed from @a origin to
+  /// @a destination in @a section at @a s.
+  static void AddCrossedBorders(
+      const LaneSection &section,
+      const double s,
+      const LateralInterval &origin,
+      const LateralInterval &destination,
+      std::vector<LaneMarking> &result) {
+    auto add = [&](int border) {
+      const auto &lanes = section.GetLanes();
+      const auto lane = lanes.find(static_cast<LaneId>(-border));
+      if (lane != lanes.end()) {
+        const auto mark = lane->second.GetInfo<RoadInfoMarkRecord>(s);
+        if (mark != nullptr) {
+          result.emplace_back(*mark);
+        }
+      }
+    };
+    if (origin.second <= destination.first) {
+      for (int border = origin.second; border <= destination.first; ++border) {
+        add(border);
       }
-    } else {
-      if (w0_is_offroad) {
-        return { LaneMarking(*w1_marks.first) };
-      } else {
-        return { LaneMarking(*w0_marks.second) };
+    } else if (destination.second <= origin.first) {
+      for (int border = origin.first; border >= destination.second; --border) {
+        add(border);
       }
     }
-
-    return {};
   }
 
-  static bool IsOffRoad(const Map &map, const geom::Location &location) {
-    return !map.GetWaypoint(location, FLAGS).has_value();
-  }
+  // ===========================================================================
+  // -- Lane graph -------------------------------------------------------------
+  // ===========================================================================
 
-  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
-      const Map &map,
-      const geom::Location &origin,
-      const geom::Location &destination) {
-    auto w0 = map.GetClosestWaypointOnRoad(origin, FLAGS);
-    auto w1 = map.GetClosestWaypointOnRoad(destination, FLAGS);
+  /// A lane reached walking the lane graph, at the distance @a s where it is
+  /// connected, after @a links links.
+  struct ReachedLane {
+    const Lane *lane;
+    double s;
+    unsigned links;
+  };
 
-    if (!w0.has_value() || !w1.has_value()) {
-      return {};
+  /// Return the lanes connected to @a lane, including itself, within
+  /// MAX_LINKS links in either direction.
+  static std::vector<ReachedLane> WalkLaneGraph(const Lane &lane, const double s) {
+    std::vector<ReachedLane> result = {{&lane, s, 0u}};
+    auto visit = [&](const Lane *next, double next_s, unsigned links) {
+      const bool visited = std::any_of(result.begin(), result.end(), [=](const auto &item) {
+        return item.lane == next;
+      });
+      if ((next != nullptr) && !visited) {
+        result.emplace_back(ReachedLane{next, next_s, links});
+      }
+    };
+    for (size_t i = 0u; i < result.size(); ++i) {
+      const auto current = result[i];
+      if (current.links == MAX_LINKS) {
+        continue;
+      }
+      // Successors are entered at their start, predecessors left at their
+      // end, in the direction of travel of each lane.
+      for (const auto *next : current.lane->GetNextLanes()) {
+        const bool forward = next->GetId() <= 0;
+        visit(next, forward ? next->GetDistance() : next->GetDistance() + next->GetLength(), current.links + 1u);
+      }
+      for (const auto *previous : current.lane->GetPreviousLanes()) {
+        const bool forward = previous->GetId() <= 0;
+        visit(previous, forward ? previous->GetDistance() + previous->GetLength() : previous->GetDistance(), current.links + 1u);
+      }
     }
+    return result;
+  }
 
-    if (w0->road_id != w1->road_id || w0->section_id != w1->section_id) {
-      /// @todo This case should also be handled.
-      return {};
+  /// Calculate the lane markings crossed from the lane of @a w0 to the lane of
+  /// @a w1 in different lane sections, relating both lanes to the lanes of a
+  /// section reachable from both with the fewest links.
+  static std::vector<LaneMarking> CrossingAtDifferentSections(
+      const Map &map,
+      const Waypoint &w0,
+      const LateralInterval &i0,
+      const Waypoint &w1,
+      const LateralInterval &i1) {
+    const auto reached0 = WalkLaneGraph(map.GetLane(w0), w0.s);
+    const auto reached1 = WalkLaneGraph(map.GetLane(w1), w1.s);
+    const ReachedLane *best0 = nullptr;
+    const ReachedLane *best1 = nullptr;
+    for (const auto &lhs : reached0) {
+      for (const auto &rhs : reached1) {
+        if ((lhs.lane->GetLaneSection() == rhs.lane->GetLaneSection()) &&
+            ((best0 == nullptr) || (lhs.links + rhs.links < best0->links + best1->links))) {
+          best0 = &lhs;
+          best1 = &rhs;
+        }
+      }
     }
+    std::vector<LaneMarking> result;
+    if (best0 != nullptr) {
+      // Keep the offset of the off-road ends with respect to their lanes.
+      const auto l0 = GetLateralInterval(best0->lane->GetId());
+      const auto l1 = GetLateralInterval(best1->lane->GetId());
+      const auto d0 = i0.first - GetLateralInterval(w0.lane_id).first;
+      const auto d1 = i1.first - GetLateralInterval(w1.lane_id).first;
+      // Lane markings at the end nearest to the section.
+      const double s = best0->links <= best1->links ? best0->s : best1->s;
+      AddCrossedBorders(
+          *best0->lane->GetLaneSection(),
+          s,
+          {l0.first + d0, l0.second + d0},
+          {l1.first + d1, l1.second + d1},
+          result);
+    }
+    return result;
+  }
 
-    if (map.IsJunction(w0->road_id) || map.IsJunction(w1->road_id)) {
+  /// Return the lane containing @a location, or the nearest lane if
+  /// @a location is off-road.
+  static boost::optional<Waypoint> GetLane(
+      const Map &map,
+      const geom::Location &location,
+      bool &is_offroad) {
+    auto waypoint = map.GetWaypoint(location, FLAGS);
+    is_offroad = !waypoint.has_value();
+    return is_offroad ? map.GetClosestWaypointOnRoad(location, FLAGS) : waypoint;
+  }
+
+  /// Calculate the lane markings crossed from @a origin, in lane @a w0, to
+  /// @a destination, in lane @a w1.
+  static std::vector<LaneMarking> CalculateCrossing(
+      const Map &map,
+      const geom::Location &origin,
+      const geom::Location &destination,
+      const boost::optional<Waypoint> &w0,
+      const bool w0_is_offroad,
+      const boost::optional<Waypoint> &w1,
+      const bool w1_is_offroad) {
+    if (!w0.has_value() || !w1.has_value()) {
       return {};
     }
 
-    const auto w0_is_offroad = IsOffRoad(map, origin);
-    const auto w1_is_offroad = IsOffRoad(map, destination);
-
     if (w0_is_offroad && w1_is_offroad) {
       // outside the road
       return {};
     }
 
-    if ((w0->lane_id == w1->lane_id) && !w0_is_offroad && !w1_is_offroad) {
+    if ((w0->road_id == w1->road_id) &&
+        (w0->section_id == w1->section_id) &&
+        (w0->lane_id == w1->lane_id) &&
+        !w0_is_offroad && !w1_is_offroad) {
       // both at the same lane and inside the road
       return {};
     }
 
-    const auto transform = map.ComputeTransform(*w0);
-    geom::Vector3D orig_vec = transform.GetForwardVector();
-    geom::Vector3D dest_vec = (destination - origin).MakeUnitVector();
+    const auto i0 = GetLateralInterval(map, *w0, w0_is_offroad, origin);
+    const auto i1 = GetLateralInterval(map, *w1, w1_is_offroad, destination);
+    if ((w0->road_id == w1->road_id) && (w0->section_id == w1->section_id)) {
+      std::vector<LaneMarking> result;
+      const auto &section = *map.GetLane(*w0).GetLaneSection();
+      AddCrossedBorders(section, w0->s, i0, i1, result);
+      return result;
+    }
+    return CrossingAtDifferentSections(map, *w0, i0, *w1, i1);
+  }
 
-    // cross product
-    const auto dest_is_at_right =
-        (-orig_vec.x * dest_vec.y + orig_vec.y * dest_vec.x) < 0;
+  std::vector<LaneMarking> LaneCrossingCalculator::Calculate(
+      const Map &map,
+      const geom::Location &origin,
+      const geom::Location &destination) {
+    bool w0_is_offroad = true;
+    bool w1_is_offroad = true;
+    auto w0 = GetLane(map, origin, w0_is_offroad);
+    auto w1 = GetLane(map, destination, w1_is_offroad);
+    return CalculateCrossing(map, origin, destination, w0, w0_is_offroad, w1, w1_is_offroad);
+  }
+
+  /// Find the lane containing @a location, searching first around
+  /// @a previous, and leaving the search of the nearest lane for later if it
+  /// is off-road.
+  static LaneCrossingCalculator::Hint FindLane(
+      const Map &map,
+      const geom::Location &location,
+      const boost::optional<Waypoint> &previous) {
+    LaneCrossingCalculator::Hint hint;
+    hint.location = location;
+    hint.waypoint = previous.has_value() ?
+        map.GetWaypoint(location, *previous, FLAGS) :
+        map.GetWaypoint(location, FLAGS);
+    hint.is_offroad = !hint.waypoint.has_value();
+    hint.is_valid = true;
+    return hint;
+  }
 
-    return CrossingAtSameSection(
-        map,
-        &*w0,
-        &*w1,
-        w0_is_offroad,
-        dest_is_at_right);
+  static void FindNearestLane(const Map &map, LaneCrossingCalculator::Hint &hint) {
+    if (hint.is_offroad && !hint.waypoint.has_value()) {
+      hint.waypoint = map.GetClosestWaypointOnRoad(hint.location, FLAGS);
+    }
+  }
+
+  std::vector<std::vector<LaneMarking>> LaneCrossingCalculator::CalculateBatch(
+      const Map &map,
+      const std::vector<Segment> &segments,
+      std::vector<Hint> &hints) {
+    hints.resize(segments.size());
+    std::vector<std::vector<LaneMarking>> result(segments.size());
+    for (size_t i = 0u; i < segments.size(); ++i) {
+      const auto &origin = segments[i].first;
+      const auto &destination = segments[i].second;
+      auto &hint = hints[i];
+      if (!hint.is_valid || !(hint.location == origin)) {
+        hint = FindLane(map, origin, hint.waypoint);
+      }
+      auto next = FindLane(map, destination, hint.waypoint);
+      // No lane is crossed if both ends are off-road, there is no need to
+      // search the nearest lanes.
+      if (!hint.is_offroad || !next.is_offroad) {
+        FindNearestLane(map, hint);
+        FindNearestLane(map, next);
+        result[i] = CalculateCrossing(
+            map,
+            origin,
+            destination,
+            hint.waypoint,
+            hint.is_offroad,
+            next.waypoint,
+            next.is_offroad);
+      }
+      hint = std::move(next);
+    }
+    return result;
   }
 
 } // namespace element
@@ -6,12 +6,16 @@
 
 #pragma once
 
+#include "carla/geom/Location.h"
 #include "carla/road/element/LaneMarking.h"
+#include "carla/road/element/Waypoint.h"
 
+#include <boost/optional.hpp>
+
+#include <utility>
 #include <vector>
 
 namespace carla {
-namespace geom { class Location; }
 namespace road {
 
   class Map;
@@ -21,10 +25,40 @@ namespace element {
   class LaneCrossingCalculator {
   public:
 
+    /// Lane found at the destination of a segment, reused as the lane at the
+    /// origin of the next segment if it starts at the same location.
+    struct Hint {
+      geom::Location location;
+      /// Lane containing the location. If off-road, the nearest lane, only
+      /// searched once it is needed.
+      boost::optional<Waypoint> waypoint;
+      bool is_offroad = true;
+      bool is_valid = false;
+    };
+
+    using Segment = std::pair<geom::Location, geom::Location>;
+
+    /// Calculate the lane markings crossed from @a origin to @a destination,
+    /// in order. If they are in different lane sections, roads or junctions,
+    /// their lanes are related through a lane section connected to both by
+    /// the fewest lane links.
     static std::vector<LaneMarking> Calculate(
         const Map &map,
         const geom::Location &origin,
         const geom::Location &destination);
+
+    /// Calculate the lane markings crossed by each of @a segments.
+    ///
+    /// @a hints keeps one hint per segment between calls, e.g. one per
+    /// bounding box corner of each vehicle; if a segment starts where the
+    /// previous segment at the same index ended, the lane at its origin is
+    /// not searched again, and the lane at its destination is searched first
+    /// around the lane at its origin. The result is the same as calling
+    /// Calculate for each segment, except where lanes overlap.
+    static std::vector<std::vector<LaneMarking>> CalculateBatch(
+        const Map &map,
+        const std::vector<Segment> &segments,
+        std::vector<Hint> &hints);
   };
 
 } // namespace element
@@ -30,6 +30,10 @@ namespace element {
       : RoadInfo(s),
         _width(a, b, c, d, s) {}
 
+    RoadInfoLaneWidth(double s, const geom::CubicPolynomial &width)
+      : RoadInfo(s),
+        _width(width) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final {
       v.Visit(*this);
     }
@@ -13,6 +13,9 @@
 
 namespace carla {
 namespace road {
+
+  class CompiledMap;
+
 namespace general {
 
   class Validity : private MovableNonCopyable {
@@ -26,8 +29,18 @@ namespace general {
         _from_lane(from_lane),
         _to_lane(to_lane) {}
 
+    road::LaneId GetFromLane() const {
+      return _from_lane;
+    }
+
+    road::LaneId GetToLane() const {
+      return _to_lane;
+    }
+
   private:
 
+    friend road::CompiledMap;
+
 #if defined(__clang__)
 #  pragma clang diagnostic push
 #  pragma clang diagnostic ignored "-Wunused-private-field"
@@ -16,6 +16,9 @@
 
 namespace carla {
 namespace road {
+
+  class CompiledMap;
+
 namespace signal {
 
   class Signal : private MovableNonCopyable {
@@ -69,8 +72,67 @@ namespace signal {
       _dependencies.push_back(std::move(dependency));
     }
 
+    road::RoadId GetRoadId() const {
+      return _road_id;
+    }
+
+    road::SignId GetSignalId() const {
+      return _signal_id;
+    }
+
+    double GetS() const {
+      return _s;
+    }
+
+    double GetT() const {
+      return _t;
+    }
+
+    const std::string &GetName() const {
+      return _name;
+    }
+
+    /// Whether the signal changes its state, e.g. traffic lights.
+    bool IsDynamic() const {
+      return _dynamic == "yes";
+    }
+
+    const std::string &GetOrientation() const {
+      return _orientation;
+    }
+
+    const std::string &GetCountry() const {
+      return _country;
+    }
+
+    const std::string &GetType() const {
+      return _type;
+    }
+
+    const std::string &GetSubtype() const {
+      return _subtype;
+    }
+
+    double GetValue() const {
+      return _value;
+    }
+
+    const std::string &GetUnit() const {
+      return _unit;
+    }
+
+    const std::string &GetText() const {
+      return _text;
+    }
+
+    const std::vector<general::Validity> &GetValidities() const {
+      return _validities;
+    }
+
   private:
 
+    friend road::CompiledMap;
+
 #if defined(__clang__)
 #  pragma clang diagnostic push
 #  pragma clang diagnostic ignored "-Wunused-private-field"
@@ -14,6 +14,9 @@
 
 namespace carla {
 namespace road {
+
+  class CompiledMap;
+
 namespace signal {
 
   class SignalReference : private MovableNonCopyable {
@@ -35,8 +38,35 @@ namespace signal {
       _validities.push_back(std::move(validity));
     }
 
+    road::RoadId GetRoadId() const {
+      return _road_id;
+    }
+
+    /// Id of the referenced signal.
+    road::SignId GetSignalId() const {
+      return _signal_id;
+    }
+
+    double GetS() const {
+      return _s;
+    }
+
+    double GetT() const {
+      return _t;
+    }
+
+    const std::string &GetOrientation() const {
+      return _orientation;
+    }
+
+    const std::vector<general::Validity> &GetValidities() const {
+      return _validities;
+    }
+
   private:
 
+    friend road::CompiledMap;
+
 #if defined(__clang__)
 #  pragma clang diagnostic push
 #  pragma clang diagnostic ignored "-Wunused-private-field"
@@ -7,9 +7,13 @@
 #pragma once
 
 #include "carla/Buffer.h"
+#include "carla/Exception.h"
 #include "carla/Memory.h"
 #include "carla/sensor/CompileTimeTypeMap.h"
 #include "carla/sensor/RawData.h"
+#include "carla/sensor/RuntimeSensorRegistry.h"
+
+#include <stdexcept>
 
 namespace carla {
 namespace sensor {
@@ -24,6 +28,9 @@ namespace sensor {
   /// appropriate serializer is called for each sensor to serialize and
   /// deserialize its data.
   ///
+  /// The data of sensor types past the ones of the map is deserialized by the
+  /// RuntimeSensorRegistry.
+  ///
   /// Do not use directly, use the SensorRegistry instantiation.
   template <typename... Items>
   class CompositeSerializer : public CompileTimeTypeMap<Items...> {
@@ -40,33 +47,35 @@ namespace sensor {
 
     /// Deserializes a Buffer by calling the "Deserialize" function of the
     /// serializer that generated the Buffer.
+    ///
+    /// @throw std::runtime_error if the version of the wire format, the
+    /// sensor type or the payload type of the Buffer do not match this
+    /// registry, or the payload is malformed.
     static interpreted_type Deserialize(Buffer &&data);
 
   private:
 
-    template <size_t Index, typename Data>
-    static interpreted_type Deserialize_impl(Data &&data) {
+    template <size_t Index>
+    static interpreted_type Deserialize_impl(RawData &&data) {
       using Serializer = typename Super::template get_by_index<Index>::type;
-      return Serializer::Deserialize(std::forward<Data>(data));
+      if (data.GetPayloadType() != Serializer::payload_type) {
+        throw_exception(std::runtime_error("invalid sensor data: payload type mismatch"));
+      }
+      return Serializer::Deserialize(std::move(data));
     }
 
-    template <typename Data, size_t... Is>
-    static interpreted_type Deserialize_impl(size_t i, Data &&data, std::index_sequence<Is...>) {
-      // This function is equivalent to creating a switch statement with a case
-      // for each element in the map, the compiler should be able to optimize it
-      // into a jump table. See https://stackoverflow.com/a/46282159/5308925.
-      interpreted_type result;
-      std::initializer_list<int> ({
-          (i == Is ? (result = Deserialize_impl<Is>(std::forward<Data>(data))), 0 : 0)...
-      });
-      return result;
+    template <size_t... Is>
+    static interpreted_type Deserialize_impl(size_t i, RawData &&data, std::index_sequence<Is...>) {
+      // Dense table of the deserializers indexed by sensor type, the same
+      // lookup used by the RuntimeSensorRegistry.
+      static constexpr interpreted_type (*table[])(RawData &&) = {&Deserialize_impl<Is>...};
+      return table[i](std::move(data));
     }
 
-    template <typename Data>
-    static interpreted_type Deserialize(size_t index, Data &&data) {
+    static interpreted_type Deserialize(size_t index, RawData &&data) {
       return Deserialize_impl(
           index,
-          std::forward<Data>(data),
+          std::move(data),
           std::make_index_sequence<Super::size()>());
     }
   };
@@ -86,9 +95,18 @@ namespace sensor {
   template <typename... Items>
   inline typename CompositeSerializer<Items...>::interpreted_type
   CompositeSerializer<Items...>::Deserialize(Buffer &&data) {
+    if (data.size() < s11n::SensorHeaderSerializer::header_offset) {
+      throw_exception(std::runtime_error("invalid sensor data: truncated header"));
+    }
     RawData message{std::move(data)};
-    size_t index = message.GetSensorTypeId();
-    return Deserialize(index, std::move(message));
+    if (message.GetVersion() != s11n::SensorHeaderSerializer::Version) {
+      throw_exception(std::runtime_error("invalid sensor data: unsupported version"));
+    }
+    const auto index = message.GetSensorTypeId();
+    if (index >= Super::size()) {
+      return RuntimeSensorRegistry::Deserialize(std::move(message));
+    }
+    return Deserialize(static_cast<size_t>(index), std::move(message));
   }
 
 } // namespace sensor
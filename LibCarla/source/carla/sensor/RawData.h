@@ -27,6 +27,16 @@ namespace sensor {
 
   public:
 
+    /// Version of the wire format of the data.
+    uint32_t GetVersion() const {
+     return GetHeader().version;
+    }
+
+    /// Layout of the data generated by the sensor.
+    s11n::PayloadType GetPayloadType() const {
+     return GetHeader().payload_type;
+    }
+
     /// Type-id of the sensor that generated the data.
     uint64_t GetSensorTypeId() const {
      return GetHeader().sensor_type;
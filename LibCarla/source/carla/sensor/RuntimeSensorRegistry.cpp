@@ -0,0 +1,45 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/RuntimeSensorRegistry.h"
+
+#include "carla/sensor/SensorRegistry.h"
+
+namespace carla {
+namespace sensor {
+
+  static_assert(
+      SensorRegistry::size() <= RuntimeSensorRegistry::FirstId,
+      "The ids of the SensorRegistry overlap the ids registered at runtime");
+
+  // Zero-initialized, i.e., no deserializer registered.
+  std::array<std::atomic<RuntimeSensorRegistry::DeserializeFunction>, RuntimeSensorRegistry::Capacity>
+      RuntimeSensorRegistry::_table;
+
+  static size_t GetSlot(const uint64_t id) {
+    const uint64_t slot = id - RuntimeSensorRegistry::FirstId;
+    if (!(slot < RuntimeSensorRegistry::Capacity)) {
+      throw_exception(std::invalid_argument("sensor type id out of the range of runtime sensors"));
+    }
+    return static_cast<size_t>(slot);
+  }
+
+  void RuntimeSensorRegistry::Register(const uint64_t id, const DeserializeFunction deserialize) {
+    if (deserialize == nullptr) {
+      throw_exception(std::invalid_argument("invalid deserialize function"));
+    }
+    DeserializeFunction expected = nullptr;
+    if (!_table[GetSlot(id)].compare_exchange_strong(expected, deserialize, std::memory_order_acq_rel)) {
+      throw_exception(std::invalid_argument("sensor type id already registered"));
+    }
+  }
+
+  void RuntimeSensorRegistry::Unregister(const uint64_t id) {
+    _table[GetSlot(id)].store(nullptr, std::memory_order_release);
+  }
+
+} // namespace sensor
+} // namespace carla
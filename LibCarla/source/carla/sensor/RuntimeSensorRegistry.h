@@ -0,0 +1,92 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Exception.h"
+#include "carla/Memory.h"
+#include "carla/sensor/RawData.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+namespace carla {
+namespace sensor {
+
+  class SensorData;
+
+  /// Deserializers registered at runtime, for sensors that are not part of
+  /// the compile-time SensorRegistry. Each one is keyed by a sensor type id
+  /// in [FirstId, FirstId + Capacity), agreed between the server, that
+  /// writes it in the header of each message with s11n::PayloadType::Custom,
+  /// and the client, that registers the deserializer before subscribing to
+  /// the sensor.
+  ///
+  /// The deserializers are kept in a dense array indexed by id, so looking
+  /// one up is a bounds check and an atomic load. Registering is thread-safe
+  /// and may happen while data is being received.
+  class RuntimeSensorRegistry {
+  public:
+
+    using DeserializeFunction = SharedPtr<SensorData> (*)(RawData &&data);
+
+    /// First sensor type id available, far from the ids of the SensorRegistry
+    /// so these do not change when built-in sensors are added.
+    static constexpr uint64_t FirstId = 256u;
+
+    /// Maximum number of sensor types registered at runtime.
+    static constexpr size_t Capacity = 256u;
+
+    /// Register @a deserialize for the data of the sensors of type @a id.
+    ///
+    /// @throw std::invalid_argument if @a id is out of range or already
+    /// registered.
+    static void Register(uint64_t id, DeserializeFunction deserialize);
+
+    /// Register the Deserialize function of @a SerializerT, a serializer like
+    /// the ones of the SensorRegistry.
+    template <typename SerializerT>
+    static void Register(uint64_t id) {
+      Register(id, &SerializerT::Deserialize);
+    }
+
+    /// Remove the deserializer of the sensors of type @a id, if any.
+    ///
+    /// @throw std::invalid_argument if @a id is out of range.
+    static void Unregister(uint64_t id);
+
+    /// Deserializer of the sensors of type @a id, nullptr if none.
+    static DeserializeFunction Get(uint64_t id) {
+      // Ids below FirstId wrap around and fail the check too.
+      const uint64_t slot = id - FirstId;
+      return slot < Capacity ? _table[slot].load(std::memory_order_acquire) : nullptr;
+    }
+
+    /// Deserialize @a data with the deserializer registered for its sensor
+    /// type.
+    ///
+    /// @throw std::runtime_error if there is none or the payload type is not
+    /// s11n::PayloadType::Custom.
+    static SharedPtr<SensorData> Deserialize(RawData &&data) {
+      const auto deserialize = Get(data.GetSensorTypeId());
+      if (deserialize == nullptr) {
+        throw_exception(std::runtime_error("invalid sensor data: unknown sensor type"));
+      }
+      if (data.GetPayloadType() != s11n::PayloadType::Custom) {
+        throw_exception(std::runtime_error("invalid sensor data: payload type mismatch"));
+      }
+      return deserialize(std::move(data));
+    }
+
+  private:
+
+    static std::array<std::atomic<DeserializeFunction>, Capacity> _table;
+  };
+
+} // namespace sensor
+} // namespace carla
@@ -42,6 +42,9 @@ namespace sensor {
   ///
   /// Use s11n::NoopSerializer if the sensor does not send data (sensors that
   /// work only on client-side).
+  ///
+  /// Sensors that cannot be added here, e.g. to avoid recompiling LibCarla,
+  /// may register their deserializer at runtime in the RuntimeSensorRegistry.
   using SensorRegistry = CompositeSerializer<
     std::pair<FWorldObserver *, s11n::EpisodeStateSerializer>,
     std::pair<ASceneCaptureCamera *, s11n::ImageSerializer>,
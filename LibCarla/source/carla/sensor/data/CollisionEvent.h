@@ -7,11 +7,12 @@
 #pragma once
 
 #include "carla/Debug.h"
-#include "carla/client/detail/ActorVariant.h"
 #include "carla/geom/Vector3D.h"
 #include "carla/sensor/SensorData.h"
 #include "carla/sensor/s11n/CollisionEventSerializer.h"
 
+#include <mutex>
+
 namespace carla {
 namespace sensor {
 namespace data {
@@ -25,36 +26,56 @@ namespace data {
 
     friend Serializer;
 
-    explicit CollisionEvent(const RawData &data)
+    explicit CollisionEvent(RawData data)
       : Super(data),
-        _self_actor(Serializer::DeserializeRawData(data).self_actor),
-        _other_actor(Serializer::DeserializeRawData(data).other_actor),
-        _normal_impulse(Serializer::DeserializeRawData(data).normal_impulse) {}
+        _data(std::move(data)) {}
+
+  private:
+
+    const Serializer::Data &GetData() const {
+      return Serializer::DeserializeRawData(_data);
+    }
+
+    /// The actor is retrieved from the episode only the first time, even if
+    /// called from several threads.
+    SharedPtr<client::Actor> GetCachedActor(
+        const s11n::SerializedActor &serialized,
+        std::once_flag &flag,
+        SharedPtr<client::Actor> &cached) const {
+      std::call_once(flag, [&]() {
+        cached = serialized.Get(GetEpisode().Lock());
+      });
+      return cached;
+    }
 
   public:
 
     /// Get "self" actor. Actor that measured the collision.
     SharedPtr<client::Actor> GetActor() const {
-      return _self_actor.Get(GetEpisode());
+      return GetCachedActor(GetData().self_actor, _self_actor_flag, _self_actor);
     }
 
     /// Get the actor to which we collided.
     SharedPtr<client::Actor> GetOtherActor() const {
-      return _other_actor.Get(GetEpisode());
+      return GetCachedActor(GetData().other_actor, _other_actor_flag, _other_actor);
     }
 
     /// Normal impulse result of the collision.
-    const geom::Vector3D &GetNormalImpulse() const {
-      return _normal_impulse;
+    geom::Vector3D GetNormalImpulse() const {
+      return GetData().normal_impulse;
     }
 
   private:
 
-    client::detail::ActorVariant _self_actor;
+    RawData _data;
+
+    mutable std::once_flag _self_actor_flag;
+
+    mutable SharedPtr<client::Actor> _self_actor;
 
-    client::detail::ActorVariant _other_actor;
+    mutable std::once_flag _other_actor_flag;
 
-    geom::Vector3D _normal_impulse;
+    mutable SharedPtr<client::Actor> _other_actor;
   };
 
 } // namespace data
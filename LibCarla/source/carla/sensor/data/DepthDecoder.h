@@ -0,0 +1,84 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+#include "carla/sensor/data/Color.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// Decoding of the images of the depth camera. The depth of each pixel is
+  /// a 24-bit integer stored in the red (lowest byte), green and blue
+  /// channels, the maximum value being MaxDepth meters.
+  class DepthDecoder {
+  public:
+
+    /// Depth of the maximum encoded value [meters].
+    static constexpr float MaxDepth = 1000.0f;
+
+    /// Depth in meters encoded in @a color. Computed in float, with a
+    /// relative error below 1e-6 with respect to the exact value.
+    static float DecodeMeters(const Color &color) {
+      constexpr float meters_per_unit = MaxDepth / static_cast<float>(256 * 256 * 256 - 1);
+      const uint32_t depth =
+          static_cast<uint32_t>(color.r) |
+          (static_cast<uint32_t>(color.g) << 8u) |
+          (static_cast<uint32_t>(color.b) << 16u);
+      return static_cast<float>(depth) * meters_per_unit;
+    }
+
+    /// Decode the depth in meters of each pixel of [@a begin, @a end) to
+    /// @a out, in a single branch-free pass the compiler can vectorize.
+    static void DecodeMeters(const Color *begin, const Color *end, float *out) {
+      for (; begin != end; ++begin, ++out) {
+        *out = DecodeMeters(*begin);
+      }
+    }
+
+    /// Back-project the @a width x @a height @a depths in meters of an image
+    /// with horizontal field of view @a fov_angle degrees to points in the
+    /// camera frame, x forward, y right and z up, writing them to @a out.
+    /// Each point is at the center of its pixel. Pixels at @a max_depth or
+    /// farther, like the sky, are skipped.
+    ///
+    /// @return the number of points written, at most @a width x @a height.
+    static size_t BackProject(
+        const float *depths,
+        uint32_t width,
+        uint32_t height,
+        float fov_angle,
+        float max_depth,
+        geom::Location *out) {
+      const float focal_length =
+          static_cast<float>(width) / (2.0f * std::tan(geom::Math::ToRadians(fov_angle) / 2.0f));
+      const float inverse_focal_length = 1.0f / focal_length;
+      const float center_x = static_cast<float>(width) / 2.0f;
+      const float center_y = static_cast<float>(height) / 2.0f;
+      size_t count = 0u;
+      for (uint32_t v = 0u; v < height; ++v) {
+        const float z = (center_y - (static_cast<float>(v) + 0.5f)) * inverse_focal_length;
+        for (uint32_t u = 0u; u < width; ++u, ++depths) {
+          const float depth = *depths;
+          const float y = ((static_cast<float>(u) + 0.5f) - center_x) * inverse_focal_length;
+          out[count] = geom::Location{depth, y * depth, z * depth};
+          count += (depth < max_depth) ? 1u : 0u;
+        }
+      }
+      return count;
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -7,9 +7,14 @@
 #pragma once
 
 #include "carla/Debug.h"
+#include "carla/geom/Location.h"
 #include "carla/sensor/data/Array.h"
+#include "carla/sensor/data/DepthDecoder.h"
+#include "carla/sensor/data/LabelExtractor.h"
 #include "carla/sensor/s11n/ImageSerializer.h"
 
+#include <vector>
+
 namespace carla {
 namespace sensor {
 namespace data {
@@ -53,6 +58,41 @@ namespace data {
     auto GetFOVAngle() const {
       return GetHeader().fov_angle;
     }
+
+    /// Decode the depth encoded by the depth camera in each pixel to meters,
+    /// writing size() floats to @a out, row by row. See DepthDecoder.
+    void DecodeDepthMeters(float *out) const {
+      DepthDecoder::DecodeMeters(Super::begin(), Super::end(), out);
+    }
+
+    /// Decode the depth encoded by the depth camera and back-project each
+    /// pixel closer than @a max_depth meters to a point in the camera frame,
+    /// x forward, y right and z up. See DepthDecoder::BackProject.
+    std::vector<geom::Location> DecodeDepthPointCloud(
+        float max_depth = DepthDecoder::MaxDepth) const {
+      std::vector<float> depths(Super::size());
+      DecodeDepthMeters(depths.data());
+      std::vector<geom::Location> result(depths.size());
+      result.resize(DepthDecoder::BackProject(
+          depths.data(),
+          GetWidth(),
+          GetHeight(),
+          GetFOVAngle(),
+          max_depth,
+          result.data()));
+      return result;
+    }
+
+    /// Extract the labels of the semantic segmentation camera, writing
+    /// size() labels to @a labels, row by row, and the pixel count and
+    /// bounding rectangle of each label to @a counts and @a boxes, of
+    /// LabelExtractor::NumberOfLabels elements. See LabelExtractor.
+    void ExtractLabels(
+        uint8_t *labels,
+        uint32_t *counts,
+        LabelExtractor::Box *boxes) const {
+      LabelExtractor::Extract(Super::data(), GetWidth(), GetHeight(), labels, counts, boxes);
+    }
   };
 
 } // namespace data
@@ -0,0 +1,81 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Color.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace sensor {
+namespace data {
+
+  /// Extraction of the labels of the images of the semantic segmentation
+  /// camera, the label (tag) of each pixel is stored in the red channel.
+  class LabelExtractor {
+  public:
+
+    /// Number of distinct labels, any value of the red channel.
+    static constexpr size_t NumberOfLabels = 256u;
+
+    /// Bounding rectangle of the pixels of a label, bounds included. All -1
+    /// if the label does not appear.
+    struct Box {
+      int32_t min_x;
+      int32_t min_y;
+      int32_t max_x;
+      int32_t max_y;
+    };
+
+    /// Write the label of each pixel of the @a width x @a height @a pixels
+    /// to @a labels, and the number of pixels and the bounding rectangle of
+    /// each label to @a counts and @a boxes, of NumberOfLabels elements.
+    ///
+    /// Single pass, row by row: the labels of a row are extracted in a
+    /// branch-free loop the compiler can vectorize, then the statistics are
+    /// updated once per run of equal labels, runs being long in segmentation
+    /// images.
+    static void Extract(
+        const Color *pixels,
+        uint32_t width,
+        uint32_t height,
+        uint8_t *labels,
+        uint32_t *counts,
+        Box *boxes) {
+      std::fill(counts, counts + NumberOfLabels, 0u);
+      std::fill(boxes, boxes + NumberOfLabels, Box{-1, -1, -1, -1});
+      for (uint32_t y = 0u; y < height; ++y, pixels += width, labels += width) {
+        for (uint32_t x = 0u; x < width; ++x) {
+          labels[x] = pixels[x].r;
+        }
+        for (uint32_t x = 0u; x < width;) {
+          const uint8_t label = labels[x];
+          uint32_t end = x + 1u;
+          while ((end < width) && (labels[end] == label)) {
+            ++end;
+          }
+          counts[label] += end - x;
+          auto &box = boxes[label];
+          const auto row = static_cast<int32_t>(y);
+          if (box.min_y < 0) {
+            box = {static_cast<int32_t>(x), row, static_cast<int32_t>(end - 1u), row};
+          } else {
+            box.min_x = std::min(box.min_x, static_cast<int32_t>(x));
+            box.max_x = std::max(box.max_x, static_cast<int32_t>(end - 1u));
+            box.max_y = row;
+          }
+          x = end;
+        }
+      }
+    }
+  };
+
+} // namespace data
+} // namespace sensor
+} // namespace carla
@@ -26,10 +26,10 @@ namespace data {
 
     friend Serializer;
 
-    explicit LidarMeasurement(RawData data)
-      : Super(std::move(data)) {
-      Super::SetOffset(Serializer::GetHeaderOffset(Super::GetRawData()));
-    }
+    /// The offset is computed before moving @a data, the Array checks on
+    /// construction that the points are a whole number of locations.
+    LidarMeasurement(size_t header_offset, RawData data)
+      : Super(header_offset, std::move(data)) {}
 
   private:
 
@@ -37,6 +37,15 @@ namespace data {
       return Serializer::DeserializeHeader(Super::GetRawData());
     }
 
+    template <typename T>
+    const T *GetAttribute(size_t offset) const {
+      if (!HasAttributes()) {
+        return nullptr;
+      }
+      const auto *begin = Super::GetRawData().begin() + GetHeader().GetSize();
+      return reinterpret_cast<const T *>(begin + offset);
+    }
+
   public:
 
     /// Horizontal angle of the Lidar at the time of the measurement.
@@ -55,6 +64,31 @@ namespace data {
     auto GetPointCount(size_t channel) const {
       return GetHeader().GetPointCount(channel);
     }
+
+    /// Whether the measurement carries the intensity, time offset and channel
+    /// of each point.
+    bool HasAttributes() const {
+      return GetHeader().HasAttributes();
+    }
+
+    /// Array with the intensity of each point, or nullptr if the measurement
+    /// has no attributes.
+    const float *GetIntensities() const {
+      return GetAttribute<float>(0u);
+    }
+
+    /// Array with the time offset in seconds of each point relative to the
+    /// timestamp of the measurement, or nullptr if the measurement has no
+    /// attributes.
+    const float *GetTimeOffsets() const {
+      return GetAttribute<float>(sizeof(float) * size());
+    }
+
+    /// Array with the channel of each point, or nullptr if the measurement has
+    /// no attributes.
+    const uint16_t *GetChannels() const {
+      return GetAttribute<uint16_t>(2u * sizeof(float) * size());
+    }
   };
 
 } // namespace data
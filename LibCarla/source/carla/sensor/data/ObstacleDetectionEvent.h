@@ -7,10 +7,10 @@
 #pragma once
 
 #include "carla/Debug.h"
-#include "carla/client/detail/ActorVariant.h"
 #include "carla/sensor/SensorData.h"
 #include "carla/sensor/s11n/ObstacleDetectionEventSerializer.h"
 
+#include <mutex>
 
 namespace carla {
 namespace sensor {
@@ -25,40 +25,56 @@ namespace data {
 
     friend Serializer;
 
-    explicit ObstacleDetectionEvent(const RawData &data)
+    explicit ObstacleDetectionEvent(RawData data)
       : Super(data),
-        _self_actor(nullptr),
-        _other_actor(nullptr) {
-      auto ddata = Serializer::DeserializeRawData(data);
-      _self_actor = std::move(ddata.self_actor);
-      _other_actor = std::move(ddata.other_actor);
-      _distance = ddata.distance;
+        _data(std::move(data)) {}
+
+  private:
+
+    const Serializer::Data &GetData() const {
+      return Serializer::DeserializeRawData(_data);
+    }
+
+    /// The actor is retrieved from the episode only the first time, even if
+    /// called from several threads.
+    SharedPtr<client::Actor> GetCachedActor(
+        const s11n::SerializedActor &serialized,
+        std::once_flag &flag,
+        SharedPtr<client::Actor> &cached) const {
+      std::call_once(flag, [&]() {
+        cached = serialized.Get(GetEpisode().Lock());
+      });
+      return cached;
     }
 
   public:
 
     /// Get "self" actor. Actor that measured the collision.
     SharedPtr<client::Actor> GetActor() const {
-      return _self_actor.Get(GetEpisode());
+      return GetCachedActor(GetData().self_actor, _self_actor_flag, _self_actor);
     }
 
     /// Get the actor to which we collided.
     SharedPtr<client::Actor> GetOtherActor() const {
-      return _other_actor.Get(GetEpisode());
+      return GetCachedActor(GetData().other_actor, _other_actor_flag, _other_actor);
     }
 
     /// Get obstacle distance.
     float GetDistance() const {
-      return _distance;
+      return GetData().distance;
     }
 
   private:
 
-    client::detail::ActorVariant _self_actor;
+    RawData _data;
+
+    mutable std::once_flag _self_actor_flag;
+
+    mutable SharedPtr<client::Actor> _self_actor;
 
-    client::detail::ActorVariant _other_actor;
+    mutable std::once_flag _other_actor_flag;
 
-    float _distance;
+    mutable SharedPtr<client::Actor> _other_actor;
   };
 
 } // namespace data
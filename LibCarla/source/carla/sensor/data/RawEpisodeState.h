@@ -25,9 +25,7 @@ namespace data {
     friend Serializer;
 
     explicit RawEpisodeState(RawData data)
-      : Super(std::move(data)) {
-      Super::SetOffset(Serializer::header_offset);
-    }
+      : Super(Serializer::header_offset, std::move(data)) {}
 
   private:
 
@@ -4,14 +4,20 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/Exception.h"
 #include "carla/sensor/data/CollisionEvent.h"
 #include "carla/sensor/s11n/CollisionEventSerializer.h"
 
+#include <stdexcept>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> CollisionEventSerializer::Deserialize(RawData &&data) {
+    if (data.size() != sizeof(Data)) {
+      throw_exception(std::runtime_error("CollisionEventSerializer: invalid data size"));
+    }
     return SharedPtr<SensorData>(new data::CollisionEvent(std::move(data)));
   }
 
@@ -12,6 +12,7 @@
 #include "carla/rpc/Actor.h"
 #include "carla/geom/Vector3D.h"
 #include "carla/sensor/RawData.h"
+#include "carla/sensor/s11n/SerializedActor.h"
 
 namespace carla {
 namespace sensor {
@@ -20,34 +21,40 @@ namespace sensor {
 
 namespace s11n {
 
-  /// Serializes the current state of the whole episode.
+  /// Serializes the collision events, in a fixed layout read in place.
   class CollisionEventSerializer {
   public:
 
+#pragma pack(push, 1)
     struct Data {
 
-      rpc::Actor self_actor;
+      SerializedActor self_actor;
 
-      rpc::Actor other_actor;
+      SerializedActor other_actor;
 
       geom::Vector3D normal_impulse;
-
-      MSGPACK_DEFINE_ARRAY(self_actor, other_actor, normal_impulse)
     };
+#pragma pack(pop)
 
     constexpr static auto header_offset = 0u;
 
-    static Data DeserializeRawData(const RawData &message) {
-      return MsgPack::UnPack<Data>(message.begin(), message.size());
+    constexpr static auto payload_type = PayloadType::CollisionEvent;
+
+    static const Data &DeserializeRawData(const RawData &message) {
+      return *reinterpret_cast<const Data *>(message.begin());
     }
 
     template <typename SensorT>
     static Buffer Serialize(
         const SensorT &,
-        rpc::Actor self_actor,
-        rpc::Actor other_actor,
+        const rpc::Actor &self_actor,
+        const rpc::Actor &other_actor,
         geom::Vector3D normal_impulse) {
-      return MsgPack::Pack(Data{self_actor, other_actor, normal_impulse});
+      const Data data{
+          SerializedActor::Make(self_actor),
+          SerializedActor::Make(other_actor),
+          normal_impulse};
+      return Buffer{reinterpret_cast<const unsigned char *>(&data), sizeof(data)};
     }
 
     static SharedPtr<SensorData> Deserialize(RawData &&data);
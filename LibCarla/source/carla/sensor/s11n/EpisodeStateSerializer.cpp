@@ -6,13 +6,20 @@
 
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
 
+#include "carla/Exception.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
+#include <stdexcept>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> EpisodeStateSerializer::Deserialize(RawData &&data) {
+    if ((data.size() < header_offset) ||
+        ((data.size() - header_offset) % sizeof(data::ActorDynamicState) != 0u)) {
+      throw_exception(std::runtime_error("EpisodeStateSerializer: invalid data size"));
+    }
     return SharedPtr<data::RawEpisodeState>(new data::RawEpisodeState{std::move(data)});
   }
 
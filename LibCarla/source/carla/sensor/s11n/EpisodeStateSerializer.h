@@ -37,6 +37,8 @@ namespace s11n {
 
     constexpr static auto header_offset = sizeof(Header);
 
+    constexpr static auto payload_type = PayloadType::EpisodeState;
+
     static const Header &DeserializeHeader(const RawData &message) {
       return *reinterpret_cast<const Header *>(message.begin());
     }
@@ -6,13 +6,25 @@
 
 #include "carla/sensor/s11n/ImageSerializer.h"
 
+#include "carla/Exception.h"
 #include "carla/sensor/data/Image.h"
 
+#include <stdexcept>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> ImageSerializer::Deserialize(RawData &&data) {
+    if (data.size() < header_offset) {
+      throw_exception(std::runtime_error("ImageSerializer: truncated header"));
+    }
+    const auto &header = DeserializeHeader(data);
+    const auto pixel_bytes = data.size() - header_offset;
+    if ((pixel_bytes % sizeof(data::Color) != 0u) ||
+        (pixel_bytes / sizeof(data::Color) != uint64_t(header.width) * header.height)) {
+      throw_exception(std::runtime_error("ImageSerializer: invalid image size"));
+    }
     auto image = SharedPtr<data::Image>(new data::Image{std::move(data)});
     // Set alpha of each pixel in the buffer to max to make it 100% opaque
     for (auto &pixel : *image) {
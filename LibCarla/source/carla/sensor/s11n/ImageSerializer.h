@@ -33,6 +33,8 @@ namespace s11n {
 
     constexpr static auto header_offset = sizeof(ImageHeader);
 
+    constexpr static auto payload_type = PayloadType::Image;
+
     static const ImageHeader &DeserializeHeader(const RawData &data) {
       return *reinterpret_cast<const ImageHeader *>(data.begin());
     }
@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/rpc/Location.h"
 
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 namespace carla {
@@ -36,6 +38,16 @@ namespace s11n {
   ///      Xn, Yn, Zn,
   ///    }
   ///
+  /// The upper byte of the channel count stores the version of the layout.
+  /// Version 0 is the layout above. Version 1 adds per-point attributes,
+  /// stored as separate arrays between the header and the points
+  ///
+  ///    {
+  ///      Intensity0, ..., Intensityn,        (float)
+  ///      TimeOffset0, ..., TimeOffsetn,      (float)
+  ///      Channel0, ..., Channeln,            (uint16_t, padded to 4 bytes)
+  ///    }
+  ///
   /// @warning WritePoint should be called sequentially in the order in which
   /// the points are going to be stored, i.e., starting at channel zero and
   /// increasing steadily.
@@ -51,11 +63,25 @@ namespace s11n {
       SIZE
     };
 
+    static constexpr uint32_t ChannelCountMask = 0x00FFFFFFu;
+
+    static constexpr uint32_t VersionShift = 24u;
+
   public:
 
-    explicit LidarMeasurement(uint32_t ChannelCount = 0u)
+    enum Version : uint32_t {
+      /// Only the XYZ of each point.
+      PointsOnly,
+      /// Intensity, time offset and channel of each point too.
+      WithAttributes
+    };
+
+    explicit LidarMeasurement(
+        uint32_t ChannelCount = 0u,
+        Version version = Version::PointsOnly)
       : _header(Index::SIZE + ChannelCount, 0u) {
-      _header[Index::ChannelCount] = ChannelCount;
+      DEBUG_ASSERT(ChannelCount <= ChannelCountMask);
+      _header[Index::ChannelCount] = ChannelCount | (version << VersionShift);
     }
 
     LidarMeasurement &operator=(LidarMeasurement &&) = default;
@@ -69,21 +95,48 @@ namespace s11n {
     }
 
     uint32_t GetChannelCount() const {
-      return _header[Index::ChannelCount];
+      return _header[Index::ChannelCount] & ChannelCountMask;
+    }
+
+    Version GetVersion() const {
+      return static_cast<Version>(_header[Index::ChannelCount] >> VersionShift);
+    }
+
+    bool HasAttributes() const {
+      return GetVersion() >= Version::WithAttributes;
     }
 
     void Reset(uint32_t total_point_count) {
       std::memset(_header.data() + Index::SIZE, 0, sizeof(uint32_t) * GetChannelCount());
       _points.clear();
       _points.reserve(3u * total_point_count);
+      _intensity.clear();
+      _time_offset.clear();
+      _channel.clear();
+      if (HasAttributes()) {
+        _intensity.reserve(total_point_count);
+        _time_offset.reserve(total_point_count);
+        _channel.reserve(total_point_count);
+      }
     }
 
     void WritePoint(uint32_t channel, rpc::Location point) {
+      WritePoint(channel, point, 0.0f, 0.0f);
+    }
+
+    /// Write a point with its attributes, these are discarded if the
+    /// measurement was not created with Version::WithAttributes.
+    void WritePoint(uint32_t channel, rpc::Location point, float intensity, float time_offset) {
       DEBUG_ASSERT(GetChannelCount() > channel);
       _header[Index::SIZE + channel] += 1u;
       _points.emplace_back(point.x);
       _points.emplace_back(point.y);
       _points.emplace_back(point.z);
+      if (HasAttributes()) {
+        _intensity.emplace_back(intensity);
+        _time_offset.emplace_back(time_offset);
+        _channel.emplace_back(static_cast<uint16_t>(channel));
+      }
     }
 
   private:
@@ -91,6 +144,12 @@ namespace s11n {
     std::vector<uint32_t> _header;
 
     std::vector<float> _points;
+
+    std::vector<float> _intensity;
+
+    std::vector<float> _time_offset;
+
+    std::vector<uint16_t> _channel;
   };
 
 } // namespace s11n
@@ -6,15 +6,34 @@
 
 #include "carla/sensor/s11n/LidarSerializer.h"
 
+#include "carla/Exception.h"
 #include "carla/sensor/data/LidarMeasurement.h"
 
+#include <stdexcept>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> LidarSerializer::Deserialize(RawData &&data) {
+    // Check each part of the header before reading the next one.
+    if (data.size() < sizeof(uint32_t) * LidarMeasurement::Index::SIZE) {
+      throw_exception(std::runtime_error("LidarSerializer: truncated header"));
+    }
+    const auto view = DeserializeHeader(data);
+    if (view.GetVersion() > LidarMeasurement::Version::WithAttributes) {
+      throw_exception(std::runtime_error("LidarSerializer: unsupported version"));
+    }
+    if (data.size() < view.GetSize()) {
+      throw_exception(std::runtime_error("LidarSerializer: truncated header"));
+    }
+    const auto header_offset = GetHeaderOffset(data);
+    if ((data.size() < header_offset) ||
+        ((data.size() - header_offset) != sizeof(geom::Location) * view.GetTotalPointCount())) {
+      throw_exception(std::runtime_error("LidarSerializer: invalid number of points"));
+    }
     return SharedPtr<data::LidarMeasurement>(
-        new data::LidarMeasurement{std::move(data)});
+        new data::LidarMeasurement{header_offset, std::move(data)});
   }
 
 } // namespace s11n
@@ -32,7 +32,16 @@ namespace s11n {
     }
 
     uint32_t GetChannelCount() const {
-      return _begin[Index::ChannelCount];
+      return _begin[Index::ChannelCount] & LidarMeasurement::ChannelCountMask;
+    }
+
+    LidarMeasurement::Version GetVersion() const {
+      return static_cast<LidarMeasurement::Version>(
+          _begin[Index::ChannelCount] >> LidarMeasurement::VersionShift);
+    }
+
+    bool HasAttributes() const {
+      return GetVersion() >= LidarMeasurement::Version::WithAttributes;
     }
 
     uint32_t GetPointCount(size_t channel) const {
@@ -40,6 +49,19 @@ namespace s11n {
       return _begin[Index::SIZE + channel];
     }
 
+    size_t GetTotalPointCount() const {
+      size_t total = 0u;
+      for (auto channel = 0u; channel < GetChannelCount(); ++channel) {
+        total += GetPointCount(channel);
+      }
+      return total;
+    }
+
+    /// Size in bytes of the header.
+    size_t GetSize() const {
+      return sizeof(uint32_t) * (GetChannelCount() + Index::SIZE);
+    }
+
   private:
 
     friend class LidarSerializer;
@@ -59,13 +81,26 @@ namespace s11n {
   class LidarSerializer {
   public:
 
+    constexpr static auto payload_type = PayloadType::Lidar;
+
     static LidarHeaderView DeserializeHeader(const RawData &data) {
       return LidarHeaderView{reinterpret_cast<const uint32_t *>(data.begin())};
     }
 
+    /// Size in bytes of the attribute arrays of @a point_count points.
+    static size_t GetAttributesSize(size_t point_count) {
+      return 2u * sizeof(float) * point_count + GetChannelArraySize(point_count);
+    }
+
+    /// Size in bytes of the channel array, padded to keep the points aligned.
+    static size_t GetChannelArraySize(size_t point_count) {
+      return sizeof(uint16_t) * (point_count + point_count % 2u);
+    }
+
+    /// Offset of the points, i.e., the size of the header plus the attributes.
     static size_t GetHeaderOffset(const RawData &data) {
       auto View = DeserializeHeader(data);
-      return sizeof(uint32_t) * (View.GetChannelCount() + LidarMeasurement::Index::SIZE);
+      return View.GetSize() + (View.HasAttributes() ? GetAttributesSize(View.GetTotalPointCount()) : 0u);
     }
 
     template <typename Sensor>
@@ -86,8 +121,24 @@ namespace s11n {
       const Sensor &,
       const LidarMeasurement &measurement,
       Buffer &&output) {
-    std::array<boost::asio::const_buffer, 2u> seq = {
+    if (!measurement.HasAttributes()) {
+      std::array<boost::asio::const_buffer, 2u> seq = {
+          boost::asio::buffer(measurement._header),
+          boost::asio::buffer(measurement._points)};
+      output.copy_from(seq);
+      return std::move(output);
+    }
+    DEBUG_ASSERT(measurement._intensity.size() == measurement._channel.size());
+    DEBUG_ASSERT(measurement._time_offset.size() == measurement._channel.size());
+    DEBUG_ASSERT(3u * measurement._channel.size() == measurement._points.size());
+    constexpr uint16_t padding = 0u;
+    const auto point_count = measurement._channel.size();
+    std::array<boost::asio::const_buffer, 6u> seq = {
         boost::asio::buffer(measurement._header),
+        boost::asio::buffer(measurement._intensity),
+        boost::asio::buffer(measurement._time_offset),
+        boost::asio::buffer(measurement._channel),
+        boost::asio::buffer(&padding, GetChannelArraySize(point_count) - sizeof(uint16_t) * point_count),
         boost::asio::buffer(measurement._points)};
     output.copy_from(seq);
     return std::move(output);
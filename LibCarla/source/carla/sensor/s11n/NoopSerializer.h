@@ -24,6 +24,8 @@ namespace s11n {
   class NoopSerializer {
   public:
 
+    constexpr static auto payload_type = PayloadType::None;
+
     [[ noreturn ]] static SharedPtr<SensorData> Deserialize(RawData &&data);
   };
 
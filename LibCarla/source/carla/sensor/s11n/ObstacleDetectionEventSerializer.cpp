@@ -4,14 +4,20 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include "carla/Exception.h"
 #include "carla/sensor/data/ObstacleDetectionEvent.h"
 #include "carla/sensor/s11n/ObstacleDetectionEventSerializer.h"
 
+#include <stdexcept>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
 
   SharedPtr<SensorData> ObstacleDetectionEventSerializer::Deserialize(RawData &&data) {
+    if (data.size() != sizeof(Data)) {
+      throw_exception(std::runtime_error("ObstacleDetectionEventSerializer: invalid data size"));
+    }
     return SharedPtr<SensorData>(new data::ObstacleDetectionEvent(std::move(data)));
   }
 
@@ -11,6 +11,7 @@
 #include "carla/Memory.h"
 #include "carla/rpc/Actor.h"
 #include "carla/sensor/RawData.h"
+#include "carla/sensor/s11n/SerializedActor.h"
 
 namespace carla {
 namespace sensor {
@@ -19,34 +20,40 @@ namespace sensor {
 
 namespace s11n {
 
-  /// Serializes the current state of the whole episode.
+  /// Serializes the obstacle detection events, in a fixed layout read in place.
   class ObstacleDetectionEventSerializer {
   public:
 
+#pragma pack(push, 1)
     struct Data {
 
-      rpc::Actor self_actor;
+      SerializedActor self_actor;
 
-      rpc::Actor other_actor;
+      SerializedActor other_actor;
 
       float distance;
-
-      MSGPACK_DEFINE_ARRAY(self_actor, other_actor, distance)
     };
+#pragma pack(pop)
 
     constexpr static auto header_offset = 0u;
 
-    static Data DeserializeRawData(const RawData &message) {
-      return MsgPack::UnPack<Data>(message.begin(), message.size());
+    constexpr static auto payload_type = PayloadType::ObstacleDetectionEvent;
+
+    static const Data &DeserializeRawData(const RawData &message) {
+      return *reinterpret_cast<const Data *>(message.begin());
     }
 
     template <typename SensorT>
     static Buffer Serialize(
         const SensorT &,
-        rpc::Actor self_actor,
-        rpc::Actor other_actor,
+        const rpc::Actor &self_actor,
+        const rpc::Actor &other_actor,
         float distance) {
-      return MsgPack::Pack(Data{self_actor, other_actor, distance});
+      const Data data{
+          SerializedActor::Make(self_actor),
+          SerializedActor::Make(other_actor),
+          distance};
+      return Buffer{reinterpret_cast<const unsigned char *>(&data), sizeof(data)};
     }
 
     static SharedPtr<SensorData> Deserialize(RawData &&data);
@@ -13,7 +13,7 @@ namespace sensor {
 namespace s11n {
 
   static_assert(
-      SensorHeaderSerializer::header_offset == 3u * 8u + 6u * 4u,
+      SensorHeaderSerializer::header_offset == 2u * 4u + 3u * 8u + 6u * 4u,
       "Header size missmatch");
 
   static Buffer PopBufferFromPool() {
@@ -23,10 +23,13 @@ namespace s11n {
 
   Buffer SensorHeaderSerializer::Serialize(
       const uint64_t index,
+      const PayloadType payload_type,
       const uint64_t frame,
       double timestamp,
       const rpc::Transform transform) {
     Header h;
+    h.version = Version;
+    h.payload_type = payload_type;
     h.sensor_type = index;
     h.frame = frame;
     h.timestamp = timestamp;
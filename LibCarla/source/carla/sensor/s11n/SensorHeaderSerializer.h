@@ -9,16 +9,38 @@
 #include "carla/Buffer.h"
 #include "carla/rpc/Transform.h"
 
+#include <cstdint>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
 
+  /// Layout of the data that follows the header, each serializer declares the
+  /// type of payload it writes.
+  enum class PayloadType : uint32_t {
+    None,
+    EpisodeState,
+    Image,
+    Lidar,
+    CollisionEvent,
+    ObstacleDetectionEvent,
+    /// Written by the sensors registered at runtime, see
+    /// RuntimeSensorRegistry.
+    Custom
+  };
+
   /// Serializes the meta-information (header) sent with all the sensor data.
   class SensorHeaderSerializer {
   public:
 
+    /// Version of the wire format, to be increased whenever the layout of the
+    /// header or of any payload changes.
+    static constexpr uint32_t Version = 1u;
+
 #pragma pack(push, 1)
     struct Header {
+      uint32_t version;
+      PayloadType payload_type;
       uint64_t sensor_type;
       uint64_t frame;
       double timestamp;
@@ -30,6 +52,7 @@ namespace s11n {
 
     static Buffer Serialize(
         uint64_t index,
+        PayloadType payload_type,
         uint64_t frame,
         double timestamp,
         rpc::Transform transform);
@@ -0,0 +1,30 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/sensor/s11n/SerializedActor.h"
+
+#include "carla/Debug.h"
+#include "carla/client/detail/Simulator.h"
+
+namespace carla {
+namespace sensor {
+namespace s11n {
+
+  SharedPtr<client::Actor> SerializedActor::Get(
+      const std::shared_ptr<client::detail::Simulator> &simulator) const {
+    DEBUG_ASSERT(simulator != nullptr);
+    if (id != 0u) {
+      auto actor = simulator->GetActorById(id);
+      if (actor.has_value()) {
+        return simulator->MakeActor(std::move(*actor));
+      }
+    }
+    return simulator->MakeActor(Deserialize());
+  }
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
@@ -0,0 +1,96 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Memory.h"
+#include "carla/geom/BoundingBox.h"
+#include "carla/rpc/Actor.h"
+#include "carla/rpc/ActorId.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace carla {
+namespace client {
+
+  class Actor;
+
+namespace detail {
+
+  class Simulator;
+
+} // namespace detail
+} // namespace client
+
+namespace sensor {
+namespace s11n {
+
+#pragma pack(push, 1)
+  /// Fixed-size record of an actor involved in a sensor event, so the event
+  /// can be read in place. The actors registered in the episode are
+  /// retrieved by id, the rest (e.g. props of the map, with id 0) are
+  /// rebuilt from the type id, bounding box and semantic tags recorded.
+  struct SerializedActor {
+
+    static constexpr size_t MaxSemanticTags = 15u;
+
+    static constexpr size_t MaxTypeIdLength = 63u;
+
+    ActorId id;
+
+    ActorId parent_id;
+
+    geom::BoundingBox bounding_box;
+
+    uint8_t semantic_tag_count;
+
+    uint8_t semantic_tags[MaxSemanticTags];
+
+    /// Null-terminated, truncated to MaxTypeIdLength characters.
+    char type_id[MaxTypeIdLength + 1u];
+
+    static SerializedActor Make(const rpc::Actor &actor) {
+      SerializedActor result{};
+      result.id = actor.id;
+      result.parent_id = actor.parent_id;
+      result.bounding_box = actor.bounding_box;
+      const auto tag_count = std::min(actor.semantic_tags.size(), size_t(MaxSemanticTags));
+      result.semantic_tag_count = static_cast<uint8_t>(tag_count);
+      std::memcpy(result.semantic_tags, actor.semantic_tags.data(), tag_count);
+      const auto &description_id = actor.description.id;
+      std::memcpy(result.type_id, description_id.data(), std::min(description_id.size(), size_t(MaxTypeIdLength)));
+      return result;
+    }
+
+    /// Rebuild the rpc::Actor recorded, without the attributes of its
+    /// description.
+    rpc::Actor Deserialize() const {
+      rpc::Actor actor;
+      actor.id = id;
+      actor.parent_id = parent_id;
+      actor.bounding_box = bounding_box;
+      const auto tag_count = std::min(size_t(semantic_tag_count), size_t(MaxSemanticTags));
+      actor.semantic_tags.assign(semantic_tags, semantic_tags + tag_count);
+      actor.description.id.assign(type_id, std::find(type_id, type_id + MaxTypeIdLength, '\0'));
+      return actor;
+    }
+
+    /// Get the actor from the episode of @a simulator, or make it from the
+    /// record if it is not registered.
+    SharedPtr<client::Actor> Get(const std::shared_ptr<client::detail::Simulator> &simulator) const;
+  };
+#pragma pack(pop)
+
+  static_assert(
+      sizeof(SerializedActor) == 2u * 4u + 6u * 4u + 16u + 64u,
+      "SerializedActor size missmatch");
+
+} // namespace s11n
+} // namespace sensor
+} // namespace carla
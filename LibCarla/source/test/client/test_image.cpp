@@ -5,12 +5,24 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "Random.h"
 
+#include <carla/StopWatch.h>
+#include <carla/image/AsyncWriter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/sensor/SensorData.h>
+#include <carla/sensor/data/DepthDecoder.h>
+#include <carla/sensor/data/LabelExtractor.h>
 
+#include <future>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 template <typename ViewT, typename PixelT>
 struct TestImage {
@@ -186,3 +198,317 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+/// Check that the ImageConverter::ConvertInPlace of BGRA views, using
+/// ColorConverterKernels, and the @a scalar_kernel give the same pixels as
+/// the generic views.
+template <typename ConverterT>
+static void CheckConvertInPlace(size_t step, void (*scalar_kernel)(uint8_t *, uint8_t *)) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  constexpr auto max_depth = 256u * 256u * 256u;
+  const auto width = max_depth / step;
+  auto img_bgra8 = MakeTestImage<bgra8_pixel_t>(width, 1u);
+  for (auto i = 0u; i < width; ++i) {
+    const auto depth = static_cast<uint32_t>(i * step);
+    auto &pixel = img_bgra8.view(static_cast<std::ptrdiff_t>(i), 0);
+    get_color(pixel, red_t()) = static_cast<uint8_t>(depth & 0xFFu);
+    get_color(pixel, green_t()) = static_cast<uint8_t>((depth >> 8u) & 0xFFu);
+    get_color(pixel, blue_t()) = static_cast<uint8_t>(depth >> 16u);
+    get_color(pixel, alpha_t()) = 0u;
+  }
+  auto expected = MakeTestImage<bgra8_pixel_t>(width, 1u);
+  ImageConverter::CopyPixels(
+      ImageView::MakeColorConvertedView<decltype(img_bgra8.view), bgra8_pixel_t>(img_bgra8.view, ConverterT()),
+      expected.view);
+  auto scalar = MakeTestImage<bgra8_pixel_t>(width, 1u);
+  ImageConverter::CopyPixels(img_bgra8.view, scalar.view);
+  ImageConverter::ConvertInPlace(img_bgra8.view, ConverterT());
+  auto *begin = reinterpret_cast<uint8_t *>(&*scalar.view.row_begin(0));
+  scalar_kernel(begin, begin + sizeof(bgra8_pixel_t) * width);
+  for (auto i = 0u; i < width; ++i) {
+    const auto x = static_cast<std::ptrdiff_t>(i);
+    ASSERT_EQ(img_bgra8.view(x, 0), expected.view(x, 0)) << "at depth " << i * step;
+    ASSERT_EQ(scalar.view(x, 0), expected.view(x, 0)) << "at depth " << i * step;
+  }
+}
+
+TEST(image, color_converter_kernels) {
+  using namespace carla::image;
+#ifdef NDEBUG
+  constexpr size_t step = 1u;
+#else
+  constexpr size_t step = 251u;
+#endif // NDEBUG
+  using Scalar = ColorConverterKernels::Scalar;
+  CheckConvertInPlace<ColorConverter::Depth>(step, Scalar::Depth);
+  CheckConvertInPlace<ColorConverter::LogarithmicDepth>(step, Scalar::LogarithmicDepth);
+  CheckConvertInPlace<ColorConverter::CityScapesPalette>(256u * 256u, Scalar::CityScapesPalette);
+}
+
+#ifdef NDEBUG
+TEST(image, color_converter_kernels_benchmark) {
+  using namespace boost::gil;
+  using namespace carla::image;
+  constexpr auto width = 1920u;
+  constexpr auto height = 1080u;
+  auto source = MakeTestImage<bgra8_pixel_t>(width, height);
+  for (auto &pixel : source.view) {
+    for (auto i = 0u; i < 4u; ++i) {
+      pixel[i] = static_cast<uint8_t>(util::Random::Uniform(0.0, 256.0));
+    }
+  }
+  auto image = MakeTestImage<bgra8_pixel_t>(width, height);
+  auto benchmark = [&](const char *name, auto converter, auto scalar_kernel) {
+    using ConverterT = decltype(converter);
+    constexpr auto runs = 10u;
+    // Warm up, so the lookup tables are built before measuring.
+    ImageConverter::CopyPixels(source.view, image.view);
+    ImageConverter::ConvertInPlace(image.view, converter);
+    carla::StopWatch stop_watch;
+    for (auto i = 0u; i < runs; ++i) {
+      ImageConverter::CopyPixels(source.view, image.view);
+      ImageConverter::CopyPixels(
+          ImageView::MakeColorConvertedView<decltype(image.view), bgra8_pixel_t>(image.view, ConverterT()),
+          image.view);
+    }
+    const auto generic_time = stop_watch.GetElapsedTime<std::chrono::microseconds>() / runs;
+    stop_watch.Restart();
+    for (auto i = 0u; i < runs; ++i) {
+      ImageConverter::CopyPixels(source.view, image.view);
+      ImageConverter::ConvertInPlace(image.view, converter);
+    }
+    const auto kernel_time = stop_watch.GetElapsedTime<std::chrono::microseconds>() / runs;
+    stop_watch.Restart();
+    for (auto i = 0u; i < runs; ++i) {
+      ImageConverter::CopyPixels(source.view, image.view);
+      for (std::ptrdiff_t y = 0; y < image.view.height(); ++y) {
+        auto *begin = reinterpret_cast<uint8_t *>(&*image.view.row_begin(y));
+        scalar_kernel(begin, begin + sizeof(bgra8_pixel_t) * width);
+      }
+    }
+    const auto scalar_time = stop_watch.GetElapsedTime<std::chrono::microseconds>() / runs;
+    carla::logging::log(
+        name, "of", width, 'x', height, "image in", generic_time, "us with views,",
+        kernel_time, "us with kernels,", scalar_time, "us with scalar kernels (including copy).");
+  };
+  using Scalar = ColorConverterKernels::Scalar;
+  benchmark("Depth", ColorConverter::Depth(), Scalar::Depth);
+  benchmark("LogarithmicDepth", ColorConverter::LogarithmicDepth(), Scalar::LogarithmicDepth);
+  benchmark("CityScapesPalette", ColorConverter::CityScapesPalette(), Scalar::CityScapesPalette);
+}
+#endif // NDEBUG
+
+TEST(image, depth_decoder) {
+  using carla::sensor::data::Color;
+  using carla::sensor::data::DepthDecoder;
+  const float max_depth = DepthDecoder::MaxDepth;
+  std::vector<Color> colors;
+  for (uint32_t depth = 0u; depth < 256u * 256u * 256u; depth += 257u) {
+    colors.emplace_back(
+        static_cast<uint8_t>(depth & 0xFFu),
+        static_cast<uint8_t>((depth >> 8u) & 0xFFu),
+        static_cast<uint8_t>((depth >> 16u) & 0xFFu));
+  }
+  colors.emplace_back(255u, 255u, 255u);
+  std::vector<float> meters(colors.size());
+  DepthDecoder::DecodeMeters(colors.data(), colors.data() + colors.size(), meters.data());
+  for (size_t i = 0u; i < colors.size(); ++i) {
+    const auto &color = colors[i];
+    const double expected =
+        1000.0 * (color.r + color.g * 256.0 + color.b * 256.0 * 256.0) / (256.0 * 256.0 * 256.0 - 1.0);
+    ASSERT_NEAR(meters[i], expected, 1e-6 * expected + 1e-9);
+    ASSERT_EQ(meters[i], DepthDecoder::DecodeMeters(color));
+  }
+  ASSERT_FLOAT_EQ(meters.back(), max_depth);
+
+  // Back-project a 4x2 image with 90 degrees of field of view, the focal
+  // length is 2 pixels and the center of the image at (2, 1).
+  constexpr uint32_t width = 4u;
+  constexpr uint32_t height = 2u;
+  const std::vector<float> depths = {10.0f, 20.0f, 30.0f, max_depth, 10.0f, 10.0f, 10.0f, 10.0f};
+  std::vector<carla::geom::Location> points(depths.size());
+  const auto count = DepthDecoder::BackProject(depths.data(), width, height, 90.0f, max_depth, points.data());
+  ASSERT_EQ(count, 7u);
+  ASSERT_FLOAT_EQ(points[0u].x, 10.0f);
+  ASSERT_FLOAT_EQ(points[0u].y, -0.75f * 10.0f);
+  ASSERT_FLOAT_EQ(points[0u].z, 0.25f * 10.0f);
+  ASSERT_FLOAT_EQ(points[2u].x, 30.0f);
+  ASSERT_FLOAT_EQ(points[2u].y, 0.25f * 30.0f);
+  ASSERT_FLOAT_EQ(points[2u].z, 0.25f * 30.0f);
+  // The pixel at max_depth is skipped.
+  ASSERT_FLOAT_EQ(points[3u].y, -0.75f * 10.0f);
+  ASSERT_FLOAT_EQ(points[3u].z, -0.25f * 10.0f);
+  ASSERT_FLOAT_EQ(points[6u].y, 0.75f * 10.0f);
+  ASSERT_EQ(DepthDecoder::BackProject(depths.data(), width, height, 90.0f, 15.0f, points.data()), 5u);
+}
+
+TEST(image, label_extractor) {
+  using carla::sensor::data::Color;
+  using carla::sensor::data::LabelExtractor;
+  constexpr uint32_t width = 37u;
+  constexpr uint32_t height = 23u;
+  // Labels in blocks plus some noise, in the red channel.
+  std::vector<Color> pixels(width * height);
+  for (uint32_t y = 0u; y < height; ++y) {
+    for (uint32_t x = 0u; x < width; ++x) {
+      const auto label = ((x * y) % 7u == 3u) ? 255u : (x / 5u + 10u * (y / 4u));
+      pixels[y * width + x] = Color{static_cast<uint8_t>(label), static_cast<uint8_t>(x), static_cast<uint8_t>(y)};
+    }
+  }
+  std::vector<uint8_t> labels(pixels.size());
+  std::vector<uint32_t> counts(LabelExtractor::NumberOfLabels, 42u);
+  std::vector<LabelExtractor::Box> boxes(LabelExtractor::NumberOfLabels, LabelExtractor::Box{1, 2, 3, 4});
+  LabelExtractor::Extract(pixels.data(), width, height, labels.data(), counts.data(), boxes.data());
+
+  std::vector<uint32_t> expected_counts(LabelExtractor::NumberOfLabels, 0u);
+  std::vector<LabelExtractor::Box> expected_boxes(LabelExtractor::NumberOfLabels, LabelExtractor::Box{-1, -1, -1, -1});
+  for (uint32_t y = 0u; y < height; ++y) {
+    for (uint32_t x = 0u; x < width; ++x) {
+      const auto label = pixels[y * width + x].r;
+      ASSERT_EQ(labels[y * width + x], label);
+      ++expected_counts[label];
+      auto &box = expected_boxes[label];
+      const auto ix = static_cast<int32_t>(x);
+      const auto iy = static_cast<int32_t>(y);
+      box.min_x = (box.min_x < 0) ? ix : std::min(box.min_x, ix);
+      box.min_y = (box.min_y < 0) ? iy : std::min(box.min_y, iy);
+      box.max_x = std::max(box.max_x, ix);
+      box.max_y = std::max(box.max_y, iy);
+    }
+  }
+  for (size_t i = 0u; i < LabelExtractor::NumberOfLabels; ++i) {
+    ASSERT_EQ(counts[i], expected_counts[i]) << "label " << i;
+    ASSERT_EQ(boxes[i].min_x, expected_boxes[i].min_x) << "label " << i;
+    ASSERT_EQ(boxes[i].min_y, expected_boxes[i].min_y) << "label " << i;
+    ASSERT_EQ(boxes[i].max_x, expected_boxes[i].max_x) << "label " << i;
+    ASSERT_EQ(boxes[i].max_y, expected_boxes[i].max_y) << "label " << i;
+  }
+  ASSERT_EQ(counts[0u], 4u * 5u - 2u);
+  ASSERT_EQ(boxes[200u].min_x, -1);
+}
+
+namespace {
+
+  class TestSensorData : public carla::sensor::SensorData {
+  public:
+
+    explicit TestSensorData(size_t frame) : SensorData(frame, 0.0, carla::rpc::Transform{}) {}
+  };
+
+  /// Write function recording the paths written, that waits for a gate to
+  /// open before writing.
+  class TestWriter {
+  public:
+
+    TestWriter() : _gate(_open.get_future().share()) {}
+
+    carla::image::AsyncWriter::WriteFunction MakeWriteFunction() {
+      return [this](const carla::sensor::SensorData &, std::string path) {
+        std::call_once(_first_write, [this]() { _started.set_value(); });
+        _gate.wait();
+        if (path == "fail") {
+          throw std::runtime_error("cannot write");
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _written.emplace(std::move(path));
+      };
+    }
+
+    void WaitStarted() {
+      _started.get_future().wait();
+    }
+
+    void Open() {
+      _open.set_value();
+    }
+
+    std::set<std::string> GetWritten() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _written;
+    }
+
+  private:
+
+    std::promise<void> _open;
+
+    std::shared_future<void> _gate;
+
+    std::promise<void> _started;
+
+    std::once_flag _first_write;
+
+    std::mutex _mutex;
+
+    std::set<std::string> _written;
+  };
+
+} // namespace
+
+TEST(image, async_writer) {
+  using carla::image::AsyncWriter;
+  auto submit = [](AsyncWriter &writer, size_t frame, std::string path) {
+    return writer.Submit(carla::MakeShared<TestSensorData>(frame), std::move(path));
+  };
+  using Paths = std::set<std::string>;
+
+  {
+    TestWriter test;
+    AsyncWriter writer{test.MakeWriteFunction(), 1u, 2u, AsyncWriter::DropPolicy::DropNewest};
+    ASSERT_TRUE(submit(writer, 1u, "1"));
+    test.WaitStarted();
+    ASSERT_TRUE(submit(writer, 2u, "2"));
+    ASSERT_TRUE(submit(writer, 3u, "3"));
+    ASSERT_FALSE(submit(writer, 4u, "4"));
+    ASSERT_EQ(writer.GetStats().pending, 3u);
+    test.Open();
+    writer.Flush();
+    ASSERT_EQ(test.GetWritten(), (Paths{"1", "2", "3"}));
+    const auto stats = writer.GetStats();
+    ASSERT_EQ(stats.pending, 0u);
+    ASSERT_EQ(stats.submitted, 4u);
+    ASSERT_EQ(stats.written, 3u);
+    ASSERT_EQ(stats.dropped, 1u);
+    ASSERT_EQ(stats.failed, 0u);
+  }
+
+  {
+    TestWriter test;
+    AsyncWriter writer{test.MakeWriteFunction(), 1u, 2u, AsyncWriter::DropPolicy::DropOldest};
+    ASSERT_TRUE(submit(writer, 1u, "1"));
+    test.WaitStarted();
+    ASSERT_TRUE(submit(writer, 2u, "2"));
+    ASSERT_TRUE(submit(writer, 3u, "3"));
+    ASSERT_TRUE(submit(writer, 4u, "4"));
+    ASSERT_TRUE(submit(writer, 5u, "fail"));
+    test.Open();
+    writer.Flush();
+    ASSERT_EQ(test.GetWritten(), (Paths{"1", "4"}));
+    const auto stats = writer.GetStats();
+    ASSERT_EQ(stats.written, 2u);
+    ASSERT_EQ(stats.dropped, 2u);
+    ASSERT_EQ(stats.failed, 1u);
+  }
+
+  {
+    TestWriter test;
+    test.Open();
+    Paths expected;
+    {
+      AsyncWriter writer{test.MakeWriteFunction(), 4u, 3u, AsyncWriter::DropPolicy::Block};
+      for (auto i = 0u; i < 200u; ++i) {
+        expected.emplace(std::to_string(i));
+        ASSERT_TRUE(submit(writer, i, std::to_string(i)));
+      }
+      // The destructor writes the data still in the queue.
+    }
+    ASSERT_EQ(test.GetWritten(), expected);
+  }
+
+  {
+    TestWriter test;
+    ASSERT_THROW(
+        AsyncWriter(test.MakeWriteFunction(), 1u, 0u, AsyncWriter::DropPolicy::Block),
+        std::invalid_argument);
+  }
+}
@@ -0,0 +1,177 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/geom/Math.h>
+#include <carla/pointcloud/LidarSweepAssembler.h>
+#include <carla/sensor/CompositeSerializer.h>
+#include <carla/sensor/data/LidarMeasurement.h>
+#include <carla/sensor/s11n/LidarSerializer.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+
+#include <cmath>
+#include <vector>
+
+using carla::geom::Location;
+using carla::sensor::data::LidarMeasurement;
+
+namespace {
+
+  struct TestLidar {};
+
+  using TestRegistry = carla::sensor::CompositeSerializer<
+      std::pair<TestLidar *, carla::sensor::s11n::LidarSerializer>>;
+
+  struct TestPoint {
+    uint32_t channel;
+    carla::rpc::Location location;
+    float intensity;
+    float time_offset;
+  };
+
+} // namespace
+
+/// Serialize @a points with the header of a sensor message, and deserialize
+/// them back as the client would.
+static carla::SharedPtr<LidarMeasurement> RoundTrip(
+    carla::sensor::s11n::LidarMeasurement::Version version,
+    uint32_t channel_count,
+    const std::vector<TestPoint> &points,
+    const carla::rpc::Transform &transform = {},
+    float horizontal_angle = 42.0f,
+    uint64_t frame = 7u) {
+  carla::sensor::s11n::LidarMeasurement measurement{channel_count, version};
+  measurement.Reset(static_cast<uint32_t>(points.size()));
+  for (auto &&point : points) {
+    measurement.WritePoint(point.channel, point.location, point.intensity, point.time_offset);
+  }
+  measurement.SetHorizontalAngle(horizontal_angle);
+  TestLidar sensor;
+  const auto payload = TestRegistry::Serialize(sensor, measurement, carla::Buffer{});
+  const auto header = carla::sensor::s11n::SensorHeaderSerializer::Serialize(
+      0u, carla::sensor::s11n::PayloadType::Lidar, frame, 1.0, transform);
+  carla::Buffer message;
+  message.reset(static_cast<carla::Buffer::size_type>(header.size() + payload.size()));
+  message.copy_from(header);
+  message.copy_from(header.size(), payload);
+  auto data = TestRegistry::Deserialize(std::move(message));
+  auto lidar = boost::dynamic_pointer_cast<LidarMeasurement>(data);
+  EXPECT_NE(lidar, nullptr);
+  return lidar;
+}
+
+static std::vector<TestPoint> MakePoints() {
+  return {
+      {0u, {1.0f, 2.0f, 3.0f}, 0.5f, 0.00f},
+      {0u, {4.0f, 5.0f, 6.0f}, 0.6f, 0.01f},
+      {2u, {7.0f, 8.0f, 9.0f}, 0.7f, 0.02f}};
+}
+
+static void CheckPoints(const LidarMeasurement &lidar, const std::vector<TestPoint> &points) {
+  ASSERT_EQ(lidar.GetHorizontalAngle(), 42.0f);
+  ASSERT_EQ(lidar.GetChannelCount(), 3u);
+  ASSERT_EQ(lidar.GetPointCount(0u), 2u);
+  ASSERT_EQ(lidar.GetPointCount(1u), 0u);
+  ASSERT_EQ(lidar.GetPointCount(2u), 1u);
+  ASSERT_EQ(lidar.size(), points.size());
+  for (auto i = 0u; i < points.size(); ++i) {
+    ASSERT_EQ(lidar[i], points[i].location);
+  }
+}
+
+TEST(lidar, points_only) {
+  const auto points = MakePoints();
+  auto lidar = RoundTrip(carla::sensor::s11n::LidarMeasurement::PointsOnly, 3u, points);
+  ASSERT_NE(lidar, nullptr);
+  CheckPoints(*lidar, points);
+  ASSERT_FALSE(lidar->HasAttributes());
+  ASSERT_EQ(lidar->GetIntensities(), nullptr);
+  ASSERT_EQ(lidar->GetTimeOffsets(), nullptr);
+  ASSERT_EQ(lidar->GetChannels(), nullptr);
+}
+
+TEST(lidar, with_attributes) {
+  for (auto count : {3u, 2u, 0u}) { // Odd count to check the padding.
+    auto points = MakePoints();
+    points.resize(count);
+    auto lidar = RoundTrip(carla::sensor::s11n::LidarMeasurement::WithAttributes, 3u, points);
+    ASSERT_NE(lidar, nullptr);
+    ASSERT_TRUE(lidar->HasAttributes());
+    ASSERT_EQ(lidar->GetChannelCount(), 3u);
+    ASSERT_EQ(lidar->size(), points.size());
+    for (auto i = 0u; i < points.size(); ++i) {
+      ASSERT_EQ((*lidar)[i], points[i].location);
+      ASSERT_EQ(lidar->GetIntensities()[i], points[i].intensity);
+      ASSERT_EQ(lidar->GetTimeOffsets()[i], points[i].time_offset);
+      ASSERT_EQ(lidar->GetChannels()[i], points[i].channel);
+    }
+    if (count == 3u) {
+      CheckPoints(*lidar, points);
+    }
+  }
+}
+
+/// Point @a hit as the lidar writes it from @a transform: relative to the
+/// sensor and rotated by 90 - yaw.
+static Location MakeLidarPoint(const carla::geom::Transform &transform, const Location &hit) {
+  const auto angle = carla::geom::Math::ToRadians(90.0f - transform.rotation.yaw);
+  const auto relative = transform.location - hit;
+  return {
+      std::cos(angle) * relative.x - std::sin(angle) * relative.y,
+      std::sin(angle) * relative.x + std::cos(angle) * relative.y,
+      relative.z};
+}
+
+TEST(lidar, sweep_assembler) {
+  using carla::geom::Rotation;
+  using carla::geom::Transform;
+  using carla::pointcloud::LidarSweepAssembler;
+  const std::vector<Location> world = {
+      {10.0f, 0.0f, 0.0f}, {0.0f, 15.0f, 1.0f}, {-20.0f, 3.0f, -1.0f}, {5.0f, -30.0f, 2.0f}};
+
+  // The lidar turns 120 degrees per tick while the vehicle moves and turns,
+  // each tick sees one of the world points.
+  LidarSweepAssembler assembler{5u, 2u};
+  std::vector<const LidarSweepAssembler::Sweep *> sweeps;
+  for (auto tick = 0u; tick < 9u; ++tick) {
+    const Transform transform{
+        Location{2.0f * static_cast<float>(tick), 0.5f * static_cast<float>(tick), 0.1f},
+        Rotation{0.0f, 10.0f * static_cast<float>(tick), 0.0f}};
+    const auto angle = std::fmod(120.0f * static_cast<float>(tick + 1u), 360.0f);
+    const auto hit = world[tick % world.size()];
+    std::vector<TestPoint> points = {{0u, MakeLidarPoint(transform, hit), 0.0f, 0.0f}};
+    if (tick == 8u) { // Does not fit in the sweep.
+      points.push_back(points.front());
+      points.push_back(points.front());
+      points.push_back(points.front());
+    }
+    auto measurement = RoundTrip(carla::sensor::s11n::LidarMeasurement::PointsOnly, 1u, points, transform, angle, tick);
+    ASSERT_NE(measurement, nullptr);
+    const auto *sweep = assembler.Add(*measurement);
+    if (sweep == nullptr) {
+      continue;
+    }
+    // The sweep ends with this measurement, its points must be in this frame.
+    ASSERT_EQ(sweep->frame, tick);
+    ASSERT_EQ(sweep->transform, transform);
+    ASSERT_EQ(sweep->measurement_count, 3u);
+    ASSERT_EQ(sweep->size(), tick == 8u ? 5u : 3u);
+    ASSERT_EQ(sweep->dropped_points, tick == 8u ? 1u : 0u);
+    for (auto i = 0u; i < 3u; ++i) {
+      const auto expected = MakeLidarPoint(transform, world[(tick - 2u + i) % world.size()]);
+      const auto &point = sweep->begin()[i];
+      ASSERT_NEAR(point.x, expected.x, 1e-4f);
+      ASSERT_NEAR(point.y, expected.y, 1e-4f);
+      ASSERT_NEAR(point.z, expected.z, 1e-4f);
+    }
+    sweeps.push_back(sweep);
+  }
+  // Ticks 0 to 2 are discarded, the first wrap is at tick 2.
+  ASSERT_EQ(sweeps.size(), 2u);
+  ASSERT_NE(sweeps[0u]->begin(), sweeps[1u]->begin());
+  ASSERT_THROW(LidarSweepAssembler(5u, 0u), std::invalid_argument);
+}
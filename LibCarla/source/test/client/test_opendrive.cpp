@@ -13,16 +13,41 @@
 #include <carla/geom/Location.h>
 #include <carla/geom/Math.h>
 #include <carla/opendrive/OpenDriveParser.h>
+#include <carla/opendrive/OpenDriveRegionLoader.h>
+#include <carla/opendrive/parser/GeoReferenceParser.h>
+#include <carla/opendrive/parser/GeometryParser.h>
+#include <carla/opendrive/parser/JunctionParser.h>
+#include <carla/opendrive/parser/LaneParser.h>
+#include <carla/opendrive/parser/ProfilesParser.h>
+#include <carla/opendrive/parser/RoadParser.h>
+#include <carla/opendrive/parser/SignalParser.h>
+#include <carla/opendrive/parser/TrafficGroupParser.h>
+#include <carla/road/CompiledMap.h>
+#include <carla/road/InformationSet.h>
 #include <carla/road/MapBuilder.h>
 #include <carla/road/element/RoadInfoElevation.h>
 #include <carla/road/element/RoadInfoGeometry.h>
+#include <carla/road/element/RoadInfoLaneOffset.h>
 #include <carla/road/element/RoadInfoMarkRecord.h>
+#include <carla/road/element/RoadInfoSpeed.h>
 #include <carla/road/element/RoadInfoVisitor.h>
+#include <carla/road/signal/Signal.h>
 
 #include <pugixml/pugixml.hpp>
 
+#include <boost/filesystem/operations.hpp>
+
+#ifdef __linux__
+#  include <sys/resource.h>
+#endif // __linux__
+
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
+#include <sstream>
 #include <string>
+#include <thread>
 
 using namespace carla::road;
 using namespace carla::road::element;
@@ -424,3 +449,1380 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+static std::vector<Waypoint> Sorted(std::vector<Waypoint> waypoints) {
+  std::sort(waypoints.begin(), waypoints.end(), [](const auto &lhs, const auto &rhs) {
+    return std::tie(lhs.road_id, lhs.section_id, lhs.lane_id, lhs.s) <
+           std::tie(rhs.road_id, rhs.section_id, rhs.lane_id, rhs.s);
+  });
+  return waypoints;
+}
+
+static std::vector<Waypoint> SortedWaypoints(const Map &map) {
+  return Sorted(map.GenerateWaypoints(2.0));
+}
+
+TEST(road, compiled_map) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Compiling", file);
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto map = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(map.has_value());
+    const auto source_hash = CompiledMap::Hash(opendrive);
+    const auto buffer = CompiledMap::Serialize(*map, source_hash);
+    const auto stored_hash = CompiledMap::GetSourceHash(buffer.data(), buffer.size());
+    ASSERT_TRUE(stored_hash.has_value());
+    ASSERT_EQ(*stored_hash, source_hash);
+
+    auto compiled = CompiledMap::Deserialize(buffer.data(), buffer.size(), source_hash);
+    ASSERT_TRUE(compiled.has_value());
+    ASSERT_EQ(compiled->GetMap().GetRoadCount(), map->GetMap().GetRoadCount());
+    ASSERT_EQ(compiled->GetMap().GetJunctions().size(), map->GetMap().GetJunctions().size());
+    ASSERT_EQ(compiled->GetGeoReference().latitude, map->GetGeoReference().latitude);
+    ASSERT_EQ(compiled->GetGeoReference().longitude, map->GetGeoReference().longitude);
+
+    // Same waypoints at exactly the same locations.
+    const auto waypoints = SortedWaypoints(*map);
+    ASSERT_EQ(SortedWaypoints(*compiled), waypoints);
+    for (const auto &waypoint : waypoints) {
+      ASSERT_EQ(compiled->ComputeTransform(waypoint), map->ComputeTransform(waypoint));
+      ASSERT_EQ(compiled->GetLaneWidth(waypoint), map->GetLaneWidth(waypoint));
+      ASSERT_EQ(compiled->GetLaneType(waypoint), map->GetLaneType(waypoint));
+      ASSERT_EQ(Sorted(compiled->GetNext(waypoint, 5.0)), Sorted(map->GetNext(waypoint, 5.0)));
+    }
+    ASSERT_EQ(compiled->GenerateTopology().size(), map->GenerateTopology().size());
+
+    // Serializing again gives exactly the same bytes.
+    ASSERT_EQ(CompiledMap::Serialize(*compiled, source_hash), buffer);
+
+    // Outdated and corrupted files are rejected.
+    ASSERT_FALSE(CompiledMap::Deserialize(buffer.data(), buffer.size(), source_hash + 1u).has_value());
+    ASSERT_FALSE(CompiledMap::Deserialize(buffer.data(), buffer.size() / 2u).has_value());
+    auto corrupted = buffer;
+    corrupted[0u] = ~corrupted[0u];
+    ASSERT_FALSE(CompiledMap::Deserialize(corrupted.data(), corrupted.size()).has_value());
+  }
+}
+
+/// Hand-written compiled map of a single straight road with one lane, whose
+/// last lane info is the record written by @a write_info.
+template <typename FuncT>
+static std::vector<unsigned char> MakeCompiledMap(FuncT &&write_info) {
+  std::vector<unsigned char> buffer;
+  auto write = [&](auto value) {
+    const auto *begin = reinterpret_cast<const unsigned char *>(&value);
+    buffer.insert(buffer.end(), begin, begin + sizeof(value));
+  };
+  write(uint32_t(0x50414d43u)); // Magic.
+  write(uint32_t(2u));          // Version.
+  write(uint64_t(0u));          // Source hash.
+  write(uint32_t(1u));          // String table with an empty string.
+  write(uint32_t(0u));
+  write(0.0); write(0.0); write(0.0); // Geo reference.
+  write(uint32_t(0u));          // Junctions.
+  write(uint32_t(1u));          // Roads.
+  write(RoadId(1u)); write(uint32_t(0u)); write(10.0); write(JuncId(-1));
+  write(RoadId(0u)); write(RoadId(0u));
+  write(uint32_t(1u));          // Sections.
+  write(SectionId(0u)); write(0.0);
+  write(uint32_t(1u));          // Lanes.
+  write(LaneId(-1)); write(uint32_t(Lane::LaneType::Driving)); write(uint8_t(0u));
+  write(LaneId(0)); write(LaneId(0));
+  write(uint32_t(2u));          // Lane infos, a width and the record tested.
+  write(uint8_t(9u)); write(0.0); write(CubicPolynomial(3.5, 0.0, 0.0, 0.0));
+  write_info(write);
+  write(uint32_t(3u));          // Road infos, a flat line and its lane offset.
+  write(uint8_t(0u)); write(0.0); write(CubicPolynomial(0.0, 0.0, 0.0, 0.0));
+  write(uint8_t(1u)); write(0.0); write(uint8_t(GeometryType::LINE));
+  write(0.0); write(10.0); write(0.0); write(Location(0.0f, 0.0f, 0.0f));
+  write(uint8_t(6u)); write(0.0); write(CubicPolynomial(0.0, 0.0, 0.0, 0.0));
+  write(uint32_t(0u));          // Signals.
+  write(uint32_t(0u));          // Signal references.
+  write(uint32_t(0u));          // Waypoint lists.
+  write(uint8_t(0u));           // Topology.
+  return buffer;
+}
+
+TEST(road, compiled_map_unknown_record) {
+  const auto valid = MakeCompiledMap([](auto write) {
+    write(uint8_t(11u)); write(0.0); write(30.0); // Speed.
+  });
+  ASSERT_TRUE(CompiledMap::Deserialize(valid.data(), valid.size()).has_value());
+  // An unknown tag followed by data that would be read as the rest of the
+  // road must not be skipped.
+  const auto unknown_record = MakeCompiledMap([](auto write) {
+    write(uint8_t(0xFFu)); write(0.0);
+  });
+  ASSERT_FALSE(CompiledMap::Deserialize(unknown_record.data(), unknown_record.size()).has_value());
+  const auto unknown_geometry = MakeCompiledMap([](auto write) {
+    write(uint8_t(1u)); write(0.0); write(uint8_t(0xFFu));
+  });
+  ASSERT_FALSE(CompiledMap::Deserialize(unknown_geometry.data(), unknown_geometry.size()).has_value());
+}
+
+TEST(road, compiled_map_file) {
+  namespace fs = boost::filesystem;
+  const auto path = (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.carla_map")).string();
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+
+    carla::StopWatch stop_watch;
+    auto map = OpenDriveParser::LoadCompiled(opendrive, path);
+    const auto xml_time = stop_watch.GetElapsedTime();
+    ASSERT_TRUE(map.has_value());
+    ASSERT_TRUE(CompiledMap::IsUpToDate(path, opendrive));
+    ASSERT_FALSE(CompiledMap::IsUpToDate(path, opendrive + " "));
+
+    stop_watch.Restart();
+    auto compiled = OpenDriveParser::LoadCompiled(opendrive, path);
+    const auto compiled_time = stop_watch.GetElapsedTime();
+    ASSERT_TRUE(compiled.has_value());
+    ASSERT_EQ(SortedWaypoints(*compiled), SortedWaypoints(*map));
+
+    carla::logging::log(
+        file, ": parsed and compiled in", xml_time, "ms, loaded compiled in",
+        compiled_time, "ms.");
+  }
+  fs::remove(path);
+}
+
+/// Write an OpenDRIVE with @a copies of the roads and junctions of
+/// @a opendrive to @a out. Each copy has its ids shifted and is placed next
+/// to the previous ones, in a square grid.
+static void WriteScaledOpenDrive(std::ostream &out, const std::string &opendrive, unsigned copies) {
+  pugi::xml_document xml;
+  EXPECT_TRUE(xml.load_string(opendrive.c_str()));
+  auto root = xml.child("OpenDRIVE");
+  unsigned offset = 0u;
+  double min_x = 0.0, min_y = 0.0, max_x = 0.0, max_y = 0.0, max_length = 0.0;
+  for (auto node : root.children("road")) {
+    offset = std::max(offset, node.attribute("id").as_uint() + 1u);
+    for (auto geometry : node.child("planView").children("geometry")) {
+      min_x = std::min(min_x, geometry.attribute("x").as_double());
+      min_y = std::min(min_y, geometry.attribute("y").as_double());
+      max_x = std::max(max_x, geometry.attribute("x").as_double());
+      max_y = std::max(max_y, geometry.attribute("y").as_double());
+      max_length = std::max(max_length, geometry.attribute("length").as_double());
+    }
+  }
+  for (auto node : root.children("junction")) {
+    offset = std::max(offset, node.attribute("id").as_uint() + 1u);
+  }
+  const double spacing = std::max(max_x - min_x, max_y - min_y) + 2.0 * max_length + 100.0;
+  const auto side = static_cast<unsigned>(std::ceil(std::sqrt(copies)));
+
+  auto shift = [](pugi::xml_attribute attribute, unsigned amount) {
+    if (attribute && (attribute.as_int() >= 0)) {
+      attribute.set_value(attribute.as_uint() + amount);
+    }
+  };
+  out << "<?xml version=\"1.0\" standalone=\"yes\"?>\n<OpenDRIVE>\n";
+  root.child("header").print(out);
+  for (auto i = 0u; i < copies; ++i) {
+    const auto amount = i * offset;
+    const double dx = (i % side) * spacing;
+    const double dy = (i / side) * spacing;
+    for (auto node : root.children("road")) {
+      pugi::xml_document copy;
+      auto road = copy.append_copy(node);
+      shift(road.attribute("id"), amount);
+      shift(road.attribute("junction"), amount);
+      shift(road.child("link").child("predecessor").attribute("elementId"), amount);
+      shift(road.child("link").child("successor").attribute("elementId"), amount);
+      for (auto geometry : road.child("planView").children("geometry")) {
+        geometry.attribute("x").set_value(geometry.attribute("x").as_double() + dx);
+        geometry.attribute("y").set_value(geometry.attribute("y").as_double() + dy);
+      }
+      road.print(out);
+    }
+    for (auto node : root.children("junction")) {
+      pugi::xml_document copy;
+      auto junction = copy.append_copy(node);
+      shift(junction.attribute("id"), amount);
+      for (auto connection : junction.children("connection")) {
+        shift(connection.attribute("incomingRoad"), amount);
+        shift(connection.attribute("connectingRoad"), amount);
+      }
+      junction.print(out);
+    }
+  }
+  out << "</OpenDRIVE>\n";
+}
+
+/// Return an OpenDRIVE with @a copies of @a opendrive, see
+/// WriteScaledOpenDrive.
+static std::string ScaleOpenDrive(const std::string &opendrive, unsigned copies) {
+  std::ostringstream out;
+  WriteScaledOpenDrive(out, opendrive, copies);
+  return out.str();
+}
+
+/// Load @a opendrive running every parser sequentially.
+static boost::optional<Map> LoadSequentially(const std::string &opendrive) {
+  pugi::xml_document xml;
+  EXPECT_TRUE(xml.load_string(opendrive.c_str()));
+  MapBuilder map_builder;
+  parser::GeoReferenceParser::Parse(xml, map_builder);
+  parser::RoadParser::Parse(xml, map_builder);
+  parser::JunctionParser::Parse(xml, map_builder);
+  parser::GeometryParser::Parse(xml, map_builder);
+  parser::LaneParser::Parse(xml, map_builder);
+  parser::ProfilesParser::Parse(xml, map_builder);
+  parser::TrafficGroupParser::Parse(xml, map_builder);
+  parser::SignalParser::Parse(xml, map_builder);
+  return map_builder.Build();
+}
+
+TEST(road, parse_files_parallel) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = ScaleOpenDrive(util::OpenDrive::Load(file), 8u);
+    auto expected = LoadSequentially(opendrive);
+    ASSERT_TRUE(expected.has_value());
+    const auto expected_data = CompiledMap::Serialize(*expected, 0u);
+    for (auto i = 0u; i < 4u; ++i) {
+      auto map = OpenDriveParser::Load(opendrive);
+      ASSERT_TRUE(map.has_value());
+      ASSERT_EQ(map->GetMap().GetRoadCount(), expected->GetMap().GetRoadCount());
+      ASSERT_TRUE(CompiledMap::Serialize(*map, 0u) == expected_data);
+    }
+  }
+}
+
+TEST(road, parse_files_scaled) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto source = util::OpenDrive::Load(file);
+    for (auto copies : {1u, 8u, 64u}) {
+      const auto opendrive = ScaleOpenDrive(source, copies);
+
+      carla::StopWatch stop_watch;
+      size_t number_of_roads = 0u;
+      {
+        auto map = LoadSequentially(opendrive);
+        ASSERT_TRUE(map.has_value());
+        number_of_roads = map->GetMap().GetRoadCount();
+      }
+      const auto sequential_time = stop_watch.GetElapsedTime();
+
+      stop_watch.Restart();
+      {
+        auto map = OpenDriveParser::Load(opendrive);
+        ASSERT_TRUE(map.has_value());
+        ASSERT_EQ(map->GetMap().GetRoadCount(), number_of_roads);
+      }
+      const auto parallel_time = stop_watch.GetElapsedTime();
+
+      carla::logging::log(
+          file, 'x', copies, ':', number_of_roads, "roads, loaded in",
+          parallel_time, "ms, sequential parsing", sequential_time, "ms.");
+    }
+  }
+#endif // NDEBUG
+}
+
+TEST(road, region_loader) {
+  namespace fs = boost::filesystem;
+  const auto path = (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.xodr")).string();
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto map = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(map.has_value());
+    const auto number_of_roads = map->GetMap().GetRoadCount();
+    {
+      std::ofstream out(path);
+      WriteScaledOpenDrive(out, opendrive, 4u);
+    }
+    auto loader = OpenDriveRegionLoader::Open(path, 2u);
+    ASSERT_NE(loader, nullptr);
+    ASSERT_EQ(loader->GetNumberOfRoads(), 4u * number_of_roads);
+
+    // The region with the roads of the first copy is the original map.
+    std::vector<RoadId> road_ids;
+    for (const auto &road : map->GetMap().GetRoads()) {
+      road_ids.emplace_back(road.first);
+    }
+    auto region = loader->GetRegion(road_ids);
+    ASSERT_NE(region, nullptr);
+    ASSERT_EQ(region->GetMap().GetRoadCount(), number_of_roads);
+    ASSERT_EQ(SortedWaypoints(*region), SortedWaypoints(*map));
+    ASSERT_EQ(region->GenerateTopology().size(), map->GenerateTopology().size());
+    ASSERT_EQ(loader->GetRegion(road_ids), region);
+
+    // Concurrent requests of a region not cached yet end up sharing one map.
+    if (road_ids.size() > 1u) {
+      const std::vector<RoadId> some_road_ids(road_ids.begin() + 1, road_ids.end());
+      std::vector<std::shared_ptr<const carla::road::Map>> results(4u);
+      std::vector<std::thread> threads;
+      for (auto &result : results) {
+        threads.emplace_back([&]() { result = loader->GetRegion(some_road_ids); });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      for (const auto &result : results) {
+        ASSERT_NE(result, nullptr);
+        ASSERT_EQ(result, results.front());
+      }
+      ASSERT_EQ(loader->GetRegion(some_road_ids), results.front());
+      ASSERT_EQ(loader->GetNumberOfCachedRegions(), 2u);
+    }
+
+    // A smaller area only has some of the roads, and no links to the rest.
+    const auto waypoint = map->GenerateWaypoints(10.0).front();
+    const auto location = map->ComputeTransform(waypoint).location;
+    const auto area = loader->GetArea(location - Location(1.0f, 1.0f, 0.0f), location + Location(1.0f, 1.0f, 0.0f));
+    ASSERT_NE(area, nullptr);
+    ASSERT_GT(area->GetMap().GetRoadCount(), 0u);
+    ASSERT_LT(area->GetMap().GetRoadCount(), loader->GetNumberOfRoads());
+    ASSERT_TRUE(area->GetClosestWaypointOnRoad(location).has_value());
+    for (const auto &pair : area->GenerateTopology()) {
+      ASSERT_TRUE(area->GetMap().ContainsRoad(pair.second.road_id));
+    }
+
+    // Regions in use are not evicted.
+    ASSERT_EQ(loader->GetNumberOfCachedRegions(), 2u);
+    loader->GetArea(Location(-1e6f, -1e6f, 0.0f), Location(1e6f, 1e6f, 0.0f));
+    ASSERT_EQ(loader->GetNumberOfCachedRegions(), 3u);
+    region.reset();
+    loader->GetArea(Location(-1e6f, -1e6f, 0.0f), Location(1e6f, 1e6f, 0.0f));
+    ASSERT_EQ(loader->GetNumberOfCachedRegions(), 2u);
+    ASSERT_NE(loader->GetRegion(road_ids).get(), nullptr);
+  }
+  fs::remove(path);
+  ASSERT_EQ(OpenDriveRegionLoader::Open(path), nullptr);
+}
+
+#ifdef NDEBUG
+/// Peak resident memory of the process in megabytes.
+static double GetPeakMemory() {
+#ifdef __linux__
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#else
+  return 0.0;
+#endif // __linux__
+}
+#endif // NDEBUG
+
+TEST(road, region_loader_large_map) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  namespace fs = boost::filesystem;
+  const auto path = (fs::temp_directory_path() / fs::unique_path("%%%%-%%%%.xodr")).string();
+  const auto files = util::OpenDrive::GetAvailableFiles();
+  ASSERT_FALSE(files.empty());
+  const auto file = files.back();
+  const auto opendrive = util::OpenDrive::Load(file);
+  auto map = OpenDriveParser::Load(opendrive);
+  ASSERT_TRUE(map.has_value());
+  const auto location = map->ComputeTransform(map->GenerateWaypoints(10.0).front()).location;
+  {
+    std::ofstream out(path);
+    WriteScaledOpenDrive(out, opendrive, 64u);
+  }
+  const auto file_size = static_cast<double>(fs::file_size(path)) / (1024.0 * 1024.0);
+  const double initial_memory = GetPeakMemory();
+
+  carla::StopWatch stop_watch;
+  {
+    auto loader = OpenDriveRegionLoader::Open(path);
+    ASSERT_NE(loader, nullptr);
+    const auto index_time = stop_watch.GetElapsedTime();
+    auto region = loader->GetArea(location - Location(50.0f, 50.0f, 0.0f), location + Location(50.0f, 50.0f, 0.0f));
+    ASSERT_NE(region, nullptr);
+    ASSERT_TRUE(region->GetClosestWaypointOnRoad(location).has_value());
+    const auto first_query_time = stop_watch.GetElapsedTime();
+    carla::logging::log(
+        file, 'x', 64, '(', file_size, "MB,", loader->GetNumberOfRoads(), "roads): indexed in",
+        index_time, "ms, first query in", first_query_time, "ms with",
+        region->GetMap().GetRoadCount(), "roads loaded, peak memory",
+        GetPeakMemory(), "MB (", initial_memory, "MB before).");
+  }
+
+  stop_watch.Restart();
+  {
+    std::ifstream in(path);
+    const std::string content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    auto large_map = OpenDriveParser::Load(content);
+    ASSERT_TRUE(large_map.has_value());
+    ASSERT_TRUE(large_map->GetClosestWaypointOnRoad(location).has_value());
+  }
+  carla::logging::log(
+      file, 'x', 64, ": full load and first query in", stop_watch.GetElapsedTime(),
+      "ms, peak memory", GetPeakMemory(), "MB.");
+  fs::remove(path);
+#endif // NDEBUG
+}
+
+/// Random spiral, poly3 and paramPoly3 geometries. Curvatures are kept below
+/// 0.05 and lengths below 50 meters so no geometry curls back on itself.
+static std::vector<std::unique_ptr<GeometryTabulated>> MakeRandomGeometries(size_t count) {
+  std::vector<std::unique_ptr<GeometryTabulated>> result;
+  for (size_t i = 0u; i < count; ++i) {
+    const double length = Random::Uniform(5.0, 50.0);
+    const double heading = Random::Uniform(-Math::Pi<double>(), Math::Pi<double>());
+    const auto start = Random::Location(-100.0f, 100.0f);
+    const Location location(start.x, start.y, 0.0f);
+    const double k = 0.05;
+    result.emplace_back(std::make_unique<GeometrySpiral>(
+        0.0, length, heading, location, Random::Uniform(-k, k), Random::Uniform(-k, k)));
+    result.emplace_back(std::make_unique<GeometrySpiral>(
+        0.0, length, heading, location, 0.0, Random::Uniform(-k, k)));
+    // Cubic curves of bounded curvature, y = a + b x + c x^2 + d x^3.
+    const double c = Random::Uniform(-0.01, 0.01);
+    const double d = Random::Uniform(-0.1, 0.1) * k / (length * 6.0);
+    result.emplace_back(std::make_unique<GeometryPoly3>(
+        0.0, length, heading, location, 0.0, Random::Uniform(-0.2, 0.2), c, d));
+    // u grows at least as fast as p, so the curve is at least length long.
+    result.emplace_back(std::make_unique<GeometryParamPoly3>(
+        0.0, length, heading, location,
+        0.0, 1.0, Random::Uniform(0.0, 0.002), 0.0,
+        0.0, 0.0, c, d, true));
+    // Normalized range, p in [0, 1]. The curve is about length long.
+    result.emplace_back(std::make_unique<GeometryParamPoly3>(
+        0.0, length, heading, location,
+        0.0, length, 0.0, 0.0,
+        0.0, 0.0, c * length * length, d * length * length * length, false));
+  }
+  return result;
+}
+
+TEST(road, geometry_lookup_table_accuracy) {
+  // Positions are stored as floats, allow their rounding error too.
+  const double tolerance = GeometryLookupTable::MaxError + 1e-4;
+  for (const auto &geometry : MakeRandomGeometries(20u)) {
+    const double length = geometry->GetLength();
+    for (double s = 0.0; s <= length; s += length / 997.0) {
+      const auto table = geometry->PosFromDist(s);
+      const auto exact = geometry->PosFromDistExact(s);
+      ASSERT_LE(Math::Distance2D(table.location, exact.location), tolerance)
+          << "geometry type " << static_cast<int>(geometry->GetType()) << " at s = " << s;
+      ASSERT_NEAR(std::remainder(table.tangent - exact.tangent, 2.0 * Math::Pi<double>()), 0.0, 1e-3);
+    }
+  }
+}
+
+TEST(road, geometry_distance_to) {
+  for (const auto &geometry : MakeRandomGeometries(20u)) {
+    const double length = geometry->GetLength();
+    for (int i = 0; i < 100; ++i) {
+      // A point at a known distance of the curve, along its normal.
+      const double s = Random::Uniform(1.0, length - 1.0);
+      const double offset = Random::Uniform(-2.0, 2.0);
+      auto point = geometry->PosFromDistExact(s);
+      point.ApplyLateralOffset(static_cast<float>(offset));
+      const auto result = geometry->DistanceTo(point.location);
+      ASSERT_NEAR(result.first, s, 1e-2);
+      ASSERT_NEAR(result.second, std::abs(offset), 1e-3);
+    }
+  }
+}
+
+TEST(road, geometry_lookup_table_fallback) {
+  for (const auto &geometry : MakeRandomGeometries(5u)) {
+    ASSERT_TRUE(geometry->GetLookupTable().IsAccurate());
+  }
+  // A circle of radius 1 m, too long for the table to reach the accuracy
+  // within its maximum number of intervals; evaluated exactly instead.
+  const GeometrySpiral circle(0.0, 4e5, 0.0, Location(0.0f, 0.0f, 0.0f), 1.0, 1.0);
+  ASSERT_FALSE(circle.GetLookupTable().IsAccurate());
+  for (int i = 0; i < 100; ++i) {
+    const double s = Random::Uniform(0.0, circle.GetLength());
+    const auto point = circle.PosFromDist(s);
+    const auto exact = circle.PosFromDistExact(s);
+    ASSERT_EQ(point.location, exact.location);
+    ASSERT_EQ(point.tangent, exact.tangent);
+    ASSERT_NEAR(circle.DistanceTo(exact.location).second, 0.0, 1e-3);
+  }
+}
+
+TEST(road, geometry_spiral_exact) {
+  for (int i = 0; i < 20; ++i) {
+    const double length = Random::Uniform(5.0, 100.0);
+    const double curve_start = Random::Uniform(-0.1, 0.1);
+    const double curve_end = (i % 4 == 0) ? curve_start : Random::Uniform(-0.1, 0.1);
+    const GeometrySpiral spiral(0.0, length, 0.0, Location(0.0f, 0.0f, 0.0f), curve_start, curve_end);
+
+    // Integrate the unit tangent with Simpson's rule.
+    const auto heading = [&](double s) {
+      return curve_start * s + 0.5 * (curve_end - curve_start) / length * s * s;
+    };
+    const int steps = 2000;
+    const double h = length / steps;
+    double x = 0.0;
+    double y = 0.0;
+    for (int j = 0; j < steps; ++j) {
+      const double s = j * h;
+      x += h / 6.0 * (std::cos(heading(s)) + 4.0 * std::cos(heading(s + h / 2.0)) + std::cos(heading(s + h)));
+      y += h / 6.0 * (std::sin(heading(s)) + 4.0 * std::sin(heading(s + h / 2.0)) + std::sin(heading(s + h)));
+    }
+    const auto end = spiral.PosFromDistExact(length);
+    ASSERT_NEAR(end.location.x, x, 1e-4);
+    ASSERT_NEAR(end.location.y, y, 1e-4);
+    ASSERT_NEAR(end.tangent, heading(length), 1e-9);
+  }
+}
+
+static const char *GeometriesOpenDrive = R"(<?xml version="1.0" standalone="yes"?>
+<OpenDRIVE>
+  <header revMajor="1" revMinor="4" name="" version="1"/>
+  <road name="geometries" length="120" id="0" junction="-1">
+    <link/>
+    <planView>
+      <geometry s="0" x="0" y="0" hdg="0" length="20"><line/></geometry>
+      <geometry s="20" x="20" y="0" hdg="0" length="30"><spiral curvStart="0" curvEnd="0.02"/></geometry>
+      <geometry s="50" x="49.7311" y="2.9808" hdg="0.3" length="30"><poly3 a="0" b="0" c="0.001" d="0"/></geometry>
+      <geometry s="80" x="78.1085" y="12.6999" hdg="0.3599" length="20"><paramPoly3 aU="0" bU="1" cU="0" dU="0" aV="0" bV="0" cV="0.002" dV="0" pRange="arcLength"/></geometry>
+      <geometry s="100" x="96.5262" y="20.4830" hdg="0.4396" length="20"><paramPoly3 aU="0" bU="20" cU="0" dU="0" aV="0" bV="0" cV="0.5" dV="0" pRange="normalized"/></geometry>
+    </planView>
+    <elevationProfile>
+      <elevation s="0" a="0" b="0" c="0" d="0"/>
+    </elevationProfile>
+    <lanes>
+      <laneOffset s="0" a="0" b="0" c="0" d="0"/>
+      <laneSection s="0">
+        <center>
+          <lane id="0" type="none" level="false"/>
+        </center>
+        <right>
+          <lane id="-1" type="driving" level="false">
+            <width sOffset="0" a="3.5" b="0" c="0" d="0"/>
+          </lane>
+        </right>
+      </laneSection>
+    </lanes>
+  </road>
+</OpenDRIVE>
+)";
+
+TEST(road, parse_geometries) {
+  auto map = OpenDriveParser::Load(GeometriesOpenDrive);
+  ASSERT_TRUE(map.has_value());
+  const auto &road = map->GetMap().GetRoad(0u);
+  const std::vector<std::pair<double, GeometryType>> expected = {
+    {10.0, GeometryType::LINE},
+    {30.0, GeometryType::SPIRAL},
+    {60.0, GeometryType::POLY3},
+    {90.0, GeometryType::PARAMPOLY3},
+    {110.0, GeometryType::PARAMPOLY3}};
+  for (const auto &item : expected) {
+    const auto geometry = road.GetInfo<RoadInfoGeometry>(item.first);
+    ASSERT_NE(geometry, nullptr);
+    ASSERT_EQ(geometry->GetGeometry().GetType(), item.second);
+  }
+
+  // Waypoints can be generated and located all along the road.
+  const auto waypoints = map->GenerateWaypoints(1.0);
+  ASSERT_GT(waypoints.size(), 100u);
+  for (const auto &waypoint : waypoints) {
+    const auto location = map->ComputeTransform(waypoint).location;
+    const auto nearest = map->GetClosestWaypointOnRoad(location);
+    ASSERT_TRUE(nearest.has_value());
+    ASSERT_LT(Math::Distance2D(map->ComputeTransform(*nearest).location, location), 0.01f);
+  }
+
+  // And the geometries survive compilation.
+  const auto buffer = CompiledMap::Serialize(*map, 0u);
+  auto compiled = CompiledMap::Deserialize(buffer.data(), buffer.size(), 0u);
+  ASSERT_TRUE(compiled.has_value());
+  for (const auto &waypoint : waypoints) {
+    ASSERT_EQ(compiled->ComputeTransform(waypoint), map->ComputeTransform(waypoint));
+  }
+  ASSERT_EQ(CompiledMap::Serialize(*compiled, 0u), buffer);
+}
+
+TEST(road, geometry_benchmark) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  const auto geometries = MakeRandomGeometries(100u);
+  std::vector<Location> points;
+  for (int i = 0; i < 100; ++i) {
+    points.emplace_back(Random::Location(-150.0f, 150.0f));
+  }
+  const int samples = 100;
+  double checksum = 0.0;
+
+  carla::StopWatch stop_watch;
+  for (const auto &geometry : geometries) {
+    for (int i = 0; i < samples; ++i) {
+      checksum += geometry->PosFromDist(geometry->GetLength() * i / samples).tangent;
+    }
+  }
+  const auto table_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+  stop_watch.Restart();
+  for (const auto &geometry : geometries) {
+    for (int i = 0; i < samples; ++i) {
+      checksum -= geometry->PosFromDistExact(geometry->GetLength() * i / samples).tangent;
+    }
+  }
+  const auto exact_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+  stop_watch.Restart();
+  for (const auto &geometry : geometries) {
+    for (const auto &point : points) {
+      checksum += geometry->DistanceTo(point).second;
+    }
+  }
+  const auto distance_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+  const auto evaluations = geometries.size() * samples;
+  carla::logging::log(
+      evaluations, "evaluations: lookup table", table_time, "us, exact", exact_time,
+      "us;", geometries.size() * points.size(), "distance queries", distance_time,
+      "us (checksum", checksum, ").");
+#endif // NDEBUG
+}
+
+/// Check that the locations around the center of each lane are found in the
+/// lane, and the locations past its borders are not.
+static void CheckLaneBoundaries(const Map &map) {
+  const auto waypoints = map.GenerateWaypoints(2.0);
+  ASSERT_FALSE(waypoints.empty());
+  for (const auto &waypoint : waypoints) {
+    const auto transform = map.ComputeTransform(waypoint);
+    const auto found = map.GetWaypoint(transform.location);
+    ASSERT_TRUE(found.has_value());
+    // Lanes may overlap in junctions, the one found has its center here too.
+    ASSERT_LT(Math::Distance2D(map.ComputeTransform(*found).location, transform.location), 0.01f);
+    // At the ends of the road the lanes connected to it contain it too.
+    const double road_length = map.GetMap().GetRoad(waypoint.road_id).GetLength();
+    if (map.IsJunction(waypoint.road_id) || (waypoint.s < 0.1) || (waypoint.s > road_length - 0.1)) {
+      continue;
+    }
+    ASSERT_EQ(found->road_id, waypoint.road_id);
+    ASSERT_EQ(found->lane_id, waypoint.lane_id);
+    ASSERT_NEAR(found->s, waypoint.s, 1e-2);
+
+    // Across the lane, in the direction of the road's right.
+    const auto forward = transform.GetForwardVector();
+    const auto right = waypoint.lane_id < 0 ?
+        Location(-forward.y, forward.x, 0.0f) :
+        Location(forward.y, -forward.x, 0.0f);
+    const auto width = static_cast<float>(map.GetLaneWidth(waypoint));
+    auto across = [&](float offset) {
+      return transform.location + Location(offset * width * right.x, offset * width * right.y, 0.0f);
+    };
+    for (float offset : {-0.45f, 0.45f}) {
+      const auto inside = map.GetWaypoint(across(offset));
+      ASSERT_TRUE(inside.has_value());
+      ASSERT_EQ(inside->road_id, waypoint.road_id);
+      ASSERT_EQ(inside->lane_id, waypoint.lane_id);
+    }
+    for (float offset : {-0.55f, 0.55f}) {
+      const auto outside = map.GetWaypoint(across(offset));
+      ASSERT_TRUE(
+          !outside.has_value() ||
+          (outside->road_id != waypoint.road_id) ||
+          (outside->lane_id != waypoint.lane_id));
+    }
+  }
+}
+
+TEST(road, get_waypoint_in_lane) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    CheckLaneBoundaries(*map);
+    ASSERT_FALSE(map->GetWaypoint(Location(1e5f, 1e5f, 0.0f)).has_value());
+  }
+}
+
+TEST(road, get_waypoint_in_lane_with_offset) {
+  // Curved road whose lanes are shifted by a varying lane offset.
+  std::string opendrive = GeometriesOpenDrive;
+  const std::string lane_offset = R"(<laneOffset s="0" a="0" b="0" c="0" d="0"/>)";
+  opendrive.replace(
+      opendrive.find(lane_offset),
+      lane_offset.size(),
+      R"(<laneOffset s="0" a="-1" b="0.02" c="0" d="0"/>)");
+  auto map = OpenDriveParser::Load(opendrive);
+  ASSERT_TRUE(map.has_value());
+  CheckLaneBoundaries(*map);
+}
+
+TEST(road, information_set) {
+  // Random infos of a few types, with the raw pointers kept as reference.
+  std::vector<std::unique_ptr<RoadInfo>> infos;
+  std::vector<RoadInfoSpeed *> speeds;
+  std::vector<RoadInfoLaneOffset *> offsets;
+  for (auto i = 0u; i < 200u; ++i) {
+    const double s = Random::Uniform(0.0, 1000.0);
+    if (i % 3u == 0u) {
+      speeds.emplace_back(new RoadInfoSpeed(s, 10.0));
+      infos.emplace_back(speeds.back());
+    } else {
+      offsets.emplace_back(new RoadInfoLaneOffset(s, 0.0, 0.0, 0.0, 0.0));
+      infos.emplace_back(offsets.back());
+    }
+  }
+  const InformationSet set(std::move(infos));
+  ASSERT_EQ(set.GetAll().size(), 200u);
+  ASSERT_EQ(set.GetInfos<RoadInfoSpeed>().size(), speeds.size());
+  ASSERT_TRUE(set.GetInfos<RoadInfoGeometry>().empty());
+  ASSERT_EQ(set.GetInfo<RoadInfoGeometry>(500.0), nullptr);
+
+  // The last info of the type starting at or before s.
+  auto find = [](const auto &vec, double s) {
+    typename std::decay_t<decltype(vec)>::value_type result = nullptr;
+    for (auto info : vec) {
+      if ((info->GetDistance() <= s) &&
+          ((result == nullptr) || (info->GetDistance() > result->GetDistance()))) {
+        result = info;
+      }
+    }
+    return result;
+  };
+  for (auto i = 0u; i < 1000u; ++i) {
+    const double s = Random::Uniform(-10.0, 1010.0);
+    ASSERT_EQ(set.GetInfo<RoadInfoSpeed>(s), find(speeds, s));
+    ASSERT_EQ(set.GetInfo<RoadInfoLaneOffset>(s), find(offsets, s));
+  }
+  for (auto *speed : speeds) {
+    ASSERT_EQ(set.GetInfo<RoadInfoSpeed>(speed->GetDistance()), speed);
+  }
+  const auto &sorted = set.GetInfos<RoadInfoLaneOffset>();
+  ASSERT_TRUE(std::is_sorted(sorted.begin(), sorted.end(), [](auto *a, auto *b) {
+    return a->GetDistance() < b->GetDistance();
+  }));
+}
+
+TEST(road, road_info_lookup_benchmark) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto waypoints = map->GenerateWaypoints(1.0);
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 10'000u; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+
+    float checksum = 0.0f;
+    carla::StopWatch stop_watch;
+    for (auto i = 0u; i < 10u; ++i) {
+      for (const auto &waypoint : waypoints) {
+        checksum += map->ComputeTransform(waypoint).location.z;
+      }
+    }
+    const auto transform_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+    stop_watch.Restart();
+    for (const auto &location : locations) {
+      auto waypoint = map->GetWaypoint(location);
+      checksum += waypoint.has_value() ? static_cast<float>(waypoint->s) : 0.0f;
+    }
+    const auto get_waypoint_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+
+    carla::logging::log(
+        file, ':', 10u * waypoints.size(), "ComputeTransform in", transform_time,
+        "us,", locations.size(), "GetWaypoint in", get_waypoint_time, "us (checksum",
+        checksum, ").");
+  }
+#endif // NDEBUG
+}
+
+static bool Equal(const std::vector<LaneMarking> &lhs, const std::vector<LaneMarking> &rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const auto &a, const auto &b) {
+    return (a.type == b.type) && (a.color == b.color) &&
+           (a.lane_change == b.lane_change) && (a.width == b.width);
+  });
+}
+
+TEST(road, calculate_crossed_lanes_batch) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    auto waypoints = map->GenerateWaypoints(10.0);
+    Random::Shuffle(waypoints);
+    waypoints.resize(std::min<size_t>(waypoints.size(), 25u));
+
+    // Four corners per vehicle, each moving randomly around its lane.
+    std::vector<Location> corners;
+    for (const auto &waypoint : waypoints) {
+      const auto location = map->ComputeTransform(waypoint).location;
+      for (auto i = 0u; i < 4u; ++i) {
+        corners.emplace_back(location + Random::Location(-2.0f, 2.0f));
+      }
+    }
+
+    std::vector<LaneCrossingCalculator::Hint> hints;
+    size_t number_of_crossings = 0u;
+    size_t batch_time = 0u;
+    size_t single_time = 0u;
+    for (auto tick = 0u; tick < 20u; ++tick) {
+      std::vector<LaneCrossingCalculator::Segment> segments;
+      for (auto &corner : corners) {
+        auto next = corner + Random::Location(-1.5f, 1.5f);
+        next.z = corner.z;
+        segments.emplace_back(corner, next);
+        corner = next;
+      }
+
+      const auto previous_hints = hints;
+      carla::StopWatch stop_watch;
+      const auto batch = map->CalculateCrossedLanes(segments, hints);
+      batch_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+      ASSERT_EQ(batch.size(), segments.size());
+
+      // The lanes found may differ only where lanes overlap, in junctions.
+      auto in_junction = [&](const boost::optional<Waypoint> &waypoint) {
+        return waypoint.has_value() && map->IsJunction(waypoint->road_id);
+      };
+      stop_watch.Restart();
+      for (auto i = 0u; i < segments.size(); ++i) {
+        const auto single = map->CalculateCrossedLanes(segments[i].first, segments[i].second);
+        ASSERT_TRUE(
+            Equal(batch[i], single) ||
+            (i < previous_hints.size() && in_junction(previous_hints[i].waypoint)) ||
+            in_junction(hints[i].waypoint) ||
+            in_junction(map->GetWaypoint(segments[i].first)) ||
+            in_junction(map->GetWaypoint(segments[i].second)));
+        number_of_crossings += single.size();
+      }
+      single_time += stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    }
+    carla::logging::log(
+        file, ':', number_of_crossings, "crossings, batch in", batch_time,
+        "us, one by one in", single_time, "us.");
+  }
+}
+
+TEST(road, get_waypoint_with_hint) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    auto actors = map->GenerateWaypoints(10.0);
+    Random::Shuffle(actors);
+    actors.resize(std::min<size_t>(actors.size(), 100u));
+
+    // Actors driving along their lanes, drifting sideways.
+    std::vector<std::vector<Location>> trajectories(actors.size());
+    for (auto i = 0u; i < actors.size(); ++i) {
+      auto waypoint = actors[i];
+      for (auto tick = 0u; tick < 50u; ++tick) {
+        const auto next = map->GetNext(waypoint, 0.5);
+        if (next.empty()) {
+          break;
+        }
+        waypoint = next.front();
+        const auto transform = map->ComputeTransform(waypoint);
+        const auto forward = transform.GetForwardVector();
+        const auto offset = static_cast<float>(Random::Uniform(-1.5, 1.5));
+        trajectories[i].emplace_back(
+            transform.location + Location(-offset * forward.y, offset * forward.x, 0.0f));
+      }
+    }
+
+    // Whether @a waypoint is in the lanes searched first from @a hint.
+    auto is_near = [&](const Waypoint &hint, const Waypoint &waypoint) {
+      if ((waypoint.road_id == hint.road_id) && (waypoint.section_id == hint.section_id)) {
+        return true;
+      }
+      auto lanes = map->GetSuccessors(hint);
+      const auto predecessors = map->GetPredecessors(hint);
+      lanes.insert(lanes.end(), predecessors.begin(), predecessors.end());
+      return std::any_of(lanes.begin(), lanes.end(), [&](const auto &lane) {
+        return (lane.road_id == waypoint.road_id) &&
+               (lane.section_id == waypoint.section_id) &&
+               (lane.lane_id == waypoint.lane_id);
+      });
+    };
+
+    size_t queries = 0u;
+    size_t hits = 0u;
+    size_t mismatches = 0u;
+    size_t hint_time = 0u;
+    size_t global_time = 0u;
+    size_t closest_hint_time = 0u;
+    size_t closest_global_time = 0u;
+    for (const auto &trajectory : trajectories) {
+      boost::optional<Waypoint> hint;
+      for (const auto &location : trajectory) {
+        carla::StopWatch stop_watch;
+        const auto global = map->GetWaypoint(location);
+        global_time += stop_watch.GetElapsedTime<std::chrono::nanoseconds>();
+        if (!hint.has_value()) {
+          hint = global;
+          continue;
+        }
+        stop_watch.Restart();
+        const auto found = map->GetWaypoint(location, *hint);
+        hint_time += stop_watch.GetElapsedTime<std::chrono::nanoseconds>();
+        ASSERT_EQ(found.has_value(), global.has_value());
+
+        stop_watch.Restart();
+        const auto closest = map->GetClosestWaypointOnRoad(location, *hint);
+        closest_hint_time += stop_watch.GetElapsedTime<std::chrono::nanoseconds>();
+        stop_watch.Restart();
+        const auto closest_global = map->GetClosestWaypointOnRoad(location);
+        closest_global_time += stop_watch.GetElapsedTime<std::chrono::nanoseconds>();
+        ASSERT_TRUE(closest.has_value());
+        ASSERT_TRUE(closest_global.has_value());
+
+        ++queries;
+        if (found.has_value()) {
+          hits += is_near(*hint, *found) ? 1u : 0u;
+          // Only where lanes overlap, in junctions, the lane found may differ.
+          if ((found->road_id != global->road_id) || (found->lane_id != global->lane_id)) {
+            ASSERT_TRUE(map->IsJunction(found->road_id) || map->IsJunction(global->road_id));
+            ++mismatches;
+          } else {
+            ASSERT_NEAR(found->s, global->s, 1e-3);
+          }
+          hint = found;
+        }
+      }
+    }
+    ASSERT_GT(queries, 0u);
+    carla::logging::log(
+        file, ':', queries, "queries,", 100u * hits / queries, "% found near the hint,",
+        mismatches, "in a different lane of a junction. GetWaypoint",
+        global_time / 1000u, "us, with hint", hint_time / 1000u,
+        "us; GetClosestWaypointOnRoad", closest_global_time / 1000u,
+        "us, with hint", closest_hint_time / 1000u, "us.");
+  }
+}
+
+TEST(road, get_waypoint_with_invalid_hint) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto waypoints = map->GenerateWaypoints(10.0);
+    ASSERT_FALSE(waypoints.empty());
+    const auto &valid = waypoints.front();
+    auto make_hint = [&](auto &&modify) {
+      auto hint = valid;
+      modify(hint);
+      return hint;
+    };
+    // Stale hints, or hints from another map, fall back to the search in the
+    // whole map.
+    const std::vector<Waypoint> hints = {
+        make_hint([](Waypoint &w) { w.road_id = std::numeric_limits<RoadId>::max(); }),
+        make_hint([](Waypoint &w) { w.section_id = std::numeric_limits<SectionId>::max(); }),
+        make_hint([](Waypoint &w) { w.lane_id = 1000; }),
+        make_hint([](Waypoint &w) { w.lane_id = 0; }),
+        make_hint([](Waypoint &w) { w.s = std::numeric_limits<double>::quiet_NaN(); })};
+    auto same = [](const boost::optional<Waypoint> &lhs, const boost::optional<Waypoint> &rhs) {
+      return (lhs.has_value() == rhs.has_value()) && (!lhs.has_value() || (*lhs == *rhs));
+    };
+    for (const auto &waypoint : waypoints) {
+      const auto location = map->ComputeTransform(waypoint).location;
+      const auto expected = map->GetWaypoint(location);
+      const auto expected_closest = map->GetClosestWaypointOnRoad(location);
+      for (const auto &hint : hints) {
+        ASSERT_TRUE(same(map->GetWaypoint(location, hint), expected));
+        ASSERT_TRUE(same(map->GetClosestWaypointOnRoad(location, hint), expected_closest));
+      }
+    }
+  }
+}
+
+TEST(road, calculate_crossed_lanes_across_sections) {
+  auto same_lane = [](const boost::optional<Waypoint> &lhs, const Waypoint &rhs) {
+    return lhs.has_value() &&
+           (lhs->road_id == rhs.road_id) &&
+           (lhs->section_id == rhs.section_id) &&
+           (lhs->lane_id == rhs.lane_id);
+  };
+  // Lane marking of the outer or the inner border of a lane.
+  auto marking = [](const Map &map, const Waypoint &waypoint, bool outer) {
+    const auto marks = map.GetMarkRecord(waypoint);
+    const auto mark = outer ? marks.first : marks.second;
+    return mark != nullptr ? std::vector<LaneMarking>{LaneMarking(*mark)} : std::vector<LaneMarking>{};
+  };
+  auto is_driving = [](const Map &map, const boost::optional<Waypoint> &waypoint) {
+    return waypoint.has_value() && (map.GetLaneType(*waypoint) == Lane::LaneType::Driving);
+  };
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    size_t same_section = 0u;
+    size_t other_section = 0u;
+    size_t junction = 0u;
+    for (const auto &waypoint : map->GenerateWaypoints(2.0)) {
+      const auto origin = map->ComputeTransform(waypoint).location;
+      if (!same_lane(map->GetWaypoint(origin), waypoint)) {
+        continue; // Overlapping lanes.
+      }
+
+      // Two lanes to the right in the same section.
+      const auto right = map->GetRight(waypoint);
+      const auto right2 = right.has_value() ? map->GetRight(*right) : boost::optional<Waypoint>{};
+      if (is_driving(*map, right2)) {
+        const auto destination = map->ComputeTransform(*right2).location;
+        if (same_lane(map->GetWaypoint(destination), *right2)) {
+          auto expected = marking(*map, waypoint, true);
+          const auto outer = marking(*map, *right, true);
+          expected.insert(expected.end(), outer.begin(), outer.end());
+          ASSERT_TRUE(Equal(map->CalculateCrossedLanes(origin, destination), expected));
+          ++same_section;
+        }
+      }
+
+      // To the left lane a few meters ahead, maybe in another section, road
+      // or junction.
+      for (const auto &next : map->GetNext(waypoint, 3.0)) {
+        const auto left = map->GetLeft(next);
+        if (!is_driving(*map, left)) {
+          continue;
+        }
+        const auto destination = map->ComputeTransform(*left).location;
+        if (!same_lane(map->GetWaypoint(destination), *left)) {
+          continue; // Overlapping lanes.
+        }
+        const bool is_same_section =
+            (next.road_id == waypoint.road_id) && (next.section_id == waypoint.section_id);
+        const auto expected = marking(*map, is_same_section ? waypoint : next, false);
+        ASSERT_TRUE(Equal(map->CalculateCrossedLanes(origin, destination), expected));
+        if (map->IsJunction(waypoint.road_id) || map->IsJunction(next.road_id)) {
+          ++junction;
+        } else if (is_same_section) {
+          ++same_section;
+        } else {
+          ++other_section;
+        }
+      }
+    }
+    carla::logging::log(
+        file, ':', same_section, "crossings in the same section,", other_section,
+        "to another section,", junction, "in junctions.");
+    ASSERT_GT(other_section, 0u);
+    ASSERT_GT(junction, 0u);
+  }
+}
+
+TEST(road, cached_waypoints_and_topology) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    auto map = OpenDriveParser::Load(opendrive);
+    ASSERT_TRUE(map.has_value());
+
+    // Same results as generating them, generated only once.
+    carla::StopWatch stop_watch;
+    const auto waypoints = map->GetCachedWaypoints(2.0);
+    const auto first_call = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    ASSERT_EQ(*waypoints, map->GenerateWaypoints(2.0));
+    stop_watch.Restart();
+    ASSERT_EQ(map->GetCachedWaypoints(2.0), waypoints);
+    const auto second_call = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    ASSERT_NE(map->GetCachedWaypoints(5.0), waypoints);
+    ASSERT_EQ(*map->GetCachedWaypoints(5.0), map->GenerateWaypoints(5.0));
+    const auto topology = map->GetCachedTopology();
+    ASSERT_EQ(*topology, map->GenerateTopology());
+    ASSERT_EQ(map->GetCachedTopology(), topology);
+    carla::logging::log(
+        file, ": generating waypoints took", first_call, "us, cached", second_call, "us");
+
+    // Compiled maps keep the cached results.
+    const auto source_hash = CompiledMap::Hash(opendrive);
+    const auto buffer = CompiledMap::Serialize(*map, source_hash);
+    auto compiled = CompiledMap::Deserialize(buffer.data(), buffer.size(), source_hash);
+    ASSERT_TRUE(compiled.has_value());
+    ASSERT_EQ(*compiled->GetCachedWaypoints(2.0), *waypoints);
+    ASSERT_EQ(*compiled->GetCachedWaypoints(5.0), *map->GetCachedWaypoints(5.0));
+    ASSERT_EQ(*compiled->GetCachedTopology(), *topology);
+    ASSERT_EQ(CompiledMap::Serialize(*compiled, source_hash), buffer);
+
+    // Only the distances most recently asked for are kept.
+    for (auto i = 0u; i < Map::MaxCachedWaypointLists; ++i) {
+      map->GetCachedWaypoints(10.0 + i);
+    }
+    const auto regenerated = map->GetCachedWaypoints(2.0);
+    ASSERT_NE(regenerated, waypoints);
+    ASSERT_EQ(*regenerated, *waypoints);
+    ASSERT_EQ(map->GetCachedWaypoints(2.0), regenerated);
+  }
+}
+
+TEST(road, export_waypoints) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto waypoints = map->GenerateWaypoints(1.0);
+    carla::StopWatch stop_watch;
+    const auto arrays = map->ExportWaypoints(waypoints);
+    carla::logging::log(
+        file, ':', waypoints.size(), "waypoints exported in",
+        stop_watch.GetElapsedTime<std::chrono::microseconds>(), "us");
+    ASSERT_EQ(arrays.size(), waypoints.size());
+    auto check_marking = [](
+        const RoadInfoMarkRecord *record,
+        uint8_t type,
+        uint8_t color,
+        uint8_t lane_change,
+        double width) {
+      if (record == nullptr) {
+        ASSERT_EQ(type, static_cast<uint8_t>(LaneMarking::Type::None));
+        return;
+      }
+      const LaneMarking marking(*record);
+      ASSERT_EQ(type, static_cast<uint8_t>(marking.type));
+      ASSERT_EQ(color, static_cast<uint8_t>(marking.color));
+      ASSERT_EQ(lane_change, static_cast<uint8_t>(marking.lane_change));
+      ASSERT_EQ(width, marking.width);
+    };
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      const auto &waypoint = waypoints[i];
+      ASSERT_EQ(arrays.road_ids[i], waypoint.road_id);
+      ASSERT_EQ(arrays.section_ids[i], waypoint.section_id);
+      ASSERT_EQ(arrays.lane_ids[i], waypoint.lane_id);
+      ASSERT_EQ(arrays.s[i], waypoint.s);
+      ASSERT_EQ(arrays.transforms[i], map->ComputeTransform(waypoint));
+      ASSERT_EQ(arrays.lane_widths[i], map->GetLaneWidth(waypoint));
+      ASSERT_EQ(arrays.lane_types[i], static_cast<uint32_t>(map->GetLaneType(waypoint)));
+      ASSERT_EQ(arrays.junction_ids[i], map->GetJunctionId(waypoint.road_id));
+      const auto marks = map->GetMarkRecord(waypoint);
+      check_marking(
+          marks.first,
+          arrays.right_marking_types[i],
+          arrays.right_marking_colors[i],
+          arrays.right_marking_lane_changes[i],
+          arrays.right_marking_widths[i]);
+      check_marking(
+          marks.second,
+          arrays.left_marking_types[i],
+          arrays.left_marking_colors[i],
+          arrays.left_marking_lane_changes[i],
+          arrays.left_marking_widths[i]);
+    }
+  }
+}
+
+TEST(road, lane_graph) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto &graph = map->GetLaneGraph();
+    size_t number_of_lanes = 0u;
+    for (const auto &road : map->GetMap().GetRoads()) {
+      for (const auto &section : road.second.GetLaneSections()) {
+        number_of_lanes += section.GetLanes().size();
+      }
+    }
+    ASSERT_EQ(graph.GetNumberOfLanes(), number_of_lanes);
+
+    for (auto i = 0u; i < graph.GetNumberOfLanes(); ++i) {
+      const auto &node = graph.GetNode(i);
+      const auto &lane = map->GetMap().GetRoad(node.road_id).GetLaneById(node.section_id, node.lane_id);
+      ASSERT_EQ(&graph.GetLane(i), &lane);
+      ASSERT_EQ(graph.GetIndex(node.road_id, node.section_id, node.lane_id), i);
+      ASSERT_EQ(node.s, lane.GetDistance());
+      ASSERT_EQ(node.length, lane.GetLength());
+
+      // Same links as the lanes.
+      std::vector<const Lane *> next_lanes;
+      for (const auto index : graph.GetSuccessors(i)) {
+        next_lanes.emplace_back(&graph.GetLane(index));
+      }
+      ASSERT_TRUE(std::equal(
+          next_lanes.begin(), next_lanes.end(),
+          lane.GetNextLanes().begin(), lane.GetNextLanes().end()));
+      std::vector<const Lane *> previous_lanes;
+      for (const auto index : graph.GetPredecessors(i)) {
+        previous_lanes.emplace_back(&graph.GetLane(index));
+      }
+      ASSERT_TRUE(std::equal(
+          previous_lanes.begin(), previous_lanes.end(),
+          lane.GetPreviousLanes().begin(), lane.GetPreviousLanes().end()));
+
+      // Right and left lanes, skipping the center lane.
+      if (node.lane_id == 0) {
+        continue;
+      }
+      const auto &lanes = lane.GetLaneSection()->GetLanes();
+      auto check_neighbour = [&](LaneGraph::LaneIndex index, LaneId lane_id) {
+        if (lanes.find(lane_id) == lanes.end()) {
+          ASSERT_EQ(index, LaneGraph::InvalidIndex);
+        } else {
+          ASSERT_NE(index, LaneGraph::InvalidIndex);
+          ASSERT_EQ(graph.GetNode(index).lane_id, lane_id);
+          ASSERT_EQ(graph.GetNode(index).section_id, node.section_id);
+        }
+      };
+      const LaneId sign = node.lane_id > 0 ? 1 : -1;
+      check_neighbour(graph.GetRight(i), node.lane_id + sign);
+      check_neighbour(graph.GetLeft(i), std::abs(node.lane_id) == 1 ? -node.lane_id : node.lane_id - sign);
+    }
+    ASSERT_EQ(graph.GetIndex(Waypoint{0u, 1000u, -1, 0.0}), LaneGraph::InvalidIndex);
+    ASSERT_EQ(graph.GetIndex(Waypoint{0u, 0u, -100, 0.0}), LaneGraph::InvalidIndex);
+
+#ifdef NDEBUG
+    const auto waypoints = map->GenerateWaypoints(1.0);
+    double checksum = 0.0;
+    carla::StopWatch stop_watch;
+    for (auto i = 0u; i < 10u; ++i) {
+      for (const auto &waypoint : waypoints) {
+        checksum += map->GetMap().GetRoad(waypoint.road_id).GetLaneById(
+            waypoint.section_id, waypoint.lane_id).GetDistance();
+      }
+    }
+    const auto lookup_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    stop_watch.Restart();
+    for (auto i = 0u; i < 10u; ++i) {
+      for (const auto &waypoint : waypoints) {
+        checksum += map->GetLane(waypoint).GetDistance();
+      }
+    }
+    const auto get_lane_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    stop_watch.Restart();
+    for (const auto &waypoint : waypoints) {
+      for (const auto &next : map->GetNext(waypoint, 50.0)) {
+        checksum += next.s;
+      }
+    }
+    const auto get_next_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    stop_watch.Restart();
+    const auto topology = map->GenerateTopology();
+    const auto topology_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+    carla::logging::log(
+        file, ':', 10u * waypoints.size(), "lane lookups in", lookup_time, "us by ids,",
+        get_lane_time, "us by index;", waypoints.size(), "GetNext(50) in", get_next_time,
+        "us; topology of", topology.size(), "links in", topology_time, "us (checksum",
+        checksum, ").");
+#endif // NDEBUG
+  }
+}
+
+TEST(road, signals_ahead) {
+  pugi::xml_document xml;
+  const auto opendrive = util::OpenDrive::Load("Grid4.xodr");
+  ASSERT_TRUE(xml.load_string(opendrive.c_str()));
+  auto root = xml.child("OpenDRIVE");
+  auto find_road = [&](const char *id) {
+    return root.find_child_by_attribute("road", "id", id);
+  };
+  // A stop sign for lane -1 of road 1, referenced from road 2, and a speed
+  // limit for the left lanes of road 1.
+  auto signals = find_road("1").append_child("signals");
+  auto stop = signals.append_child("signal");
+  stop.append_attribute("id") = 1000;
+  stop.append_attribute("s") = 50.0;
+  stop.append_attribute("name") = "Stop";
+  stop.append_attribute("dynamic") = "no";
+  stop.append_attribute("orientation") = "+";
+  stop.append_attribute("type") = "206";
+  auto validity = stop.append_child("validity");
+  validity.append_attribute("fromLane") = -1;
+  validity.append_attribute("toLane") = -1;
+  auto limit = signals.append_child("signal");
+  limit.append_attribute("id") = 1001;
+  limit.append_attribute("s") = 20.0;
+  limit.append_attribute("name") = "SpeedLimit";
+  limit.append_attribute("dynamic") = "no";
+  limit.append_attribute("orientation") = "-";
+  limit.append_attribute("type") = "274";
+  limit.append_attribute("value") = 30.0;
+  auto reference = find_road("2").append_child("signals").append_child("signalReference");
+  reference.append_attribute("id") = 1000;
+  reference.append_attribute("s") = 10.0;
+  reference.append_attribute("orientation") = "+";
+  std::ostringstream out;
+  xml.save(out);
+  auto map = OpenDriveParser::Load(out.str());
+  ASSERT_TRUE(map.has_value());
+
+  auto get_ids = [](const std::vector<SignalAhead> &signals) {
+    std::vector<SignId> ids;
+    for (const auto &item : signals) {
+      ids.emplace_back(item.signal->GetSignalId());
+    }
+    return ids;
+  };
+
+  // Right lanes drive towards increasing s.
+  const auto ahead = map->GetSignalsAhead(Waypoint{1u, 0u, -1, 10.0}, 45.0);
+  ASSERT_EQ(get_ids(ahead), std::vector<SignId>{1000u});
+  ASSERT_NEAR(ahead[0u].distance, 40.0, 1e-6);
+  ASSERT_EQ(ahead[0u].waypoint.road_id, 1u);
+  ASSERT_EQ(ahead[0u].waypoint.section_id, 1u);
+  ASSERT_EQ(ahead[0u].waypoint.lane_id, -1);
+  ASSERT_NEAR(ahead[0u].waypoint.s, 50.0, 1e-6);
+  ASSERT_EQ(ahead[0u].signal->GetName(), "Stop");
+  ASSERT_FALSE(ahead[0u].signal->IsDynamic());
+  ASSERT_TRUE(map->GetSignalsAhead(Waypoint{1u, 0u, -1, 10.0}, 35.0).empty());
+  ASSERT_TRUE(map->GetSignalsAhead(Waypoint{1u, 1u, -1, 51.0}, 20.0).empty());
+
+  // Out of the validity of the stop sign.
+  ASSERT_TRUE(map->GetSignalsAhead(Waypoint{1u, 0u, -2, 10.0}, 45.0).empty());
+
+  // Left lanes drive towards decreasing s.
+  const auto left = map->GetSignalsAhead(Waypoint{1u, 1u, 1, 60.0}, 45.0);
+  ASSERT_EQ(get_ids(left), std::vector<SignId>{1001u});
+  ASSERT_NEAR(left[0u].distance, 40.0, 1e-6);
+  ASSERT_EQ(left[0u].signal->GetValue(), 30.0);
+  ASSERT_TRUE(map->GetSignalsAhead(Waypoint{1u, 0u, 1, 19.0}, 45.0).empty());
+
+  // The reference is found from the lanes leading to road 2.
+  const auto predecessors = map->GetPredecessors(Waypoint{2u, 0u, -1, 1.0});
+  ASSERT_FALSE(predecessors.empty());
+  for (const auto &waypoint : predecessors) {
+    const auto signals_ahead = map->GetSignalsAhead(waypoint, 20.0);
+    ASSERT_EQ(get_ids(signals_ahead), std::vector<SignId>{1000u});
+    ASSERT_NEAR(signals_ahead[0u].distance, 10.0, 0.1);
+    ASSERT_EQ(signals_ahead[0u].waypoint.road_id, 2u);
+  }
+
+  // Each signal is reported once, at its nearest position.
+  for (const auto &waypoint : map->GenerateWaypoints(5.0)) {
+    const auto signals_ahead = map->GetSignalsAhead(waypoint, 200.0);
+    auto ids = get_ids(signals_ahead);
+    std::sort(ids.begin(), ids.end());
+    ASSERT_EQ(std::unique(ids.begin(), ids.end()), ids.end());
+    ASSERT_TRUE(std::is_sorted(
+        signals_ahead.begin(), signals_ahead.end(),
+        [](const auto &lhs, const auto &rhs) { return lhs.distance < rhs.distance; }));
+  }
+}
+
+TEST(road, signals_ahead_far) {
+  pugi::xml_document xml;
+  const auto opendrive = util::OpenDrive::Load("Grid10.xodr");
+  ASSERT_TRUE(xml.load_string(opendrive.c_str()));
+  // A single signal for both directions of road 1.
+  auto road = xml.child("OpenDRIVE").find_child_by_attribute("road", "id", "1");
+  auto signal = road.append_child("signals").append_child("signal");
+  signal.append_attribute("id") = 1000;
+  signal.append_attribute("s") = 20.0;
+  signal.append_attribute("name") = "Stop";
+  signal.append_attribute("dynamic") = "no";
+  signal.append_attribute("orientation") = "none";
+  signal.append_attribute("type") = "206";
+  std::ostringstream out;
+  xml.save(out);
+  auto map = OpenDriveParser::Load(out.str());
+  ASSERT_TRUE(map.has_value());
+
+  // Searching far explores each lane of the grid once, a nearer search finds
+  // the same signals at the same distances.
+  const auto waypoints = map->GenerateWaypoints(100.0);
+  size_t found = 0u;
+  carla::StopWatch stop_watch;
+  for (const auto &waypoint : waypoints) {
+    const auto far = map->GetSignalsAhead(waypoint, 2000.0);
+    ASSERT_LE(far.size(), 1u);
+    found += far.size();
+    for (const auto distance : {50.0, 200.0, 600.0}) {
+      const auto near = map->GetSignalsAhead(waypoint, distance);
+      if (far.empty() || (far[0u].distance > distance)) {
+        ASSERT_TRUE(near.empty());
+      } else {
+        ASSERT_EQ(near.size(), 1u);
+        ASSERT_NEAR(near[0u].distance, far[0u].distance, 1e-6);
+        ASSERT_EQ(near[0u].signal, far[0u].signal);
+      }
+    }
+  }
+  const auto elapsed = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  ASSERT_GT(found, waypoints.size() / 2u);
+  carla::logging::log(
+      "Grid10:", 4u * waypoints.size(), "signal searches up to 2000 m in", elapsed, "us.");
+}
@@ -0,0 +1,339 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/pointcloud/PointCloudFilter.h>
+#include <carla/pointcloud/PointCloudIO.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using carla::geom::Location;
+using carla::pointcloud::PointCloudFilter;
+using carla::pointcloud::PointCloudIO;
+
+static std::vector<Location> MakePoints(size_t count) {
+  std::vector<Location> points;
+  points.reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    points.emplace_back(
+        static_cast<float>(util::Random::Uniform(-100.0, 100.0)),
+        static_cast<float>(util::Random::Uniform(-100.0, 100.0)),
+        static_cast<float>(util::Random::Uniform(-10.0, 10.0)));
+  }
+  return points;
+}
+
+static std::string Dump(
+    PointCloudIO::Format format,
+    const std::vector<Location> &points,
+    const std::vector<uint32_t> &point_count_by_channel = {}) {
+  std::ostringstream out;
+  PointCloudIO::Dump(out, format, points.data(), points.data() + points.size(), point_count_by_channel);
+  return out.str();
+}
+
+template <typename T>
+static T ReadBytes(const char *&src) {
+  T value;
+  std::memcpy(&value, src, sizeof(T));
+  src += sizeof(T);
+  return value;
+}
+
+TEST(pointcloud, ascii_ply) {
+  const auto points = MakePoints(100u);
+  std::ostringstream expected;
+  PointCloudIO::Dump(expected, points.begin(), points.end());
+  ASSERT_EQ(Dump(PointCloudIO::Format::AsciiPly, points), expected.str());
+
+  const auto with_channel = Dump(PointCloudIO::Format::AsciiPly, points, {60u, 40u});
+  ASSERT_NE(with_channel.find("property uint16 channel\nend_header\n"), std::string::npos);
+  std::istringstream in(with_channel.substr(with_channel.find("end_header\n") + 11u));
+  for (auto i = 0u; i < points.size(); ++i) {
+    float x, y, z;
+    unsigned channel;
+    ASSERT_TRUE(static_cast<bool>(in >> x >> y >> z >> channel));
+    ASSERT_NEAR(x, points[i].x, 1e-4f);
+    ASSERT_EQ(channel, i < 60u ? 0u : 1u);
+  }
+}
+
+TEST(pointcloud, binary_ply) {
+  const auto points = MakePoints(100u);
+  for (auto with_channel : {false, true}) {
+    const std::vector<uint32_t> counts = with_channel ? std::vector<uint32_t>{10u, 0u, 90u} : std::vector<uint32_t>{};
+    const auto data = Dump(PointCloudIO::Format::BinaryPly, points, counts);
+    const std::string header =
+        "ply\n"
+        "format binary_little_endian 1.0\n"
+        "element vertex 100\n"
+        "property float32 x\n"
+        "property float32 y\n"
+        "property float32 z\n" +
+        std::string(with_channel ? "property uint16 channel\n" : "") +
+        "end_header\n";
+    ASSERT_EQ(data.substr(0u, header.size()), header);
+    const size_t vertex_size = 3u * sizeof(float) + (with_channel ? sizeof(uint16_t) : 0u);
+    ASSERT_EQ(data.size(), header.size() + vertex_size * points.size());
+    const char *src = data.data() + header.size();
+    for (auto i = 0u; i < points.size(); ++i) {
+      ASSERT_EQ(ReadBytes<float>(src), points[i].x);
+      ASSERT_EQ(ReadBytes<float>(src), points[i].y);
+      ASSERT_EQ(ReadBytes<float>(src), points[i].z);
+      if (with_channel) {
+        ASSERT_EQ(ReadBytes<uint16_t>(src), i < 10u ? 0u : 2u);
+      }
+    }
+  }
+}
+
+TEST(pointcloud, bin) {
+  const auto points = MakePoints(100u);
+  for (auto with_channel : {false, true}) {
+    const std::vector<uint32_t> counts = with_channel ? std::vector<uint32_t>{50u, 50u} : std::vector<uint32_t>{};
+    const auto data = Dump(PointCloudIO::Format::Bin, points, counts);
+    ASSERT_EQ(data.size(), 4u * sizeof(float) * points.size());
+    const char *src = data.data();
+    for (auto i = 0u; i < points.size(); ++i) {
+      ASSERT_EQ(ReadBytes<float>(src), points[i].x);
+      ASSERT_EQ(ReadBytes<float>(src), points[i].y);
+      ASSERT_EQ(ReadBytes<float>(src), points[i].z);
+      ASSERT_EQ(ReadBytes<float>(src), with_channel && (i >= 50u) ? 1.0f : 0.0f);
+    }
+  }
+  ASSERT_TRUE(Dump(PointCloudIO::Format::Bin, {}).empty());
+  ASSERT_THROW(Dump(PointCloudIO::Format::Bin, points, {50u, 49u}), std::invalid_argument);
+}
+
+template <typename FilterT>
+static std::vector<Location> Filter(const std::vector<Location> &points, FilterT &&filter) {
+  std::vector<Location> result(points.size());
+  result.resize(filter(points.data(), points.data() + points.size(), result.data()));
+  return result;
+}
+
+static auto MakeVoxel(const Location &point, float voxel_size) {
+  return std::make_tuple(
+      std::floor(point.x / voxel_size),
+      std::floor(point.y / voxel_size),
+      std::floor(point.z / voxel_size));
+}
+
+static bool LessXYZ(const Location &lhs, const Location &rhs) {
+  return std::tie(lhs.x, lhs.y, lhs.z) < std::tie(rhs.x, rhs.y, rhs.z);
+}
+
+TEST(pointcloud, voxel_downsample) {
+  const std::vector<Location> points = {
+      {0.1f, 0.1f, 0.1f}, {0.3f, 0.5f, 0.9f}, {1.5f, 0.5f, 0.5f}, {0.2f, 0.3f, 0.2f}, {-0.5f, 0.5f, 0.5f}};
+  auto result = Filter(points, [](auto begin, auto end, auto out) {
+    return PointCloudFilter::VoxelDownsample(begin, end, 1.0f, out);
+  });
+  std::sort(result.begin(), result.end(), LessXYZ);
+  ASSERT_EQ(result.size(), 3u);
+  ASSERT_EQ(result[0u], Location(-0.5f, 0.5f, 0.5f));
+  ASSERT_NEAR(result[1u].x, 0.2f, 1e-6f);
+  ASSERT_NEAR(result[1u].y, 0.3f, 1e-6f);
+  ASSERT_NEAR(result[1u].z, 0.4f, 1e-6f);
+  ASSERT_EQ(result[2u], Location(1.5f, 0.5f, 0.5f));
+
+  // Large enough to run in parallel.
+  constexpr float voxel_size = 4.0f; // Exact inverse, to match the reference.
+  const auto cloud = MakePoints(200000u);
+  std::map<std::tuple<float, float, float>, std::pair<carla::geom::Vector3D, size_t>> expected;
+  for (auto &point : cloud) {
+    auto &voxel = expected[MakeVoxel(point, voxel_size)];
+    voxel.first += point;
+    ++voxel.second;
+  }
+  auto downsampled = Filter(cloud, [&](auto begin, auto end, auto out) {
+    return PointCloudFilter::VoxelDownsample(begin, end, voxel_size, out);
+  });
+  ASSERT_EQ(downsampled.size(), expected.size());
+  for (auto &centroid : downsampled) {
+    auto it = expected.find(MakeVoxel(centroid, voxel_size));
+    ASSERT_NE(it, expected.end());
+    const auto mean = it->second.first / static_cast<float>(it->second.second);
+    ASSERT_NEAR(centroid.x, mean.x, 1e-2f);
+    ASSERT_NEAR(centroid.y, mean.y, 1e-2f);
+    ASSERT_NEAR(centroid.z, mean.z, 1e-2f);
+  }
+  ASSERT_EQ(
+      Filter(cloud, [&](auto begin, auto end, auto out) {
+        return PointCloudFilter::VoxelDownsample(begin, end, voxel_size, out);
+      }),
+      downsampled);
+  ASSERT_THROW(PointCloudFilter::VoxelDownsample(nullptr, nullptr, 0.0f, nullptr), std::invalid_argument);
+
+  // Cells far apart must not share a key, and points out of the range of the
+  // grid are dropped.
+  constexpr float far = 2097152.0f; // 2^21.
+  const std::vector<Location> far_points = {
+      {0.5f, 0.5f, 0.5f},
+      {far + 0.5f, 0.5f, 0.5f},
+      {0.5f, -far + 0.5f, 0.5f},
+      {0.5f, 0.5f, 2.0f * far + 0.5f},
+      {1e30f, 0.5f, 0.5f},
+      {0.5f, std::numeric_limits<float>::quiet_NaN(), 0.5f},
+      {0.5f, 0.5f, -std::numeric_limits<float>::infinity()}};
+  auto far_result = Filter(far_points, [](auto begin, auto end, auto out) {
+    return PointCloudFilter::VoxelDownsample(begin, end, 1.0f, out);
+  });
+  std::sort(far_result.begin(), far_result.end(), LessXYZ);
+  ASSERT_EQ(far_result.size(), 4u);
+  ASSERT_EQ(far_result[0u], far_points[2u]);
+  ASSERT_EQ(far_result[1u], far_points[0u]);
+  ASSERT_EQ(far_result[2u], far_points[3u]);
+  ASSERT_EQ(far_result[3u], far_points[1u]);
+}
+
+TEST(pointcloud, crop) {
+  using carla::geom::BoundingBox;
+  using carla::geom::Rotation;
+  using carla::geom::Transform;
+  const auto cloud = MakePoints(100000u);
+  const BoundingBox box{Location{10.0f, -20.0f, 0.0f}, {30.0f, 15.0f, 5.0f}};
+  std::vector<Location> expected;
+  std::copy_if(cloud.begin(), cloud.end(), std::back_inserter(expected), [&](const Location &point) {
+    return
+        (std::abs(point.x - box.location.x) <= box.extent.x) &&
+        (std::abs(point.y - box.location.y) <= box.extent.y) &&
+        (std::abs(point.z - box.location.z) <= box.extent.z);
+  });
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(Filter(cloud, [&](auto begin, auto end, auto out) {
+    return PointCloudFilter::Crop(begin, end, box, out);
+  }), expected);
+  ASSERT_EQ(Filter(cloud, [&](auto begin, auto end, auto out) {
+    return PointCloudFilter::Crop(begin, end, box, Transform{}, out);
+  }), expected);
+
+  // A box 4 m long and 2 m wide in front of an actor at (10, 0, 0) facing +y.
+  const BoundingBox actor_box{Location{2.0f, 0.0f, 0.0f}, {2.0f, 1.0f, 1.0f}};
+  const Transform transform{Location{10.0f, 0.0f, 0.0f}, Rotation{0.0f, 90.0f, 0.0f}};
+  const std::vector<Location> points = {
+      {10.0f, 0.5f, 0.0f}, {10.0f, -0.5f, 0.0f}, {10.9f, 3.9f, 0.5f}, {11.1f, 2.0f, 0.0f}, {9.5f, 2.0f, -1.5f}};
+  ASSERT_EQ(Filter(points, [&](auto begin, auto end, auto out) {
+    return PointCloudFilter::Crop(begin, end, actor_box, transform, out);
+  }), (std::vector<Location>{points[0u], points[2u]}));
+}
+
+TEST(pointcloud, remove_ground) {
+  std::vector<Location> points;
+  for (auto x = 0; x < 10; ++x) {
+    for (auto y = 0; y < 10; ++y) {
+      points.emplace_back(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, 0.01f * static_cast<float>(x));
+    }
+  }
+  points.emplace_back(2.5f, 2.5f, 1.5f);
+  points.emplace_back(7.7f, 3.2f, 0.15f);
+  points.emplace_back(7.7f, 3.2f, 0.3f);
+  auto result = Filter(points, [](auto begin, auto end, auto out) {
+    return PointCloudFilter::RemoveGround(begin, end, 1.0f, 0.2f, out);
+  });
+  ASSERT_EQ(result, (std::vector<Location>{{2.5f, 2.5f, 1.5f}, {7.7f, 3.2f, 0.3f}}));
+
+  // Large enough to run in parallel.
+  const auto cloud = MakePoints(200000u);
+  std::map<std::pair<float, float>, float> lowest;
+  for (auto &point : cloud) {
+    const auto cell = std::make_pair(std::floor(point.x / 2.0f), std::floor(point.y / 2.0f));
+    auto it = lowest.emplace(cell, point.z).first;
+    it->second = std::min(it->second, point.z);
+  }
+  std::vector<Location> expected;
+  std::copy_if(cloud.begin(), cloud.end(), std::back_inserter(expected), [&](const Location &point) {
+    const auto cell = std::make_pair(std::floor(point.x / 2.0f), std::floor(point.y / 2.0f));
+    return (point.z - lowest[cell]) >= 1.0f;
+  });
+  ASSERT_EQ(Filter(cloud, [](auto begin, auto end, auto out) {
+    return PointCloudFilter::RemoveGround(begin, end, 2.0f, 1.0f, out);
+  }), expected);
+}
+
+#ifdef NDEBUG
+TEST(pointcloud, dump_benchmark) {
+  constexpr size_t number_of_points = 100000u;
+  constexpr int iterations = 10;
+  const auto points = MakePoints(number_of_points);
+  const std::vector<uint32_t> counts(32u, number_of_points / 32u);
+
+  auto measure = [&](const char *name, auto &&dump) {
+    size_t size = 0u;
+    carla::StopWatch stop_watch;
+    for (auto i = 0; i < iterations; ++i) {
+      std::ostringstream out;
+      dump(out);
+      size = static_cast<size_t>(out.tellp());
+    }
+    stop_watch.Stop();
+    carla::logging::log(
+        name, static_cast<double>(stop_watch.GetElapsedTime()) / iterations, "ms,",
+        size / 1024u, "KB");
+  };
+
+  measure("ascii ply (iterators):", [&](std::ostream &out) {
+    PointCloudIO::Dump(out, points.begin(), points.end());
+  });
+  measure("ascii ply:", [&](std::ostream &out) {
+    PointCloudIO::Dump(out, PointCloudIO::Format::AsciiPly, points.data(), points.data() + points.size());
+  });
+  measure("binary ply:", [&](std::ostream &out) {
+    PointCloudIO::Dump(out, PointCloudIO::Format::BinaryPly, points.data(), points.data() + points.size());
+  });
+  measure("binary ply with channel:", [&](std::ostream &out) {
+    PointCloudIO::Dump(out, PointCloudIO::Format::BinaryPly, points.data(), points.data() + points.size(), counts);
+  });
+  measure("bin:", [&](std::ostream &out) {
+    PointCloudIO::Dump(out, PointCloudIO::Format::Bin, points.data(), points.data() + points.size());
+  });
+}
+
+TEST(pointcloud, filter_benchmark) {
+  constexpr size_t number_of_points = 1000000u;
+  constexpr int iterations = 10;
+  const auto points = MakePoints(number_of_points);
+  std::vector<Location> out(number_of_points);
+
+  auto measure = [&](const char *name, auto &&filter) {
+    size_t count = 0u;
+    carla::StopWatch stop_watch;
+    for (auto i = 0; i < iterations; ++i) {
+      count = filter(points.data(), points.data() + points.size(), out.data());
+    }
+    stop_watch.Stop();
+    carla::logging::log(
+        name, static_cast<double>(stop_watch.GetElapsedTime()) / iterations, "ms,",
+        count, "points left");
+  };
+
+  measure("voxel downsample (0.5 m):", [](auto begin, auto end, auto result) {
+    return PointCloudFilter::VoxelDownsample(begin, end, 0.5f, result);
+  });
+  measure("crop:", [](auto begin, auto end, auto result) {
+    return PointCloudFilter::Crop(begin, end, carla::geom::BoundingBox{Location{}, {50.0f, 20.0f, 5.0f}}, result);
+  });
+  measure("oriented crop:", [](auto begin, auto end, auto result) {
+    const carla::geom::Transform transform{Location{}, carla::geom::Rotation{0.0f, 30.0f, 0.0f}};
+    return PointCloudFilter::Crop(begin, end, carla::geom::BoundingBox{Location{}, {50.0f, 20.0f, 5.0f}}, transform, result);
+  });
+  measure("remove ground (1 m, 0.2 m):", [](auto begin, auto end, auto result) {
+    return PointCloudFilter::RemoveGround(begin, end, 1.0f, 0.2f, result);
+  });
+}
+#endif // NDEBUG
@@ -0,0 +1,238 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+#include "Random.h"
+
+#include <carla/StopWatch.h>
+#include <carla/opendrive/OpenDriveParser.h>
+#include <carla/road/ContractionHierarchy.h>
+#include <carla/road/RoutingGraph.h>
+
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <sstream>
+
+using namespace carla::road;
+using namespace carla::road::element;
+using namespace carla::opendrive;
+using namespace util;
+
+using NodeId = RoutingGraph::NodeId;
+
+/// Plain Dijkstra on the routing graph, used as reference.
+static std::vector<double> ComputeDistances(const RoutingGraph &graph, NodeId origin) {
+  const auto &edges = graph.GetEdges();
+  std::vector<double> distances(graph.GetNumberOfNodes(), ContractionHierarchy::Infinity);
+  using Entry = std::pair<double, NodeId>;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+  distances[origin] = 0.0;
+  queue.emplace(0.0, origin);
+  while (!queue.empty()) {
+    const auto entry = queue.top();
+    queue.pop();
+    if (entry.first > distances[entry.second]) {
+      continue;
+    }
+    auto it = std::lower_bound(edges.begin(), edges.end(), entry.second, [](const auto &edge, NodeId node) {
+      return edge.source < node;
+    });
+    for (; (it != edges.end()) && (it->source == entry.second); ++it) {
+      const double distance = entry.first + it->weight;
+      if (distance < distances[it->target]) {
+        distances[it->target] = distance;
+        queue.emplace(distance, it->target);
+      }
+    }
+  }
+  return distances;
+}
+
+static std::vector<NodeId> RandomNodes(size_t number_of_nodes, size_t count) {
+  std::vector<NodeId> result;
+  result.reserve(count);
+  for (auto i = 0u; i < count; ++i) {
+    result.emplace_back(static_cast<NodeId>(Random::Uniform(0.0, number_of_nodes - 1u) + 0.5));
+  }
+  return result;
+}
+
+TEST(routing, contraction_hierarchy_distances) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("Parsing", file);
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const RoutingGraph graph(*map);
+    ASSERT_GT(graph.GetNumberOfNodes(), 0u);
+
+    carla::StopWatch stop_watch;
+    const ContractionHierarchy hierarchy(graph);
+    carla::logging::log(
+        file, "contracted", hierarchy.GetNumberOfNodes(), "nodes in",
+        stop_watch.GetElapsedTime(), "ms, added",
+        hierarchy.GetNumberOfShortcuts(), "shortcuts.");
+    ASSERT_EQ(hierarchy.GetNumberOfNodes(), graph.GetNumberOfNodes());
+    ASSERT_TRUE(hierarchy.IsBuiltFrom(graph));
+
+    const auto &nodes = graph.GetNodes();
+    for (auto origin : RandomNodes(nodes.size(), 20u)) {
+      const auto expected = ComputeDistances(graph, origin);
+      for (auto destination = 0u; destination < nodes.size(); ++destination) {
+        const double distance = hierarchy.GetDistance(origin, destination);
+        if (expected[destination] == ContractionHierarchy::Infinity) {
+          ASSERT_EQ(distance, ContractionHierarchy::Infinity);
+          ASSERT_TRUE(hierarchy.GetRoute(origin, destination).empty());
+          continue;
+        }
+        ASSERT_NEAR(distance, expected[destination], 1e-6);
+        // The unpacked route must follow the original edges and add up to the
+        // same distance.
+        const auto route = hierarchy.GetRoute(origin, destination);
+        ASSERT_FALSE(route.empty());
+        ASSERT_EQ(route.front(), origin);
+        ASSERT_EQ(route.back(), destination);
+        double length = 0.0;
+        for (auto i = 0u; i + 1u < route.size(); ++i) {
+          const auto from = hierarchy.GetWaypoint(route[i]);
+          const auto to = hierarchy.GetWaypoint(route[i + 1u]);
+          ASSERT_TRUE(std::any_of(graph.GetEdges().begin(), graph.GetEdges().end(), [&](const auto &edge) {
+            return (edge.source == route[i]) && (edge.target == route[i + 1u]);
+          })) << "no edge from road " << from.road_id << " to road " << to.road_id;
+          length += nodes[route[i]].length;
+        }
+        ASSERT_NEAR(length, distance, 1e-6);
+      }
+    }
+  }
+}
+
+TEST(routing, waypoint_distances) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const RoutingGraph graph(*map);
+    const ContractionHierarchy hierarchy(graph);
+    auto waypoints = map->GenerateWaypoints(5.0);
+    ASSERT_FALSE(waypoints.empty());
+    Random::Shuffle(waypoints);
+    waypoints.resize(std::min<size_t>(waypoints.size(), 50u));
+    const auto matrix = hierarchy.GetDistanceMatrix(waypoints, waypoints);
+    ASSERT_EQ(matrix.size(), waypoints.size() * waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      ASSERT_EQ(matrix[i * waypoints.size() + i], 0.0);
+      for (auto j = 0u; j < waypoints.size(); ++j) {
+        const double distance = hierarchy.GetDistance(waypoints[i], waypoints[j]);
+        ASSERT_NEAR(matrix[i * waypoints.size() + j], distance, 1e-6);
+        const auto route = hierarchy.GetRoute(waypoints[i], waypoints[j]);
+        ASSERT_EQ(route.empty(), distance == ContractionHierarchy::Infinity);
+        if (!route.empty()) {
+          ASSERT_EQ(route.front(), waypoints[i]);
+          ASSERT_EQ(route.back(), waypoints[j]);
+        }
+      }
+    }
+  }
+}
+
+TEST(routing, save_and_load) {
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const RoutingGraph graph(*map);
+    const ContractionHierarchy hierarchy(graph);
+
+    std::stringstream stream;
+    hierarchy.Write(stream);
+    const auto loaded = ContractionHierarchy::Read(stream);
+    ASSERT_TRUE(loaded.has_value());
+    ASSERT_TRUE(loaded->IsBuiltFrom(graph));
+    ASSERT_EQ(loaded->GetNumberOfShortcuts(), hierarchy.GetNumberOfShortcuts());
+
+    const auto nodes = RandomNodes(graph.GetNumberOfNodes(), 50u);
+    ASSERT_EQ(
+        loaded->GetDistanceMatrix(nodes, nodes),
+        hierarchy.GetDistanceMatrix(nodes, nodes));
+
+    std::istringstream garbage("not a contraction hierarchy");
+    ASSERT_FALSE(ContractionHierarchy::Read(garbage).has_value());
+
+    // Counts past the end of the data are rejected before allocating.
+    auto data = stream.str();
+    const uint64_t huge_count = uint64_t(1u) << 60u;
+    data.replace(2u * sizeof(uint32_t), sizeof(huge_count), reinterpret_cast<const char *>(&huge_count), sizeof(huge_count));
+    std::istringstream corrupted(data);
+    ASSERT_FALSE(ContractionHierarchy::Read(corrupted).has_value());
+    std::istringstream truncated(stream.str().substr(0u, stream.str().size() / 2u));
+    ASSERT_FALSE(ContractionHierarchy::Read(truncated).has_value());
+
+    // Shortcuts that cannot be unpacked are rejected.
+    if (hierarchy.GetNumberOfShortcuts() > 0u) {
+      using Node = RoutingGraph::Node;
+      constexpr auto node_size = 3u * sizeof(uint32_t) + 2u * sizeof(double);
+      static_assert(sizeof(Node::road_id) + sizeof(Node::section_id) + sizeof(Node::lane_id) == 3u * sizeof(uint32_t), "");
+      constexpr auto arc_size = 2u * sizeof(NodeId) + sizeof(double);
+      data = stream.str();
+      auto read_count = [&](size_t offset) {
+        uint64_t count;
+        std::memcpy(&count, data.data() + offset, sizeof(count));
+        return count;
+      };
+      const auto number_of_nodes = graph.GetNumberOfNodes();
+      const auto offsets_size = (number_of_nodes + 1u) * sizeof(uint32_t);
+      const size_t successors = 2u * sizeof(uint32_t) + sizeof(uint64_t) + number_of_nodes * node_size;
+      const size_t upward = successors + sizeof(uint64_t) + offsets_size + read_count(successors) * arc_size;
+      const size_t arcs = upward + sizeof(uint64_t) + offsets_size;
+      bool found = false;
+      for (auto i = 0u; (i < read_count(upward)) && !found; ++i) {
+        NodeId arc[2u];
+        std::memcpy(arc, data.data() + arcs + i * arc_size, sizeof(arc));
+        if (arc[1u] != RoutingGraph::InvalidNode) {
+          // Make the shortcut go through its own target.
+          std::memcpy(&data[arcs + i * arc_size + sizeof(NodeId)], &arc[0u], sizeof(NodeId));
+          found = true;
+        }
+      }
+      ASSERT_TRUE(found);
+      std::istringstream invalid_shortcut(data);
+      ASSERT_FALSE(ContractionHierarchy::Read(invalid_shortcut).has_value());
+    }
+  }
+}
+
+TEST(routing, distance_matrix) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  constexpr auto size = 1000u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const RoutingGraph graph(*map);
+    const ContractionHierarchy hierarchy(graph);
+    const auto origins = RandomNodes(graph.GetNumberOfNodes(), size);
+    const auto destinations = RandomNodes(graph.GetNumberOfNodes(), size);
+
+    carla::StopWatch stop_watch;
+    const auto matrix = hierarchy.GetDistanceMatrix(origins, destinations);
+    const auto matrix_time = stop_watch.GetElapsedTime();
+
+    stop_watch.Restart();
+    for (auto i = 0u; i < 10u; ++i) {
+      const auto expected = ComputeDistances(graph, origins[i]);
+      for (auto j = 0u; j < size; ++j) {
+        ASSERT_NEAR(matrix[i * size + j], expected[destinations[j]], 1e-6);
+      }
+    }
+    const auto dijkstra_time = stop_watch.GetElapsedTime() * (size / 10u);
+
+    carla::logging::log(
+        file, ": computed", size, 'x', size, "distance matrix in", matrix_time,
+        "ms, estimated time with Dijkstra", dijkstra_time, "ms.");
+  }
+#endif // NDEBUG
+}
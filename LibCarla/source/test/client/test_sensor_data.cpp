@@ -0,0 +1,375 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/sensor/RuntimeSensorRegistry.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/CollisionEvent.h>
+#include <carla/sensor/data/Image.h>
+#include <carla/sensor/data/LidarMeasurement.h>
+#include <carla/sensor/data/ObstacleDetectionEvent.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using carla::sensor::RuntimeSensorRegistry;
+using carla::sensor::SensorRegistry;
+using carla::sensor::s11n::PayloadType;
+using carla::sensor::s11n::SensorHeaderSerializer;
+using carla::sensor::s11n::SerializedActor;
+
+namespace {
+
+  struct TestCamera {
+    uint32_t GetImageWidth() const { return 4u; }
+    uint32_t GetImageHeight() const { return 3u; }
+    float GetFOVAngle() const { return 90.0f; }
+  };
+
+  struct TestSensor {};
+
+  /// Data of a sensor registered at runtime, a single value.
+  class TestData : public carla::sensor::SensorData {
+  public:
+
+    TestData(const carla::sensor::RawData &data, uint32_t value)
+      : SensorData(data),
+        _value(value) {}
+
+    uint32_t GetValue() const {
+      return _value;
+    }
+
+  private:
+
+    const uint32_t _value;
+  };
+
+  struct TestSerializer {
+    static carla::SharedPtr<carla::sensor::SensorData> Deserialize(carla::sensor::RawData &&data) {
+      if (data.size() != sizeof(uint32_t)) {
+        throw std::runtime_error("invalid test data");
+      }
+      uint32_t value;
+      std::memcpy(&value, data.begin(), sizeof(value));
+      return carla::MakeShared<TestData>(data, value);
+    }
+  };
+
+  template <size_t... Is>
+  std::array<PayloadType, sizeof...(Is)> GetPayloadTypes(std::index_sequence<Is...>) {
+    return {{SensorRegistry::get_by_index<Is>::type::payload_type...}};
+  }
+
+  /// Payload type of each entry of the registry.
+  const auto RegistryPayloadTypes = GetPayloadTypes(std::make_index_sequence<SensorRegistry::size()>());
+
+  carla::rpc::Actor MakeActor(carla::ActorId id, std::string type_id) {
+    carla::rpc::Actor actor;
+    actor.id = id;
+    actor.parent_id = id + 1u;
+    actor.description.id = std::move(type_id);
+    actor.bounding_box = carla::geom::BoundingBox{{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}};
+    actor.semantic_tags = {10u, 4u};
+    return actor;
+  }
+
+  /// A valid payload of @a type.
+  carla::Buffer MakePayload(PayloadType type) {
+    using namespace carla::sensor::s11n;
+    TestSensor sensor;
+    switch (type) {
+      case PayloadType::EpisodeState: {
+        const EpisodeStateSerializer::Header header{42u, 3.5, 0.05f};
+        constexpr auto state_size = sizeof(carla::sensor::data::ActorDynamicState);
+        carla::Buffer buffer;
+        buffer.reset(static_cast<carla::Buffer::size_type>(sizeof(header) + 2u * state_size));
+        std::memset(buffer.data(), 0, buffer.size());
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        for (carla::ActorId id = 1u; id <= 2u; ++id) {
+          // The id is the first member of the state.
+          std::memcpy(buffer.data() + sizeof(header) + (id - 1u) * state_size, &id, sizeof(id));
+        }
+        return EpisodeStateSerializer::Serialize(sensor, std::move(buffer));
+      }
+      case PayloadType::Image: {
+        TestCamera camera;
+        const auto size = ImageSerializer::header_offset + 4u * 4u * 3u;
+        carla::Buffer bitmap;
+        bitmap.reset(static_cast<carla::Buffer::size_type>(size));
+        for (auto i = 0u; i < size; ++i) {
+          bitmap.data()[i] = static_cast<unsigned char>(i);
+        }
+        return ImageSerializer::Serialize(camera, std::move(bitmap));
+      }
+      case PayloadType::Lidar: {
+        LidarMeasurement measurement{2u, LidarMeasurement::WithAttributes};
+        measurement.Reset(3u);
+        measurement.SetHorizontalAngle(45.0f);
+        measurement.WritePoint(0u, {1.0f, 2.0f, 3.0f}, 0.5f, 0.0f);
+        measurement.WritePoint(1u, {4.0f, 5.0f, 6.0f}, 0.6f, 0.1f);
+        measurement.WritePoint(1u, {7.0f, 8.0f, 9.0f}, 0.7f, 0.2f);
+        return LidarSerializer::Serialize(sensor, measurement, carla::Buffer{});
+      }
+      case PayloadType::CollisionEvent:
+        return CollisionEventSerializer::Serialize(
+            sensor,
+            MakeActor(3u, "vehicle.test"),
+            MakeActor(0u, "static.wall"),
+            carla::geom::Vector3D{1.0f, -2.0f, 3.0f});
+      case PayloadType::ObstacleDetectionEvent:
+        return ObstacleDetectionEventSerializer::Serialize(
+            sensor,
+            MakeActor(3u, "vehicle.test"),
+            MakeActor(5u, "walker.test"),
+            12.5f);
+      case PayloadType::None:
+      default:
+        return carla::Buffer{};
+    }
+  }
+
+  carla::Buffer MakeMessage(uint64_t sensor_type, PayloadType payload_type, const carla::Buffer &payload) {
+    const auto header = SensorHeaderSerializer::Serialize(
+        sensor_type,
+        payload_type,
+        7u,
+        1.5,
+        carla::rpc::Transform{carla::geom::Location{1.0f, 2.0f, 3.0f}, carla::geom::Rotation{}});
+    carla::Buffer message;
+    message.reset(static_cast<carla::Buffer::size_type>(header.size() + payload.size()));
+    message.copy_from(header);
+    message.copy_from(header.size(), payload);
+    return message;
+  }
+
+  /// A message as sent by the sensor at @a index of the registry.
+  carla::Buffer MakeMessage(size_t index) {
+    return MakeMessage(index, RegistryPayloadTypes[index], MakePayload(RegistryPayloadTypes[index]));
+  }
+
+  /// A message of a sensor registered at runtime, with @a value as payload.
+  carla::Buffer MakeCustomMessage(uint64_t sensor_type, uint32_t value, PayloadType payload_type = PayloadType::Custom) {
+    carla::Buffer payload;
+    payload.copy_from(reinterpret_cast<const unsigned char *>(&value), sizeof(value));
+    return MakeMessage(sensor_type, payload_type, payload);
+  }
+
+  carla::Buffer Copy(const carla::Buffer &message, size_t size) {
+    return carla::Buffer{message.data(), static_cast<carla::Buffer::size_type>(size)};
+  }
+
+  /// Deserialize @a message, that may be malformed, and read all the data.
+  /// Returns whether it was accepted.
+  bool TryDeserialize(carla::Buffer message) {
+    using namespace carla::sensor::data;
+    carla::SharedPtr<carla::sensor::SensorData> data;
+    try {
+      data = SensorRegistry::Deserialize(std::move(message));
+    } catch (const std::exception &) {
+      return false;
+    }
+    EXPECT_NE(data, nullptr);
+    // Touch every element to catch any read out of bounds.
+    size_t checksum = 0u;
+    if (auto image = boost::dynamic_pointer_cast<Image>(data)) {
+      for (auto &pixel : *image) {
+        checksum += pixel.r;
+      }
+    } else if (auto lidar = boost::dynamic_pointer_cast<LidarMeasurement>(data)) {
+      for (auto &point : *lidar) {
+        checksum += static_cast<size_t>(point.x != 0.0f);
+      }
+      if (lidar->HasAttributes()) {
+        for (auto i = 0u; i < lidar->size(); ++i) {
+          checksum += lidar->GetChannels()[i];
+        }
+      }
+    } else if (auto state = boost::dynamic_pointer_cast<RawEpisodeState>(data)) {
+      for (auto &actor : *state) {
+        checksum += actor.id;
+      }
+    }
+    (void) checksum;
+    return true;
+  }
+
+} // namespace
+
+TEST(sensor_data, serialized_actor) {
+  auto actor = MakeActor(3u, std::string(100u, 'x'));
+  actor.semantic_tags.resize(20u, 7u);
+  const auto serialized = SerializedActor::Make(actor);
+  const auto result = serialized.Deserialize();
+  ASSERT_EQ(result.id, 3u);
+  ASSERT_EQ(result.parent_id, 4u);
+  ASSERT_EQ(result.description.id, std::string(SerializedActor::MaxTypeIdLength, 'x'));
+  ASSERT_TRUE(result.description.attributes.empty());
+  ASSERT_EQ(result.bounding_box, actor.bounding_box);
+  ASSERT_EQ(result.semantic_tags.size(), static_cast<size_t>(SerializedActor::MaxSemanticTags));
+  ASSERT_EQ(result.semantic_tags[0u], 10u);
+  ASSERT_EQ(result.semantic_tags[1u], 4u);
+  ASSERT_EQ(result.semantic_tags[2u], 7u);
+  ASSERT_EQ(SerializedActor::Make(MakeActor(0u, "static.wall")).Deserialize().description.id, "static.wall");
+}
+
+TEST(sensor_data, round_trip) {
+  using namespace carla::sensor::data;
+  for (auto index = 0u; index < SensorRegistry::size(); ++index) {
+    const auto type = RegistryPayloadTypes[index];
+    if (type == PayloadType::None) {
+      ASSERT_THROW(SensorRegistry::Deserialize(MakeMessage(index)), std::exception);
+      continue;
+    }
+    const auto data = SensorRegistry::Deserialize(MakeMessage(index));
+    ASSERT_NE(data, nullptr);
+    ASSERT_EQ(data->GetFrame(), 7u);
+    ASSERT_EQ(data->GetTimestamp(), 1.5);
+    ASSERT_EQ(data->GetSensorTransform().location.y, 2.0f);
+    switch (type) {
+      case PayloadType::EpisodeState: {
+        auto state = boost::dynamic_pointer_cast<RawEpisodeState>(data);
+        ASSERT_NE(state, nullptr);
+        ASSERT_EQ(state->GetEpisodeId(), 42u);
+        ASSERT_EQ(state->GetPlatformTimeStamp(), 3.5);
+        ASSERT_EQ(state->size(), 2u);
+        const carla::ActorId id = state->at(1u).id;
+        ASSERT_EQ(id, 2u);
+        break;
+      }
+      case PayloadType::Image: {
+        auto image = boost::dynamic_pointer_cast<Image>(data);
+        ASSERT_NE(image, nullptr);
+        ASSERT_EQ(image->GetWidth(), 4u);
+        ASSERT_EQ(image->GetHeight(), 3u);
+        ASSERT_EQ(image->GetFOVAngle(), 90.0f);
+        ASSERT_EQ(image->size(), 12u);
+        const auto offset = carla::sensor::s11n::ImageSerializer::header_offset;
+        ASSERT_EQ((*image)[1u].b, static_cast<uint8_t>(offset + 4u));
+        ASSERT_EQ((*image)[1u].a, 255u);
+        break;
+      }
+      case PayloadType::Lidar: {
+        auto lidar = boost::dynamic_pointer_cast<LidarMeasurement>(data);
+        ASSERT_NE(lidar, nullptr);
+        ASSERT_EQ(lidar->GetHorizontalAngle(), 45.0f);
+        ASSERT_EQ(lidar->size(), 3u);
+        ASSERT_EQ(lidar->GetPointCount(1u), 2u);
+        ASSERT_EQ((*lidar)[1u], carla::geom::Location(4.0f, 5.0f, 6.0f));
+        ASSERT_EQ(lidar->GetTimeOffsets()[2u], 0.2f);
+        break;
+      }
+      case PayloadType::CollisionEvent: {
+        auto event = boost::dynamic_pointer_cast<CollisionEvent>(data);
+        ASSERT_NE(event, nullptr);
+        ASSERT_EQ(event->GetNormalImpulse(), carla::geom::Vector3D(1.0f, -2.0f, 3.0f));
+        break;
+      }
+      case PayloadType::ObstacleDetectionEvent: {
+        auto event = boost::dynamic_pointer_cast<ObstacleDetectionEvent>(data);
+        ASSERT_NE(event, nullptr);
+        ASSERT_EQ(event->GetDistance(), 12.5f);
+        break;
+      }
+      default:
+        FAIL() << "payload type without test: " << static_cast<uint32_t>(type);
+    }
+  }
+}
+
+TEST(sensor_data, invalid_header) {
+  const auto index = SensorRegistry::get<ARayCastLidar *>::index;
+  auto with_header = [&](auto modify) {
+    auto message = MakeMessage(index);
+    SensorHeaderSerializer::Header header;
+    std::memcpy(&header, message.data(), sizeof(header));
+    modify(header);
+    std::memcpy(message.data(), &header, sizeof(header));
+    return message;
+  };
+  ASSERT_TRUE(TryDeserialize(MakeMessage(index)));
+  ASSERT_THROW(SensorRegistry::Deserialize(carla::Buffer{}), std::runtime_error);
+  ASSERT_THROW(SensorRegistry::Deserialize(with_header([](auto &h) { h.version += 1u; })), std::runtime_error);
+  ASSERT_THROW(SensorRegistry::Deserialize(with_header([](auto &h) { h.sensor_type = SensorRegistry::size(); })), std::runtime_error);
+  ASSERT_THROW(SensorRegistry::Deserialize(with_header([](auto &h) { h.payload_type = PayloadType::Image; })), std::runtime_error);
+}
+
+TEST(sensor_data, fuzz) {
+  std::mt19937_64 engine(42u);
+  auto random = [&](size_t max) {
+    return std::uniform_int_distribution<size_t>(0u, max - 1u)(engine);
+  };
+  for (auto index = 0u; index < SensorRegistry::size(); ++index) {
+    const auto message = MakeMessage(index);
+    const auto size = message.size();
+    // Every truncation, none of them may read past the end.
+    for (auto length = 0u; length < size; ++length) {
+      const bool accepted = TryDeserialize(Copy(message, length));
+      if (length < SensorHeaderSerializer::header_offset) {
+        ASSERT_FALSE(accepted) << "sensor " << index << " length " << length;
+      }
+    }
+    // Random bytes past the sensor type, plus random trailing bytes.
+    for (auto i = 0u; i < 2000u; ++i) {
+      auto fuzzed = Copy(message, size);
+      const auto flips = 1u + random(4u);
+      for (auto j = 0u; j < flips; ++j) {
+        const auto offset = 8u + random(size - 8u);
+        fuzzed.data()[offset] = static_cast<unsigned char>(random(256u));
+      }
+      if (random(4u) == 0u) {
+        carla::Buffer longer;
+        longer.reset(static_cast<carla::Buffer::size_type>(size + 1u + random(16u)));
+        std::memset(longer.data(), 0, longer.size());
+        std::memcpy(longer.data(), fuzzed.data(), size);
+        fuzzed = std::move(longer);
+      }
+      TryDeserialize(std::move(fuzzed));
+    }
+  }
+}
+
+TEST(sensor_data, runtime_registry) {
+  const auto id = RuntimeSensorRegistry::FirstId + 3u;
+  const uint64_t last_id = RuntimeSensorRegistry::FirstId + RuntimeSensorRegistry::Capacity - 1u;
+  ASSERT_EQ(RuntimeSensorRegistry::Get(id), nullptr);
+  ASSERT_THROW(SensorRegistry::Deserialize(MakeCustomMessage(id, 42u)), std::runtime_error);
+
+  RuntimeSensorRegistry::Register<TestSerializer>(id);
+  RuntimeSensorRegistry::Register<TestSerializer>(last_id);
+  ASSERT_NE(RuntimeSensorRegistry::Get(id), nullptr);
+  auto data = SensorRegistry::Deserialize(MakeCustomMessage(id, 42u));
+  auto test_data = boost::dynamic_pointer_cast<TestData>(data);
+  ASSERT_NE(test_data, nullptr);
+  ASSERT_EQ(test_data->GetValue(), 42u);
+  ASSERT_EQ(test_data->GetFrame(), 7u);
+  ASSERT_EQ(test_data->GetTimestamp(), 1.5);
+  ASSERT_NE(boost::dynamic_pointer_cast<TestData>(SensorRegistry::Deserialize(MakeCustomMessage(last_id, 1u))), nullptr);
+
+  // Built-in sensors are not affected.
+  ASSERT_TRUE(TryDeserialize(MakeMessage(SensorRegistry::get<ARayCastLidar *>::index)));
+
+  ASSERT_THROW(SensorRegistry::Deserialize(MakeCustomMessage(id, 42u, PayloadType::Image)), std::runtime_error);
+  ASSERT_THROW(SensorRegistry::Deserialize(MakeCustomMessage(id + 1u, 42u)), std::runtime_error);
+  ASSERT_THROW(SensorRegistry::Deserialize(MakeCustomMessage(last_id + 1u, 42u)), std::runtime_error);
+  ASSERT_THROW(SensorRegistry::Deserialize(MakeCustomMessage(SensorRegistry::size(), 42u)), std::runtime_error);
+  ASSERT_THROW(RuntimeSensorRegistry::Register<TestSerializer>(id), std::invalid_argument);
+  ASSERT_THROW(RuntimeSensorRegistry::Register<TestSerializer>(last_id + 1u), std::invalid_argument);
+  ASSERT_THROW(RuntimeSensorRegistry::Register<TestSerializer>(SensorRegistry::size()), std::invalid_argument);
+  ASSERT_THROW(RuntimeSensorRegistry::Register(id + 1u, nullptr), std::invalid_argument);
+
+  RuntimeSensorRegistry::Unregister(id);
+  RuntimeSensorRegistry::Unregister(last_id);
+  ASSERT_EQ(RuntimeSensorRegistry::Get(id), nullptr);
+  ASSERT_THROW(SensorRegistry::Deserialize(MakeCustomMessage(id, 42u)), std::runtime_error);
+}
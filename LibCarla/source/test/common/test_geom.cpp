@@ -5,11 +5,15 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "test.h"
+#include "Random.h"
 
+#include <carla/StopWatch.h>
+#include <carla/geom/GeoLocation.h>
 #include <carla/geom/Vector3D.h>
 #include <carla/geom/Math.h>
 #include <carla/geom/Transform.h>
 #include <limits>
+#include <vector>
 
 namespace carla {
 namespace geom {
@@ -179,3 +183,64 @@ TEST(geom, nearest_point_arc) {
   ASSERT_NEAR(Math::DistanceArcToPoint(Vector3D(1,2,0),
       Vector3D(0,0,0), 1.57f, 0, 1).second, 1.0f, 0.01f);
 }
+
+TEST(geom, geo_location_batch_transform) {
+  const GeoLocation references[] = {
+      {0.0, 0.0, 0.0},
+      {49.0, 8.0, 100.0},
+      {-33.9, 151.2, 10.0},
+      {70.0, -20.0, 0.0}};
+  std::vector<Location> locations;
+  for (auto i = 0u; i < 1000u; ++i) {
+    locations.emplace_back(util::Random::Location(-10000.0f, 10000.0f));
+  }
+  for (const auto &reference : references) {
+    const auto geo_locations = reference.Transform(locations);
+    ASSERT_EQ(geo_locations.size(), locations.size());
+    for (auto i = 0u; i < locations.size(); ++i) {
+      const auto expected = reference.Transform(locations[i]);
+      ASSERT_NEAR(geo_locations[i].latitude, expected.latitude, 1e-10);
+      ASSERT_NEAR(geo_locations[i].longitude, expected.longitude, 1e-10);
+      ASSERT_NEAR(geo_locations[i].altitude, expected.altitude, 1e-10);
+    }
+    // Back to the same locations, up to float precision.
+    const auto inverse = reference.InverseTransform(geo_locations);
+    ASSERT_EQ(inverse.size(), locations.size());
+    for (auto i = 0u; i < locations.size(); ++i) {
+      ASSERT_NEAR(inverse[i].x, locations[i].x, 2e-3);
+      ASSERT_NEAR(inverse[i].y, locations[i].y, 2e-3);
+      ASSERT_NEAR(inverse[i].z, locations[i].z, 2e-3);
+      const auto location = reference.InverseTransform(geo_locations[i]);
+      ASSERT_EQ(location, inverse[i]);
+    }
+    const auto origin = reference.InverseTransform(reference);
+    ASSERT_NEAR(origin.Length(), 0.0f, 1e-6f);
+  }
+  ASSERT_TRUE(references[0u].Transform(std::vector<Location>{}).empty());
+}
+
+#ifdef NDEBUG
+TEST(geom, geo_location_batch_transform_benchmark) {
+  const GeoLocation reference{49.0, 8.0, 0.0};
+  std::vector<Location> locations;
+  for (auto i = 0u; i < 1000000u; ++i) {
+    locations.emplace_back(util::Random::Location(-10000.0f, 10000.0f));
+  }
+  double checksum = 0.0;
+  carla::StopWatch stop_watch;
+  for (const auto &location : locations) {
+    checksum += reference.Transform(location).latitude;
+  }
+  const auto scalar_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  stop_watch.Restart();
+  const auto geo_locations = reference.Transform(locations);
+  const auto batch_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  stop_watch.Restart();
+  const auto inverse = reference.InverseTransform(geo_locations);
+  const auto inverse_time = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  checksum += geo_locations.back().latitude + inverse.back().x;
+  carla::logging::log(
+      locations.size(), "locations to geo-locations in", scalar_time, "us one by one,",
+      batch_time, "us in batch, back in", inverse_time, "us (checksum", checksum, ").");
+}
+#endif // NDEBUG
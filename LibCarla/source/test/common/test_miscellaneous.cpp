@@ -6,8 +6,33 @@
 
 #include "test.h"
 
+#include <carla/ParallelFor.h>
 #include <carla/Version.h>
 
+#include <stdexcept>
+#include <vector>
+
 TEST(miscellaneous, version) {
   std::cout << "LibCarla " << carla::version() << std::endl;
 }
+
+TEST(miscellaneous, parallel_for) {
+  constexpr size_t size = 10000u;
+  // The calls share the same threads, nested calls run in the calling thread.
+  for (int repetition = 0; repetition < 10; ++repetition) {
+    std::vector<size_t> visited(size, 0u);
+    carla::ParallelFor(size, 1u, [&](size_t i) {
+      size_t count = 0u;
+      carla::ParallelFor(4u, 1u, [&](size_t) { ++count; });
+      visited[i] = i + count;
+    });
+    for (size_t i = 0u; i < size; ++i) {
+      ASSERT_EQ(visited[i], i + 4u);
+    }
+  }
+  ASSERT_THROW(carla::ParallelFor(size, 1u, [](size_t i) {
+    if (i == size / 2u) {
+      throw std::runtime_error("parallel_for");
+    }
+  }), std::runtime_error);
+}
@@ -8,6 +8,7 @@
 #include <carla/PythonUtil.h>
 #include <carla/client/Map.h>
 #include <carla/client/Waypoint.h>
+#include <carla/road/WaypointArrays.h>
 #include <carla/road/element/LaneMarking.h>
 
 #include <ostream>
@@ -26,6 +27,14 @@ namespace client {
     return out;
   }
 
+  std::ostream &operator<<(std::ostream &out, const SignalAhead &signal) {
+    out << "SignalAhead(id=" << signal.id
+        << ", name=" << signal.name
+        << ", type=" << signal.type
+        << ", distance=" << signal.distance << ')';
+    return out;
+  }
+
 } // namespace client
 } // namespace carla
 
@@ -49,12 +58,106 @@ static auto GetTopology(const carla::client::Map &self) {
   return result;
 }
 
+static auto GetWaypoint(
+    const carla::client::Map &self,
+    const carla::geom::Location &location,
+    bool project_to_road,
+    uint32_t lane_type) {
+  return self.GetWaypoint(location, project_to_road, lane_type);
+}
+
+static auto GetWaypointNear(
+    const carla::client::Map &self,
+    const carla::geom::Location &location,
+    const carla::client::Waypoint &hint,
+    bool project_to_road,
+    uint32_t lane_type) {
+  return self.GetWaypoint(location, hint, project_to_road, lane_type);
+}
+
+static boost::shared_ptr<carla::road::WaypointArrays> ExportWaypointList(
+    const carla::client::Map &self,
+    const boost::python::object &waypoints) {
+  namespace py = boost::python;
+  std::vector<carla::road::element::Waypoint> list;
+  const auto size = py::len(waypoints);
+  list.reserve(static_cast<size_t>(size));
+  for (decltype(py::len(waypoints)) i = 0; i < size; ++i) {
+    const carla::client::Waypoint &waypoint = py::extract<const carla::client::Waypoint &>(waypoints[i]);
+    list.push_back({
+        waypoint.GetRoadId(),
+        waypoint.GetSectionId(),
+        waypoint.GetLaneId(),
+        waypoint.GetDistance()});
+  }
+  carla::PythonUtil::ReleaseGIL unlock;
+  return boost::make_shared<carla::road::WaypointArrays>(self.ExportWaypoints(list));
+}
+
+static boost::shared_ptr<carla::road::WaypointArrays> ExportWaypointsByDistance(
+    const carla::client::Map &self,
+    double distance) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return boost::make_shared<carla::road::WaypointArrays>(self.ExportWaypoints(distance));
+}
+
+/// Return a read-only memoryview of @a data, @a columns items of @a format
+/// per waypoint. The view shares the memory of the arrays in @a self and
+/// keeps them alive.
+template <typename T>
+static boost::python::object MakeWaypointArrayView(
+    boost::python::object self,
+    const std::vector<T> &data,
+    const char *format,
+    size_t columns = 1u) {
+  namespace py = boost::python;
+  auto view = MakeOwnedMemoryView(self, data.data(), sizeof(T) * data.size());
+#if PY_MAJOR_VERSION >= 3
+  if ((columns == 1u) || data.empty()) {
+    return view.attr("cast")(format); // Cannot cast to a shape with zeros.
+  }
+  return view.attr("cast")(format, py::make_tuple(data.size(), columns));
+#else
+  (void) format;
+  (void) columns;
+  return view;
+#endif
+}
+
+#define WAYPOINT_ARRAY(member, format) +[](boost::python::object self) { \
+      const carla::road::WaypointArrays &arrays = \
+          boost::python::extract<const carla::road::WaypointArrays &>(self); \
+      return MakeWaypointArrayView(self, arrays.member, format); \
+    }
+
 static carla::geom::GeoLocation ToGeolocation(
     const carla::client::Map &self,
     const carla::geom::Location &location) {
   return self.GetGeoReference().Transform(location);
 }
 
+static boost::python::list ToGeolocations(
+    const carla::client::Map &self,
+    const boost::python::object &locations) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> list;
+  const auto size = py::len(locations);
+  list.reserve(static_cast<size_t>(size));
+  for (decltype(py::len(locations)) i = 0; i < size; ++i) {
+    list.push_back(py::extract<carla::geom::Location>(locations[i]));
+  }
+  std::vector<carla::geom::GeoLocation> geo_locations;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    geo_locations = self.GetGeoReference().Transform(list);
+  }
+  py::list result;
+  for (const auto &geo_location : geo_locations) {
+    result.append(geo_location);
+  }
+  return result;
+}
+
 void export_map() {
   using namespace boost::python;
   namespace cc = carla::client;
@@ -129,10 +232,14 @@ void export_map() {
     .def(init<std::string, std::string>((arg("name"), arg("xodr_content"))))
     .add_property("name", CALL_RETURNING_COPY(cc::Map, GetName))
     .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
-    .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoint", &GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    .def("get_waypoint_near", &GetWaypointNear, (arg("location"), arg("hint"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     .def("get_topology", &GetTopology)
     .def("generate_waypoints", CALL_RETURNING_LIST_1(cc::Map, GenerateWaypoints, double), (args("distance")))
+    .def("export_waypoints", &ExportWaypointList, (arg("waypoints")))
+    .def("export_waypoints", &ExportWaypointsByDistance, (arg("distance")))
     .def("transform_to_geolocation", &ToGeolocation, (arg("location")))
+    .def("transform_to_geolocations", &ToGeolocations, (arg("locations")))
     .def("to_opendrive", CALL_RETURNING_COPY(cc::Map, GetOpenDrive))
     .def("save_to_disk", &SaveOpenDriveToDisk, (arg("path")=""))
     .def(self_ns::str(self_ns::self))
@@ -149,6 +256,46 @@ void export_map() {
     .add_property("width", &cre::LaneMarking::width)
   ;
 
+  static_assert(sizeof(cg::Transform) == 6u * sizeof(float), "Transforms are exported as 6 floats");
+
+  class_<cr::WaypointArrays, boost::noncopyable, boost::shared_ptr<cr::WaypointArrays>>("WaypointArrays", no_init)
+    .def("__len__", &cr::WaypointArrays::size)
+    .add_property("road_ids", WAYPOINT_ARRAY(road_ids, "I"))
+    .add_property("section_ids", WAYPOINT_ARRAY(section_ids, "I"))
+    .add_property("lane_ids", WAYPOINT_ARRAY(lane_ids, "i"))
+    .add_property("s", WAYPOINT_ARRAY(s, "d"))
+    .add_property("transforms", +[](object self) {
+      const cr::WaypointArrays &arrays = extract<const cr::WaypointArrays &>(self);
+      return MakeWaypointArrayView(self, arrays.transforms, "f", 6u);
+    })
+    .add_property("lane_widths", WAYPOINT_ARRAY(lane_widths, "d"))
+    .add_property("lane_types", WAYPOINT_ARRAY(lane_types, "I"))
+    .add_property("junction_ids", WAYPOINT_ARRAY(junction_ids, "i"))
+    .add_property("right_marking_types", WAYPOINT_ARRAY(right_marking_types, "B"))
+    .add_property("right_marking_colors", WAYPOINT_ARRAY(right_marking_colors, "B"))
+    .add_property("right_marking_lane_changes", WAYPOINT_ARRAY(right_marking_lane_changes, "B"))
+    .add_property("right_marking_widths", WAYPOINT_ARRAY(right_marking_widths, "d"))
+    .add_property("left_marking_types", WAYPOINT_ARRAY(left_marking_types, "B"))
+    .add_property("left_marking_colors", WAYPOINT_ARRAY(left_marking_colors, "B"))
+    .add_property("left_marking_lane_changes", WAYPOINT_ARRAY(left_marking_lane_changes, "B"))
+    .add_property("left_marking_widths", WAYPOINT_ARRAY(left_marking_widths, "d"))
+  ;
+
+  class_<cc::SignalAhead>("SignalAhead", no_init)
+    .def_readonly("id", &cc::SignalAhead::id)
+    .def_readonly("name", &cc::SignalAhead::name)
+    .def_readonly("country", &cc::SignalAhead::country)
+    .def_readonly("type", &cc::SignalAhead::type)
+    .def_readonly("subtype", &cc::SignalAhead::subtype)
+    .def_readonly("value", &cc::SignalAhead::value)
+    .def_readonly("unit", &cc::SignalAhead::unit)
+    .def_readonly("text", &cc::SignalAhead::text)
+    .def_readonly("is_dynamic", &cc::SignalAhead::is_dynamic)
+    .def_readonly("distance", &cc::SignalAhead::distance)
+    .add_property("waypoint", +[](const cc::SignalAhead &self) { return self.waypoint; })
+    .def(self_ns::str(self_ns::self))
+  ;
+
   class_<cc::Waypoint, boost::noncopyable, boost::shared_ptr<cc::Waypoint>>("Waypoint", no_init)
     .add_property("id", &cc::Waypoint::GetId)
     .add_property("transform", CALL_RETURNING_COPY(cc::Waypoint, GetTransform))
@@ -165,6 +312,7 @@ void export_map() {
     .add_property("right_lane_marking", CALL_RETURNING_OPTIONAL(cc::Waypoint, GetRightLaneMarking))
     .add_property("left_lane_marking", CALL_RETURNING_OPTIONAL(cc::Waypoint, GetLeftLaneMarking))
     .def("next", CALL_RETURNING_LIST_1(cc::Waypoint, GetNext, double), (args("distance")))
+    .def("get_signals_ahead", CALL_RETURNING_LIST_1(cc::Waypoint, GetSignalsAhead, double), (args("distance")))
     .def("get_right_lane", &cc::Waypoint::GetRight)
     .def("get_left_lane", &cc::Waypoint::GetLeft)
     .def(self_ns::str(self_ns::self))
@@ -5,9 +5,12 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include <carla/PythonUtil.h>
+#include <carla/image/AsyncWriter.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/pointcloud/LidarSweepAssembler.h>
+#include <carla/pointcloud/PointCloudFilter.h>
 #include <carla/pointcloud/PointCloudIO.h>
 #include <carla/sensor/SensorData.h>
 #include <carla/sensor/data/CollisionEvent.h>
@@ -19,6 +22,9 @@
 
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 
+#include <cstring>
+#include <functional>
+#include <memory>
 #include <ostream>
 #include <iostream>
 
@@ -77,6 +83,21 @@ namespace data {
 
 } // namespace data
 } // namespace sensor
+
+namespace image {
+
+  std::ostream &operator<<(std::ostream &out, const AsyncWriter::Stats &stats) {
+    out << "AsyncWriterStats(pending=" << stats.pending
+        << ", submitted=" << stats.submitted
+        << ", written=" << stats.written
+        << ", dropped=" << stats.dropped
+        << ", failed=" << stats.failed
+        << ", writes_per_second=" << stats.writes_per_second
+        << ')';
+    return out;
+  }
+
+} // namespace image
 } // namespace carla
 
 enum class EColorConverter {
@@ -98,6 +119,155 @@ static auto GetRawDataAsBuffer(T &self) {
   return boost::python::object(boost::python::handle<>(ptr));
 }
 
+/// Return a read-only memoryview of the @a size items of a lidar attribute
+/// array, or None if the measurement has no attributes. The view shares the
+/// memory of the measurement and keeps it alive.
+template <typename T>
+static boost::python::object GetLidarAttributeAsBuffer(
+    boost::python::object measurement,
+    const T *data,
+    size_t size,
+    const char *format) {
+  namespace py = boost::python;
+  if (data == nullptr) {
+    return py::object();
+  }
+  auto view = MakeOwnedMemoryView(measurement, data, sizeof(T) * size);
+#if PY_MAJOR_VERSION >= 3
+  return view.attr("cast")(format);
+#else
+  (void) format;
+  return view;
+#endif
+}
+
+/// Return a memoryview of @a rows x @a columns elements of type @a format
+/// owning its data, taking the first @a rows rows of @a bytes, a bytearray.
+template <typename T>
+static boost::python::object MakeArrayView(
+    boost::python::object bytes,
+    const char *format,
+    size_t rows,
+    size_t columns) {
+  namespace py = boost::python;
+  const auto size = static_cast<Py_ssize_t>(sizeof(T) * rows * columns);
+  if (PyByteArray_Resize(bytes.ptr(), size) != 0) {
+    py::throw_error_already_set();
+  }
+#if PY_MAJOR_VERSION >= 3
+  py::object view(py::handle<>(PyMemoryView_FromObject(bytes.ptr())));
+  if (size == 0) {
+    return view.attr("cast")(format); // Cannot cast to a shape with zeros.
+  }
+  return view.attr("cast")(format, py::make_tuple(rows, columns));
+#else
+  (void) format;
+  return bytes;
+#endif
+}
+
+/// Return a one-dimensional memoryview of elements of type @a format owning
+/// its data, all of @a bytes, a bytearray.
+static boost::python::object MakeVectorView(
+    boost::python::object bytes,
+    const char *format) {
+  namespace py = boost::python;
+#if PY_MAJOR_VERSION >= 3
+  py::object view(py::handle<>(PyMemoryView_FromObject(bytes.ptr())));
+  return view.attr("cast")(format);
+#else
+  (void) format;
+  return bytes;
+#endif
+}
+
+/// Return a float32 memoryview of @a rows x @a columns owning its data,
+/// taking the first @a rows rows of @a bytes, a bytearray.
+static boost::python::object MakeFloatArrayView(
+    boost::python::object bytes,
+    size_t rows,
+    size_t columns) {
+  return MakeArrayView<float>(bytes, "f", rows, columns);
+}
+
+/// A bytearray of @a size bytes.
+static boost::python::object MakeByteArray(size_t size) {
+  namespace py = boost::python;
+  return py::object(py::handle<>(PyByteArray_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(size))));
+}
+
+static boost::python::object DecodeDepthMeters(const carla::sensor::data::Image &self) {
+  auto bytes = MakeByteArray(sizeof(float) * self.size());
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.DecodeDepthMeters(reinterpret_cast<float *>(PyByteArray_AsString(bytes.ptr())));
+  }
+  return MakeFloatArrayView(bytes, self.GetHeight(), self.GetWidth());
+}
+
+static boost::python::object DecodeDepthPointCloud(
+    const carla::sensor::data::Image &self,
+    float max_depth) {
+  static_assert(sizeof(carla::geom::Location) == 3u * sizeof(float), "Invalid location size.");
+  auto bytes = MakeByteArray(sizeof(carla::geom::Location) * self.size());
+  size_t count = 0u;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    std::vector<float> depths(self.size());
+    self.DecodeDepthMeters(depths.data());
+    count = carla::sensor::data::DepthDecoder::BackProject(
+        depths.data(),
+        self.GetWidth(),
+        self.GetHeight(),
+        self.GetFOVAngle(),
+        max_depth,
+        reinterpret_cast<carla::geom::Location *>(PyByteArray_AsString(bytes.ptr())));
+  }
+  return MakeFloatArrayView(bytes, count, 3u);
+}
+
+/// Return (labels, counts, boxes), memoryviews of uint8 of height x width,
+/// uint32 of 256 and int32 of 256 x 4 (min_x, min_y, max_x, max_y).
+static boost::python::object ExtractLabels(const carla::sensor::data::Image &self) {
+  namespace py = boost::python;
+  using carla::sensor::data::LabelExtractor;
+  static_assert(sizeof(LabelExtractor::Box) == 4u * sizeof(int32_t), "Invalid box size.");
+  constexpr size_t number_of_labels = LabelExtractor::NumberOfLabels;
+  auto labels = MakeByteArray(self.size());
+  auto counts = MakeByteArray(sizeof(uint32_t) * number_of_labels);
+  auto boxes = MakeByteArray(sizeof(LabelExtractor::Box) * number_of_labels);
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    self.ExtractLabels(
+        reinterpret_cast<uint8_t *>(PyByteArray_AsString(labels.ptr())),
+        reinterpret_cast<uint32_t *>(PyByteArray_AsString(counts.ptr())),
+        reinterpret_cast<LabelExtractor::Box *>(PyByteArray_AsString(boxes.ptr())));
+  }
+  return py::make_tuple(
+      MakeArrayView<uint8_t>(labels, "B", self.GetHeight(), self.GetWidth()),
+      MakeVectorView(counts, "I"),
+      MakeArrayView<int32_t>(boxes, "i", number_of_labels, 4u));
+}
+
+/// Call @a filter(begin, end, out) over the points of @a self without the
+/// GIL, and return the points written to out as a float32 memoryview of
+/// shape (N, 3).
+template <typename FilterT>
+static boost::python::object FilterPointCloud(
+    const carla::sensor::data::LidarMeasurement &self,
+    FilterT &&filter) {
+  auto bytes = MakeByteArray(sizeof(carla::geom::Location) * self.size());
+  size_t count = 0u;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    count = filter(
+        self.begin(),
+        self.end(),
+        reinterpret_cast<carla::geom::Location *>(PyByteArray_AsString(bytes.ptr())));
+  }
+  return MakeFloatArrayView(bytes, count, 3u);
+}
+
 template <typename T>
 static void ConvertImage(T &self, EColorConverter cc) {
   carla::PythonUtil::ReleaseGIL unlock;
@@ -120,42 +290,226 @@ static void ConvertImage(T &self, EColorConverter cc) {
   }
 }
 
-template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
-  carla::PythonUtil::ReleaseGIL unlock;
+/// Write @a self converted with @a cc, @a args are forwarded to
+/// ImageIO::WriteView.
+template <typename T, typename... Args>
+static std::string WriteImageToDisk(T &self, std::string path, EColorConverter cc, Args... args) {
   using namespace carla::image;
   auto view = ImageView::MakeView(self);
   switch (cc) {
     case EColorConverter::Raw:
       return ImageIO::WriteView(
           std::move(path),
-          view);
+          view,
+          args...);
     case EColorConverter::Depth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::Depth()),
+          args...);
     case EColorConverter::LogarithmicDepth:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::LogarithmicDepth()),
+          args...);
     case EColorConverter::CityScapesPalette:
       return ImageIO::WriteView(
           std::move(path),
-          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()));
+          ImageView::MakeColorConvertedView(view, ColorConverter::CityScapesPalette()),
+          args...);
     default:
       throw std::invalid_argument("invalid color converter!");
   }
 }
 
 template <typename T>
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  return WriteImageToDisk(self, std::move(path), cc);
+}
+
+template <typename T>
+static std::string SavePointCloudToDisk(
+    T &self,
+    std::string path,
+    carla::pointcloud::PointCloudIO::Format format,
+    bool with_channel) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  std::vector<uint32_t> point_count_by_channel;
+  if (with_channel) {
+    for (auto channel = 0u; channel < self.GetChannelCount(); ++channel) {
+      point_count_by_channel.emplace_back(self.GetPointCount(channel));
+    }
+  }
+  return carla::pointcloud::PointCloudIO::SaveToDisk(
+      std::move(path),
+      format,
+      self.data(),
+      self.data() + self.size(),
+      point_count_by_channel);
+}
+
+/// Writes images and lidar measurements to disk in background threads, see
+/// carla::image::AsyncWriter.
+class AsyncSensorDataWriter {
+public:
+
+  using AsyncWriter = carla::image::AsyncWriter;
+
+  AsyncSensorDataWriter(
+      size_t worker_threads,
+      size_t queue_size,
+      AsyncWriter::DropPolicy drop_policy,
+      EColorConverter cc,
+      const std::string &format,
+      int compression)
+    : _writes_images(!GetPointCloudFormat(format).has_value()),
+      _writer(
+          new AsyncWriter(MakeWriteFunction(cc, format, compression), worker_threads, queue_size, drop_policy),
+          carla::PythonUtil::ReleaseGILDeleter()) {}
+
+  bool Submit(const carla::SharedPtr<carla::sensor::SensorData> &data, std::string path) {
+    namespace csd = carla::sensor::data;
+    if (dynamic_cast<const csd::Image *>(data.get()) != nullptr) {
+      if (!_writes_images) {
+        throw std::invalid_argument("this writer has a point cloud format, it only writes lidar measurements!");
+      }
+    } else if (dynamic_cast<const csd::LidarMeasurement *>(data.get()) == nullptr) {
+      throw std::invalid_argument("only images and lidar measurements can be written!");
+    }
+    // The reference to the Python object needs to be released while holding
+    // the GIL.
+    using Deleter = carla::PythonUtil::AcquireGILDeleter;
+    auto holder = carla::SharedPtr<carla::SharedPtr<carla::sensor::SensorData>>{
+        new carla::SharedPtr<carla::sensor::SensorData>(data),
+        Deleter()};
+    carla::SharedPtr<carla::sensor::SensorData> item{holder, data.get()};
+    holder.reset();
+    carla::PythonUtil::ReleaseGIL unlock;
+    return _writer->Submit(std::move(item), std::move(path));
+  }
+
+  void Flush() {
+    carla::PythonUtil::ReleaseGIL unlock;
+    _writer->Flush();
+  }
+
+  AsyncWriter::Stats GetStats() const {
+    return _writer->GetStats();
+  }
+
+private:
+
+  using ImageWriteFunction = std::function<void(const carla::sensor::data::Image &, std::string)>;
+
+  static ImageWriteFunction MakeImageWriteFunction(
+      EColorConverter cc,
+      const std::string &format,
+      int compression) {
+    namespace io = carla::image::io;
+    using Image = carla::sensor::data::Image;
+    if (format.empty()) {
+      return [=](const Image &image, std::string path) {
+        WriteImageToDisk(image, std::move(path), cc, compression);
+      };
+    } else if ((format == "png") && io::png::is_supported) {
+      return [=](const Image &image, std::string path) {
+        WriteImageToDisk(image, std::move(path), cc, compression, io::png());
+      };
+    } else if (((format == "jpeg") || (format == "jpg")) && io::jpeg::is_supported) {
+      return [=](const Image &image, std::string path) {
+        WriteImageToDisk(image, std::move(path), cc, compression, io::jpeg());
+      };
+    } else if ((format == "tiff") && io::tiff::is_supported) {
+      return [=](const Image &image, std::string path) {
+        WriteImageToDisk(image, std::move(path), cc, compression, io::tiff());
+      };
+    }
+    throw std::invalid_argument("unsupported image format \"" + format + "\"!");
+  }
+
+  using PointCloudFormat = carla::pointcloud::PointCloudIO::Format;
+
+  /// Point cloud format named @a format, none if it is not one.
+  static boost::optional<PointCloudFormat> GetPointCloudFormat(const std::string &format) {
+    if (format == "ply") {
+      return PointCloudFormat::BinaryPly;
+    } else if (format == "ascii_ply") {
+      return PointCloudFormat::AsciiPly;
+    } else if (format == "bin") {
+      return PointCloudFormat::Bin;
+    }
+    return boost::none;
+  }
+
+  /// With a point cloud format only lidar measurements are written, otherwise
+  /// @a format is the one of the images and the lidar measurements are
+  /// written as binary PLY.
+  static AsyncWriter::WriteFunction MakeWriteFunction(
+      EColorConverter cc,
+      const std::string &format,
+      int compression) {
+    namespace csd = carla::sensor::data;
+    const auto point_cloud_format = GetPointCloudFormat(format);
+    ImageWriteFunction write_image;
+    if (!point_cloud_format.has_value()) {
+      write_image = MakeImageWriteFunction(cc, format, compression);
+    }
+    const auto lidar_format = point_cloud_format.value_or(PointCloudFormat::BinaryPly);
+    return [write_image=std::move(write_image), lidar_format](const carla::sensor::SensorData &data, std::string path) {
+      if (auto *image = dynamic_cast<const csd::Image *>(&data)) {
+        write_image(*image, std::move(path));
+      } else if (auto *measurement = dynamic_cast<const csd::LidarMeasurement *>(&data)) {
+        carla::pointcloud::PointCloudIO::SaveToDisk(
+            std::move(path),
+            lidar_format,
+            measurement->data(),
+            measurement->data() + measurement->size());
+      }
+    };
+  }
+
+  const bool _writes_images;
+
+  std::shared_ptr<AsyncWriter> _writer;
+};
+
+/// Copy of a sweep of carla::pointcloud::LidarSweepAssembler, since the
+/// assembler overwrites its sweeps.
+struct LidarSweep {
+  size_t frame;
+  double timestamp;
+  carla::geom::Transform transform;
+  size_t measurement_count;
+  size_t dropped_points;
+  boost::python::object points;
+};
+
+static boost::python::object AddToLidarSweep(
+    carla::pointcloud::LidarSweepAssembler &self,
+    const carla::sensor::data::LidarMeasurement &measurement) {
+  // The assembler is not thread-safe, and the sweep returned is overwritten
+  // by later calls, so keep the GIL until the sweep is copied.
+  const auto *sweep = self.Add(measurement);
+  if (sweep == nullptr) {
+    return boost::python::object();
+  }
+  auto bytes = MakeByteArray(sizeof(carla::geom::Location) * sweep->size());
+  std::memcpy(PyByteArray_AsString(bytes.ptr()), sweep->begin(), sizeof(carla::geom::Location) * sweep->size());
+  return boost::python::object(LidarSweep{
+      sweep->frame,
+      sweep->timestamp,
+      sweep->transform,
+      sweep->measurement_count,
+      sweep->dropped_points,
+      MakeFloatArrayView(bytes, sweep->size(), 3u)});
 }
 
 void export_sensor_data() {
   using namespace boost::python;
   namespace cc = carla::client;
+  namespace cg = carla::geom;
+  namespace ci = carla::image;
   namespace cr = carla::rpc;
   namespace cs = carla::sensor;
   namespace csd = carla::sensor::data;
@@ -180,6 +534,9 @@ void export_sensor_data() {
     .add_property("fov", &csd::Image::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::Image>)
     .def("convert", &ConvertImage<csd::Image>, (arg("color_converter")))
+    .def("decode_depth_meters", &DecodeDepthMeters)
+    .def("decode_depth_point_cloud", &DecodeDepthPointCloud, (arg("max_depth")=static_cast<float>(csd::DepthDecoder::MaxDepth)))
+    .def("extract_labels", &ExtractLabels)
     .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw))
     .def("__len__", &csd::Image::size)
     .def("__iter__", iterator<csd::Image>())
@@ -192,12 +549,55 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  enum_<carla::pointcloud::PointCloudIO::Format>("PointCloudFormat")
+    .value("AsciiPly", carla::pointcloud::PointCloudIO::Format::AsciiPly)
+    .value("BinaryPly", carla::pointcloud::PointCloudIO::Format::BinaryPly)
+    .value("Bin", carla::pointcloud::PointCloudIO::Format::Bin)
+  ;
+
   class_<csd::LidarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::LidarMeasurement>>("LidarMeasurement", no_init)
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .add_property("has_attributes", &csd::LidarMeasurement::HasAttributes)
+    .def("get_intensities", +[](object self) {
+      const csd::LidarMeasurement &measurement = extract<const csd::LidarMeasurement &>(self);
+      return GetLidarAttributeAsBuffer(self, measurement.GetIntensities(), measurement.size(), "f");
+    })
+    .def("get_time_offsets", +[](object self) {
+      const csd::LidarMeasurement &measurement = extract<const csd::LidarMeasurement &>(self);
+      return GetLidarAttributeAsBuffer(self, measurement.GetTimeOffsets(), measurement.size(), "f");
+    })
+    .def("get_point_channels", +[](object self) {
+      const csd::LidarMeasurement &measurement = extract<const csd::LidarMeasurement &>(self);
+      return GetLidarAttributeAsBuffer(self, measurement.GetChannels(), measurement.size(), "H");
+    })
+    .def("voxel_downsample", +[](const csd::LidarMeasurement &self, float voxel_size) {
+      return FilterPointCloud(self, [=](auto begin, auto end, auto out) {
+        return carla::pointcloud::PointCloudFilter::VoxelDownsample(begin, end, voxel_size, out);
+      });
+    }, (arg("voxel_size")))
+    .def("crop", +[](const csd::LidarMeasurement &self, const cg::BoundingBox &box, object transform) {
+      if (transform.is_none()) {
+        return FilterPointCloud(self, [&](auto begin, auto end, auto out) {
+          return carla::pointcloud::PointCloudFilter::Crop(begin, end, box, out);
+        });
+      }
+      const cg::Transform box_transform = extract<cg::Transform>(transform);
+      return FilterPointCloud(self, [&](auto begin, auto end, auto out) {
+        return carla::pointcloud::PointCloudFilter::Crop(begin, end, box, box_transform, out);
+      });
+    }, (arg("bounding_box"), arg("transform")=object()))
+    .def("remove_ground", +[](const csd::LidarMeasurement &self, float cell_size, float band_height) {
+      return FilterPointCloud(self, [=](auto begin, auto end, auto out) {
+        return carla::pointcloud::PointCloudFilter::RemoveGround(begin, end, cell_size, band_height, out);
+      });
+    }, (arg("cell_size")=1.0f, arg("band_height")=0.2f))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (
+        arg("path"),
+        arg("format")=carla::pointcloud::PointCloudIO::Format::AsciiPly,
+        arg("with_channel")=false))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> cr::Location {
@@ -209,6 +609,50 @@ void export_sensor_data() {
     .def(self_ns::str(self_ns::self))
   ;
 
+  enum_<ci::AsyncWriter::DropPolicy>("WriterDropPolicy")
+    .value("Block", ci::AsyncWriter::DropPolicy::Block)
+    .value("DropNewest", ci::AsyncWriter::DropPolicy::DropNewest)
+    .value("DropOldest", ci::AsyncWriter::DropPolicy::DropOldest)
+  ;
+
+  class_<ci::AsyncWriter::Stats>("AsyncWriterStats", no_init)
+    .def_readonly("pending", &ci::AsyncWriter::Stats::pending)
+    .def_readonly("submitted", &ci::AsyncWriter::Stats::submitted)
+    .def_readonly("written", &ci::AsyncWriter::Stats::written)
+    .def_readonly("dropped", &ci::AsyncWriter::Stats::dropped)
+    .def_readonly("failed", &ci::AsyncWriter::Stats::failed)
+    .def_readonly("writes_per_second", &ci::AsyncWriter::Stats::writes_per_second)
+    .def(self_ns::str(self_ns::self))
+  ;
+
+  class_<AsyncSensorDataWriter, boost::noncopyable>("AsyncWriter",
+      init<size_t, size_t, ci::AsyncWriter::DropPolicy, EColorConverter, std::string, int>((
+          arg("worker_threads")=0u,
+          arg("queue_size")=64u,
+          arg("drop_policy")=ci::AsyncWriter::DropPolicy::Block,
+          arg("color_converter")=EColorConverter::Raw,
+          arg("format")=std::string(),
+          arg("compression")=-1)))
+    .def("submit", &AsyncSensorDataWriter::Submit, (arg("data"), arg("path")))
+    .def("flush", &AsyncSensorDataWriter::Flush)
+    .def("get_stats", &AsyncSensorDataWriter::GetStats)
+  ;
+
+  class_<LidarSweep>("LidarSweep", no_init)
+    .def_readonly("frame", &LidarSweep::frame)
+    .def_readonly("timestamp", &LidarSweep::timestamp)
+    .def_readonly("transform", &LidarSweep::transform)
+    .def_readonly("measurement_count", &LidarSweep::measurement_count)
+    .def_readonly("dropped_points", &LidarSweep::dropped_points)
+    .def_readonly("points", &LidarSweep::points)
+  ;
+
+  class_<carla::pointcloud::LidarSweepAssembler, boost::noncopyable>("LidarSweepAssembler",
+      init<size_t, size_t>((arg("max_points_per_sweep"), arg("ring_size")=2u)))
+    .def("add", &AddToLidarSweep, (arg("measurement")))
+    .def("reset", &carla::pointcloud::LidarSweepAssembler::Reset)
+  ;
+
   class_<csd::CollisionEvent, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::CollisionEvent>>("CollisionEvent", no_init)
     .add_property("actor", &csd::CollisionEvent::GetActor)
     .add_property("other_actor", &csd::CollisionEvent::GetOtherActor)
@@ -17,6 +17,72 @@ static boost::python::object OptionalToPythonObject(OptionalT &optional) {
   return optional.has_value() ? boost::python::object(*optional) : boost::python::object();
 }
 
+/// Python object exporting, through the buffer protocol, read-only memory
+/// owned by another Python object that it keeps alive.
+struct OwnedBuffer {
+  PyObject_HEAD
+  PyObject *owner;
+  void *data;
+  Py_ssize_t size;
+};
+
+static int OwnedBufferGetBuffer(PyObject *self, Py_buffer *view, int flags) {
+  auto *buffer = reinterpret_cast<OwnedBuffer *>(self);
+  return PyBuffer_FillInfo(view, self, buffer->data, buffer->size, 1, flags);
+}
+
+static PyTypeObject *GetOwnedBufferType();
+
+static void OwnedBufferDealloc(PyObject *self) {
+  Py_XDECREF(reinterpret_cast<OwnedBuffer *>(self)->owner);
+  GetOwnedBufferType()->tp_free(self);
+}
+
+static PyTypeObject MakeOwnedBufferType() {
+  static PyBufferProcs buffer_procs = [] {
+    PyBufferProcs procs{};
+    procs.bf_getbuffer = &OwnedBufferGetBuffer;
+    return procs;
+  }();
+  PyTypeObject type{};
+  // As PyVarObject_HEAD_INIT, the type is static so it is never deallocated.
+  reinterpret_cast<PyObject &>(type).ob_refcnt = 1;
+  type.tp_name = "libcarla.OwnedBuffer";
+  type.tp_basicsize = sizeof(OwnedBuffer);
+  type.tp_dealloc = &OwnedBufferDealloc;
+  type.tp_as_buffer = &buffer_procs;
+  type.tp_flags = Py_TPFLAGS_DEFAULT;
+#if PY_MAJOR_VERSION < 3
+  type.tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+  return type;
+}
+
+static PyTypeObject *GetOwnedBufferType() {
+  static PyTypeObject type = MakeOwnedBufferType();
+  if (!(type.tp_flags & Py_TPFLAGS_READY) && (PyType_Ready(&type) != 0)) {
+    boost::python::throw_error_already_set();
+  }
+  return &type;
+}
+
+/// Return a read-only memoryview of the @a size bytes at @a data, owned by
+/// @a owner. The view shares the memory and keeps @a owner alive, so it stays
+/// valid after the other references to @a owner are gone.
+static boost::python::object MakeOwnedMemoryView(
+    boost::python::object owner,
+    const void *data,
+    size_t size) {
+  namespace py = boost::python;
+  py::object exporter(py::handle<>(PyType_GenericAlloc(GetOwnedBufferType(), 0)));
+  auto *buffer = reinterpret_cast<OwnedBuffer *>(exporter.ptr());
+  Py_INCREF(owner.ptr());
+  buffer->owner = owner.ptr();
+  buffer->data = const_cast<void *>(data);
+  buffer->size = static_cast<Py_ssize_t>(size);
+  return py::object(py::handle<>(PyMemoryView_FromObject(exporter.ptr())));
+}
+
 // Convenient for requests without arguments.
 #define CALL_WITHOUT_GIL(cls, fn) +[](cls &self) { \
       carla::PythonUtil::ReleaseGIL unlock; \
@@ -616,9 +616,15 @@ void UActorBlueprintFunctionLibrary::MakeLidarDefinition(
   LowerFOV.Id = TEXT("lower_fov");
   LowerFOV.Type = EActorAttributeType::Float;
   LowerFOV.RecommendedValues = { TEXT("-30.0") };
+  // Per-point attributes.
+  FActorVariation PointAttributes;
+  PointAttributes.Id = TEXT("point_attributes");
+  PointAttributes.Type = EActorAttributeType::Bool;
+  PointAttributes.RecommendedValues = { TEXT("false") };
+  PointAttributes.bRestrictToRecommended = false;
 
   Definition.Variations.Append(
-      {Channels, Range, PointsPerSecond, Frequency, UpperFOV, LowerFOV});
+      {Channels, Range, PointsPerSecond, Frequency, UpperFOV, LowerFOV, PointAttributes});
 
   Success = CheckActorDefinition(Definition);
 }
@@ -1114,6 +1120,8 @@ void UActorBlueprintFunctionLibrary::SetLidar(
       RetrieveActorAttributeToFloat("upper_fov", Description.Variations, Lidar.UpperFovLimit);
   Lidar.LowerFovLimit =
       RetrieveActorAttributeToFloat("lower_fov", Description.Variations, Lidar.LowerFovLimit);
+  Lidar.PointAttributes =
+      RetrieveActorAttributeToBool("point_attributes", Description.Variations, Lidar.PointAttributes);
 }
 
 #undef CARLA_ABFL_CHECK_ACTOR
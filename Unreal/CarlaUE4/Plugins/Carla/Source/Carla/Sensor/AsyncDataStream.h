@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "GameFramework/Actor.h"
+
 #include <compiler/disable-ue4-macros.h>
 #include <carla/Buffer.h>
 #include <carla/sensor/SensorRegistry.h>
@@ -57,6 +59,13 @@ public:
   template <typename SensorT, typename... ArgsT>
   void Send(SensorT &Sensor, ArgsT &&... Args);
 
+  /// Send a payload already serialized, for the sensors whose deserializer is
+  /// registered at carla::sensor::RuntimeSensorRegistry.
+  void SendPayload(carla::Buffer &&Payload)
+  {
+    Stream.Write(std::move(Header), std::move(Payload));
+  }
+
 private:
 
   friend class FDataStreamTmpl<T>;
@@ -68,6 +77,13 @@ private:
       double Timestamp,
       StreamType InStream);
 
+  /// @pre This functions needs to be called in the game-thread.
+  explicit FAsyncDataStreamTmpl(
+      const AActor &InSensor,
+      uint64_t SensorTypeId,
+      double Timestamp,
+      StreamType InStream);
+
   StreamType Stream;
 
   carla::Buffer Header;
@@ -104,8 +120,28 @@ inline FAsyncDataStreamTmpl<T>::FAsyncDataStreamTmpl(
     Header([&Sensor, Timestamp]() {
       check(IsInGameThread());
       using Serializer = carla::sensor::s11n::SensorHeaderSerializer;
+      using SensorSerializer = typename carla::sensor::SensorRegistry::template get<SensorT*>::type;
       return Serializer::Serialize(
           carla::sensor::SensorRegistry::template get<SensorT*>::index,
+          SensorSerializer::payload_type,
+          GFrameCounter,
+          Timestamp,
+          Sensor.GetActorTransform());
+    }()) {}
+
+template <typename T>
+inline FAsyncDataStreamTmpl<T>::FAsyncDataStreamTmpl(
+    const AActor &Sensor,
+    uint64_t SensorTypeId,
+    double Timestamp,
+    StreamType InStream)
+  : Stream(std::move(InStream)),
+    Header([&Sensor, SensorTypeId, Timestamp]() {
+      check(IsInGameThread());
+      using Serializer = carla::sensor::s11n::SensorHeaderSerializer;
+      return Serializer::Serialize(
+          SensorTypeId,
+          carla::sensor::s11n::PayloadType::Custom,
           GFrameCounter,
           Timestamp,
           Sensor.GetActorTransform());
@@ -43,6 +43,16 @@ public:
     return FAsyncDataStreamTmpl<T>{Sensor, Timestamp, *Stream};
   }
 
+  /// Create a FAsyncDataStream object for a sensor whose deserializer is
+  /// registered at carla::sensor::RuntimeSensorRegistry with @a SensorTypeId.
+  ///
+  /// @pre This functions needs to be called in the game-thread.
+  auto MakeAsyncDataStream(const AActor &Sensor, uint64_t SensorTypeId, double Timestamp)
+  {
+    check(Stream.has_value());
+    return FAsyncDataStreamTmpl<T>{Sensor, SensorTypeId, Timestamp, *Stream};
+  }
+
   /// Return the token that allows subscribing to this stream.
   auto GetToken() const
   {
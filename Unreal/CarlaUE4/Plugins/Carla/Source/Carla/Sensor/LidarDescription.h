@@ -39,6 +39,11 @@ struct CARLA_API FLidarDescription
   UPROPERTY(EditAnywhere)
   float LowerFovLimit = -30.0f;
 
+  /// Whether to send the intensity, time offset and channel of each point,
+  /// 10 extra bytes per point.
+  UPROPERTY(EditAnywhere)
+  bool PointAttributes = false;
+
   /// Wether to show debug points of laser hits in simulator.
   UPROPERTY(EditAnywhere)
   bool ShowDebugPoints = false;
@@ -35,7 +35,11 @@ void ARayCastLidar::Set(const FActorDescription &ActorDescription)
 void ARayCastLidar::Set(const FLidarDescription &LidarDescription)
 {
   Description = LidarDescription;
-  LidarMeasurement = FLidarMeasurement(Description.Channels);
+  LidarMeasurement = FLidarMeasurement(
+      Description.Channels,
+      Description.PointAttributes ?
+          FLidarMeasurement::Version::WithAttributes :
+          FLidarMeasurement::Version::PointsOnly);
   CreateLasers();
 }
 
@@ -87,6 +91,9 @@ void ARayCastLidar::ReadPoints(const float DeltaTime)
   const float CurrentHorizontalAngle = LidarMeasurement.GetHorizontalAngle();
   const float AngleDistanceOfTick = Description.RotationFrequency * 360.0f * DeltaTime;
   const float AngleDistanceOfLaserMeasure = AngleDistanceOfTick / PointsToScanWithOneLaser;
+  // The points of each laser are shot evenly during the tick, which ends at
+  // the timestamp of the measurement.
+  const float TimeOfLaserMeasure = DeltaTime / PointsToScanWithOneLaser;
 
   LidarMeasurement.Reset(ChannelCount * PointsToScanWithOneLaser);
 
@@ -98,7 +105,10 @@ void ARayCastLidar::ReadPoints(const float DeltaTime)
       const float Angle = CurrentHorizontalAngle + AngleDistanceOfLaserMeasure * i;
       if (ShootLaser(Channel, Angle, Point))
       {
-        LidarMeasurement.WritePoint(Channel, Point);
+        // Intensity is not modelled yet, always 0. The attributes are
+        // discarded if they are not enabled.
+        const float TimeOffset = TimeOfLaserMeasure * i - DeltaTime;
+        LidarMeasurement.WritePoint(Channel, Point, 0.0f, TimeOffset);
       }
     }
   }
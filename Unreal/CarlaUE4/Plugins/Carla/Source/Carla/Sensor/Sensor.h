@@ -68,6 +68,14 @@ protected:
     return Stream.MakeAsyncDataStream(Self, GetEpisode().GetElapsedGameTime());
   }
 
+  /// Return the FDataStream associated with this sensor, for sensors whose
+  /// deserializer is registered at carla::sensor::RuntimeSensorRegistry with
+  /// @a SensorTypeId. Send its data with FAsyncDataStream::SendPayload.
+  FAsyncDataStream GetCustomDataStream(uint64 SensorTypeId)
+  {
+    return Stream.MakeAsyncDataStream(*this, SensorTypeId, GetEpisode().GetElapsedGameTime());
+  }
+
 private:
 
   FDataStream Stream;